@@ -0,0 +1,180 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELBENCHMARK_H
+#define EUTELBENCHMARK_H
+
+// system includes <>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Key/value pairs describing a benchmark or its configuration
+  /*! The values are kept as JSON text, strings are quoted on insertion:
+   *  EUTelBenchmarkTags()("sensor", "Mimosa26")("occupancy", 1e-3)
+   */
+  class EUTelBenchmarkTags {
+  public:
+    EUTelBenchmarkTags() : _tags() {}
+
+    EUTelBenchmarkTags &operator()(std::string const &key, std::string const &value) {
+      _tags.emplace_back(key, quote(value));
+      return *this;
+    }
+    EUTelBenchmarkTags &operator()(std::string const &key, char const *value) {
+      return (*this)(key, std::string(value));
+    }
+    EUTelBenchmarkTags &operator()(std::string const &key, double value) {
+      _tags.emplace_back(key, number(value));
+      return *this;
+    }
+
+    //! The tags as the members of a JSON object, without the braces
+    std::string members() const {
+      std::string json;
+      for(auto const &tag : _tags) {
+        json += (json.empty() ? "" : ", ") + quote(tag.first) + ": " + tag.second;
+      }
+      return json;
+    }
+
+    static std::string quote(std::string const &text) {
+      std::string quoted = "\"";
+      for(char const c : text) {
+        if(c == '"' || c == '\\') {
+          quoted += '\\';
+          quoted += c;
+        } else if(static_cast<unsigned char>(c) < 0x20) {
+          char escaped[8];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+          quoted += escaped;
+        } else {
+          quoted += c;
+        }
+      }
+      return quoted + "\"";
+    }
+
+    //! JSON has no infinities and NaNs, they become null
+    static std::string number(double value) {
+      if(!std::isfinite(value)) return "null";
+      std::ostringstream text;
+      text.precision(6);
+      text << value;
+      return text.str();
+    }
+
+  private:
+    std::vector<std::pair<std::string, std::string>> _tags;
+  };
+
+  //! Minimal timing harness writing its results as JSON
+  /*! Each benchmark is a callable doing one iteration of the measured work
+   *  and returning a value depending on all of it (e.g. a sum of the
+   *  results), which keeps the compiler from optimising the work away.
+   *
+   *  The number of iterations per repetition is doubled until a repetition
+   *  takes at least minTime / repetitions, then the repetitions are timed
+   *  and their median and minimum reported, per iteration and per item
+   *  (pixel, cluster, hit, track, ... as given to run()). For benchmarks
+   *  consuming a data stream the bytes per iteration can be given as
+   *  well, to get the throughput in MB/s.
+   */
+  class EUTelBenchmark {
+  public:
+    EUTelBenchmark(std::string const &suite, double minTime, unsigned repetitions)
+        : _suite(suite), _minTime(minTime), _repetitions(std::max(repetitions, 1u)),
+          _config(), _results(), _sink(0.) {}
+
+    //! Record the configuration of the whole suite
+    void setConfig(EUTelBenchmarkTags const &config) { _config = config; }
+
+    template <class Function>
+    void run(std::string const &name, EUTelBenchmarkTags const &tags,
+             double itemsPerIteration, Function function, double bytesPerIteration = 0.) {
+      double const batchTime = _minTime / _repetitions;
+      size_t iterations = 1;
+      while(time(function, iterations) < batchTime && iterations < (size_t(1) << 40)) {
+        iterations *= 2;
+      }
+
+      std::vector<double> perIteration;
+      for(unsigned i = 0; i < _repetitions; ++i) {
+        perIteration.push_back(time(function, iterations) * 1e9 / static_cast<double>(iterations));
+      }
+      std::sort(perIteration.begin(), perIteration.end());
+      double const median = perIteration[perIteration.size() / 2];
+
+      record(name, tags, iterations, _repetitions, median, perIteration.front(), itemsPerIteration,
+             bytesPerIteration);
+    }
+
+    //! Record a measurement timed by the caller, for work which can not be repeated
+    void add(std::string const &name, EUTelBenchmarkTags const &tags, double seconds,
+             double items, double bytes = 0.) {
+      record(name, tags, 1, 1, seconds * 1e9, seconds * 1e9, items, bytes);
+    }
+
+    void writeJSON(std::ostream &out) const {
+      out << "{\n  \"suite\": " << EUTelBenchmarkTags::quote(_suite)
+          << ",\n  \"config\": {" << _config.members() << "},\n  \"results\": [";
+      for(size_t i = 0; i < _results.size(); ++i) {
+        out << (i ? ",\n    " : "\n    ") << _results[i];
+      }
+      out << "\n  ]\n}" << std::endl;
+    }
+
+  private:
+    void record(std::string const &name, EUTelBenchmarkTags const &tags, size_t iterations,
+                unsigned repetitions, double nsMedian, double nsMin, double items, double bytes) {
+      std::ostringstream json;
+      std::string const tagMembers = tags.members();
+      json << "{\"name\": " << EUTelBenchmarkTags::quote(name)
+           << (tagMembers.empty() ? "" : ", ") << tagMembers
+           << ", \"iterations\": " << iterations
+           << ", \"repetitions\": " << repetitions
+           << ", \"ns_per_iteration\": " << EUTelBenchmarkTags::number(nsMedian)
+           << ", \"ns_per_iteration_min\": " << EUTelBenchmarkTags::number(nsMin)
+           << ", \"items_per_iteration\": " << EUTelBenchmarkTags::number(items)
+           << ", \"ns_per_item\": " << EUTelBenchmarkTags::number(items > 0. ? nsMedian / items : 0.)
+           << ", \"items_per_second\": " << EUTelBenchmarkTags::number(nsMedian > 0. ? items * 1e9 / nsMedian : 0.);
+      if(bytes > 0.) {
+        json << ", \"mb_per_second\": " << EUTelBenchmarkTags::number(nsMedian > 0. ? bytes * 1e3 / nsMedian : 0.);
+      }
+      json << "}";
+      _results.push_back(json.str());
+      std::cerr << name << " {" << tagMembers << "}: " << nsMedian << " ns per iteration" << std::endl;
+    }
+
+    template <class Function> double time(Function &function, size_t iterations) {
+      auto const start = std::chrono::steady_clock::now();
+      double sum = 0.;
+      for(size_t i = 0; i < iterations; ++i) sum += function();
+      auto const stop = std::chrono::steady_clock::now();
+      _sink = _sink + sum;
+      return std::chrono::duration<double>(stop - start).count();
+    }
+
+    std::string _suite;
+    double _minTime;
+    unsigned _repetitions;
+    EUTelBenchmarkTags _config;
+    std::vector<std::string> _results;
+    //! Where the results of the benchmarked functions end up
+    volatile double _sink;
+  };
+}
+#endif
@@ -0,0 +1,230 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// Throughput of the ALPIDE multi-event cluster filter: the original
+// algorithm of EUTelProcessorALPIDEClusterFilter (nested vectors, pairwise
+// pixel comparison, erase from the middle) against
+// EUTelMultiEventClusterFilter, on a synthetic high occupancy ALPIDE run.
+// Both must write out exactly the same clusters. The timings are written
+// as JSON to stdout.
+//
+// Usage: benchALPIDEClusterFilter [events] [clusters per sensor and event]
+
+// eutelescope includes ".h"
+#include "EUTelBenchmark.h"
+#include "EUTelMultiEventClusterFilter.h"
+
+// system includes <>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace eutelescope;
+
+namespace {
+
+  int const nSensors = 6;
+  int const nColumns = 1024;
+  int const nRows = 512;
+  int const depth = 2;
+  float const overlap = 0.1f;
+  int const pixelType = 2; // kEUTelGenericSparsePixel
+
+  struct InputCluster {
+    int sensorID, time;
+    std::vector<EUTelMultiEventClusterFilter::Pixel> pixels;
+  };
+  typedef std::vector<InputCluster> InputEvent;
+
+  //! A written cluster, in the legacy [x, y, sensor, type, time, signal, pixel time] layout
+  typedef std::vector<std::vector<int>> OutputCluster;
+
+  //! Random clusters, a fraction of them repeated (partially) in the next events
+  std::vector<InputEvent> generateRun(size_t nEvents, unsigned clustersPerSensor) {
+    std::mt19937 generator(42);
+    std::poisson_distribution<unsigned> nClusters(clustersPerSensor);
+    std::uniform_int_distribution<int> column(0, nColumns - 1), row(0, nRows - 1);
+    std::uniform_int_distribution<int> step(-1, 1), size(1, 8);
+    std::uniform_real_distribution<double> uniform(0., 1.);
+
+    std::vector<InputEvent> run(nEvents);
+    for(size_t iEvent = 0; iEvent < nEvents; ++iEvent) {
+      //a few empty events, which never enter the window
+      if(uniform(generator) < 0.02) continue;
+      InputEvent &event = run[iEvent];
+      int const time = static_cast<int>(iEvent);
+      InputEvent const *previous = iEvent > 0 ? &run[iEvent - 1] : nullptr;
+      for(int sensorID = 0; sensorID < nSensors; ++sensorID) {
+        unsigned const n = nClusters(generator);
+        for(unsigned iCluster = 0; iCluster < n; ++iCluster) {
+          InputCluster cluster{sensorID, time, {}};
+          if(previous && !previous->empty() && uniform(generator) < 0.3) {
+            //repeated cluster, possibly missing or gaining a pixel
+            std::uniform_int_distribution<size_t> pick(0, previous->size() - 1);
+            InputCluster const &source = (*previous)[pick(generator)];
+            cluster.sensorID = source.sensorID;
+            cluster.pixels = source.pixels;
+            if(cluster.pixels.size() > 1 && uniform(generator) < 0.3) cluster.pixels.pop_back();
+            if(!cluster.pixels.empty() && uniform(generator) < 0.3) {
+              auto pixel = cluster.pixels.front();
+              pixel.x += 1;
+              cluster.pixels.push_back(pixel);
+            }
+          } else if(uniform(generator) > 0.001) {
+            int x = column(generator), y = row(generator);
+            int const nPixels = size(generator);
+            for(int iPixel = 0; iPixel < nPixels; ++iPixel) {
+              cluster.pixels.push_back({x, y, 1, 0});
+              x = std::min(std::max(x + step(generator), 0), nColumns - 1);
+              y = std::min(std::max(y + step(generator), 0), nRows - 1);
+            }
+          }
+          event.push_back(cluster);
+        }
+      }
+    }
+    return run;
+  }
+
+  //! The algorithm of EUTelProcessorALPIDEClusterFilter before the ring buffer
+  class LegacyFilter {
+  public:
+    LegacyFilter() : PixelsOfEvents() {}
+
+    void process(InputEvent const &event, std::vector<OutputCluster> &output) {
+      readCollections(event);
+      filter();
+      writeCollection(output);
+    }
+
+  private:
+    bool SameCluster(int iEvent, int iCluster, int jEvent, int jCluster) {
+      auto const &a = PixelsOfEvents[static_cast<size_t>(iEvent)][static_cast<size_t>(iCluster)];
+      auto const &b = PixelsOfEvents[static_cast<size_t>(jEvent)][static_cast<size_t>(jCluster)];
+      int nSame = 0;
+      for(unsigned int iPixel = 0; iPixel < a.size(); iPixel++) {
+        for(unsigned int jPixel = 0; jPixel < b.size(); jPixel++) {
+          if(a[iPixel][0] == b[jPixel][0] && a[iPixel][1] == b[jPixel][1] &&
+             a[iPixel][2] == b[jPixel][2] && a[iPixel][3] == b[jPixel][3]) {
+            nSame++;
+            break;
+          }
+        }
+      }
+      return static_cast<float>(nSame) > static_cast<float>(a.size()) * overlap ||
+             static_cast<float>(nSame) > static_cast<float>(b.size()) * overlap;
+    }
+
+    void readCollections(InputEvent const &event) {
+      std::vector<std::vector<std::vector<int>>> EventPixels;
+      for(auto const &cluster : event) {
+        std::vector<std::vector<int>> pixVector;
+        for(auto const &pixel : cluster.pixels) {
+          pixVector.push_back({pixel.x, pixel.y, cluster.sensorID, pixelType, cluster.time,
+                               pixel.signal, pixel.time});
+        }
+        EventPixels.push_back(pixVector);
+      }
+      if(!EventPixels.empty()) PixelsOfEvents.push_back(EventPixels);
+    }
+
+    void filter() {
+      if(PixelsOfEvents.size() <= depth) return;
+      for(unsigned int iCluster = 0; iCluster < PixelsOfEvents[0].size(); iCluster++) {
+        for(unsigned int jEvent = 1; jEvent <= depth; jEvent++) {
+          bool wasSameCluster = false;
+          for(unsigned int jCluster = 0; jCluster < PixelsOfEvents[jEvent].size(); jCluster++) {
+            if(SameCluster(0, static_cast<int>(iCluster), static_cast<int>(jEvent), static_cast<int>(jCluster))) {
+              PixelsOfEvents[jEvent].erase(PixelsOfEvents[jEvent].begin() + jCluster);
+              wasSameCluster = true;
+            }
+          }
+          if(!wasSameCluster) break;
+        }
+      }
+    }
+
+    void writeCollection(std::vector<OutputCluster> &output) {
+      if(PixelsOfEvents.size() <= depth) return;
+      for(auto &cluster : PixelsOfEvents[0]) {
+        OutputCluster written;
+        while(!cluster.empty()) {
+          written.push_back(cluster.front());
+          cluster.erase(cluster.begin());
+        }
+        if(!written.empty()) output.push_back(written);
+      }
+      PixelsOfEvents.erase(PixelsOfEvents.begin());
+    }
+
+    std::vector<std::vector<std::vector<std::vector<int>>>> PixelsOfEvents;
+  };
+
+  void processNew(EUTelMultiEventClusterFilter &filter, InputEvent const &event,
+                  std::vector<OutputCluster> &output) {
+    filter.beginEvent();
+    for(auto const &cluster : event) {
+      filter.addCluster(cluster.sensorID, pixelType, cluster.time);
+      for(auto const &pixel : cluster.pixels) {
+        filter.addPixel(pixel.x, pixel.y, pixel.signal, pixel.time);
+      }
+    }
+    if(!filter.endEvent()) return;
+    for(size_t iCluster = 0; iCluster < filter.getNumberOfClusters(); ++iCluster) {
+      if(!filter.isKept(iCluster)) continue;
+      OutputCluster written;
+      for(auto pixel = filter.pixelsBegin(iCluster); pixel != filter.pixelsEnd(iCluster); ++pixel) {
+        written.push_back({pixel->x, pixel->y, filter.getSensorID(iCluster), filter.getType(iCluster),
+                           filter.getTime(iCluster), pixel->signal, pixel->time});
+      }
+      if(!written.empty()) output.push_back(written);
+    }
+  }
+
+  template<class Function> double seconds(Function function) {
+    auto const start = std::chrono::steady_clock::now();
+    function();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+}
+
+int main(int argc, char **argv) {
+  size_t const nEvents = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500;
+  auto const clustersPerSensor = static_cast<unsigned>(argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100);
+
+  auto const run = generateRun(nEvents, clustersPerSensor);
+
+  std::vector<OutputCluster> legacyOutput, newOutput;
+  LegacyFilter legacy;
+  double const legacyTime = seconds([&] {
+    for(auto const &event : run) legacy.process(event, legacyOutput);
+  });
+  EUTelMultiEventClusterFilter filter(depth, overlap);
+  double const newTime = seconds([&] {
+    for(auto const &event : run) processNew(filter, event, newOutput);
+  });
+
+  EUTelBenchmark benchmark("alpideclusterfilter", 0., 1);
+  benchmark.setConfig(EUTelBenchmarkTags()("events", static_cast<double>(nEvents))("sensors", nSensors)
+                      ("clustersPerSensor", clustersPerSensor)("depth", depth)("overlap", overlap));
+  benchmark.add("legacyFilter", EUTelBenchmarkTags()("items", "events")("clustersWritten", static_cast<double>(legacyOutput.size())),
+                legacyTime, static_cast<double>(nEvents));
+  benchmark.add("ringBufferFilter", EUTelBenchmarkTags()("items", "events")("clustersWritten", static_cast<double>(newOutput.size())),
+                newTime, static_cast<double>(nEvents));
+  benchmark.writeJSON(std::cout);
+
+  if(legacyOutput != newOutput) {
+    std::cerr << "The two filters write out different clusters" << std::endl;
+    return 1;
+  }
+  return 0;
+}
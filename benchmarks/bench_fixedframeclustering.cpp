@@ -0,0 +1,192 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// Throughput of the NZS fixed frame clustering on full frames, in frames/s:
+//  - legacyLoop: the loops of EUTelClusteringProcessor before
+//    EUTelFixedFrameClusterFinder, a bound check and an index computation
+//    per window pixel and new candidate vectors per seed
+//  - finder: EUTelFixedFrameClusterFinder, offset table and a bound check
+//    only for the seeds near the frame edge
+// Both must find the same clusters.
+//
+// Usage: benchFixedFrameClustering [--frames 20] [--x-pixels 1152]
+//                                  [--y-pixels 576] [--hits 200]
+//                                  [--cluster-size 3] [--min-time 1]
+//                                  [--repetitions 5] [--output results.json]
+
+// eutelescope includes ".h"
+#include "EUTELESCOPE.h"
+#include "EUTelBenchmark.h"
+#include "EUTelFixedFrameClusterFinder.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace eutelescope;
+
+namespace {
+
+  float const seedCut = 4.5f;
+  float const clusterCut = 6.f;
+
+  //! The former loops, returning the number of clusters
+  size_t legacyLoop(int xNoOfPixel, int yNoOfPixel, int clusterSize, float const *charge, float const *noise,
+                    std::vector<short> &status, std::vector<std::pair<float, unsigned int>> &seeds) {
+    seeds.clear();
+    for(unsigned int iPixel = 0; iPixel < status.size(); iPixel++) {
+      if(status[iPixel] == EUTELESCOPE::GOODPIXEL && charge[iPixel] > seedCut * noise[iPixel]) {
+        seeds.push_back(std::make_pair(charge[iPixel], iPixel));
+      }
+    }
+    std::sort(seeds.begin(), seeds.end());
+
+    size_t nClusters = 0;
+    for(auto seed = seeds.rbegin(); seed != seeds.rend(); ++seed) {
+      if(status[seed->second] != EUTELESCOPE::GOODPIXEL) continue;
+      double signal = 0.;
+      double noise2 = 0.;
+      std::vector<float> charges;
+      std::vector<int> indices;
+      int const seedX = static_cast<int>(seed->second) % xNoOfPixel;
+      int const seedY = static_cast<int>(seed->second) / xNoOfPixel;
+      for(int yPixel = seedY - clusterSize / 2; yPixel <= seedY + clusterSize / 2; yPixel++) {
+        for(int xPixel = seedX - clusterSize / 2; xPixel <= seedX + clusterSize / 2; xPixel++) {
+          if(xPixel >= 0 && xPixel < xNoOfPixel && yPixel >= 0 && yPixel < yNoOfPixel) {
+            int const index = xPixel + yPixel * xNoOfPixel;
+            bool const isGood = status[index] == EUTELESCOPE::GOODPIXEL;
+            indices.push_back(isGood ? index : -1);
+            if(isGood) {
+              signal += charge[index];
+              noise2 += std::pow(noise[index], 2);
+            }
+            charges.push_back(isGood ? charge[index] : 0.f);
+          } else {
+            charges.push_back(0.f);
+            indices.push_back(-1);
+          }
+        }
+      }
+      if(signal > clusterCut * std::sqrt(noise2)) {
+        for(int index : indices) {
+          if(index != -1) status[static_cast<size_t>(index)] = static_cast<short>(EUTELESCOPE::HITPIXEL);
+        }
+        ++nClusters;
+      }
+    }
+    return nClusters;
+  }
+}
+
+int main(int argc, char **argv) {
+  std::string output;
+  size_t nFrames = 20;
+  int xNoOfPixel = 1152;
+  int yNoOfPixel = 576;
+  size_t nHits = 200;
+  int clusterSize = 3;
+  double minTime = 1.;
+  unsigned repetitions = 5;
+
+  for(int i = 1; i + 1 < argc; i += 2) {
+    std::string const option = argv[i], value = argv[i + 1];
+    if(option == "--frames") nFrames = std::strtoul(value.c_str(), nullptr, 10);
+    else if(option == "--x-pixels") xNoOfPixel = std::atoi(value.c_str());
+    else if(option == "--y-pixels") yNoOfPixel = std::atoi(value.c_str());
+    else if(option == "--hits") nHits = std::strtoul(value.c_str(), nullptr, 10);
+    else if(option == "--cluster-size") clusterSize = std::atoi(value.c_str());
+    else if(option == "--min-time") minTime = std::atof(value.c_str());
+    else if(option == "--repetitions") repetitions = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+    else if(option == "--output") output = value;
+    else {
+      std::cerr << "Unknown option " << option << std::endl;
+      return 1;
+    }
+  }
+
+  //Gaussian noise around 1 with 3x3 charge blobs at random positions
+  size_t const nPixel = static_cast<size_t>(xNoOfPixel) * static_cast<size_t>(yNoOfPixel);
+  std::mt19937 generator(42);
+  std::normal_distribution<float> gaussian(0.f, 1.f);
+  std::uniform_int_distribution<size_t> position(0, nPixel - 1);
+  std::vector<float> noise(nPixel), charge(nFrames * nPixel);
+  for(auto &value : noise) value = 1.f + 0.2f * std::abs(gaussian(generator));
+  for(size_t iFrame = 0; iFrame < nFrames; ++iFrame) {
+    float *frame = &charge[iFrame * nPixel];
+    for(size_t iPixel = 0; iPixel < nPixel; ++iPixel) frame[iPixel] = noise[iPixel] * gaussian(generator);
+    for(size_t iHit = 0; iHit < nHits; ++iHit) {
+      long const centre = static_cast<long>(position(generator));
+      for(long dy = -1; dy <= 1; ++dy) {
+        for(long dx = -1; dx <= 1; ++dx) {
+          long const index = centre + dx + dy * xNoOfPixel;
+          if(index < 0 || index >= static_cast<long>(nPixel)) continue;
+          frame[index] += (dx == 0 && dy == 0 ? 20.f : 5.f) * (1.f + 0.3f * gaussian(generator));
+        }
+      }
+    }
+  }
+
+  EUTelFixedFrameClusterFinder finder(xNoOfPixel, yNoOfPixel, clusterSize, clusterSize, seedCut, clusterCut);
+  std::vector<EUTelFixedFrameClusterFinder::Cluster> clusters;
+  std::vector<std::pair<float, unsigned int>> seeds;
+  std::vector<short> status(nPixel);
+  auto resetStatus = [&] { std::fill(status.begin(), status.end(), static_cast<short>(EUTELESCOPE::GOODPIXEL)); };
+
+  int result = 0;
+  double nClusters = 0.;
+  for(size_t iFrame = 0; iFrame < nFrames && result == 0; ++iFrame) {
+    float const *frame = &charge[iFrame * nPixel];
+    resetStatus();
+    size_t const legacy = legacyLoop(xNoOfPixel, yNoOfPixel, clusterSize, frame, noise.data(), status, seeds);
+    resetStatus();
+    nClusters += static_cast<double>(finder.findClusters(frame, noise.data(), status.data(), clusters));
+    if(clusters.size() != legacy) result = 1;
+  }
+  if(result != 0) std::cerr << "The cluster finder and the legacy loop give different clusters" << std::endl;
+
+  double const frames = static_cast<double>(nFrames);
+  double const bytes = frames * static_cast<double>(nPixel * sizeof(float));
+  EUTelBenchmark benchmark("fixedframeclustering", minTime, repetitions);
+  benchmark.setConfig(EUTelBenchmarkTags()("frames", frames)("xPixels", xNoOfPixel)("yPixels", yNoOfPixel)
+                      ("hits", static_cast<double>(nHits))("clusterSize", clusterSize)
+                      ("clustersPerFrame", nClusters / frames)("minTime", minTime)("repetitions", repetitions));
+  EUTelBenchmarkTags const tags = EUTelBenchmarkTags()("items", "frames");
+  benchmark.run("legacyLoop", tags, frames, [&] {
+    double total = 0.;
+    for(size_t iFrame = 0; iFrame < nFrames; ++iFrame) {
+      resetStatus();
+      total += static_cast<double>(
+          legacyLoop(xNoOfPixel, yNoOfPixel, clusterSize, &charge[iFrame * nPixel], noise.data(), status, seeds));
+    }
+    return total;
+  }, bytes);
+  benchmark.run("finder", tags, frames, [&] {
+    double total = 0.;
+    for(size_t iFrame = 0; iFrame < nFrames; ++iFrame) {
+      resetStatus();
+      total += static_cast<double>(finder.findClusters(&charge[iFrame * nPixel], noise.data(), status.data(), clusters));
+    }
+    return total;
+  }, bytes);
+
+  if(output.empty()) {
+    benchmark.writeJSON(std::cout);
+  } else {
+    std::ofstream file(output);
+    benchmark.writeJSON(file);
+  }
+  return result;
+}
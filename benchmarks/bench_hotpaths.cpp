@@ -0,0 +1,434 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// Microbenchmarks of the per event hot paths of the reconstruction, on
+// synthetic data with a fixed seed:
+//  - getSparseData: decoding the sparse pixels of a TrackerDataImpl
+//  - sparseClustering: the cluster finder of EUTelSparseClustering
+//  - getCenterOfGravity: EUTelGenericSparseClusterImpl on the found clusters
+//  - local2Master / local2MasterBatch: hit transformation, with a GEAR file
+//  - findTriplets / matchTriplets / gblFit: the EUTelGBL track finding and fit
+// The pixel benchmarks run on Poisson hit maps of Mimosa26, FEI4 and ALPIDE
+// sized sensors at the requested occupancies, the tracking ones on straight
+// tracks through a six plane telescope with noise hits.
+//
+// The results are written as JSON, to stdout or the file given by --output.
+//
+// Usage: benchHotPaths [--occupancy 1e-4,1e-3,1e-2] [--tracks 5,20,50]
+//                      [--events 100] [--min-time 0.5] [--repetitions 5]
+//                      [--gear file.xml] [--output results.json]
+
+// eutelescope includes ".h"
+#include "EUTELESCOPE.h"
+#include "EUTelBenchmark.h"
+#include "EUTelGenericSparseClusterImpl.h"
+#include "EUTelGenericSparsePixel.h"
+#include "EUTelGeometryTelescopeGeoDescription.h"
+#include "EUTelSparseClusterFinder.h"
+#include "EUTelTripletGBLUtility.h"
+#include "EUTelUtility.h"
+
+#ifdef USE_GBL
+// GBL includes
+#include "include/GblTrajectory.h"
+#endif
+
+// gear includes <.h>
+#include "gear/GearMgr.h"
+#include "gearxml/GearXML.h"
+
+// lcio includes <.h>
+#include <IMPL/TrackerDataImpl.h>
+
+// system includes <>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace eutelescope;
+
+namespace {
+
+  //! Pixel matrix of a sensor type
+  struct SensorSpec {
+    char const *name;
+    int nColumns, nRows;
+    //! Largest signal, 1 for binary read out
+    int maxSignal;
+  };
+
+  // Mimosa26 and FEI4 as in geometries/, ALPIDE (no geometry there) from its data sheet
+  SensorSpec const sensorSpecs[] = {{"Mimosa26", 1152, 576, 1},
+                                    {"FEI4", 80, 336, 14},
+                                    {"ALPIDE", 1024, 512, 1}};
+
+  struct Pixel {
+    short x, y;
+    float signal;
+  };
+  typedef std::vector<Pixel> HitMap;
+
+  //! Mean number of pixels of a cluster from hitMaps()
+  double const meanClusterSize = 2.5;
+
+  //! Hit maps with occupancy fired pixels per pixel and event on average
+  /*! The clusters are placed uniformly, their number is Poisson distributed.
+   *  A cluster is a seed pixel and each of its three neighbours towards
+   *  higher x and y with a probability of one half.
+   */
+  std::vector<HitMap> hitMaps(SensorSpec const &spec, double occupancy, size_t nEvents,
+                              std::mt19937 &generator) {
+    std::poisson_distribution<int> nClusters(occupancy * spec.nColumns * spec.nRows / meanClusterSize);
+    std::uniform_int_distribution<int> column(0, spec.nColumns - 2), row(0, spec.nRows - 2);
+    std::uniform_int_distribution<int> signal(1, spec.maxSignal);
+    std::bernoulli_distribution neighbour(0.5);
+
+    std::vector<HitMap> maps(nEvents);
+    for(auto &map : maps) {
+      int const n = nClusters(generator);
+      for(int iCluster = 0; iCluster < n; ++iCluster) {
+        int const x = column(generator), y = row(generator);
+        map.push_back(Pixel{static_cast<short>(x), static_cast<short>(y), static_cast<float>(signal(generator))});
+        for(int dx = 0; dx < 2; ++dx) {
+          for(int dy = 0; dy < 2; ++dy) {
+            if((dx || dy) && neighbour(generator)) {
+              map.push_back(Pixel{static_cast<short>(x + dx), static_cast<short>(y + dy),
+                                  static_cast<float>(signal(generator))});
+            }
+          }
+        }
+      }
+      //overlapping clusters fire a pixel only once
+      std::sort(map.begin(), map.end(), [](Pixel const &a, Pixel const &b) {
+        return a.x != b.x ? a.x < b.x : a.y < b.y;
+      });
+      map.erase(std::unique(map.begin(), map.end(), [](Pixel const &a, Pixel const &b) {
+                  return a.x == b.x && a.y == b.y;
+                }), map.end());
+      std::shuffle(map.begin(), map.end(), generator);
+    }
+    return maps;
+  }
+
+  //! Zero suppressed data in the kEUTelGenericSparsePixel layout
+  std::unique_ptr<IMPL::TrackerDataImpl> sparseData(HitMap const &map) {
+    std::unique_ptr<IMPL::TrackerDataImpl> data(new IMPL::TrackerDataImpl);
+    std::vector<float> values;
+    values.reserve(4 * map.size());
+    for(auto const &pixel : map) {
+      values.insert(values.end(), {static_cast<float>(pixel.x), static_cast<float>(pixel.y), pixel.signal, 0.f});
+    }
+    data->setChargeValues(values);
+    return data;
+  }
+
+  size_t totalSize(std::vector<HitMap> const &maps) {
+    size_t n = 0;
+    for(auto const &map : maps) n += map.size();
+    return n;
+  }
+
+  void benchmarkPixels(EUTelBenchmark &benchmark, SensorSpec const &spec, double occupancy,
+                       size_t nEvents, std::mt19937 &generator) {
+    auto const maps = hitMaps(spec, occupancy, nEvents, generator);
+    auto const nPixels = static_cast<double>(totalSize(maps));
+    auto const tags = [&] { return EUTelBenchmarkTags()("sensor", spec.name)("occupancy", occupancy)("events", static_cast<double>(nEvents)); };
+
+    std::vector<std::unique_ptr<IMPL::TrackerDataImpl>> data;
+    for(auto const &map : maps) data.push_back(sparseData(map));
+
+    benchmark.run("getSparseData", tags()("items", "pixels"), nPixels, [&] {
+      double sum = 0.;
+      for(auto const &event : data) {
+        auto const pixels = Utility::getSparseData(event.get(), kEUTelGenericSparsePixel);
+        for(auto const &pixel : *pixels) sum += pixel.get().getSignal();
+      }
+      return sum;
+    });
+
+    EUTelSparseClusterFinder finder(0, spec.nColumns - 1, 0, spec.nRows - 1, 2);
+    benchmark.run("sparseClustering", tags()("items", "pixels"), nPixels, [&] {
+      size_t nClusters = 0;
+      for(auto const &map : maps) {
+        finder.clear();
+        for(auto const &pixel : map) finder.addPixel(pixel.x, pixel.y);
+        nClusters += finder.findClusters();
+      }
+      return nClusters;
+    });
+
+    //the clusters found above, as written out by the clustering processors
+    std::vector<std::unique_ptr<IMPL::TrackerDataImpl>> clusterData;
+    for(auto const &map : maps) {
+      finder.clear();
+      for(auto const &pixel : map) finder.addPixel(pixel.x, pixel.y);
+      finder.findClusters();
+      for(size_t iCluster = 0; iCluster < finder.getNumberOfClusters(); ++iCluster) {
+        HitMap cluster;
+        auto const range = finder.getCluster(iCluster);
+        for(auto iPixel = range.first; iPixel != range.second; ++iPixel) cluster.push_back(map[*iPixel]);
+        clusterData.push_back(sparseData(cluster));
+      }
+    }
+    std::vector<std::unique_ptr<EUTelGenericSparseClusterImpl<EUTelGenericSparsePixel>>> clusters;
+    for(auto const &cluster : clusterData) {
+      clusters.emplace_back(new EUTelGenericSparseClusterImpl<EUTelGenericSparsePixel>(cluster.get()));
+    }
+    benchmark.run("getCenterOfGravity", tags()("items", "clusters"), static_cast<double>(clusters.size()), [&] {
+      double sum = 0.;
+      for(auto const &cluster : clusters) {
+        float x = 0.f, y = 0.f;
+        cluster->getCenterOfGravity(x, y);
+        sum += x + y;
+      }
+      return sum;
+    });
+  }
+
+  void benchmarkGeometry(EUTelBenchmark &benchmark, std::string const &gearFile,
+                         std::mt19937 &generator) {
+    gear::GearXML gearXML(gearFile);
+    gear::GearMgr *gearManager = gearXML.createGearMgr();
+    auto &geometry = geo::gGeometry(gearManager);
+    geometry.initializeTGeoDescription("benchHotPaths.root", false);
+    int const sensorID = geometry.sensorIDsVec().front();
+
+    size_t const nPoints = 10000;
+    std::uniform_real_distribution<double> position(-10., 10.);
+    std::vector<double> local(3 * nPoints), global(3 * nPoints);
+    for(size_t i = 0; i < nPoints; ++i) {
+      local[3 * i] = position(generator);
+      local[3 * i + 1] = position(generator);
+    }
+    auto const tags = [&] { return EUTelBenchmarkTags()("sensor", static_cast<double>(sensorID))("items", "hits"); };
+
+    benchmark.run("local2Master", tags(), nPoints, [&] {
+      for(size_t i = 0; i < nPoints; ++i) geometry.local2Master(sensorID, &local[3 * i], &global[3 * i]);
+      return global[3 * nPoints - 1];
+    });
+    benchmark.run("local2MasterBatch", tags(), nPoints, [&] {
+      geometry.local2Master(sensorID, local.data(), global.data(), nPoints);
+      return global[3 * nPoints - 1];
+    });
+  }
+
+  //! Six planes, 150 mm apart, as a DATURA/ACONITE telescope in a wide configuration
+  int const nPlanes = 6;
+  double const planeDistance = 150.;
+  double const resolution = 0.0035;
+
+  typedef std::vector<EUTelTripletGBLUtility::hit> HitVector;
+
+  EUTelTripletGBLUtility::hit telescopeHit(double x, double y, int plane) {
+    double const position[] = {x, y, plane * planeDistance};
+    EUTelTripletGBLUtility::hit hit(position, plane);
+    hit.ex = hit.ey = resolution;
+    hit.ez = 0.;
+    hit.clustersize = hit.clustersizex = hit.clustersizey = 1;
+    hit.locx = x;
+    hit.locy = y;
+    hit.id = 0;
+    return hit;
+  }
+
+  //! Straight tracks with a few mrad spread plus as many noise hits per plane
+  std::vector<HitVector> telescopeEvents(double tracksPerEvent, size_t nEvents,
+                                         std::mt19937 &generator) {
+    std::poisson_distribution<int> nTracks(tracksPerEvent);
+    std::uniform_real_distribution<double> inX(-10., 10.), inY(-5., 5.);
+    std::normal_distribution<double> slope(0., 0.002), smear(0., resolution);
+
+    std::vector<HitVector> events(nEvents);
+    for(auto &hits : events) {
+      int const n = nTracks(generator);
+      for(int iTrack = 0; iTrack < n; ++iTrack) {
+        double const x0 = inX(generator), y0 = inY(generator);
+        double const tx = slope(generator), ty = slope(generator);
+        for(int plane = 0; plane < nPlanes; ++plane) {
+          double const z = plane * planeDistance;
+          hits.push_back(telescopeHit(x0 + tx * z + smear(generator), y0 + ty * z + smear(generator), plane));
+        }
+      }
+      for(int iNoise = 0; iNoise < n * nPlanes; ++iNoise) {
+        hits.push_back(telescopeHit(inX(generator), inY(generator), iNoise % nPlanes));
+      }
+    }
+    return events;
+  }
+
+  void benchmarkTracking(EUTelBenchmark &benchmark, double tracksPerEvent, size_t nEvents,
+                         std::mt19937 &generator) {
+    auto const events = telescopeEvents(tracksPerEvent, nEvents, generator);
+    auto const tags = [&] { return EUTelBenchmarkTags()("tracks", tracksPerEvent)("events", static_cast<double>(nEvents)); };
+
+    //same cuts as the EUTelGBL examples
+    std::array<int, 3> const upstreamIDs{{0, 1, 2}}, downstreamIDs{{3, 4, 5}};
+    double const resCut = 0.1, slopeCut = 0.01, matchingCut = 0.1;
+    double const zMid = 2.5 * planeDistance;
+    EUTelTripletGBLUtility gblutil;
+
+    size_t nHits = 0;
+    for(auto const &hits : events) nHits += hits.size();
+    std::vector<std::vector<EUTelTripletGBLUtility::triplet>> upstream(nEvents), downstream(nEvents);
+    benchmark.run("findTriplets", tags()("items", "hits"), static_cast<double>(nHits), [&] {
+      size_t nTriplets = 0;
+      for(size_t iEvent = 0; iEvent < nEvents; ++iEvent) {
+        upstream[iEvent].clear();
+        downstream[iEvent].clear();
+        gblutil.FindTriplets(events[iEvent], upstreamIDs, resCut, slopeCut, upstream[iEvent], false, true);
+        gblutil.FindTriplets(events[iEvent], downstreamIDs, resCut, slopeCut, downstream[iEvent], false, false);
+        nTriplets += upstream[iEvent].size() + downstream[iEvent].size();
+      }
+      return nTriplets;
+    });
+
+    size_t nUpstream = 0;
+    for(auto const &triplets : upstream) nUpstream += triplets.size();
+    std::vector<std::vector<EUTelTripletGBLUtility::track>> tracks(nEvents);
+    benchmark.run("matchTriplets", tags()("items", "triplets"), static_cast<double>(nUpstream), [&] {
+      size_t nTracks = 0;
+      for(size_t iEvent = 0; iEvent < nEvents; ++iEvent) {
+        tracks[iEvent].clear();
+        gblutil.MatchTriplets(upstream[iEvent], downstream[iEvent], zMid, matchingCut, tracks[iEvent]);
+        nTracks += tracks[iEvent].size();
+      }
+      return nTracks;
+    });
+
+#ifdef USE_GBL
+    //the trajectory of EUTelGBL: a plane with a measurement and a scatterer,
+    //then two air scatterers at 21% and 79% of the way to the next plane
+    double const momentum = 4.;
+    auto const scatteringWeight = [&](double radLength) {
+      double const theta = 0.0136 / momentum * std::sqrt(radLength) * (1. + 0.038 * std::log(radLength));
+      return Eigen::Vector2d(1. / (theta * theta), 1. / (theta * theta));
+    };
+    Eigen::Vector2d const wscatSi = scatteringWeight(55e-3 / 93.66 + 50e-3 / 285.6);
+    Eigen::Vector2d const wscatAir = scatteringWeight(0.5 * planeDistance / 304200.);
+    Eigen::Vector2d const measPrec(1. / (resolution * resolution), 1. / (resolution * resolution));
+    Eigen::Matrix2d const proL2m = Eigen::Matrix2d::Identity();
+    Eigen::Vector2d const scat = Eigen::Vector2d::Zero();
+    auto const jacobianFirst = gblutil.JacobianPointToPoint(0.);
+    auto const jacobianPlane = gblutil.JacobianPointToPoint(0.21 * planeDistance);
+    auto const jacobianAirLeft = gblutil.JacobianPointToPoint(0.21 * planeDistance);
+    auto const jacobianAirRight = gblutil.JacobianPointToPoint(0.58 * planeDistance);
+
+    size_t nTracks = 0;
+    for(auto const &eventTracks : tracks) nTracks += eventTracks.size();
+    std::vector<gbl::GblPoint> points;
+    benchmark.run("gblFit", tags()("items", "tracks"), static_cast<double>(nTracks), [&] {
+      double sumChi2 = 0.;
+      for(auto &eventTracks : tracks) {
+        for(auto &track : eventTracks) {
+          auto const &up = track.get_upstream();
+          auto const &down = track.get_downstream();
+          points.clear();
+          for(int plane = 0; plane < nPlanes; ++plane) {
+            auto const &hit = plane < 3 ? up.gethit(plane) : down.gethit(plane);
+            points.emplace_back(plane ? jacobianPlane : jacobianFirst);
+            Eigen::Vector2d const meas(hit.x - up.getx_at(hit.z), hit.y - up.gety_at(hit.z));
+            points.back().addMeasurement(proL2m, meas, measPrec);
+            points.back().addScatterer(scat, wscatSi);
+            if(plane < nPlanes - 1) {
+              points.emplace_back(jacobianAirLeft);
+              points.back().addScatterer(scat, wscatAir);
+              points.emplace_back(jacobianAirRight);
+              points.back().addScatterer(scat, wscatAir);
+            }
+          }
+          gbl::GblTrajectory trajectory(points, false);
+          double chi2 = 0., lostWeight = 0.;
+          int ndf = 0;
+          trajectory.fit(chi2, ndf, lostWeight);
+          sumChi2 += chi2;
+        }
+      }
+      return sumChi2;
+    });
+#endif
+  }
+
+  std::vector<double> numberList(std::string const &text) {
+    std::vector<double> numbers;
+    std::istringstream list(text);
+    std::string item;
+    while(std::getline(list, item, ',')) numbers.push_back(std::atof(item.c_str()));
+    return numbers;
+  }
+
+  std::string joined(std::vector<double> const &numbers) {
+    std::string text;
+    for(auto number : numbers) text += (text.empty() ? "" : ",") + EUTelBenchmarkTags::number(number);
+    return text;
+  }
+}
+
+int main(int argc, char **argv) {
+  std::vector<double> occupancies{1e-4, 1e-3, 1e-2};
+  std::vector<double> tracksPerEvent{5., 20., 50.};
+  size_t nEvents = 100;
+  double minTime = 0.5;
+  unsigned repetitions = 5;
+#ifdef BENCHMARK_GEAR_FILE
+  std::string gearFile = BENCHMARK_GEAR_FILE;
+#else
+  std::string gearFile;
+#endif
+  std::string output;
+
+  for(int i = 1; i + 1 < argc; i += 2) {
+    std::string const option = argv[i], value = argv[i + 1];
+    if(option == "--occupancy") occupancies = numberList(value);
+    else if(option == "--tracks") tracksPerEvent = numberList(value);
+    else if(option == "--events") nEvents = std::strtoul(value.c_str(), nullptr, 10);
+    else if(option == "--min-time") minTime = std::atof(value.c_str());
+    else if(option == "--repetitions") repetitions = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+    else if(option == "--gear") gearFile = value;
+    else if(option == "--output") output = value;
+    else {
+      std::cerr << "Unknown option " << option << std::endl;
+      return 1;
+    }
+  }
+
+  EUTelBenchmark benchmark("hotpaths", minTime, repetitions);
+  benchmark.setConfig(EUTelBenchmarkTags()("events", static_cast<double>(nEvents))("minTime", minTime)
+                      ("repetitions", repetitions)("occupancies", joined(occupancies))
+                      ("tracks", joined(tracksPerEvent))("gear", gearFile));
+
+  std::mt19937 generator(42);
+  for(auto const &spec : sensorSpecs) {
+    for(auto occupancy : occupancies) benchmarkPixels(benchmark, spec, occupancy, nEvents, generator);
+  }
+  if(!gearFile.empty()) {
+    try {
+      benchmarkGeometry(benchmark, gearFile, generator);
+    } catch(std::exception const &e) {
+      std::cerr << "Skipping the geometry benchmarks: " << e.what() << std::endl;
+    }
+  }
+  for(auto tracks : tracksPerEvent) benchmarkTracking(benchmark, tracks, nEvents, generator);
+
+  if(output.empty()) {
+    benchmark.writeJSON(std::cout);
+  } else {
+    std::ofstream file(output);
+    benchmark.writeJSON(file);
+  }
+  return 0;
+}
@@ -0,0 +1,271 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// Throughput of the decoding of Ph2ACF raw files, in MB/s and events/s:
+//  - legacyStream: the original loop of Ph2ACF2LCIOConverter, reading the
+//    file word by word from an ifstream and testing every strip bit
+//  - mappedDecoder: EUTelMappedFile and EUTelPh2ACFDecoder
+// Both decode the whole file per iteration, the mapping included, with
+// the file in the page cache after the first one. Both must find exactly
+// the same strips and chip data.
+//
+// A recorded run is given with --input, together with its number of front
+// ends and chips. Without it a synthetic run of a 2S module (two front
+// ends of eight CBCs) is written to --scratch and removed afterwards.
+//
+// Usage: benchPh2ACFDecoder [--input run.raw] [--frontends 2] [--chips 8]
+//                           [--events 20000] [--occupancy 0.01]
+//                           [--scratch benchPh2ACFDecoder.raw]
+//                           [--min-time 1] [--repetitions 5] [--output results.json]
+
+// eutelescope includes ".h"
+#include "EUTelBenchmark.h"
+#include "EUTelMappedFile.h"
+#include "EUTelPh2ACFDecoder.h"
+
+// system includes <>
+#include <bitset>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace eutelescope;
+
+namespace {
+
+  //! The decoded content of an event compared between the two decoders
+  struct DecodedEvent {
+    std::vector<float> top, bottom;
+    //! per chip: l1cnt, pipeaddr, stub1-3 and bend1-3
+    std::vector<unsigned int> chipData;
+
+    bool operator==(DecodedEvent const &other) const {
+      return top == other.top && bottom == other.bottom && chipData == other.chipData;
+    }
+  };
+
+  void writeWord(std::ofstream &out, std::uint32_t word) {
+    out.write(reinterpret_cast<char const *>(&word), sizeof(word));
+  }
+
+  //! A raw file with random strip hits and chip data
+  void writeSyntheticRun(std::string const &fileName, int nFrontEnds, int nChips, size_t nEvents,
+                         double occupancy) {
+    std::mt19937 generator(42);
+    std::bernoulli_distribution hit(occupancy);
+    std::uniform_int_distribution<std::uint32_t> word;
+
+    std::ofstream out(fileName, std::ios::binary);
+    std::uint32_t const marker = 0xAAAAAAAA;
+    std::uint32_t const header[EUTelPh2ACFDecoder::fileHeaderWords] = {
+        marker, 0x44313943, 0x00000000, marker, 4, 0, marker, 1,
+        static_cast<std::uint32_t>(nFrontEnds * nChips), marker,
+        static_cast<std::uint32_t>(EUTelPh2ACFDecoder(nFrontEnds, nChips).getEventWords()), marker};
+    for(auto headerWord : header) writeWord(out, headerWord);
+
+    for(size_t iEvent = 0; iEvent < nEvents; ++iEvent) {
+      for(int i = 0; i < 5; ++i) writeWord(out, word(generator));
+      for(int iFE = 0; iFE < nFrontEnds; ++iFE) {
+        writeWord(out, word(generator));
+        for(int iChip = 0; iChip < nChips; ++iChip) {
+          for(int iStripWord = 0; iStripWord < 8; ++iStripWord) {
+            std::uint32_t strips = 0;
+            for(unsigned bit = 0; bit < 32; ++bit) {
+              if(hit(generator)) strips |= std::uint32_t(1) << bit;
+            }
+            writeWord(out, strips);
+          }
+          for(int i = 0; i < 3; ++i) writeWord(out, word(generator));
+        }
+      }
+    }
+  }
+
+  //! The original decoding loop of Ph2ACF2LCIOConverter, without the LCIO output
+  /*! Unlike the original it stops at the end of the file instead of
+   *  decoding one more event from a failed read.
+   */
+  std::vector<DecodedEvent> legacyDecode(std::string const &fileName, int nFE, int nChips, size_t &nHits) {
+    std::vector<DecodedEvent> events;
+    std::ifstream infile(fileName.c_str());
+    std::uint32_t tempint;
+    for(int i = 0; i < 12; i++) infile.read(reinterpret_cast<char *>(&tempint), sizeof(uint32_t));
+
+    while(true) {
+      std::vector<float> dataoutputvec_top;
+      std::vector<float> dataoutputvec_bot;
+      std::vector<unsigned int> chipData;
+
+      std::vector<uint32_t> vec_header1;
+      for(int i = 0; i < 5; i++) {
+        infile.read(reinterpret_cast<char *>(&tempint), sizeof(uint32_t));
+        vec_header1.push_back(tempint);
+      }
+      for(int iFE = 0; iFE < nFE; iFE++) {
+        std::vector<uint32_t> vec_header2;
+        infile.read(reinterpret_cast<char *>(&tempint), sizeof(uint32_t));
+        vec_header2.push_back(tempint);
+        for(int j = 0; j < nChips; j++) {
+          int topvec[4][32] = {{0}};
+          int botvec[4][32] = {{0}};
+          for(int i = 0; i < 11; i++) {
+            infile.read(reinterpret_cast<char *>(&tempint), sizeof(uint32_t));
+            if(i < 4) {
+              std::bitset<32> tempbit(tempint);
+              for(unsigned k = 0; k < tempbit.size(); k++) topvec[i][k] = tempbit.test(k) ? 1 : 0;
+            }
+            if(i >= 4 && i < 8) {
+              std::bitset<32> tempbit(tempint);
+              for(unsigned k = 0; k < tempbit.size(); k++) botvec[i - 4][k] = tempbit.test(k) ? 1 : 0;
+            }
+            if(i == 8) {
+              chipData.push_back((tempint >> 16) & 0xFE);
+              chipData.push_back((tempint >> 4) & 0x09);
+            }
+            if(i == 9) {
+              chipData.push_back(0xFF & tempint);
+              chipData.push_back(0xFF & (tempint >> 8));
+              chipData.push_back(0xFF & (tempint >> 16));
+            }
+            if(i == 10) {
+              chipData.push_back(0xF & (tempint >> 8));
+              chipData.push_back(0xF & (tempint >> 16));
+              chipData.push_back(0xF & (tempint >> 24));
+            }
+          }
+          int counter = 0;
+          for(int i = 3; i >= 0; i--) {
+            for(int k = 0; k < 32; k++) {
+              if(++counter != 32) dataoutputvec_top.push_back(static_cast<float>(topvec[i][k]));
+            }
+          }
+          counter = 0;
+          for(int i = 3; i >= 0; i--) {
+            for(int k = 0; k < 32; k++) {
+              if(++counter != 32) dataoutputvec_bot.push_back(static_cast<float>(botvec[i][k]));
+            }
+          }
+        }
+      }
+      if(!infile) break;
+
+      for(float strip : dataoutputvec_top) nHits += strip > 0.f;
+      for(float strip : dataoutputvec_bot) nHits += strip > 0.f;
+      events.push_back({dataoutputvec_top, dataoutputvec_bot, chipData});
+    }
+    return events;
+  }
+
+  //! The file through EUTelMappedFile and EUTelPh2ACFDecoder
+  /*! The events are only kept when asked for, to compare them.
+   */
+  void mappedDecode(std::string const &fileName, int nFE, int nChips, size_t &nHits,
+                    std::vector<DecodedEvent> *events) {
+    EUTelMappedFile file(fileName);
+    EUTelPh2ACFDecoder const decoder(nFE, nChips);
+    EUTelPh2ACFDecoder::Event event;
+    auto const *words = reinterpret_cast<std::uint32_t const *>(file.data());
+    size_t const nWords = file.size() / sizeof(std::uint32_t);
+    size_t const eventWords = decoder.getEventWords();
+    for(size_t position = EUTelPh2ACFDecoder::fileHeaderWords; position + eventWords <= nWords;
+        position += eventWords) {
+      decoder.decodeEvent(words + position, event);
+      nHits += event.topHits + event.bottomHits;
+      if(!events) continue;
+      std::vector<unsigned int> chipData;
+      for(auto const &chip : event.chips) {
+        chipData.insert(chipData.end(), {chip.l1Cnt, chip.pipeAddr, chip.stub1, chip.stub2, chip.stub3,
+                                         chip.bend1, chip.bend2, chip.bend3});
+      }
+      events->push_back({event.top, event.bottom, chipData});
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  std::string input, output;
+  std::string scratch = "benchPh2ACFDecoder.raw";
+  int nFrontEnds = 2, nChips = 8;
+  size_t nEvents = 20000;
+  double occupancy = 0.01;
+  double minTime = 1.;
+  unsigned repetitions = 5;
+
+  for(int i = 1; i + 1 < argc; i += 2) {
+    std::string const option = argv[i], value = argv[i + 1];
+    if(option == "--input") input = value;
+    else if(option == "--frontends") nFrontEnds = std::atoi(value.c_str());
+    else if(option == "--chips") nChips = std::atoi(value.c_str());
+    else if(option == "--events") nEvents = std::strtoul(value.c_str(), nullptr, 10);
+    else if(option == "--occupancy") occupancy = std::atof(value.c_str());
+    else if(option == "--scratch") scratch = value;
+    else if(option == "--min-time") minTime = std::atof(value.c_str());
+    else if(option == "--repetitions") repetitions = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+    else if(option == "--output") output = value;
+    else {
+      std::cerr << "Unknown option " << option << std::endl;
+      return 1;
+    }
+  }
+
+  bool const synthetic = input.empty();
+  if(synthetic) {
+    input = scratch;
+    writeSyntheticRun(input, nFrontEnds, nChips, nEvents, occupancy);
+  }
+
+  int status = 0;
+  try {
+    size_t legacyHits = 0, mappedHits = 0;
+    auto const legacyEvents = legacyDecode(input, nFrontEnds, nChips, legacyHits);
+    std::vector<DecodedEvent> mappedEvents;
+    mappedDecode(input, nFrontEnds, nChips, mappedHits, &mappedEvents);
+    if(legacyEvents != mappedEvents) {
+      std::cerr << "The two decoders give different events" << std::endl;
+      status = 1;
+    }
+
+    double const bytes = static_cast<double>(EUTelMappedFile(input).size());
+    double const events = static_cast<double>(legacyEvents.size());
+    EUTelBenchmark benchmark("ph2acfdecoder", minTime, repetitions);
+    benchmark.setConfig(EUTelBenchmarkTags()("input", synthetic ? "synthetic" : input)
+                        ("frontends", nFrontEnds)("chips", nChips)("events", events)("bytes", bytes)
+                        ("hitStrips", static_cast<double>(legacyHits))("minTime", minTime)
+                        ("repetitions", repetitions));
+    EUTelBenchmarkTags const tags = EUTelBenchmarkTags()("items", "events");
+    benchmark.run("legacyStream", tags, events, [&] {
+      size_t nHits = 0;
+      legacyDecode(input, nFrontEnds, nChips, nHits);
+      return static_cast<double>(nHits);
+    }, bytes);
+    benchmark.run("mappedDecoder", tags, events, [&] {
+      size_t nHits = 0;
+      mappedDecode(input, nFrontEnds, nChips, nHits, nullptr);
+      return static_cast<double>(nHits);
+    }, bytes);
+
+    if(output.empty()) {
+      benchmark.writeJSON(std::cout);
+    } else {
+      std::ofstream file(output);
+      benchmark.writeJSON(file);
+    }
+  } catch(std::exception const &e) {
+    std::cerr << e.what() << std::endl;
+    status = 1;
+  }
+
+  if(synthetic) std::remove(input.c_str());
+  return status;
+}
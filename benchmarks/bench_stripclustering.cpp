@@ -0,0 +1,170 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// Throughput of the strip clustering on high multiplicity events, in events/s:
+//  - legacyRescan: the clustering of CBCClustering and AlibavaClustering
+//    before EUTelStripClusterFinder, a cluster number per strip, then a
+//    scan over all the strips for every cluster to collect its strips
+//  - finderHits: EUTelStripClusterFinder with every strip over 0 hit, as
+//    CBCClustering uses it
+//  - finderSeeds: EUTelStripClusterFinder with seed and neighbour cuts on
+//    the noise and seed splitting, as AlibavaClustering uses it
+// legacyRescan and finderHits must find the same clusters.
+//
+// Usage: benchStripClustering [--events 10000] [--strips 1016]
+//                             [--occupancy 0.1] [--min-time 1]
+//                             [--repetitions 5] [--output results.json]
+
+// eutelescope includes ".h"
+#include "EUTelBenchmark.h"
+#include "EUTelStripClusterFinder.h"
+
+// system includes <>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace eutelescope;
+
+namespace {
+
+  //! First and last strip of each cluster
+  typedef std::vector<std::pair<int, int>> Spans;
+
+  //! Number the clusters strip by strip, then collect each of them by a scan over all the strips
+  void legacyRescan(float const *signal, size_t nStrips, Spans &spans) {
+    int nClusters = 0;
+    std::vector<int> clusterNumber(nStrips, 0);
+    for(size_t ichan = 0; ichan < nStrips; ichan++) {
+      if(signal[ichan] > 0) {
+        if(ichan == 0 || clusterNumber[ichan - 1] == 0) nClusters++;
+        clusterNumber[ichan] = nClusters;
+      }
+    }
+
+    spans.clear();
+    for(int icluster = 1; icluster <= nClusters; icluster++) {
+      std::vector<int> strips;
+      for(size_t ichan = 0; ichan < nStrips; ichan++) {
+        if(clusterNumber[ichan] == icluster) strips.push_back(static_cast<int>(ichan));
+      }
+      spans.emplace_back(strips.front(), strips.back());
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  std::string output;
+  size_t nEvents = 10000;
+  size_t nStrips = 1016;
+  double occupancy = 0.1;
+  double minTime = 1.;
+  unsigned repetitions = 5;
+
+  for(int i = 1; i + 1 < argc; i += 2) {
+    std::string const option = argv[i], value = argv[i + 1];
+    if(option == "--events") nEvents = std::strtoul(value.c_str(), nullptr, 10);
+    else if(option == "--strips") nStrips = std::strtoul(value.c_str(), nullptr, 10);
+    else if(option == "--occupancy") occupancy = std::atof(value.c_str());
+    else if(option == "--min-time") minTime = std::atof(value.c_str());
+    else if(option == "--repetitions") repetitions = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+    else if(option == "--output") output = value;
+    else {
+      std::cerr << "Unknown option " << option << std::endl;
+      return 1;
+    }
+  }
+
+  //Gaussian noise of 1 with hits of 1 to 3 strips at the given occupancy,
+  //the binary events are the strips above 2.5 sigma
+  std::mt19937 generator(42);
+  std::normal_distribution<float> noise(0.f, 1.f);
+  std::uniform_real_distribution<float> uniform(0.f, 1.f);
+  std::vector<float> analog(nEvents * nStrips), binary(nEvents * nStrips);
+  for(size_t iEvent = 0; iEvent < nEvents; ++iEvent) {
+    float *event = &analog[iEvent * nStrips];
+    for(size_t strip = 0; strip < nStrips; ++strip) event[strip] = noise(generator);
+    for(size_t strip = 0; strip < nStrips; ++strip) {
+      if(uniform(generator) >= occupancy / 2.) continue;
+      float const charge = 20.f + 5.f * noise(generator);
+      float const share = uniform(generator);
+      event[strip] += charge * (1.f - share);
+      if(strip + 1 < nStrips) event[strip + 1] += charge * share;
+    }
+    for(size_t strip = 0; strip < nStrips; ++strip) {
+      binary[iEvent * nStrips + strip] = event[strip] > 2.5f ? 1.f : 0.f;
+    }
+  }
+
+  EUTelStripClusterFinder hitFinder(nStrips, std::numeric_limits<float>::min(), std::numeric_limits<float>::min());
+  hitFinder.setSplitSeeds(false);
+  EUTelStripClusterFinder seedFinder(nStrips, 5.f, 2.5f);
+
+  int status = 0;
+  double nClusters = 0.;
+  Spans legacy;
+  std::vector<EUTelStripClusterFinder::Cluster> clusters;
+  for(size_t iEvent = 0; iEvent < nEvents && status == 0; ++iEvent) {
+    float const *event = &binary[iEvent * nStrips];
+    legacyRescan(event, nStrips, legacy);
+    hitFinder.findClusters(event, clusters);
+    nClusters += static_cast<double>(clusters.size());
+    if(clusters.size() != legacy.size()) status = 1;
+    for(size_t icluster = 0; icluster < clusters.size() && status == 0; ++icluster) {
+      if(clusters[icluster].firstStrip != legacy[icluster].first ||
+         clusters[icluster].lastStrip != legacy[icluster].second) {
+        status = 1;
+      }
+    }
+  }
+  if(status != 0) std::cerr << "The cluster finder and the legacy clustering give different clusters" << std::endl;
+
+  double const events = static_cast<double>(nEvents);
+  double const bytes = events * static_cast<double>(nStrips * sizeof(float));
+  EUTelBenchmark benchmark("stripclustering", minTime, repetitions);
+  benchmark.setConfig(EUTelBenchmarkTags()("events", events)("strips", static_cast<double>(nStrips))
+                      ("occupancy", occupancy)("clustersPerEvent", nClusters / events)("minTime", minTime)
+                      ("repetitions", repetitions));
+  EUTelBenchmarkTags const tags = EUTelBenchmarkTags()("items", "events");
+  benchmark.run("legacyRescan", tags, events, [&] {
+    double total = 0.;
+    for(size_t iEvent = 0; iEvent < nEvents; ++iEvent) {
+      legacyRescan(&binary[iEvent * nStrips], nStrips, legacy);
+      total += static_cast<double>(legacy.size());
+    }
+    return total;
+  }, bytes);
+  benchmark.run("finderHits", tags, events, [&] {
+    double total = 0.;
+    for(size_t iEvent = 0; iEvent < nEvents; ++iEvent) {
+      total += static_cast<double>(hitFinder.findClusters(&binary[iEvent * nStrips], clusters));
+    }
+    return total;
+  }, bytes);
+  benchmark.run("finderSeeds", tags, events, [&] {
+    double total = 0.;
+    for(size_t iEvent = 0; iEvent < nEvents; ++iEvent) {
+      total += static_cast<double>(seedFinder.findClusters(&analog[iEvent * nStrips], clusters));
+    }
+    return total;
+  }, bytes);
+
+  if(output.empty()) {
+    benchmark.writeJSON(std::cout);
+  } else {
+    std::ofstream file(output);
+    benchmark.writeJSON(file);
+  }
+  return status;
+}
@@ -0,0 +1,219 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// Throughput of the Alibava pedestal and common mode subtraction, in chips/s:
+//  - legacyChain: the loops of AlibavaPedestalSubtraction,
+//    AlibavaConstantCommonModeProcessor and AlibavaCommonModeSubtraction,
+//    with their FloatVec copies, push_backs and mask lookups per channel,
+//    without the LCIO collections in between
+//  - kernelScalar and kernelAVX2: EUTelStripCommonMode::process with the
+//    scalar and, if the CPU has it, the AVX2 loops
+// All of them must give the same corrected signals, up to the rounding of
+// the sums.
+//
+// Usage: benchStripCommonMode [--chips 100000] [--masked 0.05]
+//                             [--iterations 3] [--method slope]
+//                             [--min-time 1] [--repetitions 5] [--output results.json]
+
+// eutelescope includes ".h"
+#include "EUTelBenchmark.h"
+#include "EUTelStripCommonMode.h"
+
+// system includes <>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace eutelescope;
+
+namespace {
+
+  size_t const nChannels = EUTelStripCommonMode::nChannels;
+
+  //! The mask as AlibavaBaseProcessor::isMasked looks it up, out of line
+  struct Mask {
+    std::vector<bool> masked;
+    __attribute__((noinline)) bool isMasked(size_t ichan) const { return masked[ichan]; }
+  };
+
+  //! The three processor loops, one chip
+  void legacyChain(std::vector<float> const &raw, std::vector<float> const &pedestals, Mask const &mask,
+                   int nIterations, float noiseDeviation, bool slope, std::vector<float> &output) {
+    //AlibavaPedestalSubtraction
+    std::vector<float> datavec;
+    datavec = raw;
+    std::vector<float> pedVec = pedestals;
+    std::vector<float> recodata;
+    for(size_t ichan = 0; ichan < datavec.size(); ichan++) {
+      if(mask.isMasked(ichan)) {
+        recodata.push_back(0);
+        continue;
+      }
+      recodata.push_back(datavec[ichan] - pedVec[ichan]);
+    }
+
+    //AlibavaConstantCommonModeProcessor
+    datavec = recodata;
+    double sig = 0, mean_signal = 0, sigma_mean_signal = 0, a = 0, b = 0;
+    for(int i = 0; i < nIterations; i++) {
+      int nchan = 0;
+      double total_signal = 0, total_signal_square = 0, channelcount = 0, channelcount_square = 0, chan_sig = 0;
+      for(size_t ichan = 0; ichan < datavec.size(); ichan++) {
+        if(mask.isMasked(ichan)) continue;
+        sig = datavec[ichan];
+        if(i > 0 && !(std::fabs((sig - mean_signal) / sigma_mean_signal) < noiseDeviation)) continue;
+        double const chan = static_cast<double>(ichan);
+        total_signal += sig;
+        total_signal_square += sig * sig;
+        nchan++;
+        channelcount += chan;
+        channelcount_square += chan * chan;
+        chan_sig += chan * sig;
+      }
+      double const delta = nchan * channelcount_square - channelcount * channelcount;
+      a = (channelcount_square * total_signal - channelcount * chan_sig) / delta;
+      b = (nchan * chan_sig - channelcount * total_signal) / delta;
+      if(nchan > 0) {
+        mean_signal = total_signal / nchan;
+        sigma_mean_signal = std::sqrt(total_signal_square / nchan - mean_signal * mean_signal);
+      }
+    }
+    std::vector<float> commonmode, commonmodeerror;
+    for(size_t ichan = 0; ichan < nChannels; ichan++) {
+      commonmode.push_back(static_cast<float>(slope ? a + b * static_cast<double>(ichan) : mean_signal));
+      commonmodeerror.push_back(static_cast<float>(sigma_mean_signal));
+    }
+
+    //AlibavaCommonModeSubtraction
+    std::vector<float> cmmdvec;
+    datavec = recodata;
+    cmmdvec = commonmode;
+    output.clear();
+    for(size_t ichan = 0; ichan < datavec.size(); ichan++) {
+      if(mask.isMasked(ichan)) {
+        output.push_back(0);
+        continue;
+      }
+      output.push_back(datavec[ichan] - cmmdvec[ichan]);
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  std::string output;
+  std::string method = "slope";
+  size_t nChips = 100000;
+  double maskedFraction = 0.05;
+  int nIterations = 3;
+  double minTime = 1.;
+  unsigned repetitions = 5;
+
+  for(int i = 1; i + 1 < argc; i += 2) {
+    std::string const option = argv[i], value = argv[i + 1];
+    if(option == "--chips") nChips = std::strtoul(value.c_str(), nullptr, 10);
+    else if(option == "--masked") maskedFraction = std::atof(value.c_str());
+    else if(option == "--iterations") nIterations = std::atoi(value.c_str());
+    else if(option == "--method") method = value;
+    else if(option == "--min-time") minTime = std::atof(value.c_str());
+    else if(option == "--repetitions") repetitions = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+    else if(option == "--output") output = value;
+    else {
+      std::cerr << "Unknown option " << option << std::endl;
+      return 1;
+    }
+  }
+  if(method != "constant" && method != "slope") {
+    std::cerr << "Unknown method " << method << std::endl;
+    return 1;
+  }
+  bool const slope = method == "slope";
+  float const noiseDeviation = 2.5f;
+
+  //pedestals around 500 ADC, a common mode with a slope per chip, Gaussian noise and a few hits
+  std::mt19937 generator(42);
+  std::normal_distribution<float> noise(0.f, 5.f);
+  std::uniform_real_distribution<float> uniform(0.f, 1.f);
+  std::vector<float> pedestals(nChannels);
+  Mask mask;
+  mask.masked.resize(nChannels);
+  for(size_t ichan = 0; ichan < nChannels; ++ichan) {
+    pedestals[ichan] = 500.f + 10.f * noise(generator);
+    mask.masked[ichan] = uniform(generator) < maskedFraction;
+  }
+  std::vector<float> raw(nChips * nChannels);
+  for(size_t iChip = 0; iChip < nChips; ++iChip) {
+    float const commonMode = 4.f * noise(generator), commonModeSlope = 0.01f * noise(generator);
+    for(size_t ichan = 0; ichan < nChannels; ++ichan) {
+      float const hit = uniform(generator) < 0.01f ? 100.f : 0.f;
+      raw[iChip * nChannels + ichan] = pedestals[ichan] + commonMode + commonModeSlope * static_cast<float>(ichan) +
+                                       noise(generator) + hit;
+    }
+  }
+
+  EUTelStripCommonMode kernel(static_cast<unsigned>(nIterations), noiseDeviation,
+                              slope ? EUTelStripCommonMode::Method::slope : EUTelStripCommonMode::Method::constant);
+  kernel.setPedestals(pedestals);
+  for(size_t ichan = 0; ichan < nChannels; ++ichan) kernel.setMasked(ichan, mask.masked[ichan]);
+  bool const avx2 = EUTelStripCommonMode::isAVX2Available();
+
+  int status = 0;
+  std::vector<float> chip(nChannels), legacy, corrected(nChannels);
+  for(size_t iChip = 0; iChip < nChips && status == 0; ++iChip) {
+    chip.assign(raw.begin() + static_cast<long>(iChip * nChannels), raw.begin() + static_cast<long>((iChip + 1) * nChannels));
+    legacyChain(chip, pedestals, mask, nIterations, noiseDeviation, slope, legacy);
+    for(int useAVX2 = 0; useAVX2 <= int(avx2); ++useAVX2) {
+      kernel.setUseAVX2(useAVX2 != 0);
+      kernel.process(chip.data(), corrected.data());
+      for(size_t ichan = 0; ichan < nChannels; ++ichan) {
+        if(std::fabs(legacy[ichan] - corrected[ichan]) > 1e-3f) status = 1;
+      }
+    }
+  }
+  if(status != 0) std::cerr << "The kernel and the legacy loops give different signals" << std::endl;
+
+  double const chips = static_cast<double>(nChips);
+  double const bytes = chips * static_cast<double>(nChannels * sizeof(float));
+  EUTelBenchmark benchmark("stripcommonmode", minTime, repetitions);
+  benchmark.setConfig(EUTelBenchmarkTags()("chips", chips)("channels", static_cast<double>(nChannels))
+                      ("masked", maskedFraction)("iterations", nIterations)("method", method)
+                      ("avx2", avx2 ? "yes" : "no")("minTime", minTime)("repetitions", repetitions));
+  EUTelBenchmarkTags const tags = EUTelBenchmarkTags()("items", "chips");
+  benchmark.run("legacyChain", tags, chips, [&] {
+    double total = 0.;
+    for(size_t iChip = 0; iChip < nChips; ++iChip) {
+      chip.assign(raw.begin() + static_cast<long>(iChip * nChannels), raw.begin() + static_cast<long>((iChip + 1) * nChannels));
+      legacyChain(chip, pedestals, mask, nIterations, noiseDeviation, slope, legacy);
+      total += legacy[0];
+    }
+    return total;
+  }, bytes);
+  for(int useAVX2 = 0; useAVX2 <= int(avx2); ++useAVX2) {
+    kernel.setUseAVX2(useAVX2 != 0);
+    benchmark.run(useAVX2 ? "kernelAVX2" : "kernelScalar", tags, chips, [&] {
+      double total = 0.;
+      for(size_t iChip = 0; iChip < nChips; ++iChip) {
+        kernel.process(&raw[iChip * nChannels], corrected.data());
+        total += corrected[0];
+      }
+      return total;
+    }, bytes);
+  }
+
+  if(output.empty()) {
+    benchmark.writeJSON(std::cout);
+  } else {
+    std::ofstream file(output);
+    benchmark.writeJSON(file);
+  }
+  return status;
+}
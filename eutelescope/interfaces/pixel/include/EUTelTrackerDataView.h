@@ -0,0 +1,184 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELTRACKERDATAVIEW_H
+#define EUTELTRACKERDATAVIEW_H
+
+// personal includes ".h"
+#include "EUTELESCOPE.h"
+#include "EUTelExceptions.h"
+
+// lcio includes <.h>
+#include <IMPL/TrackerDataImpl.h>
+#include <LCIOTypes.h>
+
+// system includes
+#include <cstddef>
+#include <iterator>
+
+namespace eutelescope {
+
+//! Read-only strided column over the charge values of a TrackerData
+/*! A column is one field (x, y, signal, time, ...) of all the pixels stored
+ *	in a TrackerDataImpl. It does not own nor copy anything, it simply points
+ *	into the charge value buffer and steps over it with the record length of
+ *	the sparse pixel type. The values are converted to T on access, exactly as
+ *	the pixel classes do when they are filled from the same buffer.
+ */
+template<class T>
+class EUTelStridedColumn {
+
+  public:
+	//! Forward iterator over the column
+	class const_iterator {
+	  public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef T value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef T const * pointer;
+		typedef T reference;
+
+		const_iterator(float const * ptr, size_t stride): _ptr(ptr), _stride(stride) {}
+		T operator*() const { return static_cast<T>(*_ptr); }
+		const_iterator& operator++() { _ptr += _stride; return *this; }
+		bool operator==(const_iterator const & other) const { return _ptr == other._ptr; }
+		bool operator!=(const_iterator const & other) const { return _ptr != other._ptr; }
+	  private:
+		float const * _ptr;
+		size_t _stride;
+	};
+
+	//! Construct a column starting at @c data, with @c size entries separated by @c stride floats
+	EUTelStridedColumn(float const * data, size_t stride, size_t size): _data(data), _stride(stride), _size(size) {}
+
+	//! Non range checked access
+	T operator[](size_t i) const { return static_cast<T>(_data[i*_stride]); }
+
+	//! Number of entries in the column
+	size_t size() const { return _size; }
+
+	//! Check if the column is empty
+	bool empty() const { return _size == 0; }
+
+	const_iterator begin() const { return const_iterator(_data, _stride); }
+	const_iterator end() const { return const_iterator(_data + _size*_stride, _stride); }
+
+  private:
+	float const * _data;
+	size_t _stride;
+	size_t _size;
+};
+
+//! Zero-copy, non-virtual view over the pixels stored in a TrackerDataImpl
+/*! This is the light-weight alternative to EUTelTrackerDataInterfacerImpl when
+ *	the pixels only have to be read. Nothing is allocated and no pixel object is
+ *	created: the fields common to all sparse pixel types are read directly from
+ *	TrackerDataImpl::getChargeValues() with the record length of the given
+ *	SparsePixelType, either pixel by pixel or as whole columns.
+ *
+ *	The view is only valid as long as the charge values of the underlying
+ *	TrackerDataImpl are neither modified nor destroyed.
+ *
+ *	\b Usage:
+ *	\code{.cpp}
+ *	EUTelTrackerDataView pixels(trackerData, pixelType);
+ *	auto xColumn = pixels.x();
+ *	auto yColumn = pixels.y();
+ *	for(size_t i = 0; i < pixels.size(); ++i) { hitMap(xColumn[i], yColumn[i])++; }
+ *	\endcode
+ */
+class EUTelTrackerDataView {
+
+  public:
+	//!	Only available constructor
+	/*!	@throw UnknownDataTypeException if the sparse pixel type is not known
+	 */
+	EUTelTrackerDataView(IMPL::TrackerDataImpl const * data, SparsePixelType type):
+	_data(data->getChargeValues().data()),
+	_stride(getStride(type)),
+	_size(data->getChargeValues().size()/_stride),
+	_hasTime(type != kEUTelSimpleSparsePixel) {}
+
+	//!	Signature overloaded version taking the integer value of the cell ID field
+	EUTelTrackerDataView(IMPL::TrackerDataImpl const * data, int type):
+	EUTelTrackerDataView(data, static_cast<SparsePixelType>(type)) {}
+
+	//! Number of floats used to store one pixel of the given type
+	static size_t getStride(SparsePixelType type) {
+		switch(type) {
+			case kEUTelSimpleSparsePixel:
+				return 3;
+			case kEUTelGenericSparsePixel:
+				return 4;
+			case kEUTelGeometricPixel:
+				return 8;
+			case kEUTelMuPixel:
+				return 7;
+			default:
+				throw UnknownDataTypeException("Unknown sparsified pixel");
+		}
+	}
+
+	//! Get the number of pixels
+	size_t size() const { return _size; }
+
+	//! Check if no pixels are present
+	bool empty() const { return _size == 0; }
+
+	//! Check if the pixel type carries a time stamp
+	bool hasTime() const { return _hasTime; }
+
+	//! Number of floats used to store one pixel
+	size_t stride() const { return _stride; }
+
+	//! Per pixel access, same conversion as the pixel classes
+	short getXCoord(size_t i) const { return static_cast<short>(_data[i*_stride]); }
+	short getYCoord(size_t i) const { return static_cast<short>(_data[i*_stride + 1]); }
+	float getSignal(size_t i) const { return _data[i*_stride + 2]; }
+	//! Time of pixel @c i, only to be used if hasTime()
+	short getTime(size_t i) const { return static_cast<short>(_data[i*_stride + 3]); }
+
+	//! Column access
+	EUTelStridedColumn<short> x() const { return EUTelStridedColumn<short>(_data, _stride, _size); }
+	EUTelStridedColumn<short> y() const { return EUTelStridedColumn<short>(_data + 1, _stride, _size); }
+	EUTelStridedColumn<float> signal() const { return EUTelStridedColumn<float>(_data + 2, _stride, _size); }
+	//! Time column, empty if the pixel type does not carry a time stamp
+	EUTelStridedColumn<short> time() const { return EUTelStridedColumn<short>(_data + 3, _stride, _hasTime ? _size : 0); }
+
+	//! Append the raw record of pixel @c i to a charge value vector
+	/*! This is the allocation free equivalent of pushing the pixel into a
+	 *	EUTelTrackerDataInterfacerImpl of the same pixel type.
+	 */
+	void appendPixel(size_t i, lcio::FloatVec& chargeValues) const {
+		chargeValues.insert(chargeValues.end(), _data + i*_stride, _data + (i + 1)*_stride);
+	}
+
+	//! Signal weighted centre of gravity in pixel index units
+	/*! Same arithmetic as EUTelSparseClusterImpl::getCenterOfGravity().
+	 */
+	void getCenterOfGravity(float& xCoG, float& yCoG) const {
+		float xPos(0.0f), yPos(0.0f), totWeight(0.0f);
+		for(size_t i = 0; i < _size; ++i) {
+			float curSignal = getSignal(i);
+			xPos += getXCoord(i)*curSignal;
+			yPos += getYCoord(i)*curSignal;
+			totWeight += curSignal;
+		}
+		xCoG = xPos / totWeight;
+		yCoG = yPos / totWeight;
+	}
+
+  private:
+	float const * _data;
+	size_t _stride;
+	size_t _size;
+	bool _hasTime;
+};
+
+} //namespace
+#endif
@@ -0,0 +1,180 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELCOLUMNARFILE_H
+#define EUTELCOLUMNARFILE_H
+
+// system includes <>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Column types of a columnar file, all of them 4 bytes wide
+  enum class EUTelColumnType : std::uint8_t { Int = 0, Float = 1 };
+
+  //! Writer of a flat table of int and float columns, one column after the other
+  /*! The rows are appended to a structure of arrays buffer allocated once
+   *  when the file is opened, so filling a row costs a few stores and no
+   *  allocation. Every rowGroupSize rows the buffer is written as a row
+   *  group, each column being one contiguous block, so that a reader can
+   *  load a single column by seeking over the others.
+   *
+   *  A value not set in a row is 0 for an int column and NaN for a float
+   *  one, e.g. the hit of a plane a track has no hit on.
+   *
+   *  File layout, in the byte order of the machine:
+   *  \code
+   *  "EUTCOLS1" uint32 nColumns { uint8 type, uint32 nameLength, name } x nColumns
+   *  { uint32 nRows, { nRows x 4 bytes } x nColumns } x nRowGroups
+   *  \endcode
+   *
+   *  \b Usage:
+   *  \code{.cpp}
+   *  EUTelColumnarWriter writer;
+   *  auto event = writer.addIntColumn("event");
+   *  auto chi2 = writer.addFloatColumn("chi2");
+   *  writer.open("tracks.columns");
+   *  for(track in tracks) {
+   *    writer.set(event, eventNumber);
+   *    writer.set(chi2, track.chi2);
+   *    writer.endRow();
+   *  }
+   *  writer.close();
+   *  \endcode
+   */
+  class EUTelColumnarWriter {
+
+  public:
+    struct IntColumn {
+      size_t index;
+    };
+    struct FloatColumn {
+      size_t index;
+    };
+
+    explicit EUTelColumnarWriter(size_t rowGroupSize = 65536);
+
+    //! Closes the file, errors are lost, call close() to see them
+    ~EUTelColumnarWriter();
+
+    EUTelColumnarWriter(EUTelColumnarWriter const &) = delete;
+    EUTelColumnarWriter &operator=(EUTelColumnarWriter const &) = delete;
+
+    //! Declare a column, before open()
+    /*! @throw InvalidParameterException if the file is open or the name already used
+     */
+    IntColumn addIntColumn(std::string const &name);
+    FloatColumn addFloatColumn(std::string const &name);
+
+    //! Create the file and write its header
+    /*! @throw lcio::IOException if the file can not be created
+     */
+    void open(std::string const &fileName);
+
+    bool isOpen() const { return _file.is_open(); }
+
+    void set(IntColumn column, std::int32_t value) { _intColumns[column.index][_nBuffered] = value; }
+    void set(FloatColumn column, float value) { _floatColumns[column.index][_nBuffered] = value; }
+
+    //! Complete the current row, writing a row group when the buffer is full
+    /*! @throw lcio::IOException if the file can not be written
+     */
+    void endRow() {
+      ++_nRows;
+      if(++_nBuffered == _rowGroupSize) writeRowGroup();
+    }
+
+    //! Write the buffered rows and close the file
+    /*! @throw lcio::IOException if the file can not be written
+     */
+    void close();
+
+    //! Number of rows written since open(), including the buffered ones
+    size_t getNRows() const { return _nRows; }
+
+    size_t getRowGroupSize() const { return _rowGroupSize; }
+
+  private:
+    //! Write the buffered rows as a row group and reset the buffer to the defaults
+    void writeRowGroup();
+
+    void addColumn(std::string const &name, EUTelColumnType type);
+
+    size_t _rowGroupSize;
+    std::vector<std::string> _names;
+    std::vector<EUTelColumnType> _types;
+    //! Index of each column in _intColumns or _floatColumns
+    std::vector<size_t> _typeIndex;
+    std::vector<std::vector<std::int32_t>> _intColumns;
+    std::vector<std::vector<float>> _floatColumns;
+    size_t _nBuffered;
+    size_t _nRows;
+    std::string _fileName;
+    std::ofstream _file;
+  };
+
+  //! Reader of the files of EUTelColumnarWriter
+  /*! The row groups are located when the file is opened, reading a column
+   *  then only touches the blocks of that column.
+   *
+   *  \b Usage:
+   *  \code{.cpp}
+   *  EUTelColumnarReader reader("tracks.columns");
+   *  std::vector<float> chi2;
+   *  reader.readColumn("chi2", chi2);
+   *  \endcode
+   */
+  class EUTelColumnarReader {
+
+  public:
+    //! Open the file and locate its row groups
+    /*! @throw lcio::IOException if the file can not be read or is not a columnar file
+     */
+    explicit EUTelColumnarReader(std::string const &fileName);
+
+    std::vector<std::string> const &getColumnNames() const { return _names; }
+
+    //! Whether there is a column of that name
+    bool hasColumn(std::string const &name) const;
+
+    EUTelColumnType getColumnType(std::string const &name) const;
+
+    //! Total number of rows
+    size_t getNRows() const { return _nRows; }
+
+    //! Read a whole column, replacing the content of values
+    /*! @throw InvalidParameterException if there is no column of that name and type
+     *  @throw lcio::IOException if the file can not be read
+     */
+    void readColumn(std::string const &name, std::vector<std::int32_t> &values);
+    void readColumn(std::string const &name, std::vector<float> &values);
+
+  private:
+    //! Index of the column, checking its type
+    size_t findColumn(std::string const &name, EUTelColumnType type) const;
+
+    void readBlocks(size_t column, char *values);
+
+    struct RowGroup {
+      std::streamoff offset;
+      size_t nRows;
+    };
+
+    std::string _fileName;
+    std::ifstream _file;
+    std::vector<std::string> _names;
+    std::vector<EUTelColumnType> _types;
+    std::vector<RowGroup> _rowGroups;
+    size_t _nRows;
+  };
+}
+#endif
@@ -0,0 +1,132 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELFIXEDFRAMECLUSTERFINDER_H
+#define EUTELFIXEDFRAMECLUSTERFINDER_H
+
+// eutelescope includes ".h"
+#include "EUTELESCOPE.h"
+
+// system includes <>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Fixed frame seed clustering of a not zero suppressed frame
+  /*! This helper class does the cluster search of the FixedFrame
+   *  algorithm of EUTelClusteringProcessor on the full frame of one
+   *  sensor. A pixel is a seed candidate if it is good and its charge
+   *  is above seedCut times its noise; starting from the highest seed,
+   *  each seed still good builds a window of xClusterSize x
+   *  yClusterSize pixels around it which becomes a cluster if its
+   *  charge is above clusterCut times its noise. The pixels of a
+   *  cluster are then marked as hit in the status, so that they can
+   *  not be used again.
+   *
+   *  The window of a seed is a fixed table of index offsets, so that
+   *  only the seeds closer than half a window to the edge of the frame
+   *  need a bound check. The window charges of the clusters are
+   *  stored one after the other in an arena which, as all the other
+   *  buffers, is kept from one search to the next one.
+   *
+   *  The clusters, their quality and their charges are identical to
+   *  the ones of the original EUTelClusteringProcessor loop.
+   *
+   *  \b Usage:
+   *  \code{.cpp}
+   *  EUTelFixedFrameClusterFinder finder(1152, 576, 3, 3, 4.5, 6.0);
+   *  std::vector<EUTelFixedFrameClusterFinder::Cluster> clusters;
+   *  finder.findClusters(charge, noise, status, clusters);
+   *  for(auto const &cluster : clusters) {
+   *    float const *charges = finder.getCharges(cluster);
+   *    // finder.getWindowSize() charges, row by row
+   *  }
+   *  \endcode
+   */
+  class EUTelFixedFrameClusterFinder {
+
+  public:
+    //! A cluster found by findClusters()
+    struct Cluster {
+      int seedX;
+      int seedY;
+      ClusterQuality quality;
+      //! Position of the window charges in the charge arena
+      size_t first;
+    };
+
+    //! Constructor
+    /*! @param xNoOfPixel number of pixels along x of the frame
+     *  @param yNoOfPixel number of pixels along y of the frame
+     *  @param xClusterSize window size along x, the window spans
+     *  xClusterSize / 2 pixels on each side of the seed
+     *  @param yClusterSize window size along y
+     *  @param seedCut seed threshold in noise units
+     *  @param clusterCut cluster threshold in noise units
+     *
+     *  @throw InvalidParameterException for a frame without pixels or
+     *  a negative window size
+     */
+    EUTelFixedFrameClusterFinder(int xNoOfPixel, int yNoOfPixel,
+                                 int xClusterSize, int yClusterSize,
+                                 float seedCut, float clusterCut);
+
+    //! Find the clusters of a frame
+    /*! The three arrays are the pixels of the frame row by row, as
+     *  indexed by EUTelMatrixDecoder. The pixels of the clusters
+     *  found are set to EUTELESCOPE::HITPIXEL in @c status.
+     *
+     *  @return The number of clusters found, replacing the content of
+     *  @c clusters
+     */
+    size_t findClusters(float const *charge, float const *noise,
+                        short *status, std::vector<Cluster> &clusters);
+
+    //! Number of pixels of the frame
+    size_t getNoOfPixels() const {
+      return static_cast<size_t>(_xNoOfPixel) * static_cast<size_t>(_yNoOfPixel);
+    }
+
+    //! Number of pixels of a cluster window
+    size_t getWindowSize() const { return _windowOffsets.size(); }
+
+    //! The getWindowSize() charges of a cluster of the last search
+    /*! Pixels which are not good, already in another cluster or
+     *  outside the sensor have no charge.
+     */
+    float const *getCharges(Cluster const &cluster) const {
+      return _charges.data() + cluster.first;
+    }
+
+  private:
+    int _xNoOfPixel, _yNoOfPixel;
+
+    //! Half window sizes
+    int _xHalfSize, _yHalfSize;
+
+    float _seedCut, _clusterCut;
+
+    //! Position of the window pixels relative to the seed
+    std::vector<int> _windowX, _windowY;
+
+    //! Offsets of the window pixels from the seed in the frame
+    std::vector<long> _windowOffsets;
+
+    //! Seed candidates, as charge and frame index
+    std::vector<std::pair<float, int>> _seeds;
+
+    //! Frame index of the good pixels of the current window, -1 otherwise
+    std::vector<long> _members;
+
+    //! Window charges of all the clusters of the last search
+    std::vector<float> _charges;
+  };
+}
+#endif
@@ -13,8 +13,10 @@
   */
 
 // STL
+#include <cstddef>
 #include <string>
 #include <utility>
+#include <vector>
 
 // ROOT
 #include "TGeoManager.h"
@@ -25,6 +27,13 @@ namespace eutelescope {
     class EUTelGenericPixGeoDescr {
 
     public:
+      /** Centre and half widths of a pixel in mm, in the local frame of
+       * the sensitive area as placed into the plane */
+      struct PixelBox {
+        float x, y;
+        float halfX, halfY;
+      };
+
       /** The only constructor which is public or protected
     * @param are the dimensions of the sensor (size) as well as the minimum and
     * maximum pixel count (min&max) as well as the radiation length
@@ -85,7 +94,47 @@ namespace eutelescope {
         return this->getPixIndex(path.c_str());
       };
 
+      /** Tabulates the boxes of all pixels, unless already done. The
+       * layouts knowing their pixel sizes fill the table directly, see
+       * fillPixelBoxes(), for all others every pixel is looked up in TGeo
+       * below @param planePath, the path of any plane using this layout.
+       * To be called before the first getPixelBox() of every sensor:
+       * afterwards getPixelBox() is a plain array read, without any ROOT
+       * navigation */
+      void buildPixelBoxes(std::string const &planePath);
+
+      /** Check if the pixel boxes have been tabulated */
+      bool hasPixelBoxes() const { return !_pixelBoxes.empty(); }
+
+      /** Box of pixel (@param x, @param y), which has to be within the
+       * pixel index range, after buildPixelBoxes() */
+      PixelBox const &getPixelBox(int x, int y) const {
+        return _pixelBoxes[static_cast<size_t>(y - _minIndexY) *
+                               static_cast<size_t>(_maxIndexX - _minIndexX + 1) +
+                           static_cast<size_t>(x - _minIndexX)];
+      }
+
+      /** All the pixel boxes, x being the fast running index */
+      std::vector<PixelBox> const &getPixelBoxes() const { return _pixelBoxes; }
+
     protected:
+      /** Fills the pixel boxes from the known layout, returns false if the
+       * layout does not implement it, which is the default. The table is
+       * already sized to the pixel index range when this is called */
+      virtual bool fillPixelBoxes() { return false; }
+
+      /** Sets the boxes of the block of equally sized pixels from
+       * (@param firstX, @param firstY) to (@param lastX, @param lastY).
+       * The first pixel touches the edge at @param edgeX, @param edgeY,
+       * the following ones are @param pitchX, @param pitchY further; a
+       * negative pitch is for the indices counting down the axis */
+      void setPixelBlock(int firstX, int lastX, int firstY, int lastY,
+                         double edgeX, double pitchX, double edgeY,
+                         double pitchY);
+
+      /** Table of pixel boxes, filled by buildPixelBoxes() */
+      std::vector<PixelBox> _pixelBoxes;
+
       TGeoManager *_tGeoManager;
 
       double _sizeSensitiveAreaX, _sizeSensitiveAreaY, _sizeSensitiveAreaZ;
@@ -3,9 +3,11 @@
 
 // C++
 #include <array>
+#include <cstddef>
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 // MARLIN
 #include "marlin/Global.h"
@@ -19,8 +21,10 @@
 #include "gearimpl/TrackerPlanesParametersImpl.h"
 
 // EUTELESCOPE
+#include "EUTelExceptions.h"
 #include "EUTelGenericPixGeoMgr.h"
 #include "EUTelGeoSupportClasses.h"
+#include "EUTelMaterialBudgetTable.h"
 #include "EUTelUtility.h"
 
 // Eigen
@@ -43,6 +47,26 @@ namespace eutelescope {
     static const double DEG = 180. / PI;
     static const double RADIAN = PI / 180.;
 
+    /** Flat copy of the per plane quantities needed in the event loops
+     *  The placement of the plane is stored as a 3x4 matrix [R|t] such that
+     *  a local point x is transformed into the global one by X = R*x + t,
+     *  identical to the TGeoMatrix of the plane. Filled once the TGeo
+     *  description is initialised, see
+     *  EUTelGeometryTelescopeGeoDescription::getPlaneCache()
+     */
+    struct EUTelPlaneCache {
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+      int sensorID;
+      /** Rotation in the first three columns, translation in the last one */
+      Eigen::Matrix<double, 3, 4> transform;
+      /** Sensor size in [mm] */
+      double xSize, ySize, zSize;
+      /** Pixel pitch in [mm] */
+      double xPitch, yPitch;
+      /** Resolution in [mm] */
+      double xResolution, yResolution;
+    };
+
     class EUTelGeometryTelescopeGeoDescription {
     private:
       /** Default constructor */
@@ -105,6 +129,12 @@ namespace eutelescope {
       /** Map holding the transformation matrix for each plane (identified by its planeID) */
 	    std::map<int, TGeoMatrix*> _TGeoMatrixMap;
 
+      /** Per plane cache, in the order of _sensorIDVec */
+      std::vector<EUTelPlaneCache, Eigen::aligned_allocator<EUTelPlaneCache>> _planeCache;
+
+      /** Position of each sensor ID in _planeCache, -1 if not present */
+      std::vector<int> _planeCacheIndex;
+
       /** Conter to indicate if instance of this object exists */
       static unsigned _counter;
 
@@ -117,6 +147,9 @@ namespace eutelescope {
       /** Map containing the radiation length of each plane */
       std::map<int, double> _planeRadMap;
 
+      /** x/X0 of every plane and gap versus the track slopes */
+      EUTelMaterialBudgetTable _materialBudgetTable;
+
       /** Map containing all materials defined in GEAR file */
       std::map<std::string, EUTelMaterial> _materialMap;
 
@@ -196,6 +229,7 @@ namespace eutelescope {
        */
       inline void setPlanePitch(int sensorID, double const & xPitch, double const & yPitch) {
         _activeMap.at(sensorID)->setPitch(xPitch, yPitch);
+        if(!_planeCache.empty()) this->buildPlaneCache();
       }
 
       /** Set the given plane's amoutn of pixels in x- and y-direction
@@ -382,19 +416,69 @@ namespace eutelescope {
       double planeRadLengthGlobalIncidence(int planeID, Eigen::Vector3d incidenceDir);
       double planeRadLengthLocalIncidence(int planeID, Eigen::Vector3d incidenceDir);
 
+      /** Tabulate the material budget of every plane and of the gap behind it
+       *  The TGeo geometry is traversed along nNodes x nNodes track
+       *  directions with slopes dx/dz, dy/dz in [-maxSlope, maxSlope]. This
+       *  uses the global navigator and has to be called from a single
+       *  thread, e.g. in init(), after initializeTGeoDescription().
+       */
+      void buildMaterialBudgetTable(double maxSlope, unsigned nNodes);
+
+      /** The table filled by buildMaterialBudgetTable()
+       *  Its queries neither use gGeoManager nor modify anything, so they
+       *  can be made from several threads. The table is emptied when a
+       *  plane is aligned, its lookups then throw until it is rebuilt.
+       */
+      EUTelMaterialBudgetTable const & getMaterialBudgetTable() const {
+        return _materialBudgetTable;
+      }
+
+      /** x/X0 of a plane along a global track direction, from the table */
+      double planeRadLength(int planeID, Eigen::Vector3d const &direction) const {
+        return _materialBudgetTable.getSensorRadLength(planeID, direction(0)/direction(2), direction(1)/direction(2));
+      }
+
+      /** x/X0 between a plane and the next one along a global track direction, from the table */
+      double gapRadLength(int planeID, Eigen::Vector3d const &direction) const {
+        return _materialBudgetTable.getGapRadLength(planeID, direction(0)/direction(2), direction(1)/direction(2));
+      }
+
       void local2Master(int sensorID, std::array<double, 3> const &localPos,
-                        std::array<double, 3> &globalPos);
+                        std::array<double, 3> &globalPos) const;
       void master2Local(int sensorID, std::array<double, 3> const &globalPos,
-                        std::array<double, 3> &localPos);
+                        std::array<double, 3> &localPos) const;
       void local2MasterVec(int sensorID, std::array<double, 3> const &localVec,
-                           std::array<double, 3> &globalVec);
+                           std::array<double, 3> &globalVec) const;
       void master2LocalVec(int sensorID, std::array<double, 3> const &globalVec,
-                           std::array<double, 3> &localVec);
+                           std::array<double, 3> &localVec) const;
 
-      void local2Master(int, const double[], double[]);
-      void master2Local(int, const double[], double[]);
-      void local2MasterVec(int, const double[], double[]);
-      void master2LocalVec(int, const double[], double[]);
+      void local2Master(int, const double[], double[]) const;
+      void master2Local(int, const double[], double[]) const;
+      void local2MasterVec(int, const double[], double[]) const;
+      void master2LocalVec(int, const double[], double[]) const;
+
+      /** Batched transformations of nPoints consecutive (x,y,z) triplets
+       *  The plane is looked up once and the loop only consists of the
+       *  matrix multiplication, thus it can be vectorised by the compiler.
+       *  Input and output may be the same array.
+       */
+      void local2Master(int sensorID, const double localPos[], double globalPos[], size_t nPoints) const;
+      void master2Local(int sensorID, const double globalPos[], double localPos[], size_t nPoints) const;
+      void local2MasterVec(int sensorID, const double localVec[], double globalVec[], size_t nPoints) const;
+      void master2LocalVec(int sensorID, const double globalVec[], double localVec[], size_t nPoints) const;
+
+      /** Cached transformation, size, pitch and resolution of a plane
+       *  Only available after initializeTGeoDescription(), the lookup is a
+       *  plain array access and thread safe as long as the geometry is not
+       *  modified.
+       */
+      EUTelPlaneCache const & getPlaneCache(int sensorID) const {
+        if(sensorID < 0 || static_cast<size_t>(sensorID) >= _planeCacheIndex.size() ||
+           _planeCacheIndex[static_cast<size_t>(sensorID)] < 0) {
+          throw InvalidGeometryException("No cached geometry for sensor ID " + std::to_string(sensorID));
+        }
+        return _planeCache[static_cast<size_t>(_planeCacheIndex[static_cast<size_t>(sensorID)])];
+      }
 
       // This outputs the total percentage radiation length for the full
       // detector system.
@@ -443,11 +527,15 @@ namespace eutelescope {
 
       void translateSiPlane2TGeo(TGeoVolume *, int);
 
+      /** Fill _planeCache from the TGeo matrices and the active planes */
+      void buildPlaneCache();
+
       void clearMemoizedValues() {
         _planeNormalMap.clear();
         _planeXMap.clear();
         _planeYMap.clear();
         _planeRadMap.clear();
+        _materialBudgetTable = EUTelMaterialBudgetTable();
       }
     };
 
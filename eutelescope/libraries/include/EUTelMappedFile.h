@@ -0,0 +1,54 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELMAPPEDFILE_H
+#define EUTELMAPPEDFILE_H
+
+// system includes <>
+#include <cstddef>
+#include <string>
+
+namespace eutelescope {
+
+  //! Read only memory mapping of a whole file
+  /*! Meant for the converters of binary raw data: the file content is
+   *  decoded in place instead of being copied word by word through a
+   *  stream. The kernel is told that the file will be read sequentially,
+   *  so that it reads ahead and drops the pages behind.
+   *
+   *  The mapping lives as long as the object, pointers into data() must
+   *  not be kept beyond that.
+   */
+  class EUTelMappedFile {
+
+  public:
+    //! Map the file
+    /*! @throw lcio::IOException if the file can not be opened or mapped
+     */
+    explicit EUTelMappedFile(std::string const &fileName);
+
+    ~EUTelMappedFile();
+
+    EUTelMappedFile(EUTelMappedFile const &) = delete;
+    EUTelMappedFile &operator=(EUTelMappedFile const &) = delete;
+
+    //! Start of the file content, nullptr for an empty file
+    char const *data() const { return _data; }
+
+    //! Size of the file in bytes
+    size_t size() const { return _size; }
+
+    std::string const &getFileName() const { return _fileName; }
+
+  private:
+    std::string _fileName;
+    char const *_data;
+    size_t _size;
+  };
+}
+#endif
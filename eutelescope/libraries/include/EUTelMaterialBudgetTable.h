@@ -0,0 +1,101 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELMATERIALBUDGETTABLE_H
+#define EUTELMATERIALBUDGETTABLE_H
+
+// eutelescope includes ".h"
+#include "EUTelPixelMatrix.h"
+
+// system includes <>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Tabulated material budget x/X0 of the telescope versus track direction
+  /*! For each sensor the table holds two grids of x/X0 values: one for the
+   *  sensor itself and one for the gap down to the next sensor along the
+   *  beam. The grids are binned in the track slopes dx/dz and dy/dz, from
+   *  -maxSlope to maxSlope, and are interpolated bilinearly.
+   *
+   *  The values are stored divided by the path length factor
+   *  sqrt(1 + slopeX^2 + slopeY^2), which is what makes a plain slab flat
+   *  in the slopes; the interpolation then only has to follow the real
+   *  structure of the material. Directions beyond the table are clamped
+   *  to its edge, times their own path length factor.
+   *
+   *  The table is filled once, see
+   *  geo::EUTelGeometryTelescopeGeoDescription::buildMaterialBudgetTable(),
+   *  and never modified afterwards: the queries only read it and are thus
+   *  thread safe, unlike the ROOT navigator the values were computed with.
+   */
+  class EUTelMaterialBudgetTable {
+
+  public:
+    //! x/X0 along the direction given by the slopes (dx/dz, dy/dz)
+    typedef std::function<double(double, double)> RadLengthFunction;
+
+    //! Empty table, every query throws
+    EUTelMaterialBudgetTable();
+
+    //! Table with nNodes x nNodes grid points per sensor and gap
+    /*! @throw InvalidParameterException if maxSlope <= 0 or nNodes < 2
+     */
+    EUTelMaterialBudgetTable(double maxSlope, unsigned nNodes);
+
+    double getMaxSlope() const { return _maxSlope; }
+    unsigned getNumberOfNodes() const { return _nNodes; }
+
+    //! Slope of a grid node along either axis
+    double getNodeSlope(unsigned node) const {
+      return -_maxSlope + 2. * _maxSlope * node / (_nNodes - 1);
+    }
+
+    //! Tabulate a sensor and the gap behind it, evaluating the functions on every node
+    /*! The gap function may be empty, for the last sensor along the beam.
+     */
+    void addSensor(int sensorID, RadLengthFunction const &sensor, RadLengthFunction const &gap);
+
+    //! Check if a sensor is tabulated
+    bool hasSensor(int sensorID) const { return _sensors.find(sensorID) != nullptr; }
+
+    //! x/X0 of a sensor for a track with the slopes (dx/dz, dy/dz)
+    /*! @throw InvalidGeometryException if the sensor is not tabulated
+     */
+    double getSensorRadLength(int sensorID, double slopeX, double slopeY) const {
+      return interpolate(sensor(sensorID).sensor, slopeX, slopeY);
+    }
+
+    //! x/X0 between a sensor and the next one along the beam, zero for the last sensor
+    /*! @throw InvalidGeometryException if the sensor is not tabulated
+     */
+    double getGapRadLength(int sensorID, double slopeX, double slopeY) const {
+      return interpolate(sensor(sensorID).gap, slopeX, slopeY);
+    }
+
+  private:
+    struct Sensor {
+      //! Normalised x/X0 on the nodes, slopeY major
+      std::vector<double> sensor, gap;
+    };
+
+    Sensor const &sensor(int sensorID) const;
+
+    //! Fill a grid from a function, all zero for an empty one
+    void tabulate(RadLengthFunction const &radLength, std::vector<double> &grid) const;
+
+    double interpolate(std::vector<double> const &grid, double slopeX, double slopeY) const;
+
+    double _maxSlope;
+    unsigned _nNodes;
+    EUTelPerSensor<Sensor> _sensors;
+  };
+}
+#endif
@@ -0,0 +1,165 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELMULTIEVENTCLUSTERFILTER_H
+#define EUTELMULTIEVENTCLUSTERFILTER_H
+
+// system includes <>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Removes the clusters which show up again in the following events
+  /*! ALPIDE sensors can report the very same cluster in a few consecutive
+   *  frames. The filter keeps a window of depth + 1 events and, once the
+   *  window is full, drops from the depth newer events every cluster
+   *  sharing enough pixels with a cluster of the oldest one. The oldest
+   *  event can then be read back and is released when the next event is
+   *  started.
+   *
+   *  The window is a ring of depth + 1 frames which are reused from one
+   *  event to the next, so the memory only depends on the depth and on
+   *  the largest event seen. Each frame stores its clusters and pixels in
+   *  flat arrays, together with a hash of its pixels on (sensor, x, y):
+   *  the pixels two clusters have in common are found with one lookup per
+   *  pixel instead of comparing all the pixel pairs.
+   *
+   *  The result is the one of the original EUTelProcessorALPIDEClusterFilter:
+   *  - two clusters are the same if the number of pixels of the first one
+   *    found in the second one exceeds overlap times the size of either;
+   *  - clusters are searched for in the following events one after the
+   *    other, the search stops at the first event without a match;
+   *  - a cluster right after a removed one is not tested (the original
+   *    code erased from the vector it was looping over, this keeps the
+   *    output identical);
+   *  - events without any cluster do not enter the window.
+   *
+   *  \b Usage:
+   *  \code{.cpp}
+   *  EUTelMultiEventClusterFilter filter(2, 0.1f);
+   *  filter.beginEvent();
+   *  filter.addCluster(sensorID, type, time);
+   *  filter.addPixel(x, y, signal, time);
+   *  if(filter.endEvent()) {
+   *    for(size_t i = 0; i < filter.getNumberOfClusters(); ++i) {
+   *      if(filter.isKept(i)) ...;
+   *    }
+   *  }
+   *  \endcode
+   */
+  class EUTelMultiEventClusterFilter {
+
+  public:
+    //! A pixel as stored in the frames
+    struct Pixel {
+      int x, y, signal, time;
+    };
+
+    //! @param depth number of following events in which clusters are searched for
+    //! @param overlap minimal fraction of shared pixels of two same clusters
+    EUTelMultiEventClusterFilter(unsigned depth, float overlap);
+
+    unsigned getDepth() const { return _depth; }
+
+    //! Start a new event, releasing the oldest one if the window is full
+    void beginEvent();
+
+    //! Add a cluster to the current event
+    void addCluster(int sensorID, int type, int time);
+
+    //! Add a pixel to the last cluster of the current event
+    void addPixel(int x, int y, int signal, int time);
+
+    //! Close the current event
+    /*! @return true if the window is full: the oldest event has been
+     *  filtered and can be read back until the next beginEvent()
+     */
+    bool endEvent();
+
+    //! Number of events in the window
+    size_t getNumberOfEvents() const { return _nEvents; }
+
+    //! @name Oldest event of the window
+    //@{
+    size_t getNumberOfClusters() const { return oldest().clusters.size(); }
+
+    //! False if the cluster has been found in an older event
+    bool isKept(size_t cluster) const { return oldest().clusters[cluster].kept; }
+
+    int getSensorID(size_t cluster) const { return oldest().clusters[cluster].sensorID; }
+    int getType(size_t cluster) const { return oldest().clusters[cluster].type; }
+    int getTime(size_t cluster) const { return oldest().clusters[cluster].time; }
+
+    //! Pixels of a cluster as [begin, end)
+    Pixel const *pixelsBegin(size_t cluster) const {
+      return oldest().pixels.data() + oldest().clusters[cluster].firstPixel;
+    }
+    Pixel const *pixelsEnd(size_t cluster) const {
+      return oldest().pixels.data() + oldest().clusters[cluster].endPixel;
+    }
+    //@}
+
+  private:
+    struct Cluster {
+      int sensorID, type, time;
+      std::uint32_t firstPixel, endPixel;
+      bool kept;
+    };
+
+    struct Frame {
+      std::vector<Cluster> clusters;
+      std::vector<Pixel> pixels;
+      //! Cluster of each pixel
+      std::vector<std::uint32_t> pixelCluster;
+      //! Offsets of each hash bucket into bucketPixels, plus the end marker
+      std::vector<std::uint32_t> bucketStart;
+      //! Pixel indices sorted by hash bucket
+      std::vector<std::uint32_t> bucketPixels;
+      //! 64 - log2 of the number of buckets
+      unsigned hashShift;
+    };
+
+    Frame &frame(size_t age) { return _frames[(_first + age) % _frames.size()]; }
+    Frame const &oldest() const { return _frames[_first]; }
+
+    //! Hash bucket of a pixel in a frame
+    static size_t bucket(Frame const &frame, int sensorID, int x, int y);
+
+    //! Fill the pixel hash of a closed frame
+    void buildHash(Frame &frame);
+
+    //! Remove the clusters of the oldest event found in the newer ones
+    void filter();
+
+    //! Remove from a frame the clusters matching a cluster of the oldest frame
+    /*! @return true if at least one cluster was removed
+     */
+    bool removeMatches(Frame const &oldestFrame, Cluster const &cluster, Frame &frame);
+
+    unsigned _depth;
+    float _overlap;
+
+    //! The window, _nEvents frames starting at _first plus the one being filled
+    std::vector<Frame> _frames;
+    size_t _first;
+    size_t _nEvents;
+
+    //! @name Scratch space of removeMatches(), sized to the largest frame
+    //@{
+    //! Shared pixels per cluster of the searched frame, kept at zero between calls
+    std::vector<std::uint32_t> _nShared;
+    //! Last pixel which counted for each cluster, to count a cluster once per pixel
+    std::vector<std::uint64_t> _lastPixel;
+    std::uint64_t _pixelStamp;
+    std::vector<std::uint32_t> _candidates;
+    //@}
+  };
+}
+#endif
@@ -0,0 +1,96 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELPH2ACFDECODER_H
+#define EUTELPH2ACFDECODER_H
+
+// system includes <>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Decoder of the raw data format written by the Ph2ACF DAQ of the CMS 2S modules
+  /*! A raw file is a header of fileHeaderWords 32 bit words followed by
+   *  events of a fixed length, see getEventWords(): five words of event
+   *  header, then for each front end one more header word and eleven words
+   *  per CBC chip. Those are four words of top sensor strips, four words of
+   *  bottom sensor strips, the trigger data word and two stub data words.
+   *
+   *  The words are decoded in place, typically straight from an
+   *  EUTelMappedFile. The strips are found by scanning the set bits of the
+   *  strip words instead of testing all of them, and an Event keeps its
+   *  buffers from one decoded event to the next, so decoding allocates
+   *  nothing once the first event is done.
+   */
+  class EUTelPh2ACFDecoder {
+
+  public:
+    static size_t const fileHeaderWords = 12;
+
+    //! Strips of one sensor read out by a chip, as stored in the output
+    static size_t const stripsPerChip = 127;
+
+    struct FileHeader {
+      std::string boardType;
+      std::uint32_t versionMajor, versionMinor, beId, nCbc, eventSize32;
+    };
+
+    //! Content of the second header, one per front end
+    struct FrontEnd {
+      unsigned int chipDataMask, header2Size, eventSize;
+    };
+
+    //! Trigger and stub data of one chip
+    struct Chip {
+      unsigned int latErr, bufOvf, pipeAddr, l1Cnt;
+      unsigned int stub1, stub2, stub3;
+      unsigned int bend1, bend2, bend3;
+      unsigned int sync, or254;
+    };
+
+    struct Event {
+      unsigned int header1Size, feNbr, blockSize;
+      unsigned int cicId, chipId, dataFormatVer, dummySize;
+      unsigned int trigdataSize, eventNbr, bxCnt;
+      unsigned int stubdataSize, tluTriggerId, tdc;
+
+      std::vector<FrontEnd> frontEnds;
+
+      //! All chips, front end major
+      std::vector<Chip> chips;
+
+      //! Strip hits as 0 or 1, stripsPerChip per chip in the order of the chips
+      std::vector<float> top, bottom;
+
+      //! Number of hit strips in top and bottom
+      size_t topHits, bottomHits;
+    };
+
+    EUTelPh2ACFDecoder(int nFrontEnds, int nChips);
+
+    int getNumberOfFrontEnds() const { return _nFrontEnds; }
+    int getNumberOfChips() const { return _nChips; }
+
+    //! Length of an event in 32 bit words
+    size_t getEventWords() const;
+
+    //! Decode a file header, false if its marker words are wrong
+    static bool decodeFileHeader(std::uint32_t const *words, FileHeader &header);
+
+    //! Decode the getEventWords() words of an event
+    void decodeEvent(std::uint32_t const *words, Event &event) const;
+
+  private:
+    int _nFrontEnds;
+    int _nChips;
+  };
+}
+#endif
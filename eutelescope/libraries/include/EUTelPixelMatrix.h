@@ -0,0 +1,202 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELPIXELMATRIX_H
+#define EUTELPIXELMATRIX_H
+
+// eutelescope includes ".h"
+#include "EUTelExceptions.h"
+
+// system includes <>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Rectangular range of pixel indices of a sensor
+  /*! Maps the pixel indices (x, y) of a sensor onto a dense linear
+   *  index, x-major: all the y of the first column come first. This is
+   *  the order in which the per-pixel containers below store their
+   *  entries.
+   */
+  class EUTelPixelRange {
+
+  public:
+    //! Empty range, contains no pixel
+    EUTelPixelRange() : _minX(0), _minY(0), _sizeX(0), _sizeY(0) {}
+
+    //! Range [minX, maxX] x [minY, maxY], both ends included
+    EUTelPixelRange(int minX, int maxX, int minY, int maxY);
+
+    int getMinX() const { return _minX; }
+    int getMinY() const { return _minY; }
+    int getMaxX() const { return _minX + static_cast<int>(_sizeX) - 1; }
+    int getMaxY() const { return _minY + static_cast<int>(_sizeY) - 1; }
+    unsigned getSizeX() const { return _sizeX; }
+    unsigned getSizeY() const { return _sizeY; }
+
+    //! Total number of pixels
+    size_t size() const { return static_cast<size_t>(_sizeX) * _sizeY; }
+
+    //! Check if the pixel lies inside the range
+    bool contains(int x, int y) const {
+      return static_cast<unsigned>(x - _minX) < _sizeX &&
+             static_cast<unsigned>(y - _minY) < _sizeY;
+    }
+
+    //! Linear index of a pixel, only valid if contains(x, y)
+    size_t index(int x, int y) const {
+      return static_cast<size_t>(static_cast<unsigned>(x - _minX)) * _sizeY +
+             static_cast<unsigned>(y - _minY);
+    }
+
+    //! Pixel indices of a linear index
+    int getX(size_t index) const { return _minX + static_cast<int>(index / _sizeY); }
+    int getY(size_t index) const { return _minY + static_cast<int>(index % _sizeY); }
+
+  private:
+    int _minX, _minY;
+    unsigned _sizeX, _sizeY;
+  };
+
+  //! One bit per pixel of a sensor, e.g. to flag hot pixels
+  /*! Membership tests are a bound check and a single bit probe, pixels
+   *  outside of the range are never set.
+   */
+  class EUTelPixelMask {
+
+  public:
+    EUTelPixelMask() : _range(), _words(), _count(0) {}
+
+    //! All the pixels of the range, none set
+    explicit EUTelPixelMask(EUTelPixelRange const &range);
+
+    EUTelPixelRange const &getRange() const { return _range; }
+
+    //! Flag a pixel
+    /*! @return false if the pixel is outside of the range
+     */
+    bool set(int x, int y);
+
+    //! Check if a pixel is flagged, false outside of the range
+    bool test(int x, int y) const {
+      if(!_range.contains(x, y)) return false;
+      size_t const i = _range.index(x, y);
+      return (_words[i >> 6] >> (i & 63)) & 1u;
+    }
+
+    //! Number of flagged pixels
+    size_t count() const { return _count; }
+
+  private:
+    EUTelPixelRange _range;
+    std::vector<std::uint64_t> _words;
+    size_t _count;
+  };
+
+  //! A 32 bit counter per pixel of a sensor, e.g. to count hits
+  class EUTelPixelCounter {
+
+  public:
+    EUTelPixelCounter() : _range(), _counts() {}
+
+    //! All the pixels of the range, all the counters set to zero
+    explicit EUTelPixelCounter(EUTelPixelRange const &range);
+
+    EUTelPixelRange const &getRange() const { return _range; }
+
+    //! Increment the counter of a pixel
+    /*! @return false if the pixel is outside of the range
+     */
+    bool increment(int x, int y) {
+      if(!_range.contains(x, y)) return false;
+      ++_counts[_range.index(x, y)];
+      return true;
+    }
+
+    //! Counter of a pixel, zero outside of the range
+    std::uint32_t get(int x, int y) const {
+      return _range.contains(x, y) ? _counts[_range.index(x, y)] : 0;
+    }
+
+    //! All the counters, in the order of EUTelPixelRange::index()
+    std::vector<std::uint32_t> const &getCounts() const { return _counts; }
+
+    //! Set all the counters back to zero
+    void reset();
+
+  private:
+    EUTelPixelRange _range;
+    std::vector<std::uint32_t> _counts;
+  };
+
+  //! Per sensor storage with a constant time lookup by sensor ID
+  /*! Sensor IDs are small non negative integers, so the lookup is a plain
+   *  vector access instead of a std::map search. Iteration follows the
+   *  insertion order.
+   */
+  template<class T> class EUTelPerSensor {
+
+  public:
+    typedef typename std::vector<std::pair<int, T>>::iterator iterator;
+    typedef typename std::vector<std::pair<int, T>>::const_iterator const_iterator;
+
+    EUTelPerSensor() : _index(), _entries() {}
+
+    //! Store (or replace) the entry of a sensor
+    /*! @throw InvalidParameterException for a negative sensor ID
+     */
+    T &insert(int sensorID, T value) {
+      if(sensorID < 0) {
+        throw InvalidParameterException("Negative sensor ID " + std::to_string(sensorID));
+      }
+      if(T *existing = find(sensorID)) {
+        *existing = std::move(value);
+        return *existing;
+      }
+      auto const slot = static_cast<size_t>(sensorID);
+      if(_index.size() <= slot) _index.resize(slot + 1, -1);
+      _index[slot] = static_cast<int>(_entries.size());
+      _entries.emplace_back(sensorID, std::move(value));
+      return _entries.back().second;
+    }
+
+    //! Entry of a sensor, nullptr if there is none
+    T *find(int sensorID) {
+      int const i = position(sensorID);
+      return i < 0 ? nullptr : &_entries[static_cast<size_t>(i)].second;
+    }
+
+    T const *find(int sensorID) const {
+      int const i = position(sensorID);
+      return i < 0 ? nullptr : &_entries[static_cast<size_t>(i)].second;
+    }
+
+    size_t size() const { return _entries.size(); }
+    bool empty() const { return _entries.empty(); }
+
+    iterator begin() { return _entries.begin(); }
+    iterator end() { return _entries.end(); }
+    const_iterator begin() const { return _entries.begin(); }
+    const_iterator end() const { return _entries.end(); }
+
+  private:
+    int position(int sensorID) const {
+      if(sensorID < 0 || static_cast<size_t>(sensorID) >= _index.size()) return -1;
+      return _index[static_cast<size_t>(sensorID)];
+    }
+
+    //! Position of each sensor in _entries, -1 if absent
+    std::vector<int> _index;
+    std::vector<std::pair<int, T>> _entries;
+  };
+}
+#endif
@@ -0,0 +1,80 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELPOINTGRID_H
+#define EUTELPOINTGRID_H
+
+// system includes <>
+#include <cstddef>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Uniform 2D binning of a set of points for rectangular range queries
+  /*! The points (hits, triplet impact points, ...) are bucketed once into
+   *  a regular grid over their bounding box. A range query then only
+   *  visits the cells overlapping the requested rectangle instead of all
+   *  the points, which turns the usual "loop over everything and cut"
+   *  pattern into a lookup.
+   *
+   *  The query returns the indices of the matching points in ascending
+   *  order, i.e. in the order in which they were given to build(). Code
+   *  replacing a linear scan therefore visits the surviving points in
+   *  the very same order as before.
+   *
+   *  \b Usage:
+   *  \code{.cpp}
+   *  EUTelPointGrid grid;
+   *  grid.build(x, y, 0.5);
+   *  grid.query(x0 - cut, x0 + cut, y0 - cut, y0 + cut, candidates);
+   *  for(auto i: candidates) { if(fabs(x[i] - x0) < cut) ...; }
+   *  \endcode
+   */
+  class EUTelPointGrid {
+
+  public:
+    EUTelPointGrid();
+
+    //! Bucket the points (x[i], y[i])
+    /*! @param cellSize requested cell width, the grid is coarsened if
+     *  it would contain many more cells than points
+     */
+    void build(std::vector<double> const &x, std::vector<double> const &y,
+               double cellSize);
+
+    //! Number of points in the grid
+    size_t size() const { return _x.size(); }
+
+    //! Indices of all the points with x in [xMin, xMax] and y in [yMin, yMax]
+    /*! The result is cleared first and sorted in ascending order.
+     */
+    void query(double xMin, double xMax, double yMin, double yMax,
+               std::vector<size_t> &result) const;
+
+  private:
+    //! Cell column/row of a coordinate, clamped to the grid
+    long cellX(double x) const;
+    long cellY(double y) const;
+
+    //! Copy of the coordinates, for the final rectangle check
+    std::vector<double> _x, _y;
+
+    //! Grid origin and inverse cell width
+    double _xMin, _yMin, _invCellSize;
+
+    //! Number of cells along x and y
+    long _nX, _nY;
+
+    //! Offsets of each cell into _cellPoints, plus the end marker
+    std::vector<size_t> _cellStart;
+
+    //! Point indices sorted by cell, ascending inside each cell
+    std::vector<size_t> _cellPoints;
+  };
+}
+#endif
@@ -0,0 +1,117 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELRUNNINGPEDESTALNOISE_H
+#define EUTELRUNNINGPEDESTALNOISE_H
+
+// system includes <>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Streaming pedestal and noise estimator for a set of channels
+  /*! The pedestal of a channel is the mean of its signals and the noise
+   *  their standard deviation, as the mean and sigma of a Gaussian fit to
+   *  the signal distribution would be for pure noise. They are computed
+   *  with Welford's running moments, kept in contiguous arrays with one
+   *  entry per channel: the memory does not depend on any binning and an
+   *  event costs one pass over its channels.
+   *
+   *  Signals from particles or pick-up bias those moments, unlike a fit
+   *  of the core of the distribution. Optionally the signals of the first
+   *  maxStoredEvents events are therefore kept (event major, one float
+   *  per channel) and compute() iteratively recomputes the moments of
+   *  each channel from the stored signals within rejectionCut sigma of
+   *  its current pedestal, until nothing changes any more or after
+   *  rejectionIterations iterations.
+   *
+   *  \b Usage:
+   *  \code{.cpp}
+   *  EUTelRunningPedestalNoise estimator(nChannels, 3, 3.f, 10000);
+   *  for(each event) estimator.addEvent(signals);
+   *  estimator.compute();
+   *  float pedestal = estimator.getPedestal(channel), noise = estimator.getNoise(channel);
+   *  \endcode
+   */
+  class EUTelRunningPedestalNoise {
+
+  public:
+    //! Constructor
+    /*! @param rejectionIterations the maximum number of outlier rejection
+     *  iterations, 0 for plain moments, in which case nothing is stored
+     *  @param maxStoredEvents the number of events stored for the outlier
+     *  rejection, 0 stores all of them
+     */
+    EUTelRunningPedestalNoise(size_t nChannels, unsigned rejectionIterations = 0,
+                              float rejectionCut = 3.f, size_t maxStoredEvents = 0);
+
+    size_t getNumberOfChannels() const { return _nChannels; }
+
+    //! Number of events added
+    size_t getNumberOfEvents() const { return _nEvents; }
+
+    //! Add the signals of an event, one per channel
+    void addEvent(float const *signals);
+
+    //! Add the signals of an event
+    /*! @throw InvalidParameterException if there is not one signal per channel
+     */
+    void addEvent(std::vector<float> const &signals);
+
+    //! Compute the pedestals and noises of the events added so far
+    void compute();
+
+    //! Pedestal of a channel, as of the last compute()
+    float getPedestal(size_t channel) const { return _pedestal[channel]; }
+
+    //! Noise of a channel, as of the last compute()
+    float getNoise(size_t channel) const { return _noise[channel]; }
+
+    std::vector<float> const &getPedestals() const { return _pedestal; }
+    std::vector<float> const &getNoises() const { return _noise; }
+
+    //! Number of signals of a channel the last compute() used, after the outlier rejection
+    std::uint32_t getNumberOfEntries(size_t channel) const { return _entries[channel]; }
+
+  private:
+    //! Running moments of all channels
+    /*! The second moments are accumulated in double, in float the sum of
+     *  squared deviations of a long run loses the precision of the noise.
+     */
+    struct Moments {
+      std::vector<std::uint32_t> count;
+      std::vector<double> mean, m2;
+
+      void reset(size_t nChannels);
+      void add(size_t channel, double signal) {
+        double const delta = signal - mean[channel];
+        mean[channel] += delta / ++count[channel];
+        m2[channel] += delta * (signal - mean[channel]);
+      }
+    };
+
+    //! Fill the results from a set of moments
+    void setResults(Moments const &moments);
+
+    size_t _nChannels;
+    unsigned _rejectionIterations;
+    float _rejectionCut;
+    size_t _maxStoredEvents;
+
+    size_t _nEvents;
+    Moments _moments;
+    //! Signals of the stored events, event major
+    std::vector<float> _stored;
+
+    std::vector<float> _pedestal, _noise;
+    std::vector<std::uint32_t> _entries;
+  };
+}
+#endif
@@ -0,0 +1,141 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELSPARSECLUSTERFINDER_H
+#define EUTELSPARSECLUSTERFINDER_H
+
+// system includes <>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Grid indexed connected component search for sparsified pixels
+  /*! This helper class groups the hit pixels of one sensor into
+   *  clusters. Two pixels belong to the same cluster if the squared
+   *  distance of their pixel indices is smaller or equal to the
+   *  configured cut, and clusters are the connected components of
+   *  this neighbourhood relation.
+   *
+   *  The pixels are bucketed into an occupancy grid spanning the pixel
+   *  index range of the sensor, so the neighbours of a pixel are found
+   *  by probing the few grid cells inside the cut radius instead of
+   *  scanning all the remaining hits. The total cost is therefore
+   *  linear in the number of hit pixels. The grid is allocated once and
+   *  only the touched cells are reset after each search, so repeated
+   *  use does not allocate.
+   *
+   *  The clusters, as well as the pixel order inside each cluster, are
+   *  identical to the ones of the original EUTelSparseClustering
+   *  algorithm: a cluster is seeded by the first unassigned pixel (in
+   *  input order) and grown breadth first, the unassigned neighbours of
+   *  each pixel being appended in input order.
+   *
+   *  \b Usage:
+   *  \code{.cpp}
+   *  EUTelSparseClusterFinder finder(minX, maxX, minY, maxY, 2);
+   *  finder.clear();
+   *  for(auto& pixel: pixels) finder.addPixel(pixel.getXCoord(), pixel.getYCoord());
+   *  for(size_t iCluster = 0; iCluster < finder.findClusters(); ++iCluster) {
+   *    auto range = finder.getCluster(iCluster);
+   *    for(auto it = range.first; it != range.second; ++it) { pixels[*it]; }
+   *  }
+   *  \endcode
+   */
+  class EUTelSparseClusterFinder {
+
+  public:
+    //! Iterator over the pixel indices of a cluster
+    typedef std::vector<size_t>::const_iterator const_iterator;
+
+    //! Constructor
+    /*! @param minX lowest pixel index along x
+     *  @param maxX highest pixel index along x
+     *  @param minY lowest pixel index along y
+     *  @param maxY highest pixel index along y
+     *  @param minDistanceSquared the squared distance cut in pixel
+     *  index units (touching == 2)
+     */
+    EUTelSparseClusterFinder(int minX, int maxX, int minY, int maxY,
+                             int minDistanceSquared);
+
+    //! Remove all the pixels and clusters of the previous search
+    void clear();
+
+    //! Reserve space for @c n pixels
+    void reserve(size_t n);
+
+    //! Add a hit pixel
+    /*! The pixels are referred to later on by their insertion index.
+     *  Pixels outside the index range given in the constructor are
+     *  allowed, the grid is enlarged on the next search.
+     */
+    void addPixel(int x, int y);
+
+    //! Run the cluster search over all the added pixels
+    /*! @return The number of clusters found
+     */
+    size_t findClusters();
+
+    //! Number of pixels added since the last clear()
+    size_t getNumberOfPixels() const { return _x.size(); }
+
+    //! Number of clusters found by the last findClusters()
+    size_t getNumberOfClusters() const {
+      return _clusterOffsets.empty() ? 0 : _clusterOffsets.size() - 1;
+    }
+
+    //! Pixel indices (insertion order) belonging to cluster @c i
+    std::pair<const_iterator, const_iterator> getCluster(size_t i) const {
+      return std::make_pair(_clusterPixels.begin() + static_cast<long>(_clusterOffsets[i]),
+                            _clusterPixels.begin() + static_cast<long>(_clusterOffsets[i + 1]));
+    }
+
+  private:
+    //! (Re)allocate the occupancy grid to cover the given index range
+    void resizeGrid(int minX, int maxX, int minY, int maxY);
+
+    //! Grid cell of a pixel index, -1 if outside the grid
+    long cellIndex(int x, int y) const {
+      if(x < _minX || x > _maxX || y < _minY || y > _maxY) return -1;
+      return static_cast<long>(y - _minY) * _nX + (x - _minX);
+    }
+
+    //! Grid boundaries (pixel indices)
+    int _minX, _maxX, _minY, _maxY;
+
+    //! Number of grid cells along x
+    long _nX;
+
+    //! Neighbourhood as list of index offsets (dx, dy)
+    std::vector<std::pair<int, int>> _window;
+
+    //! First pixel in each grid cell, -1 if the cell is empty
+    std::vector<long> _cellHead;
+
+    //! Next pixel in the same grid cell, -1 for the last one
+    std::vector<long> _cellNext;
+
+    //! Pixel coordinates in insertion order
+    std::vector<int> _x, _y;
+
+    //! Flag for pixels already assigned to a cluster
+    std::vector<char> _assigned;
+
+    //! Pixel indices grouped by cluster, in cluster order
+    std::vector<size_t> _clusterPixels;
+
+    //! Start of each cluster in _clusterPixels, plus the end marker
+    std::vector<size_t> _clusterOffsets;
+
+    //! Scratch space for the neighbours of a single pixel
+    std::vector<size_t> _neighbours;
+  };
+}
+#endif
@@ -0,0 +1,125 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELSTRIPCLUSTERFINDER_H
+#define EUTELSTRIPCLUSTERFINDER_H
+
+// system includes <>
+#include <cstddef>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Seed and neighbour clustering of the signals of a strip sensor
+  /*! A cluster is a run of adjacent unmasked strips above the neighbour
+   *  cut containing at least one seed, a strip above the seed cut whose
+   *  neighbours are not masked. Both cuts are in units of the noise of
+   *  each strip, the signals are multiplied by the polarity first so that
+   *  the cuts are always on positive values.
+   *
+   *  With seed splitting on (the default, as AlibavaClustering always
+   *  did) a run with several seeds is split: a seed with a higher signal
+   *  to noise ratio than the current one, further down the run and not
+   *  adjacent to it, starts a new cluster right after the current seed,
+   *  so that the strips in between go to the higher seed. An adjacent
+   *  higher seed only moves the seed strip and lower seeds are absorbed.
+   *  Without splitting each run is one cluster with its highest strip as
+   *  seed.
+   *
+   *  The strips are visited once, the cluster sums being accumulated on
+   *  the way, and the cuts are precomputed per strip when the noise or
+   *  the mask change (only around the strip for a mask change), so an event costs a single pass over the signals
+   *  whatever the multiplicity.
+   *
+   *  \b Usage:
+   *  \code{.cpp}
+   *  EUTelStripClusterFinder finder(128, 3.f, 1.5f, -1);
+   *  finder.setNoise(noise);
+   *  for(channel in masked channels) finder.setMasked(channel, true);
+   *  std::vector<EUTelStripClusterFinder::Cluster> clusters;
+   *  finder.findClusters(signal.data(), clusters);
+   *  \endcode
+   */
+  class EUTelStripClusterFinder {
+
+  public:
+    //! A cluster found, the charges already multiplied by the polarity
+    struct Cluster {
+      int firstStrip, lastStrip, seedStrip;
+      //! Sum of the signals
+      double charge;
+      //! Linear sum of the noise of the strips
+      double noise;
+      //! Signal weighted mean strip
+      double cog;
+      //! Two strip eta of the seed and its larger neighbour, -1 if undefined
+      /*! The left strip signal over the sum of both, undefined if a
+       *  neighbour is masked or outside the sensor or both are equal.
+       */
+      double eta;
+
+      int getSize() const { return lastStrip - firstStrip + 1; }
+    };
+
+    //! Constructor, all strips unmasked with a noise of 1
+    /*! @param seedCut signal to noise ratio of a seed
+     *  @param neighbourCut signal to noise ratio of the other strips
+     *  @param polarity -1 for negative signals, 1 for positive ones
+     */
+    EUTelStripClusterFinder(size_t nStrips, float seedCut, float neighbourCut, int polarity = 1);
+
+    size_t getNStrips() const { return _noise.size(); }
+
+    //! Set the nStrips noise values
+    void setNoise(float const *noise);
+
+    //! Set the noise values
+    /*! @throw InvalidParameterException if there is not one value per strip
+     */
+    void setNoise(std::vector<float> const &noise);
+
+    //! Mask or unmask a strip, updating only its cuts and the ones of its neighbours
+    void setMasked(size_t strip, bool masked);
+    bool isMasked(size_t strip) const { return _masked[strip] != 0; }
+
+    void setSplitSeeds(bool splitSeeds) { _splitSeeds = splitSeeds; }
+    bool getSplitSeeds() const { return _splitSeeds; }
+
+    //! Find the clusters in the nStrips signals of an event
+    /*! @param clusters cleared, then filled in strip order
+     *  @return the number of clusters
+     */
+    size_t findClusters(float const *signal, std::vector<Cluster> &clusters) const;
+
+  private:
+    //! Recompute the cuts of each strip from the noise and the mask
+    void updateLevels();
+
+    //! Recompute whether the mask allows a seed on a strip
+    void updateSeedAllowed(size_t strip);
+
+    //! Complete and append a cluster
+    void addCluster(float const *signal, int first, int last, int seed, double charge, double noise,
+                    double weightedStrip, std::vector<Cluster> &clusters) const;
+
+    float _seedCut, _neighbourCut;
+    float _polarity;
+    bool _splitSeeds;
+
+    std::vector<float> _noise;
+    std::vector<char> _masked;
+
+    //! Per strip cuts, a masked strip never passes the neighbour one
+    std::vector<float> _neighbourLevel, _seedLevel;
+    //! 1 / noise, for comparing the seeds
+    std::vector<float> _inverseNoise;
+    //! Whether the neighbours of a strip allow a seed on it
+    std::vector<char> _seedAllowed;
+  };
+}
+#endif
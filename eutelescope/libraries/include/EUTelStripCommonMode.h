@@ -0,0 +1,129 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELSTRIPCOMMONMODE_H
+#define EUTELSTRIPCOMMONMODE_H
+
+// system includes <>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Pedestal subtraction, common mode and common mode subtraction of a strip readout chip
+  /*! Works on the nChannels signals of one chip (a Beetle as read out by
+   *  Alibava) as plain float arrays, with the pedestals and the channel
+   *  mask set once beforehand. Masked channels are 0 in every output and
+   *  never enter the common mode.
+   *
+   *  The common mode is computed as AlibavaConstantCommonModeProcessor
+   *  always did: a first pass over all the channels, then iterations
+   *  keeping only the channels within noiseDeviation sigma of the mean of
+   *  the previous pass. It is either the mean of the channels kept or the
+   *  straight line a + b * channel fitted to them, its error is their
+   *  standard deviation. The sums are accumulated in double, so the
+   *  results only differ from the channel by channel loop by the order of
+   *  the additions.
+   *
+   *  The loops have an AVX2 version, used when the CPU supports it, and a
+   *  scalar one otherwise. Neither needs the library to be compiled for
+   *  AVX2.
+   *
+   *  \b Usage:
+   *  \code{.cpp}
+   *  EUTelStripCommonMode kernel(3, 2.5f, EUTelStripCommonMode::Method::slope);
+   *  kernel.setPedestals(pedestals);
+   *  for(channel in masked channels) kernel.setMasked(channel, true);
+   *  EUTelStripCommonMode::CommonMode cm = kernel.process(raw, corrected);
+   *  \endcode
+   */
+  class EUTelStripCommonMode {
+
+  public:
+    //! Channels of a chip
+    static constexpr size_t nChannels = 128;
+
+    enum class Method { constant, slope };
+
+    //! The common mode of a chip in an event
+    struct CommonMode {
+      //! Mean signal of the channels kept
+      double mean;
+      //! Standard deviation of the channels kept, the common mode error
+      double sigma;
+      //! Straight line fitted to the channels kept, common mode = offset + slope * channel
+      double offset, slope;
+      //! Number of channels kept in the last iteration
+      int nUsed;
+    };
+
+    //! Constructor, no channel masked and all pedestals 0
+    /*! @param iterations number of passes over the channels, the first one
+     *  taking all of them
+     *  @param noiseDeviation the channels beyond this many sigma from the
+     *  mean are considered signal in the next pass
+     */
+    EUTelStripCommonMode(unsigned iterations, float noiseDeviation, Method method);
+
+    //! Set the nChannels pedestals
+    void setPedestals(float const *pedestals);
+
+    //! Set the pedestals
+    /*! @throw InvalidParameterException if there is not one pedestal per channel
+     */
+    void setPedestals(std::vector<float> const &pedestals);
+
+    void setMasked(size_t channel, bool masked) { _keep[channel] = masked ? 0 : -1; }
+    bool isMasked(size_t channel) const { return _keep[channel] == 0; }
+
+    //! Whether the AVX2 loops are used, by default when the CPU has AVX2
+    bool getUseAVX2() const { return _useAVX2; }
+
+    //! Force the scalar loops, or the AVX2 ones if the CPU has AVX2
+    void setUseAVX2(bool useAVX2);
+
+    //! True if the CPU supports AVX2 and it was compiled in
+    static bool isAVX2Available();
+
+    //! result = data - values for each channel, 0 for the masked ones
+    /*! Pedestal subtraction with values the pedestals, common mode
+     *  subtraction with values the common mode of each channel. result may
+     *  be data.
+     */
+    void subtract(float const *data, float const *values, float *result) const;
+
+    //! Subtract the pedestals set
+    void subtractPedestals(float const *raw, float *signal) const { subtract(raw, _pedestal, signal); }
+
+    //! Common mode of pedestal subtracted signals
+    CommonMode computeCommonMode(float const *signal) const;
+
+    //! The common mode of each channel, with the method of the kernel
+    void fillCommonMode(CommonMode const &commonMode, float *values) const;
+
+    //! Pedestal subtraction, common mode and its subtraction in one go
+    /*! @param corrected the pedestal and common mode subtracted signals
+     *  @param signal if not nullptr, gets the pedestal subtracted signals
+     *  @param commonMode if not nullptr, gets the common mode of each channel
+     */
+    CommonMode process(float const *raw, float *corrected, float *signal = nullptr,
+                       float *commonMode = nullptr) const;
+
+  private:
+    unsigned _iterations;
+    double _noiseDeviation;
+    Method _method;
+    bool _useAVX2;
+
+    float _pedestal[nChannels];
+    //! All bits set for the channels used, 0 for the masked ones, as a SIMD mask
+    std::int32_t _keep[nChannels];
+  };
+}
+#endif
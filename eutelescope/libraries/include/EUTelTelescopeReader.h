@@ -0,0 +1,194 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELTELESCOPEREADER_H
+#define EUTELTELESCOPEREADER_H
+
+// lcio includes <.h>
+#include <IMPL/LCCollectionVec.h>
+#include <LCIOTypes.h>
+#include <lcio.h>
+
+// system includes <>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if LCIO_VERSION_GE(2, 14)
+namespace MT {
+  class LCReader;
+}
+#else
+namespace IO {
+  class LCReader;
+}
+#endif
+
+namespace EVENT {
+  class LCEvent;
+}
+
+namespace eutelescope {
+
+  //! Sequential reader of a telescope LCIO file with read ahead
+  /*! Meant for the processors merging a second data stream with a
+   *  telescope run (CMSMerger, CMSBuncher, ...): they consume the
+   *  telescope frames in file order, one by one or as all the frames of a
+   *  time window, and spend most of their time waiting for LCIO to read
+   *  and unpack the next event.
+   *
+   *  A background thread keeps the next prefetchFrames frames decoded
+   *  ahead of the consumer. Since an LCIO event does not outlive the next
+   *  read, the requested collections are copied into a Frame, which stays valid
+   *  as long as it is referenced. Only TrackerData and TrackerPulse
+   *  collections can be copied, with their parameters (in particular the
+   *  CellID encoding) and the TrackerData of the pulses. With
+   *  prefetchFrames = 0 no thread is started and the frames are read on
+   *  demand.
+   *
+   *  The thread reads while Marlin reads the main input with its own
+   *  LCReader. This is only safe with the MT::LCReader of LCIO 2.14 and
+   *  later, whose readers share no state: with an older LCIO the frames
+   *  are always read on demand, see canPrefetch().
+   *
+   *  The frames consumed are indexed by run, event number and time stamp
+   *  in file order, see getIndex(). LCIO does not expose the file
+   *  offsets of its records, the position in the index is the frame
+   *  number in the file.
+   *
+   *  All the member functions have to be called from the same thread.
+   */
+  class EUTelTelescopeReader {
+
+  public:
+    //! The copied collections of a telescope event
+    class Frame {
+    public:
+      int getRunNumber() const { return _runNumber; }
+      int getEventNumber() const { return _eventNumber; }
+      lcio::long64 getTimeStamp() const { return _timeStamp; }
+
+      //! A copied collection, like LCEvent::getCollection()
+      /*! @throw lcio::DataNotAvailableException if the event did not have it
+       */
+      IMPL::LCCollectionVec *getCollection(std::string const &name) const;
+
+    private:
+      friend class EUTelTelescopeReader;
+      Frame();
+
+      int _runNumber;
+      int _eventNumber;
+      lcio::long64 _timeStamp;
+      std::map<std::string, std::unique_ptr<IMPL::LCCollectionVec>> _collections;
+      //! Copies of TrackerData referenced by pulses but not in a copied collection
+      std::unique_ptr<IMPL::LCCollectionVec> _orphans;
+    };
+
+    typedef std::shared_ptr<Frame const> FramePtr;
+
+    struct IndexEntry {
+      int runNumber;
+      int eventNumber;
+      lcio::long64 timeStamp;
+    };
+
+    //! Open a telescope file
+    /*! @param collectionNames the collections to copy into the frames
+     *  @param prefetchFrames the number of frames to read ahead,
+     *  ignored unless canPrefetch()
+     *  @throw lcio::IOException if the file can not be opened
+     */
+    EUTelTelescopeReader(std::string const &fileName, std::vector<std::string> const &collectionNames,
+                         size_t prefetchFrames);
+
+    //! Whether this LCIO build allows the read ahead
+    static bool canPrefetch();
+
+    //! Number of frames read ahead, 0 without read ahead
+    size_t getPrefetchFrames() const { return _prefetchFrames; }
+
+    //! Destructor, stops the read ahead and closes the file
+    ~EUTelTelescopeReader();
+
+    //! Number of events in the file
+    int getNumberOfEvents() const { return _nEvents; }
+
+    //! Skip frames without handing them out or indexing them
+    /*! Without frames read ahead LCIO skips them without unpacking.
+     */
+    void skip(size_t nFrames);
+
+    //! The next frame without consuming it, nullptr at the end of the file
+    FramePtr peek();
+
+    //! Consume the next frame, nullptr at the end of the file
+    FramePtr next();
+
+    //! Consume all the next frames with a time stamp below timeLimit
+    /*! The frames are appended to frames and the first frame at or beyond
+     *  timeLimit is left as the next one, the file has to be time ordered.
+     *  @return the number of frames appended
+     */
+    size_t readUntil(lcio::long64 timeLimit, std::vector<FramePtr> &frames);
+
+    //! Run, event number and time stamp of the frames consumed so far, skipped ones excepted
+    std::vector<IndexEntry> const &getIndex() const { return _index; }
+
+    //! Position in the index of the first frame at or beyond a time stamp
+    size_t findTimeStamp(lcio::long64 timeStamp) const;
+
+  private:
+    EUTelTelescopeReader(EUTelTelescopeReader const &) = delete;
+    EUTelTelescopeReader &operator=(EUTelTelescopeReader const &) = delete;
+
+    //! Read and copy the next event, nullptr at the end of the file
+    FramePtr readFrame();
+
+    //! Main loop of the read ahead thread
+    void prefetchLoop();
+
+    //! Get the next frame into _next, from the thread or the file
+    void fetch();
+
+    //! Consume the next frame without indexing it
+    FramePtr take();
+
+#if LCIO_VERSION_GE(2, 14)
+    std::unique_ptr<MT::LCReader> _reader;
+#else
+    std::unique_ptr<IO::LCReader> _reader;
+#endif
+    std::vector<std::string> _collectionNames;
+    size_t _prefetchFrames;
+    int _nEvents;
+
+    //! The frame returned by peek(), not yet consumed
+    FramePtr _next;
+    bool _nextFetched;
+    std::vector<IndexEntry> _index;
+
+    //! The read ahead, filled by the thread
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::deque<FramePtr> _queue;
+    bool _started;
+    bool _finished;
+    bool _stop;
+    std::exception_ptr _error;
+  };
+}
+#endif
@@ -64,6 +64,7 @@
 #include <utility>
 #include <deque>
 #include <algorithm>
+#include <limits>
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -73,6 +74,9 @@
 
 // Eigen include
 #include <Eigen/Core>
+
+// eutelescope includes ".h"
+#include "EUTelPointGrid.h"
 using namespace marlin;
 
 namespace eutelescope {
@@ -141,6 +145,48 @@ public:
         }
     };
 
+    //! Spatially binned hits of one plane
+    /*! Built once per event and plane, it replaces the scans over the full
+     * hit vector by a lookup of the hits inside a rectangular window. The
+     * hits are always returned in their original order.
+     */
+    class HitGrid {
+    public:
+        HitGrid(std::vector<hit> const & hits, unsigned int plane);
+
+        //! The plane ID of the hits in the grid
+        unsigned int getPlane() const { return _plane; }
+
+        //! Number of hits on the plane
+        size_t size() const { return _hitIndices.size(); }
+
+        //! Indices (into the hit vector) of all the hits on the plane, ascending
+        std::vector<size_t> const & getHitIndices() const { return _hitIndices; }
+
+        //! Lowest and highest z of the hits on the plane
+        double getZMin() const { return _zMin; }
+        double getZMax() const { return _zMax; }
+
+        //! Indices (into the hit vector) of the hits with x in [xMin, xMax] and y in [yMin, yMax], ascending
+        void query(double xMin, double xMax, double yMin, double yMax, std::vector<size_t> & result) const;
+
+        //! Same as query(), without restriction along y
+        void queryX(double xMin, double xMax, std::vector<size_t> & result) const {
+            query(xMin, xMax, std::numeric_limits<double>::lowest(), std::numeric_limits<double>::max(), result);
+        }
+
+        //! Same as query(), without restriction along x
+        void queryY(double yMin, double yMax, std::vector<size_t> & result) const {
+            query(std::numeric_limits<double>::lowest(), std::numeric_limits<double>::max(), yMin, yMax, result);
+        }
+
+    private:
+        unsigned int _plane;
+        std::vector<size_t> _hitIndices;
+        double _zMin, _zMax;
+        EUTelPointGrid _grid;
+    };
+
     class triplet {
     public:
         triplet();
@@ -282,6 +328,12 @@ public:
 
     bool AttachDUT(EUTelTripletGBLUtility::triplet & triplet, std::vector<EUTelTripletGBLUtility::hit> const & hits, unsigned int dutID,  std::vector<float> dist_cuts);
 
+    //! Same as above, with the DUT hits binned beforehand
+    /*! To be preferred when several triplets are matched to the same hits.
+     * @param dutHits grid of the DUT plane, built from the same hit vector
+     */
+    bool AttachDUT(EUTelTripletGBLUtility::triplet & triplet, std::vector<EUTelTripletGBLUtility::hit> const & hits, HitGrid const & dutHits, std::vector<float> const & dist_cuts);
+
     //! Check isolation of triplet within vector of triplets
     bool IsTripletIsolated(EUTelTripletGBLUtility::triplet const & it, std::vector<EUTelTripletGBLUtility::triplet> const &trip, double z_match, double isolation = 0.3);
 
@@ -290,26 +342,42 @@ private:
     //! store the parent, needed for having histograms in the same file as the processor that calls the util class
     marlin::Processor * parent;
 
+    //! Half range of the residual and slope cut plots, in [mm] and [mrad]
+    /*! The binned searches fill the plots from all the entries within this
+     * range, so that the plots keep the same in-range content as with a
+     * full scan. Only the under- and overflow entries are not counted.
+     */
+    static constexpr double cutPlotRange = 3.;
+
+    //! Margin added to the search windows, far above the rounding errors
+    static constexpr double searchMargin = 1E-6;
+
+    //! Flag the points having another one closer than isolation_cut
+    /*! Same criterion as IsTripletIsolated(), for all the points at once.
+     */
+    static void FlagIsolated(std::vector<double> const & x, std::vector<double> const & y, double isolation_cut, std::vector<char> & isolated);
+
 
 
 protected:
     std::string _inputCollectionTelescope;
 
 
-    //cut plots
-    AIDA::IHistogram1D * upstreamTripletSlopeX;
-    AIDA::IHistogram1D * upstreamTripletSlopeY;
-    AIDA::IHistogram1D * downstreamTripletSlopeX;
-    AIDA::IHistogram1D * downstreamTripletSlopeY;
-    AIDA::IHistogram1D * upstreamTripletResidualX;
-    AIDA::IHistogram1D * upstreamTripletResidualY;
-    AIDA::IHistogram1D * downstreamTripletResidualX;
-    AIDA::IHistogram1D * downstreamTripletResidualY;
-    AIDA::IHistogram1D * tripletMatchingResidualX;
-    AIDA::IHistogram1D * tripletMatchingResidualY;
-    AIDA::IHistogram1D * DUTMatchingResidualX;
-    AIDA::IHistogram1D * DUTMatchingResidualY;
-    AIDA::IHistogram1D * DUTHitNumber;
+    //cut plots, only filled once booked by bookHistos(): without them the
+    //triplet finding and matching also run outside of a Marlin processor
+    AIDA::IHistogram1D * upstreamTripletSlopeX = nullptr;
+    AIDA::IHistogram1D * upstreamTripletSlopeY = nullptr;
+    AIDA::IHistogram1D * downstreamTripletSlopeX = nullptr;
+    AIDA::IHistogram1D * downstreamTripletSlopeY = nullptr;
+    AIDA::IHistogram1D * upstreamTripletResidualX = nullptr;
+    AIDA::IHistogram1D * upstreamTripletResidualY = nullptr;
+    AIDA::IHistogram1D * downstreamTripletResidualX = nullptr;
+    AIDA::IHistogram1D * downstreamTripletResidualY = nullptr;
+    AIDA::IHistogram1D * tripletMatchingResidualX = nullptr;
+    AIDA::IHistogram1D * tripletMatchingResidualY = nullptr;
+    AIDA::IHistogram1D * DUTMatchingResidualX = nullptr;
+    AIDA::IHistogram1D * DUTMatchingResidualY = nullptr;
+    AIDA::IHistogram1D * DUTHitNumber = nullptr;
 };
 
 }
@@ -13,27 +13,98 @@ void EUTelTripletGBLUtility::FindTriplets(std::vector<EUTelTripletGBLUtility::hi
   auto plane1 = static_cast<unsigned>(triplet_sensor_ids[1]);
   auto plane2 = static_cast<unsigned>(triplet_sensor_ids[2]);
 
-  // get all hit is plane = plane0
+  // Partition the hits by plane, keeping their order
+  std::vector<EUTelTripletGBLUtility::hit const *> hits0, hits2;
   for( auto& ihit: hits ){
-    if( ihit.plane != plane0 ) continue; // First plane
+    if( ihit.plane == plane0 ) hits0.push_back(&ihit);
+    if( ihit.plane == plane2 ) hits2.push_back(&ihit);
+  }
+  HitGrid const hits1(hits, plane1);
+  // The cut plots are booked all together, or not at all
+  bool const fillPlots = upstreamTripletSlopeX != nullptr;
+  auto const nHits1 = hits1.size();
+  std::vector<size_t> candidates;
+
+  // If the middle plane is also the middle plane ID, the triplet slope and
+  // the extrapolation to plane1 only depend on the outer hits: the slope cut
+  // is applied once per pair, the cut plots are filled from the hits in the
+  // plot range and only the plane1 hits inside the residual cut window are
+  // turned into triplets. Otherwise (odd plane ordering) every plane1 hit is
+  // tried, as the triplet class then uses it for its slope.
+  bool const middleInBetween = (plane0 < plane1 && plane1 < plane2) || (plane0 > plane1 && plane1 > plane2);
+  bool const plane0First = plane0 < plane2;
+
+  // get all hit is plane = plane0
+  for( auto ihit: hits0 ){
 
     // get all hit is plane = plane2
-    for( auto& jhit: hits ){
-      if( jhit.plane != plane2 ) continue; // Last plane
+    for( auto jhit: hits2 ){
+
+      if( middleInBetween ) {
+        // Same arithmetic as triplet::getdx(), getdy(), getdz(), base() and slope()
+        auto const & first = plane0First ? *ihit : *jhit;
+        auto const & last = plane0First ? *jhit : *ihit;
+        double const dx = last.x - first.x;
+        double const dy = last.y - first.y;
+        double const dz = last.z - first.z;
+
+        // One entry per plane1 hit, as for a full scan. Entries outside the
+        // plot range would only end up in the overflow and are skipped.
+        auto slopeX = upstream ? upstreamTripletSlopeX : downstreamTripletSlopeX;
+        auto slopeY = upstream ? upstreamTripletSlopeY : downstreamTripletSlopeY;
+        if( fillPlots && fabs(dx*1E3/dz) <= cutPlotRange ) for( size_t k = 0; k < nHits1; ++k ) slopeX->fill(dx*1E3/dz);
+        if( fillPlots && fabs(dy*1E3/dz) <= cutPlotRange ) for( size_t k = 0; k < nHits1; ++k ) slopeY->fill(dy*1E3/dz);
+
+        // Setting cuts on the triplet track angle:
+        if( fabs(dx) > slope_cut * dz ) continue;
+        if( fabs(dy) > slope_cut * dz ) continue;
+
+        // Extrapolation to the plane1 hits, whose z can differ for tilted planes
+        double const slopeXValue = dx/dz;
+        double const slopeYValue = dy/dz;
+        double const baseX = 0.5*( first.x + last.x );
+        double const baseY = 0.5*( first.y + last.y );
+        double const baseZ = 0.5*( first.z + last.z );
+        double const xAtZMin = baseX + slopeXValue * (hits1.getZMin() - baseZ);
+        double const xAtZMax = baseX + slopeXValue * (hits1.getZMax() - baseZ);
+        double const yAtZMin = baseY + slopeYValue * (hits1.getZMin() - baseZ);
+        double const yAtZMax = baseY + slopeYValue * (hits1.getZMax() - baseZ);
+        double const xLow = std::min(xAtZMin, xAtZMax), xHigh = std::max(xAtZMin, xAtZMax);
+        double const yLow = std::min(yAtZMin, yAtZMax), yHigh = std::max(yAtZMin, yAtZMax);
+
+        //Create triplet residual plots, each axis gets an entry for every plane1 hit
+        //(same arithmetic as triplet::getdx(int) and getdy(int)), the overflow is skipped
+        auto residualX = upstream ? upstreamTripletResidualX : downstreamTripletResidualX;
+        auto residualY = upstream ? upstreamTripletResidualY : downstreamTripletResidualY;
+        double const plotWindow = cutPlotRange + searchMargin;
+        if( fillPlots ) {
+          hits1.queryX(xLow - plotWindow, xHigh + plotWindow, candidates);
+          for( auto k: candidates ) residualX->fill(hits[k].x - baseX - slopeXValue * (hits[k].z - baseZ));
+          hits1.queryY(yLow - plotWindow, yHigh + plotWindow, candidates);
+          for( auto k: candidates ) residualY->fill(hits[k].y - baseY - slopeYValue * (hits[k].z - baseZ));
+        }
+
+        // Only the plane1 hits which can pass the residual cut are left
+        double const window = trip_res_cut + searchMargin;
+        hits1.query(xLow - window, xHigh + window, yLow - window, yHigh + window, candidates);
+      } else {
+        candidates = hits1.getHitIndices();
+      }
 
       double sum_res_old = -1.;
       // get all hit is plane = plane1
-      for( auto& khit: hits ){
-	if( khit.plane != plane1 ) continue; // Middle plane
+      for( auto k: candidates ){
+	auto& khit = hits[k]; // Middle plane
 
 	// Create new preliminary triplet from the three hits:
-	EUTelTripletGBLUtility::triplet new_triplet(ihit,khit,jhit);
+	EUTelTripletGBLUtility::triplet new_triplet(*ihit,khit,*jhit);
 
+    if( !middleInBetween ) {
     //Create triplet slope plots
-    if(upstream == 1){
+    if(fillPlots && upstream == 1){
 		upstreamTripletSlopeX->fill(new_triplet.getdx()*1E3/new_triplet.getdz()); //factor 1E3 to convert from rad to mrad. To be checked
 		upstreamTripletSlopeY->fill(new_triplet.getdy()*1E3/new_triplet.getdz());
-	} else {
+	} else if(fillPlots) {
 		downstreamTripletSlopeX->fill(new_triplet.getdx()*1E3/new_triplet.getdz());
 		downstreamTripletSlopeY->fill(new_triplet.getdy()*1E3/new_triplet.getdz());
 	}
@@ -42,13 +113,14 @@ void EUTelTripletGBLUtility::FindTriplets(std::vector<EUTelTripletGBLUtility::hi
 	if( fabs(new_triplet.getdy()) > slope_cut * new_triplet.getdz()) continue;
     
     //Create triplet residual plots
-    if(upstream == 1){
+    if(fillPlots && upstream == 1){
 		upstreamTripletResidualX->fill(new_triplet.getdx(plane1));
 		upstreamTripletResidualY->fill(new_triplet.getdy(plane1));
-	} else {
+	} else if(fillPlots) {
 		downstreamTripletResidualX->fill(new_triplet.getdx(plane1));
 		downstreamTripletResidualY->fill(new_triplet.getdy(plane1));
 	}
+    }
 	// Setting cuts on the triplet residual on the middle plane
 	if( fabs(new_triplet.getdx(plane1)) > trip_res_cut) continue;
 	if( fabs(new_triplet.getdy(plane1)) > trip_res_cut) continue;
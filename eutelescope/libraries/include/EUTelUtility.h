@@ -13,6 +13,7 @@
 // eutelescope includes ".h"
 #include "EUTELESCOPE.h"
 #include "EUTelClusterDataInterfacer.h"
+#include "EUTelPixelMatrix.h"
 #include "EUTelTrackerDataInterfacerImpl.h"
 #include "EUTelVirtualCluster.h"
 
@@ -177,6 +178,15 @@ namespace eutelescope {
     readNoisyPixelList(LCEvent *event,
                        std::string const &noisyPixelCollectionName);
 
+    //! Reads the hot pixel collection into one pixel mask per sensor
+    /*! Same input as readNoisyPixelList(), but the lookup is a bit probe.
+     *  Each mask only spans the bounding box of the hot pixels of its
+     *  sensor, so no geometry is needed.
+     */
+    EUTelPerSensor<EUTelPixelMask>
+    readNoisyPixelMasks(LCEvent *event,
+                        std::string const &noisyPixelCollectionName);
+
     Eigen::Matrix3d rotationMatrixFromAngles(long double alpha,
                                              long double beta,
                                              long double gamma);
@@ -0,0 +1,104 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELWORKERPOOL_H
+#define EUTELWORKERPOOL_H
+
+// system includes <>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Persistent pool of worker threads for data parallel loops
+  /*! Marlin hands the events one by one to the processors, so the
+   *  parallelism available inside a processor is the one of the event
+   *  itself: independent sensors, clusters or tracks. This pool keeps its
+   *  threads alive for the whole job, so a parallelFor() per event only
+   *  costs a wake-up and not a thread creation.
+   *
+   *  The calling thread takes part in the work as thread index 0, the
+   *  workers have the indices 1 to size()-1. Tasks can use this index to
+   *  pick per-thread scratch space. A pool of size one (or zero) does not
+   *  start any thread and simply runs the loop serially, which is the
+   *  default behaviour of all processors using it.
+   *
+   *  The tasks must not touch shared mutable state: in particular no
+   *  streamlog output, no AIDA histogram filling, no LCIO CellID
+   *  en/decoding with shared coders and no geo::gGeometry() call, since
+   *  the singleton accessor itself is not thread safe. The usual pattern
+   *  is a serial preparation step, a parallelFor() writing into one
+   *  result slot per index and a serial step consuming the results in
+   *  index order, which keeps the output deterministic.
+   *
+   *  \b Usage:
+   *  \code{.cpp}
+   *  EUTelWorkerPool pool(4);
+   *  pool.parallelFor(jobs.size(), [&](size_t i, unsigned thread) { results[i] = work(jobs[i], scratch[thread]); });
+   *  \endcode
+   */
+  class EUTelWorkerPool {
+
+  public:
+    //! Signature of the tasks: loop index and thread index
+    typedef std::function<void(size_t, unsigned)> Task;
+
+    //! Constructor
+    /*! @param nThreads the total number of threads, including the calling
+     *  one. Values smaller than two run everything serially.
+     */
+    explicit EUTelWorkerPool(unsigned nThreads);
+
+    //! Destructor, stops and joins the worker threads
+    ~EUTelWorkerPool();
+
+    //! Total number of threads, including the calling one
+    unsigned size() const { return static_cast<unsigned>(_workers.size()) + 1; }
+
+    //! Run task(i, threadIndex) for all i in [0, n)
+    /*! Blocks until all the indices are processed. If a task throws, the
+     *  remaining indices are skipped and the first exception is rethrown
+     *  in the calling thread.
+     */
+    void parallelFor(size_t n, Task const &task);
+
+  private:
+    EUTelWorkerPool(EUTelWorkerPool const &) = delete;
+    EUTelWorkerPool &operator=(EUTelWorkerPool const &) = delete;
+
+    //! Main loop of the worker threads
+    void workerLoop(unsigned threadIndex);
+
+    //! Process indices until the current loop is exhausted
+    void runTasks(unsigned threadIndex);
+
+    std::vector<std::thread> _workers;
+    std::mutex _mutex;
+    std::condition_variable _startCondition;
+    std::condition_variable _doneCondition;
+
+    //! The loop currently processed
+    Task const *_task;
+    size_t _nTasks;
+    std::atomic<size_t> _nextTask;
+
+    //! Incremented for each new loop, wakes up the workers
+    size_t _generation;
+    //! Number of workers still busy with the current loop
+    unsigned _busyWorkers;
+    bool _stop;
+    std::exception_ptr _error;
+  };
+}
+#endif
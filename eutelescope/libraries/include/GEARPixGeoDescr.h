@@ -36,6 +36,8 @@ namespace eutelescope {
       std::pair<int, int> getPixIndex(char const *);
 
     protected:
+      bool fillPixelBoxes();
+
       TGeoMaterial *matSi;
       TGeoMedium *Si;
       TGeoVolume *plane;
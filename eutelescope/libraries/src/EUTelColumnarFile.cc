@@ -0,0 +1,217 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelColumnarFile.h"
+#include "EUTelExceptions.h"
+
+// lcio includes <.h>
+#include <Exceptions.h>
+
+// system includes <>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using namespace eutelescope;
+
+namespace {
+
+  char const magic[8] = {'E', 'U', 'T', 'C', 'O', 'L', 'S', '1'};
+
+  template <typename T> void writeValue(std::ofstream &file, T value) {
+    file.write(reinterpret_cast<char const *>(&value), sizeof(T));
+  }
+
+  template <typename T> bool readValue(std::ifstream &file, T &value) {
+    return static_cast<bool>(file.read(reinterpret_cast<char *>(&value), sizeof(T)));
+  }
+}
+
+EUTelColumnarWriter::EUTelColumnarWriter(size_t rowGroupSize)
+    : _rowGroupSize(std::max<size_t>(rowGroupSize, 1)), _nBuffered(0), _nRows(0) {}
+
+EUTelColumnarWriter::~EUTelColumnarWriter() {
+  try {
+    close();
+  } catch(...) {
+  }
+}
+
+EUTelColumnarWriter::IntColumn EUTelColumnarWriter::addIntColumn(std::string const &name) {
+  addColumn(name, EUTelColumnType::Int);
+  return IntColumn{_typeIndex.back()};
+}
+
+EUTelColumnarWriter::FloatColumn EUTelColumnarWriter::addFloatColumn(std::string const &name) {
+  addColumn(name, EUTelColumnType::Float);
+  return FloatColumn{_typeIndex.back()};
+}
+
+void EUTelColumnarWriter::addColumn(std::string const &name, EUTelColumnType type) {
+  if(isOpen()) {
+    throw InvalidParameterException("Column " + name + " added to the open columnar file " + _fileName);
+  }
+  if(std::find(_names.begin(), _names.end(), name) != _names.end()) {
+    throw InvalidParameterException("Column " + name + " declared twice");
+  }
+  _names.push_back(name);
+  _types.push_back(type);
+  if(type == EUTelColumnType::Int) {
+    _typeIndex.push_back(_intColumns.size());
+    _intColumns.emplace_back();
+  } else {
+    _typeIndex.push_back(_floatColumns.size());
+    _floatColumns.emplace_back();
+  }
+}
+
+void EUTelColumnarWriter::open(std::string const &fileName) {
+  close();
+  _fileName = fileName;
+  _file.open(fileName, std::ios::binary | std::ios::trunc);
+  if(!_file) {
+    throw lcio::IOException("Unable to create the columnar file " + fileName);
+  }
+
+  _file.write(magic, sizeof(magic));
+  writeValue(_file, static_cast<std::uint32_t>(_names.size()));
+  for(size_t column = 0; column < _names.size(); ++column) {
+    writeValue(_file, static_cast<std::uint8_t>(_types[column]));
+    writeValue(_file, static_cast<std::uint32_t>(_names[column].size()));
+    _file.write(_names[column].data(), static_cast<std::streamsize>(_names[column].size()));
+  }
+
+  for(auto &values : _intColumns) values.assign(_rowGroupSize, 0);
+  for(auto &values : _floatColumns) values.assign(_rowGroupSize, std::numeric_limits<float>::quiet_NaN());
+  _nBuffered = 0;
+  _nRows = 0;
+}
+
+void EUTelColumnarWriter::writeRowGroup() {
+  if(!isOpen()) {
+    throw lcio::IOException("Rows written to a columnar file which is not open");
+  }
+  writeValue(_file, static_cast<std::uint32_t>(_nBuffered));
+  auto const bytes = static_cast<std::streamsize>(_nBuffered * 4);
+  for(size_t column = 0; column < _names.size(); ++column) {
+    if(_types[column] == EUTelColumnType::Int) {
+      auto &values = _intColumns[_typeIndex[column]];
+      _file.write(reinterpret_cast<char const *>(values.data()), bytes);
+      std::fill(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(_nBuffered), 0);
+    } else {
+      auto &values = _floatColumns[_typeIndex[column]];
+      _file.write(reinterpret_cast<char const *>(values.data()), bytes);
+      std::fill(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(_nBuffered),
+                std::numeric_limits<float>::quiet_NaN());
+    }
+  }
+  _nBuffered = 0;
+  if(!_file) {
+    throw lcio::IOException("Unable to write the columnar file " + _fileName);
+  }
+}
+
+void EUTelColumnarWriter::close() {
+  if(!isOpen()) return;
+  if(_nBuffered > 0) writeRowGroup();
+  _file.close();
+  if(!_file) {
+    throw lcio::IOException("Unable to close the columnar file " + _fileName);
+  }
+}
+
+EUTelColumnarReader::EUTelColumnarReader(std::string const &fileName)
+    : _fileName(fileName), _file(fileName, std::ios::binary), _nRows(0) {
+  if(!_file) {
+    throw lcio::IOException("Unable to open the columnar file " + fileName);
+  }
+
+  char header[sizeof(magic)];
+  std::uint32_t nColumns = 0;
+  if(!_file.read(header, sizeof(header)) || std::memcmp(header, magic, sizeof(magic)) != 0 ||
+     !readValue(_file, nColumns)) {
+    throw lcio::IOException(fileName + " is not a columnar file");
+  }
+  for(std::uint32_t column = 0; column < nColumns; ++column) {
+    std::uint8_t type = 0;
+    std::uint32_t length = 0;
+    if(!readValue(_file, type) || !readValue(_file, length) || type > 1) {
+      throw lcio::IOException("Corrupted header in the columnar file " + fileName);
+    }
+    std::string name(length, ' ');
+    if(!_file.read(&name[0], static_cast<std::streamsize>(length))) {
+      throw lcio::IOException("Corrupted header in the columnar file " + fileName);
+    }
+    _names.push_back(name);
+    _types.push_back(static_cast<EUTelColumnType>(type));
+  }
+
+  //only the row group sizes are read, the data is skipped
+  std::streamoff position = _file.tellg();
+  std::streamoff const fileSize = _file.seekg(0, std::ios::end).tellg();
+  _file.seekg(position);
+  for(;;) {
+    std::uint32_t nRows = 0;
+    if(!readValue(_file, nRows)) break;
+    std::streamoff const offset = position + static_cast<std::streamoff>(sizeof(nRows));
+    position = offset + static_cast<std::streamoff>(nRows) * 4 * static_cast<std::streamoff>(nColumns);
+    if(position > fileSize) {
+      throw lcio::IOException("Truncated row group in the columnar file " + fileName);
+    }
+    _rowGroups.push_back(RowGroup{offset, nRows});
+    _nRows += nRows;
+    _file.seekg(position);
+  }
+  _file.clear();
+}
+
+bool EUTelColumnarReader::hasColumn(std::string const &name) const {
+  return std::find(_names.begin(), _names.end(), name) != _names.end();
+}
+
+EUTelColumnType EUTelColumnarReader::getColumnType(std::string const &name) const {
+  auto const column = std::find(_names.begin(), _names.end(), name);
+  if(column == _names.end()) {
+    throw InvalidParameterException("No column " + name + " in the columnar file " + _fileName);
+  }
+  return _types[static_cast<size_t>(column - _names.begin())];
+}
+
+size_t EUTelColumnarReader::findColumn(std::string const &name, EUTelColumnType type) const {
+  if(getColumnType(name) != type) {
+    throw InvalidParameterException("Column " + name + " of the columnar file " + _fileName +
+                                    " read with the wrong type");
+  }
+  return static_cast<size_t>(std::find(_names.begin(), _names.end(), name) - _names.begin());
+}
+
+void EUTelColumnarReader::readColumn(std::string const &name, std::vector<std::int32_t> &values) {
+  size_t const column = findColumn(name, EUTelColumnType::Int);
+  values.resize(_nRows);
+  readBlocks(column, reinterpret_cast<char *>(values.data()));
+}
+
+void EUTelColumnarReader::readColumn(std::string const &name, std::vector<float> &values) {
+  size_t const column = findColumn(name, EUTelColumnType::Float);
+  values.resize(_nRows);
+  readBlocks(column, reinterpret_cast<char *>(values.data()));
+}
+
+void EUTelColumnarReader::readBlocks(size_t column, char *values) {
+  for(auto const &group : _rowGroups) {
+    auto const bytes = static_cast<std::streamoff>(group.nRows) * 4;
+    _file.seekg(group.offset + static_cast<std::streamoff>(column) * bytes);
+    if(!_file.read(values, bytes)) {
+      _file.clear();
+      throw lcio::IOException("Unable to read the columnar file " + _fileName);
+    }
+    values += bytes;
+  }
+}
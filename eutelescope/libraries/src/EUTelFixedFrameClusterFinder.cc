@@ -0,0 +1,113 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelFixedFrameClusterFinder.h"
+#include "EUTelExceptions.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+
+using namespace eutelescope;
+
+EUTelFixedFrameClusterFinder::EUTelFixedFrameClusterFinder(int xNoOfPixel, int yNoOfPixel, int xClusterSize,
+                                                           int yClusterSize, float seedCut, float clusterCut)
+    : _xNoOfPixel(xNoOfPixel), _yNoOfPixel(yNoOfPixel), _xHalfSize(xClusterSize / 2), _yHalfSize(yClusterSize / 2),
+      _seedCut(seedCut), _clusterCut(clusterCut) {
+
+  if(xNoOfPixel <= 0 || yNoOfPixel <= 0) {
+    throw InvalidParameterException("The fixed frame clustering needs a frame with pixels");
+  }
+  if(xClusterSize < 0 || yClusterSize < 0) {
+    throw InvalidParameterException("The fixed frame cluster size can not be negative");
+  }
+
+  //row by row, as the cluster charges are stored
+  for(int dy = -_yHalfSize; dy <= _yHalfSize; ++dy) {
+    for(int dx = -_xHalfSize; dx <= _xHalfSize; ++dx) {
+      _windowX.push_back(dx);
+      _windowY.push_back(dy);
+      _windowOffsets.push_back(static_cast<long>(dy) * _xNoOfPixel + dx);
+    }
+  }
+  _members.resize(_windowOffsets.size());
+}
+
+size_t EUTelFixedFrameClusterFinder::findClusters(float const *charge, float const *noise, short *status,
+                                                  std::vector<Cluster> &clusters) {
+  clusters.clear();
+  _charges.clear();
+  _seeds.clear();
+
+  //one pass over the whole frame for the seed candidates
+  short const good = static_cast<short>(EUTELESCOPE::GOODPIXEL);
+  int const nPixel = static_cast<int>(getNoOfPixels());
+  for(int index = 0; index < nPixel; ++index) {
+    if(status[index] == good && charge[index] > _seedCut * noise[index]) _seeds.emplace_back(charge[index], index);
+  }
+
+  //highest charge first, the highest index first for equal charges
+  std::sort(_seeds.begin(), _seeds.end());
+
+  short const hit = static_cast<short>(EUTELESCOPE::HITPIXEL);
+  size_t const windowSize = _windowOffsets.size();
+  for(auto seed = _seeds.rbegin(); seed != _seeds.rend(); ++seed) {
+    long const centre = seed->second;
+    //already in a higher cluster
+    if(status[centre] != good) continue;
+
+    int const seedX = seed->second % _xNoOfPixel;
+    int const seedY = seed->second / _xNoOfPixel;
+    bool const inside = seedX >= _xHalfSize && seedX < _xNoOfPixel - _xHalfSize && seedY >= _yHalfSize &&
+                        seedY < _yNoOfPixel - _yHalfSize;
+
+    size_t const first = _charges.size();
+    _charges.resize(first + windowSize);
+    double signal = 0.;
+    double noise2 = 0.;
+    ClusterQuality quality = kGoodCluster;
+    for(size_t iPixel = 0; iPixel < windowSize; ++iPixel) {
+      _charges[first + iPixel] = 0.f;
+      _members[iPixel] = -1;
+      //only the seeds close to the edge need the bound check
+      if(!inside) {
+        int const x = seedX + _windowX[iPixel];
+        int const y = seedY + _windowY[iPixel];
+        if(x < 0 || x >= _xNoOfPixel || y < 0 || y >= _yNoOfPixel) {
+          quality = quality | kBorderCluster;
+          continue;
+        }
+      }
+      long const pixel = centre + _windowOffsets[iPixel];
+      short const pixelStatus = status[pixel];
+      if(pixelStatus == good) {
+        double const pixelNoise = noise[pixel];
+        signal += charge[pixel];
+        noise2 += pixelNoise * pixelNoise;
+        _charges[first + iPixel] = charge[pixel];
+        _members[iPixel] = pixel;
+      } else if(pixelStatus == hit) {
+        quality = quality | kIncompleteCluster | kMergedCluster;
+      } else {
+        quality = quality | kIncompleteCluster;
+      }
+    }
+
+    if(signal > _clusterCut * std::sqrt(noise2)) {
+      for(size_t iPixel = 0; iPixel < windowSize; ++iPixel) {
+        if(_members[iPixel] >= 0) status[_members[iPixel]] = hit;
+      }
+      clusters.push_back(Cluster{seedX, seedY, quality, first});
+    } else {
+      _charges.resize(first);
+    }
+  }
+  return clusters.size();
+}
@@ -1,6 +1,14 @@
 #include "EUTelGenericPixGeoDescr.h"
+#include "EUTelExceptions.h"
 #include "EUTelGeometryTelescopeGeoDescription.h"
 
+// ROOT
+#include "TGeoBBox.h"
+
+// STL
+#include <algorithm>
+#include <cmath>
+
 using namespace eutelescope;
 using namespace geo;
 
@@ -10,5 +18,69 @@ EUTelGenericPixGeoDescr::EUTelGenericPixGeoDescr(double sizeX, double sizeY,
                                                  double radLen)
     : _tGeoManager(gGeometry()._geoManager.get()), _sizeSensitiveAreaX(sizeX),
       _sizeSensitiveAreaY(sizeY), _sizeSensitiveAreaZ(sizeZ), _minIndexX(minX),
-      _minIndexY(minY), _maxIndexX(maxX), _maxIndexY(maxY), _radLength(radLen) {
+      _minIndexY(minY), _maxIndexX(maxX), _maxIndexY(maxY), _radLength(radLen), _pixelBoxes() {
+}
+
+void EUTelGenericPixGeoDescr::buildPixelBoxes(std::string const &planePath) {
+  if (hasPixelBoxes())
+    return;
+
+  auto const nX = static_cast<size_t>(_maxIndexX - _minIndexX + 1);
+  auto const nY = static_cast<size_t>(_maxIndexY - _minIndexY + 1);
+  _pixelBoxes.resize(nX * nY);
+  if (fillPixelBoxes())
+    return;
+
+  // Unknown layout: navigate to every pixel, as the geometric clustering
+  // used to do for every hit
+  for (int y = _minIndexY; y <= _maxIndexY; ++y) {
+    for (int x = _minIndexX; x <= _maxIndexX; ++x) {
+      std::string const path = planePath + getPixName(x, y);
+      if (!_tGeoManager->cd(path.c_str())) {
+        _pixelBoxes.clear();
+        throw InvalidGeometryException("No pixel volume at " + path);
+      }
+      auto bbox = dynamic_cast<TGeoBBox *>(
+          _tGeoManager->GetCurrentVolume()->GetShape());
+
+      // Transform the pixel centre up to the sensitive area, the path
+      // starts with the world and the plane volume
+      auto const depth =
+          static_cast<int>(std::count(path.begin(), path.end(), '/')) - 3;
+      double local[3] = {0, 0, 0};
+      double master[3];
+      _tGeoManager->GetCurrentNode()->LocalToMaster(local, master);
+      for (int i = 1; i < depth; ++i) {
+        std::copy(master, master + 3, local);
+        _tGeoManager->GetMother(i)->LocalToMaster(local, master);
+      }
+
+      auto &box = _pixelBoxes[static_cast<size_t>(y - _minIndexY) * nX +
+                              static_cast<size_t>(x - _minIndexX)];
+      box.x = static_cast<float>(master[0]);
+      box.y = static_cast<float>(master[1]);
+      box.halfX = static_cast<float>(bbox->GetDX());
+      box.halfY = static_cast<float>(bbox->GetDY());
+    }
+  }
+}
+
+void EUTelGenericPixGeoDescr::setPixelBlock(int firstX, int lastX, int firstY,
+                                            int lastY, double edgeX,
+                                            double pitchX, double edgeY,
+                                            double pitchY) {
+  auto const nX = static_cast<size_t>(_maxIndexX - _minIndexX + 1);
+  auto const halfX = static_cast<float>(0.5 * std::fabs(pitchX));
+  auto const halfY = static_cast<float>(0.5 * std::fabs(pitchY));
+  for (int y = firstY; y <= lastY; ++y) {
+    auto const posY = static_cast<float>(edgeY + (y - firstY + 0.5) * pitchY);
+    for (int x = firstX; x <= lastX; ++x) {
+      auto &box = _pixelBoxes[static_cast<size_t>(y - _minIndexY) * nX +
+                              static_cast<size_t>(x - _minIndexX)];
+      box.x = static_cast<float>(edgeX + (x - firstX + 0.5) * pitchX);
+      box.y = posY;
+      box.halfX = halfX;
+      box.halfY = halfY;
+    }
+  }
 }
@@ -10,6 +10,7 @@
 #include <cstring>
 #include <cmath>
 #include <sstream>
+#include <utility>
 
 // MARLIN
 #include "marlin/Global.h"
@@ -406,6 +407,9 @@ _trackerPlanesParameters(nullptr),
 _trackerPlanesLayerLayout(nullptr),
 _sensorIDVec(),
 _isGeoInitialized(false),
+_planeCache(),
+_planeCacheIndex(),
+_materialBudgetTable(),
 _geoManager(nullptr)
 {
 	//Set ROOTs verbosity to only display error messages or higher (so info will not be streamed to stderr)
@@ -688,9 +692,48 @@ void EUTelGeometryTelescopeGeoDescription::initializeTGeoDescription( std::strin
     	_geoManager->cd( pathName.c_str() );
 		  _TGeoMatrixMap[sensorID] = _geoManager->GetCurrentNode()->GetMatrix();
 	  } 
+    buildPlaneCache();
     return;
 }
 
+/**
+ * Copy the TGeo placement and the sensor parameters of every plane into a
+ * flat, sensor ID indexed table, so the event loops neither go through the
+ * maps nor through the virtual TGeoMatrix interface.
+ */
+void EUTelGeometryTelescopeGeoDescription::buildPlaneCache() {
+	_planeCache.clear();
+	_planeCacheIndex.clear();
+	for(auto sensorID: _sensorIDVec) {
+		auto matrixIt = _TGeoMatrixMap.find(sensorID);
+		if(sensorID < 0 || matrixIt == _TGeoMatrixMap.end() || matrixIt->second == nullptr) {
+			streamlog_out(WARNING) << "No TGeo placement for sensor " << sensorID << ", it will not be cached" << std::endl;
+			continue;
+		}
+		EUTelPlaneCache plane;
+		plane.sensorID = sensorID;
+		//TGeo stores the rotation row-major
+		double const * rot = matrixIt->second->GetRotationMatrix();
+		double const * tr = matrixIt->second->GetTranslation();
+		for(int i = 0; i < 3; ++i) {
+			for(int j = 0; j < 3; ++j) plane.transform(i, j) = rot[3*i + j];
+			plane.transform(i, 3) = tr[i];
+		}
+		plane.xSize = getPlaneXSize(sensorID);
+		plane.ySize = getPlaneYSize(sensorID);
+		plane.zSize = getPlaneZSize(sensorID);
+		plane.xPitch = getPlaneXPitch(sensorID);
+		plane.yPitch = getPlaneYPitch(sensorID);
+		plane.xResolution = getPlaneXResolution(sensorID);
+		plane.yResolution = getPlaneYResolution(sensorID);
+
+		auto index = static_cast<size_t>(sensorID);
+		if(index >= _planeCacheIndex.size()) _planeCacheIndex.resize(index + 1, -1);
+		_planeCacheIndex[index] = static_cast<int>(_planeCache.size());
+		_planeCache.push_back(plane);
+	}
+}
+
 Eigen::Matrix3d EUTelGeometryTelescopeGeoDescription::rotationMatrixFromAngles(int sensorID) {
 	return Utility::rotationMatrixFromAngles( static_cast<long double>(getPlaneXRotationRadians(sensorID)), 
                                             static_cast<long double>(getPlaneYRotationRadians(sensorID)), 
@@ -719,8 +762,8 @@ Eigen::Matrix3i EUTelGeometryTelescopeGeoDescription::getFlipMatrix(int sensorID
  * @param localPos (x,y,z) in local coordinate system
  * @param globalPos (x,y,z) in global coordinate system
  */
-void EUTelGeometryTelescopeGeoDescription::local2Master( int sensorID, const double localPos[], double globalPos[] ) {
-	_TGeoMatrixMap[sensorID]->LocalToMaster(localPos, globalPos);
+void EUTelGeometryTelescopeGeoDescription::local2Master( int sensorID, const double localPos[], double globalPos[] ) const {
+	local2Master(sensorID, localPos, globalPos, 1);
 }
 
 /**
@@ -731,8 +774,8 @@ void EUTelGeometryTelescopeGeoDescription::local2Master( int sensorID, const dou
  * @param globalPos (x,y,z) in global coordinate system
  * @param localPos (x,y,z) in local coordinate system
  */
-void EUTelGeometryTelescopeGeoDescription::master2Local(int sensorID, const double globalPos[], double localPos[] ) {
-	_TGeoMatrixMap[sensorID]->MasterToLocal(globalPos, localPos);
+void EUTelGeometryTelescopeGeoDescription::master2Local(int sensorID, const double globalPos[], double localPos[] ) const {
+	master2Local(sensorID, globalPos, localPos, 1);
 }
 
 /**
@@ -742,8 +785,8 @@ void EUTelGeometryTelescopeGeoDescription::master2Local(int sensorID, const doub
  * @param globalVec (x,y,z) in global coordinate system
  * @param localVec (x,y,z) in local coordinate system
  */
-void EUTelGeometryTelescopeGeoDescription::local2MasterVec( int sensorID, const double localVec[], double globalVec[] ) {
-	_TGeoMatrixMap[sensorID]->LocalToMasterVect(localVec, globalVec);
+void EUTelGeometryTelescopeGeoDescription::local2MasterVec( int sensorID, const double localVec[], double globalVec[] ) const {
+	local2MasterVec(sensorID, localVec, globalVec, 1);
 }
 
 /**
@@ -753,20 +796,78 @@ void EUTelGeometryTelescopeGeoDescription::local2MasterVec( int sensorID, const
  * @param globalVec (x,y,z) in global coordinate system
  * @param localVec (x,y,z) in local coordinate system
  */
-void EUTelGeometryTelescopeGeoDescription::master2LocalVec( int sensorID, const double globalVec[], double localVec[] ) {
-	_TGeoMatrixMap[sensorID]->MasterToLocalVect(globalVec, localVec);
+void EUTelGeometryTelescopeGeoDescription::master2LocalVec( int sensorID, const double globalVec[], double localVec[] ) const {
+	master2LocalVec(sensorID, globalVec, localVec, 1);
+}
+
+/*
+ * The batched kernels below evaluate the sums in the same order as
+ * TGeoMatrix::LocalToMaster() and friends, so the results are bit-identical
+ * to the former TGeo calls. The coefficients are copied into locals and each
+ * point is read before it is written, which allows in-place transformations.
+ */
+void EUTelGeometryTelescopeGeoDescription::local2Master( int sensorID, const double localPos[], double globalPos[], size_t nPoints ) const {
+	auto const & m = getPlaneCache(sensorID).transform;
+	double const r00 = m(0,0), r01 = m(0,1), r02 = m(0,2), t0 = m(0,3);
+	double const r10 = m(1,0), r11 = m(1,1), r12 = m(1,2), t1 = m(1,3);
+	double const r20 = m(2,0), r21 = m(2,1), r22 = m(2,2), t2 = m(2,3);
+	for(size_t i = 0; i < 3*nPoints; i += 3) {
+		double const x = localPos[i], y = localPos[i+1], z = localPos[i+2];
+		globalPos[i]   = t0 + x*r00 + y*r01 + z*r02;
+		globalPos[i+1] = t1 + x*r10 + y*r11 + z*r12;
+		globalPos[i+2] = t2 + x*r20 + y*r21 + z*r22;
+	}
+}
+
+void EUTelGeometryTelescopeGeoDescription::master2Local( int sensorID, const double globalPos[], double localPos[], size_t nPoints ) const {
+	auto const & m = getPlaneCache(sensorID).transform;
+	double const r00 = m(0,0), r01 = m(0,1), r02 = m(0,2), t0 = m(0,3);
+	double const r10 = m(1,0), r11 = m(1,1), r12 = m(1,2), t1 = m(1,3);
+	double const r20 = m(2,0), r21 = m(2,1), r22 = m(2,2), t2 = m(2,3);
+	for(size_t i = 0; i < 3*nPoints; i += 3) {
+		double const x = globalPos[i] - t0, y = globalPos[i+1] - t1, z = globalPos[i+2] - t2;
+		localPos[i]   = x*r00 + y*r10 + z*r20;
+		localPos[i+1] = x*r01 + y*r11 + z*r21;
+		localPos[i+2] = x*r02 + y*r12 + z*r22;
+	}
 }
 
-void EUTelGeometryTelescopeGeoDescription::local2Master( int sensorID, std::array<double,3> const & localPos, std::array<double,3>& globalPos) {
+void EUTelGeometryTelescopeGeoDescription::local2MasterVec( int sensorID, const double localVec[], double globalVec[], size_t nPoints ) const {
+	auto const & m = getPlaneCache(sensorID).transform;
+	double const r00 = m(0,0), r01 = m(0,1), r02 = m(0,2);
+	double const r10 = m(1,0), r11 = m(1,1), r12 = m(1,2);
+	double const r20 = m(2,0), r21 = m(2,1), r22 = m(2,2);
+	for(size_t i = 0; i < 3*nPoints; i += 3) {
+		double const x = localVec[i], y = localVec[i+1], z = localVec[i+2];
+		globalVec[i]   = x*r00 + y*r01 + z*r02;
+		globalVec[i+1] = x*r10 + y*r11 + z*r12;
+		globalVec[i+2] = x*r20 + y*r21 + z*r22;
+	}
+}
+
+void EUTelGeometryTelescopeGeoDescription::master2LocalVec( int sensorID, const double globalVec[], double localVec[], size_t nPoints ) const {
+	auto const & m = getPlaneCache(sensorID).transform;
+	double const r00 = m(0,0), r01 = m(0,1), r02 = m(0,2);
+	double const r10 = m(1,0), r11 = m(1,1), r12 = m(1,2);
+	double const r20 = m(2,0), r21 = m(2,1), r22 = m(2,2);
+	for(size_t i = 0; i < 3*nPoints; i += 3) {
+		double const x = globalVec[i], y = globalVec[i+1], z = globalVec[i+2];
+		localVec[i]   = x*r00 + y*r10 + z*r20;
+		localVec[i+1] = x*r01 + y*r11 + z*r21;
+		localVec[i+2] = x*r02 + y*r12 + z*r22;
+	}
+}
+
+void EUTelGeometryTelescopeGeoDescription::local2Master( int sensorID, std::array<double,3> const & localPos, std::array<double,3>& globalPos) const {
 	this->local2Master(sensorID, localPos.data(), globalPos.data());
 }
-void EUTelGeometryTelescopeGeoDescription::master2Local(int sensorID, std::array<double,3> const & globalPos, std::array<double,3>& localPos) {
+void EUTelGeometryTelescopeGeoDescription::master2Local(int sensorID, std::array<double,3> const & globalPos, std::array<double,3>& localPos) const {
 	this->master2Local(sensorID, globalPos.data(), localPos.data());
 }
-void EUTelGeometryTelescopeGeoDescription::local2MasterVec( int sensorID, std::array<double,3> const & localVec, std::array<double,3>& globalVec) {
+void EUTelGeometryTelescopeGeoDescription::local2MasterVec( int sensorID, std::array<double,3> const & localVec, std::array<double,3>& globalVec) const {
 	this->local2MasterVec(sensorID, localVec.data(), globalVec.data());
 }
-void EUTelGeometryTelescopeGeoDescription::master2LocalVec( int sensorID, std::array<double,3> const & globalVec, std::array<double,3>& localVec) {
+void EUTelGeometryTelescopeGeoDescription::master2LocalVec( int sensorID, std::array<double,3> const & globalVec, std::array<double,3>& localVec) const {
 	this->master2LocalVec(sensorID, globalVec.data(), localVec.data());
 }
 
@@ -872,6 +973,54 @@ double EUTelGeometryTelescopeGeoDescription::planeRadLengthLocalIncidence(int pl
 	return normRad/scale;
 }
 
+/**
+ * Tabulate x/X0 of every plane and of the gap down to the next plane as a
+ * function of the track slopes, see EUTelMaterialBudgetTable. Each node
+ * is one getRadiationLengthBetweenPoints() call: through the plane along
+ * the node direction with the same safety margin as in
+ * planeRadLengthGlobalIncidence(), and from there to the front of the
+ * next plane along _sensorIDVec.
+ */
+void EUTelGeometryTelescopeGeoDescription::buildMaterialBudgetTable(double maxSlope, unsigned nNodes) {
+	EUTelMaterialBudgetTable table(maxSlope, nNodes);
+
+	//half the path through a plane along a direction, including the margin
+	auto halfPath = [this](int sensorID, Eigen::Vector3d const & direction) {
+		return 0.51*getPlaneZSize(sensorID)/std::abs(direction.dot(getPlaneNormalVector(sensorID)));
+	};
+
+	for(size_t i = 0; i < _sensorIDVec.size(); ++i) {
+		int const sensorID = _sensorIDVec[i];
+		Eigen::Vector3d const position(getPlaneXPosition(sensorID), getPlaneYPosition(sensorID), getPlaneZPosition(sensorID));
+
+		auto sensor = [&](double slopeX, double slopeY) {
+			Eigen::Vector3d const direction = Eigen::Vector3d(slopeX, slopeY, 1.).normalized();
+			double const h = halfPath(sensorID, direction);
+			return getRadiationLengthBetweenPoints(position - h*direction, position + h*direction);
+		};
+
+		EUTelMaterialBudgetTable::RadLengthFunction gap;
+		if(i + 1 < _sensorIDVec.size()) {
+			int const nextID = _sensorIDVec[i + 1];
+			Eigen::Vector3d const nextPosition(getPlaneXPosition(nextID), getPlaneYPosition(nextID), getPlaneZPosition(nextID));
+			Eigen::Vector3d const nextNormal = getPlaneNormalVector(nextID);
+			gap = [&, nextID, nextPosition, nextNormal](double slopeX, double slopeY) {
+				Eigen::Vector3d const direction = Eigen::Vector3d(slopeX, slopeY, 1.).normalized();
+				double const start = halfPath(sensorID, direction);
+				//distance to the centre plane of the next sensor, minus its half thickness
+				double const end = nextNormal.dot(nextPosition - position)/nextNormal.dot(direction) - halfPath(nextID, direction);
+				if(end <= start) return 0.;
+				return getRadiationLengthBetweenPoints(position + start*direction, position + end*direction);
+			};
+		}
+
+		table.addSensor(sensorID, sensor, gap);
+		streamlog_out(DEBUG5) << "Sensor " << sensorID << " x/X0 at normal incidence: " << table.getSensorRadLength(sensorID, 0., 0.)
+		                      << ", gap to the next sensor: " << table.getGapRadLength(sensorID, 0., 0.) << std::endl;
+	}
+	_materialBudgetTable = std::move(table);
+}
+
 void EUTelGeometryTelescopeGeoDescription::updateSiPlanesLayout() {
 	auto siplanesParameters = const_cast<gear::SiPlanesParameters*> (&( _gearManager->getSiPlanesParameters()));
 	auto siplanesLayerLayout = const_cast<gear::SiPlanesLayerLayout*> (&(_siPlanesParameters->getSiPlanesLayerLayout()));
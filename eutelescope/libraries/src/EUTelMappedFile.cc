@@ -0,0 +1,60 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelMappedFile.h"
+
+// lcio includes <.h>
+#include <Exceptions.h>
+
+// system includes <>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace eutelescope;
+
+EUTelMappedFile::EUTelMappedFile(std::string const &fileName)
+    : _fileName(fileName), _data(nullptr), _size(0) {
+  int const fd = ::open(fileName.c_str(), O_RDONLY);
+  if(fd < 0) {
+    throw lcio::IOException("Unable to open " + fileName + ": " + std::strerror(errno));
+  }
+
+  struct stat status;
+  if(::fstat(fd, &status) != 0) {
+    std::string const error = std::strerror(errno);
+    ::close(fd);
+    throw lcio::IOException("Unable to stat " + fileName + ": " + error);
+  }
+  _size = static_cast<size_t>(status.st_size);
+
+  //mmap refuses empty files, there is nothing to map anyway
+  if(_size > 0) {
+    void *const mapped = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(mapped == MAP_FAILED) {
+      std::string const error = std::strerror(errno);
+      ::close(fd);
+      throw lcio::IOException("Unable to map " + fileName + ": " + error);
+    }
+    ::madvise(mapped, _size, MADV_SEQUENTIAL);
+    _data = static_cast<char const *>(mapped);
+  }
+
+  //the mapping stays valid without the descriptor
+  ::close(fd);
+}
+
+EUTelMappedFile::~EUTelMappedFile() {
+  if(_data) ::munmap(const_cast<char *>(_data), _size);
+}
@@ -0,0 +1,85 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelMaterialBudgetTable.h"
+#include "EUTelExceptions.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <utility>
+
+using namespace eutelescope;
+
+namespace {
+  //! Path length through a slab normal to z relative to a normal incidence
+  double pathFactor(double slopeX, double slopeY) {
+    return std::sqrt(1. + slopeX * slopeX + slopeY * slopeY);
+  }
+}
+
+EUTelMaterialBudgetTable::EUTelMaterialBudgetTable()
+    : _maxSlope(0.), _nNodes(0), _sensors() {}
+
+EUTelMaterialBudgetTable::EUTelMaterialBudgetTable(double maxSlope, unsigned nNodes)
+    : _maxSlope(maxSlope), _nNodes(nNodes), _sensors() {
+  if(!(maxSlope > 0.) || nNodes < 2) {
+    throw InvalidParameterException("The material budget table needs a positive slope range and at least two nodes");
+  }
+}
+
+void EUTelMaterialBudgetTable::addSensor(int sensorID, RadLengthFunction const &sensor,
+                                         RadLengthFunction const &gap) {
+  Sensor entry;
+  tabulate(sensor, entry.sensor);
+  tabulate(gap, entry.gap);
+  _sensors.insert(sensorID, std::move(entry));
+}
+
+void EUTelMaterialBudgetTable::tabulate(RadLengthFunction const &radLength,
+                                        std::vector<double> &grid) const {
+  grid.assign(static_cast<size_t>(_nNodes) * _nNodes, 0.);
+  if(!radLength) return;
+  for(unsigned iY = 0; iY < _nNodes; ++iY) {
+    double const slopeY = getNodeSlope(iY);
+    for(unsigned iX = 0; iX < _nNodes; ++iX) {
+      double const slopeX = getNodeSlope(iX);
+      grid[static_cast<size_t>(iY) * _nNodes + iX] = radLength(slopeX, slopeY) / pathFactor(slopeX, slopeY);
+    }
+  }
+}
+
+EUTelMaterialBudgetTable::Sensor const &EUTelMaterialBudgetTable::sensor(int sensorID) const {
+  Sensor const *entry = _sensors.find(sensorID);
+  if(!entry) {
+    throw InvalidGeometryException("No material budget tabulated for sensor ID " + std::to_string(sensorID));
+  }
+  return *entry;
+}
+
+double EUTelMaterialBudgetTable::interpolate(std::vector<double> const &grid,
+                                             double slopeX, double slopeY) const {
+  //position on the grid in units of nodes, clamped to the table
+  double const scale = (_nNodes - 1) / (2. * _maxSlope);
+  double const maxNode = _nNodes - 1;
+  double const u = std::min(std::max((slopeX + _maxSlope) * scale, 0.), maxNode);
+  double const v = std::min(std::max((slopeY + _maxSlope) * scale, 0.), maxNode);
+
+  //lower node of the cell, the last cell for the upper edge
+  auto const iX = std::min(static_cast<unsigned>(u), _nNodes - 2);
+  auto const iY = std::min(static_cast<unsigned>(v), _nNodes - 2);
+  double const fX = u - iX, fY = v - iY;
+
+  double const *node = grid.data() + static_cast<size_t>(iY) * _nNodes + iX;
+  double const lower = node[0] + fX * (node[1] - node[0]);
+  double const upper = node[_nNodes] + fX * (node[_nNodes + 1] - node[_nNodes]);
+  return (lower + fY * (upper - lower)) * pathFactor(slopeX, slopeY);
+}
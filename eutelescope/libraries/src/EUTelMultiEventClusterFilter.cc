@@ -0,0 +1,166 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelMultiEventClusterFilter.h"
+
+// system includes <>
+#include <algorithm>
+
+using namespace eutelescope;
+
+EUTelMultiEventClusterFilter::EUTelMultiEventClusterFilter(unsigned depth, float overlap)
+    : _depth(depth), _overlap(overlap), _frames(depth + 1), _first(0), _nEvents(0),
+      _nShared(), _lastPixel(), _pixelStamp(0), _candidates() {}
+
+void EUTelMultiEventClusterFilter::beginEvent() {
+  if(_nEvents == _frames.size()) {
+    _first = (_first + 1) % _frames.size();
+    --_nEvents;
+  }
+  Frame &current = frame(_nEvents);
+  current.clusters.clear();
+  current.pixels.clear();
+}
+
+void EUTelMultiEventClusterFilter::addCluster(int sensorID, int type, int time) {
+  Frame &current = frame(_nEvents);
+  auto const nPixels = static_cast<std::uint32_t>(current.pixels.size());
+  current.clusters.push_back(Cluster{sensorID, type, time, nPixels, nPixels, true});
+}
+
+void EUTelMultiEventClusterFilter::addPixel(int x, int y, int signal, int time) {
+  Frame &current = frame(_nEvents);
+  current.pixels.push_back(Pixel{x, y, signal, time});
+  current.clusters.back().endPixel = static_cast<std::uint32_t>(current.pixels.size());
+}
+
+bool EUTelMultiEventClusterFilter::endEvent() {
+  Frame &current = frame(_nEvents);
+  if(current.clusters.empty()) return false;
+
+  buildHash(current);
+  ++_nEvents;
+  if(_nEvents < _frames.size()) return false;
+
+  filter();
+  return true;
+}
+
+size_t EUTelMultiEventClusterFilter::bucket(Frame const &frame, int sensorID, int x, int y) {
+  std::uint64_t key = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(sensorID)) << 32) |
+                      (static_cast<std::uint64_t>(static_cast<std::uint16_t>(x)) << 16) |
+                      static_cast<std::uint16_t>(y);
+  //Fibonacci hashing, the top bits are the well mixed ones
+  key *= 0x9E3779B97F4A7C15ull;
+  return key >> frame.hashShift;
+}
+
+void EUTelMultiEventClusterFilter::buildHash(Frame &frame) {
+  size_t const nPixels = frame.pixels.size();
+
+  //at least twice as many buckets as pixels, a power of two
+  unsigned bits = 4;
+  while((size_t(1) << bits) < 2 * nPixels) ++bits;
+  frame.hashShift = 64 - bits;
+  size_t const nBuckets = size_t(1) << bits;
+
+  frame.pixelCluster.resize(nPixels);
+  for(size_t iCluster = 0; iCluster < frame.clusters.size(); ++iCluster) {
+    Cluster const &cluster = frame.clusters[iCluster];
+    for(std::uint32_t iPixel = cluster.firstPixel; iPixel < cluster.endPixel; ++iPixel) {
+      frame.pixelCluster[iPixel] = static_cast<std::uint32_t>(iCluster);
+    }
+  }
+
+  //counting sort of the pixels into the buckets
+  frame.bucketStart.assign(nBuckets + 1, 0);
+  for(size_t iPixel = 0; iPixel < nPixels; ++iPixel) {
+    Pixel const &pixel = frame.pixels[iPixel];
+    int const sensorID = frame.clusters[frame.pixelCluster[iPixel]].sensorID;
+    ++frame.bucketStart[bucket(frame, sensorID, pixel.x, pixel.y) + 1];
+  }
+  for(size_t iBucket = 0; iBucket < nBuckets; ++iBucket) {
+    frame.bucketStart[iBucket + 1] += frame.bucketStart[iBucket];
+  }
+  frame.bucketPixels.resize(nPixels);
+  //fill back to front, the end of each bucket moving down to its start,
+  //which keeps the pixels of a bucket in ascending order
+  for(size_t iPixel = nPixels; iPixel-- > 0;) {
+    Pixel const &pixel = frame.pixels[iPixel];
+    int const sensorID = frame.clusters[frame.pixelCluster[iPixel]].sensorID;
+    size_t const iBucket = bucket(frame, sensorID, pixel.x, pixel.y);
+    frame.bucketPixels[--frame.bucketStart[iBucket + 1]] = static_cast<std::uint32_t>(iPixel);
+  }
+  //bucketStart[i + 1] now holds the start of bucket i
+  for(size_t iBucket = 0; iBucket < nBuckets; ++iBucket) {
+    frame.bucketStart[iBucket] = frame.bucketStart[iBucket + 1];
+  }
+  frame.bucketStart[nBuckets] = static_cast<std::uint32_t>(nPixels);
+}
+
+void EUTelMultiEventClusterFilter::filter() {
+  Frame const &oldestFrame = frame(0);
+  for(auto const &cluster : oldestFrame.clusters) {
+    if(!cluster.kept) continue;
+    for(size_t age = 1; age <= _depth; ++age) {
+      if(!removeMatches(oldestFrame, cluster, frame(age))) break;
+    }
+  }
+}
+
+bool EUTelMultiEventClusterFilter::removeMatches(Frame const &oldestFrame,
+                                                 Cluster const &cluster, Frame &frame) {
+  if(_nShared.size() < frame.clusters.size()) {
+    _nShared.resize(frame.clusters.size(), 0);
+    _lastPixel.resize(frame.clusters.size(), 0);
+  }
+
+  //count, for each cluster of the frame, the pixels of the cluster it contains
+  _candidates.clear();
+  for(std::uint32_t iPixel = cluster.firstPixel; iPixel < cluster.endPixel; ++iPixel) {
+    Pixel const &pixel = oldestFrame.pixels[iPixel];
+    ++_pixelStamp;
+    size_t const iBucket = bucket(frame, cluster.sensorID, pixel.x, pixel.y);
+    for(std::uint32_t k = frame.bucketStart[iBucket]; k < frame.bucketStart[iBucket + 1]; ++k) {
+      std::uint32_t const jPixel = frame.bucketPixels[k];
+      Pixel const &other = frame.pixels[jPixel];
+      if(other.x != pixel.x || other.y != pixel.y) continue;
+      std::uint32_t const jCluster = frame.pixelCluster[jPixel];
+      Cluster const &candidate = frame.clusters[jCluster];
+      if(!candidate.kept || candidate.sensorID != cluster.sensorID || candidate.type != cluster.type) continue;
+      if(_lastPixel[jCluster] == _pixelStamp) continue;
+      _lastPixel[jCluster] = _pixelStamp;
+      if(_nShared[jCluster]++ == 0) _candidates.push_back(jCluster);
+    }
+  }
+
+  //same order as a scan of the frame, for the "skip after a removal" rule
+  std::sort(_candidates.begin(), _candidates.end());
+
+  float const size = static_cast<float>(cluster.endPixel - cluster.firstPixel);
+  bool removed = false;
+  size_t skipped = frame.clusters.size();
+  for(auto const jCluster : _candidates) {
+    auto const nShared = static_cast<float>(_nShared[jCluster]);
+    _nShared[jCluster] = 0;
+    if(jCluster == skipped) continue;
+
+    Cluster &candidate = frame.clusters[jCluster];
+    float const candidateSize = static_cast<float>(candidate.endPixel - candidate.firstPixel);
+    if(nShared > size * _overlap || nShared > candidateSize * _overlap) {
+      candidate.kept = false;
+      removed = true;
+      //the next remaining cluster is the one the original loop stepped over
+      skipped = jCluster + 1;
+      while(skipped < frame.clusters.size() && !frame.clusters[skipped].kept) ++skipped;
+    }
+  }
+  return removed;
+}
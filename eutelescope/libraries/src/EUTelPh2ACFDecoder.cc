@@ -0,0 +1,130 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelPh2ACFDecoder.h"
+
+// system includes <>
+#include <algorithm>
+#include <cstdint>
+
+using namespace eutelescope;
+
+namespace {
+  size_t const header1Words = 5;
+  size_t const header2Words = 1;
+  size_t const chipWords = 11;
+  std::uint32_t const fileHeaderMarker = 0xAAAAAAAA;
+
+  //! Set out[i] to one for every set bit i of the word, returns the number of bits
+  size_t scatterBits(std::uint32_t word, float *out) {
+    size_t const nBits = static_cast<size_t>(__builtin_popcount(word));
+    while(word) {
+      out[__builtin_ctz(word)] = 1.f;
+      word &= word - 1;
+    }
+    return nBits;
+  }
+
+  //! The strips of a sensor from its four words, out has to be zeroed
+  /*! The chip sends its strips from the last word backwards, the most
+   *  significant bit of the last word is not a strip.
+   */
+  size_t fillStrips(std::uint32_t const *words, float *out) {
+    return scatterBits(words[3] & 0x7FFFFFFF, out) + scatterBits(words[2], out + 31) +
+           scatterBits(words[1], out + 63) + scatterBits(words[0], out + 95);
+  }
+
+  char byte(std::uint32_t word, unsigned shift) {
+    return static_cast<char>((word >> shift) & 0xFF);
+  }
+}
+
+size_t const EUTelPh2ACFDecoder::fileHeaderWords;
+size_t const EUTelPh2ACFDecoder::stripsPerChip;
+
+EUTelPh2ACFDecoder::EUTelPh2ACFDecoder(int nFrontEnds, int nChips)
+    : _nFrontEnds(std::max(nFrontEnds, 0)), _nChips(std::max(nChips, 0)) {}
+
+size_t EUTelPh2ACFDecoder::getEventWords() const {
+  return header1Words + static_cast<size_t>(_nFrontEnds) * (header2Words + chipWords * static_cast<size_t>(_nChips));
+}
+
+bool EUTelPh2ACFDecoder::decodeFileHeader(std::uint32_t const *words, FileHeader &header) {
+  static size_t const markers[] = {0, 3, 6, 9, 11};
+  for(size_t const marker : markers) {
+    if(words[marker] != fileHeaderMarker) return false;
+  }
+
+  //the board type is up to eight characters, zero padded
+  char const type[9] = {byte(words[1], 24), byte(words[1], 16), byte(words[1], 8), byte(words[1], 0),
+                        byte(words[2], 24), byte(words[2], 16), byte(words[2], 8), byte(words[2], 0), 0};
+  header.boardType = type;
+  header.versionMajor = words[4];
+  header.versionMinor = words[5];
+  header.beId = words[7] & 0x000003FF;
+  header.nCbc = words[8];
+  header.eventSize32 = words[10];
+  return true;
+}
+
+void EUTelPh2ACFDecoder::decodeEvent(std::uint32_t const *words, Event &event) const {
+  event.header1Size = words[0] >> 24;
+  event.feNbr = (words[0] >> 16) & 0xFF;
+  event.blockSize = ((words[0] >> 8) & 0xFF) + (words[0] & 0xFF);
+  event.cicId = words[1] >> 24;
+  event.chipId = (words[1] >> 16) & 0xFF;
+  event.dataFormatVer = (words[1] >> 8) & 0xFF;
+  event.dummySize = words[1] & 0xFF;
+  event.trigdataSize = words[2] >> 24;
+  event.eventNbr = ((words[2] >> 16) & 0xFF) + ((words[2] >> 8) & 0xFF) + (words[2] & 0xFF);
+  event.bxCnt = words[3];
+  event.stubdataSize = words[4] >> 24;
+  event.tluTriggerId = ((words[4] >> 16) & 0xFF) + ((words[4] >> 8) & 0xFF);
+  event.tdc = words[4] & 0xFF;
+
+  size_t const nFrontEnds = static_cast<size_t>(_nFrontEnds);
+  size_t const nChips = static_cast<size_t>(_nChips);
+  event.frontEnds.resize(nFrontEnds);
+  event.chips.resize(nFrontEnds * nChips);
+  event.top.assign(nFrontEnds * nChips * stripsPerChip, 0.f);
+  event.bottom.assign(nFrontEnds * nChips * stripsPerChip, 0.f);
+  event.topHits = event.bottomHits = 0;
+
+  std::uint32_t const *word = words + header1Words;
+  for(size_t iFE = 0; iFE < nFrontEnds; ++iFE) {
+    FrontEnd &frontEnd = event.frontEnds[iFE];
+    frontEnd.chipDataMask = word[0] >> 24;
+    frontEnd.header2Size = (word[0] >> 16) & 0xFF;
+    frontEnd.eventSize = ((word[0] >> 8) & 0xFF) + (word[0] & 0xFF);
+    word += header2Words;
+
+    for(size_t iChip = 0; iChip < nChips; ++iChip, word += chipWords) {
+      size_t const index = iFE * nChips + iChip;
+      event.topHits += fillStrips(word, &event.top[index * stripsPerChip]);
+      event.bottomHits += fillStrips(word + 4, &event.bottom[index * stripsPerChip]);
+
+      //FIXME: the status bits are extracted as by the original converter,
+      //latErr and bufOvf always come out zero this way
+      Chip &chip = event.chips[index];
+      chip.latErr = (word[8] & 1) >> 1;
+      chip.bufOvf = (word[8] & 2) >> 2;
+      chip.pipeAddr = (word[8] >> 4) & 0x09;
+      chip.l1Cnt = (word[8] >> 16) & 0xFE;
+      chip.stub1 = word[9] & 0xFF;
+      chip.stub2 = (word[9] >> 8) & 0xFF;
+      chip.stub3 = (word[9] >> 16) & 0xFF;
+      chip.sync = (word[10] >> 3) & 1;
+      chip.or254 = (word[10] >> 1) & 1;
+      chip.bend1 = (word[10] >> 8) & 0xF;
+      chip.bend2 = (word[10] >> 16) & 0xF;
+      chip.bend3 = (word[10] >> 24) & 0xF;
+    }
+  }
+}
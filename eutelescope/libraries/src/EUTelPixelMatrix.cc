@@ -0,0 +1,42 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelPixelMatrix.h"
+
+// system includes <>
+#include <algorithm>
+
+using namespace eutelescope;
+
+EUTelPixelRange::EUTelPixelRange(int minX, int maxX, int minY, int maxY)
+    : _minX(minX), _minY(minY),
+      _sizeX(maxX < minX ? 0 : static_cast<unsigned>(maxX - minX) + 1),
+      _sizeY(maxY < minY ? 0 : static_cast<unsigned>(maxY - minY) + 1) {}
+
+EUTelPixelMask::EUTelPixelMask(EUTelPixelRange const &range)
+    : _range(range), _words((range.size() + 63) / 64, 0), _count(0) {}
+
+bool EUTelPixelMask::set(int x, int y) {
+  if(!_range.contains(x, y)) return false;
+  size_t const i = _range.index(x, y);
+  std::uint64_t const bit = std::uint64_t(1) << (i & 63);
+  if(!(_words[i >> 6] & bit)) {
+    _words[i >> 6] |= bit;
+    ++_count;
+  }
+  return true;
+}
+
+EUTelPixelCounter::EUTelPixelCounter(EUTelPixelRange const &range)
+    : _range(range), _counts(range.size(), 0) {}
+
+void EUTelPixelCounter::reset() {
+  std::fill(_counts.begin(), _counts.end(), 0);
+}
@@ -0,0 +1,105 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelPointGrid.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+
+using namespace eutelescope;
+
+EUTelPointGrid::EUTelPointGrid()
+    : _x(), _y(), _xMin(0.), _yMin(0.), _invCellSize(0.), _nX(1), _nY(1),
+      _cellStart(), _cellPoints() {}
+
+void EUTelPointGrid::build(std::vector<double> const &x,
+                           std::vector<double> const &y, double cellSize) {
+  _x = x;
+  _y = y;
+  size_t const nPoints = _x.size();
+
+  _xMin = 0.;
+  _yMin = 0.;
+  double xMax = 0., yMax = 0.;
+  if(nPoints > 0) {
+    auto xRange = std::minmax_element(_x.begin(), _x.end());
+    auto yRange = std::minmax_element(_y.begin(), _y.end());
+    _xMin = *xRange.first;
+    xMax = *xRange.second;
+    _yMin = *yRange.first;
+    yMax = *yRange.second;
+  }
+
+  //a single cell if the binning makes no sense, otherwise coarsen the grid
+  //until it has at most a few cells per point
+  _nX = 1;
+  _nY = 1;
+  _invCellSize = 0.;
+  if(cellSize > 0. && std::isfinite(xMax - _xMin) && std::isfinite(yMax - _yMin)) {
+    double const maxCells = 4. * static_cast<double>(nPoints) + 16.;
+    while((std::floor((xMax - _xMin) / cellSize) + 1.) *
+              (std::floor((yMax - _yMin) / cellSize) + 1.) > maxCells) {
+      cellSize *= 2.;
+    }
+    _invCellSize = 1. / cellSize;
+    _nX = static_cast<long>(std::floor((xMax - _xMin) * _invCellSize)) + 1;
+    _nY = static_cast<long>(std::floor((yMax - _yMin) * _invCellSize)) + 1;
+  }
+
+  //counting sort of the points into the cells, stable in the point index
+  auto const nCells = static_cast<size_t>(_nX * _nY);
+  _cellStart.assign(nCells + 1, 0);
+  std::vector<size_t> pointCell(nPoints);
+  for(size_t i = 0; i < nPoints; ++i) {
+    pointCell[i] = static_cast<size_t>(cellY(_y[i]) * _nX + cellX(_x[i]));
+    ++_cellStart[pointCell[i] + 1];
+  }
+  for(size_t cell = 0; cell < nCells; ++cell) _cellStart[cell + 1] += _cellStart[cell];
+  _cellPoints.resize(nPoints);
+  std::vector<size_t> fill(_cellStart.begin(), _cellStart.end() - 1);
+  for(size_t i = 0; i < nPoints; ++i) _cellPoints[fill[pointCell[i]]++] = i;
+}
+
+long EUTelPointGrid::cellX(double x) const {
+  double cell = (x - _xMin) * _invCellSize;
+  if(!(cell > 0.)) return 0;
+  if(cell >= static_cast<double>(_nX - 1)) return _nX - 1;
+  return static_cast<long>(cell);
+}
+
+long EUTelPointGrid::cellY(double y) const {
+  double cell = (y - _yMin) * _invCellSize;
+  if(!(cell > 0.)) return 0;
+  if(cell >= static_cast<double>(_nY - 1)) return _nY - 1;
+  return static_cast<long>(cell);
+}
+
+void EUTelPointGrid::query(double xMin, double xMax, double yMin, double yMax,
+                           std::vector<size_t> &result) const {
+  result.clear();
+  if(_x.empty() || !(xMin <= xMax) || !(yMin <= yMax)) return;
+
+  long const firstX = cellX(xMin), lastX = cellX(xMax);
+  long const firstY = cellY(yMin), lastY = cellY(yMax);
+  for(long iY = firstY; iY <= lastY; ++iY) {
+    for(long iX = firstX; iX <= lastX; ++iX) {
+      auto const cell = static_cast<size_t>(iY * _nX + iX);
+      for(size_t k = _cellStart[cell]; k < _cellStart[cell + 1]; ++k) {
+        size_t const i = _cellPoints[k];
+        if(_x[i] >= xMin && _x[i] <= xMax && _y[i] >= yMin && _y[i] <= yMax) {
+          result.push_back(i);
+        }
+      }
+    }
+  }
+  //the cells are visited row by row, restore the input order
+  std::sort(result.begin(), result.end());
+}
@@ -0,0 +1,95 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelRunningPedestalNoise.h"
+#include "EUTelExceptions.h"
+
+// system includes <>
+#include <cmath>
+#include <string>
+
+using namespace eutelescope;
+
+void EUTelRunningPedestalNoise::Moments::reset(size_t nChannels) {
+  count.assign(nChannels, 0);
+  mean.assign(nChannels, 0.);
+  m2.assign(nChannels, 0.);
+}
+
+EUTelRunningPedestalNoise::EUTelRunningPedestalNoise(size_t nChannels, unsigned rejectionIterations,
+                                                     float rejectionCut, size_t maxStoredEvents)
+    : _nChannels(nChannels), _rejectionIterations(rejectionIterations), _rejectionCut(rejectionCut),
+      _maxStoredEvents(maxStoredEvents), _nEvents(0), _moments(), _stored(),
+      _pedestal(nChannels, 0.f), _noise(nChannels, 0.f), _entries(nChannels, 0) {
+  _moments.reset(nChannels);
+}
+
+void EUTelRunningPedestalNoise::addEvent(float const *signals) {
+  for(size_t channel = 0; channel < _nChannels; ++channel) {
+    _moments.add(channel, signals[channel]);
+  }
+  if(_rejectionIterations > 0 && (_maxStoredEvents == 0 || _nEvents < _maxStoredEvents)) {
+    _stored.insert(_stored.end(), signals, signals + _nChannels);
+  }
+  ++_nEvents;
+}
+
+void EUTelRunningPedestalNoise::addEvent(std::vector<float> const &signals) {
+  if(signals.size() != _nChannels) {
+    throw InvalidParameterException("Pedestal and noise estimation for " + std::to_string(_nChannels) +
+                                    " channels got an event with " + std::to_string(signals.size()) + " signals");
+  }
+  addEvent(signals.data());
+}
+
+void EUTelRunningPedestalNoise::setResults(Moments const &moments) {
+  for(size_t channel = 0; channel < _nChannels; ++channel) {
+    std::uint32_t const count = moments.count[channel];
+    _entries[channel] = count;
+    _pedestal[channel] = static_cast<float>(moments.mean[channel]);
+    _noise[channel] = count > 1 ? static_cast<float>(std::sqrt(moments.m2[channel] / (count - 1))) : 0.f;
+  }
+}
+
+void EUTelRunningPedestalNoise::compute() {
+  setResults(_moments);
+  if(_rejectionIterations == 0 || _stored.empty()) return;
+
+  //start from the stored sample only, the window has to match the signals it is applied to
+  size_t const nStored = _stored.size() / _nChannels;
+  Moments moments;
+  moments.reset(_nChannels);
+  for(size_t event = 0; event < nStored; ++event) {
+    float const *signals = &_stored[event * _nChannels];
+    for(size_t channel = 0; channel < _nChannels; ++channel) moments.add(channel, signals[channel]);
+  }
+  setResults(moments);
+
+  std::vector<float> low(_nChannels), high(_nChannels);
+  for(unsigned iteration = 0; iteration < _rejectionIterations; ++iteration) {
+    for(size_t channel = 0; channel < _nChannels; ++channel) {
+      low[channel] = _pedestal[channel] - _rejectionCut * _noise[channel];
+      high[channel] = _pedestal[channel] + _rejectionCut * _noise[channel];
+    }
+
+    moments.reset(_nChannels);
+    for(size_t event = 0; event < nStored; ++event) {
+      float const *signals = &_stored[event * _nChannels];
+      for(size_t channel = 0; channel < _nChannels; ++channel) {
+        float const signal = signals[channel];
+        if(signal >= low[channel] && signal <= high[channel]) moments.add(channel, signal);
+      }
+    }
+
+    bool const converged = moments.count == _entries;
+    setResults(moments);
+    if(converged) break;
+  }
+}
@@ -0,0 +1,125 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelSparseClusterFinder.h"
+
+// system includes <>
+#include <algorithm>
+
+using namespace eutelescope;
+
+EUTelSparseClusterFinder::EUTelSparseClusterFinder(int minX, int maxX, int minY,
+                                                   int maxY, int minDistanceSquared)
+    : _minX(0), _maxX(-1), _minY(0), _maxY(-1), _nX(0), _window(), _cellHead(),
+      _cellNext(), _x(), _y(), _assigned(), _clusterPixels(), _clusterOffsets(),
+      _neighbours() {
+
+  //a negative cut does not even cluster pixels with identical indices
+  if(minDistanceSquared >= 0) {
+    int radius = 0;
+    while((radius + 1) * (radius + 1) <= minDistanceSquared) ++radius;
+    for(int dY = -radius; dY <= radius; ++dY) {
+      for(int dX = -radius; dX <= radius; ++dX) {
+        if(dX * dX + dY * dY <= minDistanceSquared) _window.emplace_back(dX, dY);
+      }
+    }
+  }
+  resizeGrid(minX, maxX, minY, maxY);
+}
+
+void EUTelSparseClusterFinder::resizeGrid(int minX, int maxX, int minY, int maxY) {
+  _minX = minX;
+  _maxX = maxX;
+  _minY = minY;
+  _maxY = maxY;
+  _nX = (maxX >= minX) ? static_cast<long>(maxX - minX + 1) : 0;
+  long nY = (maxY >= minY) ? static_cast<long>(maxY - minY + 1) : 0;
+  _cellHead.assign(static_cast<size_t>(_nX * nY), -1);
+}
+
+void EUTelSparseClusterFinder::clear() {
+  _x.clear();
+  _y.clear();
+  _clusterPixels.clear();
+  _clusterOffsets.clear();
+}
+
+void EUTelSparseClusterFinder::reserve(size_t n) {
+  _x.reserve(n);
+  _y.reserve(n);
+  _cellNext.reserve(n);
+  _assigned.reserve(n);
+  _clusterPixels.reserve(n);
+}
+
+void EUTelSparseClusterFinder::addPixel(int x, int y) {
+  _x.push_back(x);
+  _y.push_back(y);
+}
+
+size_t EUTelSparseClusterFinder::findClusters() {
+
+  size_t const nPixels = _x.size();
+  _clusterPixels.clear();
+  _clusterOffsets.assign(1, 0);
+  if(nPixels == 0) return 0;
+
+  //enlarge the grid if some pixel falls outside the sensor index range
+  auto xRange = std::minmax_element(_x.begin(), _x.end());
+  auto yRange = std::minmax_element(_y.begin(), _y.end());
+  if(*xRange.first < _minX || *xRange.second > _maxX ||
+     *yRange.first < _minY || *yRange.second > _maxY) {
+    resizeGrid(std::min(*xRange.first, _minX), std::max(*xRange.second, _maxX),
+               std::min(*yRange.first, _minY), std::max(*yRange.second, _maxY));
+  }
+
+  //bucket the pixels, filling backwards keeps each cell list in input order
+  _cellNext.assign(nPixels, -1);
+  for(size_t iPixel = nPixels; iPixel-- > 0;) {
+    auto cell = static_cast<size_t>(cellIndex(_x[iPixel], _y[iPixel]));
+    _cellNext[iPixel] = _cellHead[cell];
+    _cellHead[cell] = static_cast<long>(iPixel);
+  }
+
+  //breadth first flood fill, _clusterPixels itself serves as queue
+  _assigned.assign(nPixels, 0);
+  for(size_t seed = 0; seed < nPixels; ++seed) {
+    if(_assigned[seed]) continue;
+    _assigned[seed] = 1;
+    _clusterPixels.push_back(seed);
+
+    for(size_t front = _clusterOffsets.back(); front < _clusterPixels.size(); ++front) {
+      size_t const current = _clusterPixels[front];
+      _neighbours.clear();
+      for(auto& offset: _window) {
+        long cell = cellIndex(_x[current] + offset.first, _y[current] + offset.second);
+        if(cell < 0) continue;
+        for(long iPixel = _cellHead[static_cast<size_t>(cell)]; iPixel != -1;
+            iPixel = _cellNext[static_cast<size_t>(iPixel)]) {
+          auto candidate = static_cast<size_t>(iPixel);
+          if(!_assigned[candidate]) {
+            _assigned[candidate] = 1;
+            _neighbours.push_back(candidate);
+          }
+        }
+      }
+      //the neighbours are appended in input order, as the old algorithm did
+      std::sort(_neighbours.begin(), _neighbours.end());
+      _clusterPixels.insert(_clusterPixels.end(), _neighbours.begin(), _neighbours.end());
+    }
+    _clusterOffsets.push_back(_clusterPixels.size());
+  }
+
+  //only reset the touched cells so the grid can be reused without a full wipe
+  for(size_t iPixel = 0; iPixel < nPixels; ++iPixel) {
+    _cellHead[static_cast<size_t>(cellIndex(_x[iPixel], _y[iPixel]))] = -1;
+  }
+  return getNumberOfClusters();
+}
@@ -0,0 +1,172 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelStripClusterFinder.h"
+#include "EUTelExceptions.h"
+
+// system includes <>
+#include <algorithm>
+#include <limits>
+#include <string>
+
+using namespace eutelescope;
+
+namespace {
+
+  //! Running sums over the strips of a (part of a) cluster
+  struct Sums {
+    double charge, noise, weightedStrip;
+
+    void add(double signal, double noise_, int strip) {
+      charge += signal;
+      noise += noise_;
+      weightedStrip += signal * strip;
+    }
+
+    void add(Sums const &other) {
+      charge += other.charge;
+      noise += other.noise;
+      weightedStrip += other.weightedStrip;
+    }
+  };
+}
+
+EUTelStripClusterFinder::EUTelStripClusterFinder(size_t nStrips, float seedCut, float neighbourCut, int polarity)
+    : _seedCut(seedCut), _neighbourCut(neighbourCut), _polarity(static_cast<float>(polarity)), _splitSeeds(true),
+      _noise(nStrips, 1.f), _masked(nStrips, 0), _neighbourLevel(nStrips), _seedLevel(nStrips),
+      _inverseNoise(nStrips), _seedAllowed(nStrips) {
+  updateLevels();
+}
+
+void EUTelStripClusterFinder::setNoise(float const *noise) {
+  std::copy(noise, noise + _noise.size(), _noise.begin());
+  updateLevels();
+}
+
+void EUTelStripClusterFinder::setNoise(std::vector<float> const &noise) {
+  if(noise.size() != _noise.size()) {
+    throw InvalidParameterException("Strip clustering for " + std::to_string(_noise.size()) + " strips got " +
+                                    std::to_string(noise.size()) + " noise values");
+  }
+  setNoise(noise.data());
+}
+
+void EUTelStripClusterFinder::setMasked(size_t strip, bool masked) {
+  _masked[strip] = masked ? 1 : 0;
+  //only the strip and its neighbours are affected, so masking all the strips one by one stays linear
+  _neighbourLevel[strip] = masked ? std::numeric_limits<float>::infinity() : _neighbourCut * _noise[strip];
+  size_t const last = std::min(strip + 1, _noise.size() - 1);
+  for(size_t neighbour = strip > 0 ? strip - 1 : 0; neighbour <= last; ++neighbour) updateSeedAllowed(neighbour);
+}
+
+void EUTelStripClusterFinder::updateLevels() {
+  size_t const nStrips = _noise.size();
+  float const never = std::numeric_limits<float>::infinity();
+  for(size_t strip = 0; strip < nStrips; ++strip) {
+    float const noise = _noise[strip];
+    _neighbourLevel[strip] = _masked[strip] ? never : _neighbourCut * noise;
+    _seedLevel[strip] = _seedCut * noise;
+    //a strip without noise can not be compared by its signal to noise ratio, its signal is used instead
+    _inverseNoise[strip] = noise > 0.f ? 1.f / noise : 1.f;
+    updateSeedAllowed(strip);
+  }
+}
+
+void EUTelStripClusterFinder::updateSeedAllowed(size_t strip) {
+  //strips outside the sensor do not prevent a seed
+  _seedAllowed[strip] = !_masked[strip] && (strip == 0 || !_masked[strip - 1]) &&
+                        (strip + 1 == _noise.size() || !_masked[strip + 1]);
+}
+
+size_t EUTelStripClusterFinder::findClusters(float const *signal, std::vector<Cluster> &clusters) const {
+  clusters.clear();
+  int const nStrips = static_cast<int>(_noise.size());
+
+  //the cluster being built: [start, seed] in head, the strips after the seed in tail
+  int start = -1, seed = -1;
+  float seedRatio = 0.f;
+  Sums head = {0., 0., 0.}, tail = {0., 0., 0.};
+
+  for(int strip = 0; strip <= nStrips; ++strip) {
+    float const value = strip < nStrips ? _polarity * signal[strip] : 0.f;
+    if(strip == nStrips || !(value >= _neighbourLevel[strip])) {
+      //end of a run, kept only if it has a seed
+      if(seed >= 0) {
+        head.add(tail);
+        addCluster(signal, start, strip - 1, seed, head.charge, head.noise, head.weightedStrip, clusters);
+      }
+      start = seed = -1;
+      continue;
+    }
+
+    if(start < 0) {
+      start = strip;
+      head = tail = {0., 0., 0.};
+    }
+
+    double const noise = _noise[strip];
+    if(value >= _seedLevel[strip] && _seedAllowed[strip]) {
+      float const ratio = value * _inverseNoise[strip];
+      if(seed < 0) {
+        seed = strip;
+        seedRatio = ratio;
+        head.add(value, noise, strip);
+        continue;
+      }
+      if(ratio > seedRatio) {
+        if(_splitSeeds && strip > seed + 1) {
+          //the strips between the seeds go to the higher one
+          addCluster(signal, start, seed, seed, head.charge, head.noise, head.weightedStrip, clusters);
+          start = seed + 1;
+          head = tail;
+        } else {
+          head.add(tail);
+        }
+        tail = {0., 0., 0.};
+        seed = strip;
+        seedRatio = ratio;
+        head.add(value, noise, strip);
+        continue;
+      }
+    }
+
+    if(seed < 0) {
+      head.add(value, noise, strip);
+    } else {
+      tail.add(value, noise, strip);
+    }
+  }
+  return clusters.size();
+}
+
+void EUTelStripClusterFinder::addCluster(float const *signal, int first, int last, int seed, double charge,
+                                         double noise, double weightedStrip, std::vector<Cluster> &clusters) const {
+  Cluster cluster;
+  cluster.firstStrip = first;
+  cluster.lastStrip = last;
+  cluster.seedStrip = seed;
+  cluster.charge = charge;
+  cluster.noise = noise;
+  cluster.cog = charge != 0. ? weightedStrip / charge : static_cast<double>(seed);
+
+  cluster.eta = -1.;
+  int const nStrips = static_cast<int>(_noise.size());
+  if(seed > 0 && seed + 1 < nStrips && !_masked[seed - 1] && !_masked[seed + 1]) {
+    double const left = _polarity * signal[seed - 1];
+    double const centre = _polarity * signal[seed];
+    double const right = _polarity * signal[seed + 1];
+    if(left > right) {
+      cluster.eta = left / (left + centre);
+    } else if(right > left) {
+      cluster.eta = centre / (centre + right);
+    }
+  }
+  clusters.push_back(cluster);
+}
@@ -0,0 +1,204 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelStripCommonMode.h"
+#include "EUTelExceptions.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define EUTELSTRIPCOMMONMODE_AVX2
+#include <immintrin.h>
+#endif
+
+using namespace eutelescope;
+
+constexpr size_t EUTelStripCommonMode::nChannels;
+
+namespace {
+
+  //! Sums over the channels kept in a pass of the common mode
+  struct Sums {
+    double n, signal, signal2, channel, channel2, channelSignal;
+  };
+
+  //! One pass, cut selects the channels within deviation sigma of mean
+  Sums sumScalar(float const *signal, std::int32_t const *keep, bool cut, double mean, double sigma,
+                 double deviation) {
+    Sums sums = {0., 0., 0., 0., 0., 0.};
+    for(size_t ichan = 0; ichan < EUTelStripCommonMode::nChannels; ++ichan) {
+      if(!keep[ichan]) continue;
+      double const sig = signal[ichan];
+      //not a >= test, a sigma of 0 rejects everything
+      if(cut && !(std::fabs((sig - mean) / sigma) < deviation)) continue;
+      double const chan = static_cast<double>(ichan);
+      sums.n += 1.;
+      sums.signal += sig;
+      sums.signal2 += sig * sig;
+      sums.channel += chan;
+      sums.channel2 += chan * chan;
+      sums.channelSignal += chan * sig;
+    }
+    return sums;
+  }
+
+  void subtractScalar(float const *data, float const *values, std::int32_t const *keep, float *result) {
+    for(size_t ichan = 0; ichan < EUTelStripCommonMode::nChannels; ++ichan) {
+      result[ichan] = keep[ichan] ? data[ichan] - values[ichan] : 0.f;
+    }
+  }
+
+#ifdef EUTELSTRIPCOMMONMODE_AVX2
+  __attribute__((target("avx2"))) inline double horizontalSum(__m256d sum) {
+    __m128d const pair = _mm_add_pd(_mm256_castpd256_pd128(sum), _mm256_extractf128_pd(sum, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+  }
+
+  //! sumScalar four channels at a time, same division and comparison for the cut
+  __attribute__((target("avx2"))) Sums sumAVX2(float const *signal, std::int32_t const *keep, bool cut,
+                                                double mean, double sigma, double deviation) {
+    __m256d const one = _mm256_set1_pd(1.), four = _mm256_set1_pd(4.);
+    __m256d const signBit = _mm256_set1_pd(-0.);
+    __m256d const meanV = _mm256_set1_pd(mean), sigmaV = _mm256_set1_pd(sigma);
+    __m256d const deviationV = _mm256_set1_pd(deviation);
+    __m256d n = _mm256_setzero_pd(), sum = n, sum2 = n, channel = n, channel2 = n, channelSum = n;
+    __m256d chan = _mm256_set_pd(3., 2., 1., 0.);
+    for(size_t ichan = 0; ichan < EUTelStripCommonMode::nChannels; ichan += 4, chan = _mm256_add_pd(chan, four)) {
+      __m256d used = _mm256_castsi256_pd(
+          _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<__m128i const *>(keep + ichan))));
+      __m256d sig = _mm256_cvtps_pd(_mm_loadu_ps(signal + ichan));
+      if(cut) {
+        __m256d const pull = _mm256_andnot_pd(signBit, _mm256_div_pd(_mm256_sub_pd(sig, meanV), sigmaV));
+        used = _mm256_and_pd(used, _mm256_cmp_pd(pull, deviationV, _CMP_LT_OQ));
+      }
+      //masking instead of multiplying by 0, a masked NaN must not leak into the sums
+      sig = _mm256_and_pd(sig, used);
+      __m256d const usedChan = _mm256_and_pd(chan, used);
+      n = _mm256_add_pd(n, _mm256_and_pd(one, used));
+      sum = _mm256_add_pd(sum, sig);
+      sum2 = _mm256_add_pd(sum2, _mm256_mul_pd(sig, sig));
+      channel = _mm256_add_pd(channel, usedChan);
+      channel2 = _mm256_add_pd(channel2, _mm256_mul_pd(usedChan, usedChan));
+      channelSum = _mm256_add_pd(channelSum, _mm256_mul_pd(usedChan, sig));
+    }
+    return {horizontalSum(n),       horizontalSum(sum),      horizontalSum(sum2),
+            horizontalSum(channel), horizontalSum(channel2), horizontalSum(channelSum)};
+  }
+
+  __attribute__((target("avx2"))) void subtractAVX2(float const *data, float const *values,
+                                                    std::int32_t const *keep, float *result) {
+    for(size_t ichan = 0; ichan < EUTelStripCommonMode::nChannels; ichan += 8) {
+      __m256 const difference = _mm256_sub_ps(_mm256_loadu_ps(data + ichan), _mm256_loadu_ps(values + ichan));
+      __m256 const used = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(keep + ichan)));
+      _mm256_storeu_ps(result + ichan, _mm256_and_ps(difference, used));
+    }
+  }
+#endif
+
+  Sums sum(bool useAVX2, float const *signal, std::int32_t const *keep, bool cut, double mean, double sigma,
+           double deviation) {
+#ifdef EUTELSTRIPCOMMONMODE_AVX2
+    if(useAVX2) return sumAVX2(signal, keep, cut, mean, sigma, deviation);
+#else
+    static_cast<void>(useAVX2);
+#endif
+    return sumScalar(signal, keep, cut, mean, sigma, deviation);
+  }
+}
+
+EUTelStripCommonMode::EUTelStripCommonMode(unsigned iterations, float noiseDeviation, Method method)
+    : _iterations(iterations), _noiseDeviation(noiseDeviation), _method(method),
+      _useAVX2(isAVX2Available()) {
+  std::fill(_pedestal, _pedestal + nChannels, 0.f);
+  std::fill(_keep, _keep + nChannels, -1);
+}
+
+bool EUTelStripCommonMode::isAVX2Available() {
+#ifdef EUTELSTRIPCOMMONMODE_AVX2
+  static bool const available = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+  }();
+  return available;
+#else
+  return false;
+#endif
+}
+
+void EUTelStripCommonMode::setUseAVX2(bool useAVX2) { _useAVX2 = useAVX2 && isAVX2Available(); }
+
+void EUTelStripCommonMode::setPedestals(float const *pedestals) {
+  std::copy(pedestals, pedestals + nChannels, _pedestal);
+}
+
+void EUTelStripCommonMode::setPedestals(std::vector<float> const &pedestals) {
+  if(pedestals.size() != nChannels) {
+    throw InvalidParameterException("Common mode computation for " + std::to_string(nChannels) +
+                                    " channels got " + std::to_string(pedestals.size()) + " pedestals");
+  }
+  setPedestals(pedestals.data());
+}
+
+void EUTelStripCommonMode::subtract(float const *data, float const *values, float *result) const {
+#ifdef EUTELSTRIPCOMMONMODE_AVX2
+  if(_useAVX2) {
+    subtractAVX2(data, values, _keep, result);
+    return;
+  }
+#endif
+  subtractScalar(data, values, _keep, result);
+}
+
+EUTelStripCommonMode::CommonMode EUTelStripCommonMode::computeCommonMode(float const *signal) const {
+  CommonMode commonMode = {0., 0., 0., 0., 0};
+  for(unsigned iteration = 0; iteration < _iterations; ++iteration) {
+    Sums const sums = sum(_useAVX2, signal, _keep, iteration > 0, commonMode.mean, commonMode.sigma,
+                          _noiseDeviation);
+
+    //slope corrections: commonmode = a + b * channel
+    double const delta = sums.n * sums.channel2 - sums.channel * sums.channel;
+    commonMode.offset = (sums.channel2 * sums.signal - sums.channel * sums.channelSignal) / delta;
+    commonMode.slope = (sums.n * sums.channelSignal - sums.channel * sums.signal) / delta;
+    commonMode.nUsed = static_cast<int>(sums.n);
+
+    //standard deviation = sqrt(E[x^2] - E[x]^2), the previous pass is kept if nothing is left
+    if(sums.n > 0.) {
+      commonMode.mean = sums.signal / sums.n;
+      commonMode.sigma = std::sqrt(sums.signal2 / sums.n - commonMode.mean * commonMode.mean);
+    }
+  }
+  return commonMode;
+}
+
+void EUTelStripCommonMode::fillCommonMode(CommonMode const &commonMode, float *values) const {
+  if(_method == Method::constant) {
+    std::fill(values, values + nChannels, static_cast<float>(commonMode.mean));
+    return;
+  }
+  for(size_t ichan = 0; ichan < nChannels; ++ichan) {
+    values[ichan] = static_cast<float>(commonMode.offset + commonMode.slope * static_cast<double>(ichan));
+  }
+}
+
+EUTelStripCommonMode::CommonMode EUTelStripCommonMode::process(float const *raw, float *corrected, float *signal,
+                                                               float *commonMode) const {
+  float signalBuffer[nChannels], commonModeBuffer[nChannels];
+  if(!signal) signal = signalBuffer;
+  if(!commonMode) commonMode = commonModeBuffer;
+
+  subtractPedestals(raw, signal);
+  CommonMode const result = computeCommonMode(signal);
+  fillCommonMode(result, commonMode);
+  subtract(signal, commonMode, corrected);
+  return result;
+}
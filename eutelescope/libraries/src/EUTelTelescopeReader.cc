@@ -0,0 +1,295 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelTelescopeReader.h"
+
+// lcio includes <.h>
+#include <EVENT/LCCollection.h>
+#include <EVENT/LCEvent.h>
+#include <EVENT/LCIO.h>
+#include <EVENT/LCParameters.h>
+#include <EVENT/TrackerData.h>
+#include <EVENT/TrackerPulse.h>
+#include <Exceptions.h>
+#include <IMPL/TrackerDataImpl.h>
+#include <IMPL/TrackerPulseImpl.h>
+#if LCIO_VERSION_GE(2, 14)
+#include <MT/LCReader.h>
+#else
+#include <IO/LCReader.h>
+#include <IOIMPL/LCFactory.h>
+#endif
+
+// system includes <>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+using namespace eutelescope;
+
+namespace {
+
+  void copyParameters(EVENT::LCParameters const &source, EVENT::LCParameters &target) {
+    EVENT::StringVec keys;
+    source.getIntKeys(keys);
+    for(auto const &key : keys) {
+      EVENT::IntVec values;
+      target.setValues(key, source.getIntVals(key, values));
+    }
+    keys.clear();
+    source.getFloatKeys(keys);
+    for(auto const &key : keys) {
+      EVENT::FloatVec values;
+      target.setValues(key, source.getFloatVals(key, values));
+    }
+    keys.clear();
+    source.getStringKeys(keys);
+    for(auto const &key : keys) {
+      EVENT::StringVec values;
+      target.setValues(key, source.getStringVals(key, values));
+    }
+  }
+
+  IMPL::TrackerDataImpl *copyTrackerData(EVENT::TrackerData const *source) {
+    auto *copy = new IMPL::TrackerDataImpl();
+    copy->setCellID0(source->getCellID0());
+    copy->setCellID1(source->getCellID1());
+    copy->setTime(source->getTime());
+    copy->setChargeValues(source->getChargeValues());
+    return copy;
+  }
+}
+
+EUTelTelescopeReader::Frame::Frame()
+    : _runNumber(0), _eventNumber(0), _timeStamp(0), _collections(),
+      _orphans(new IMPL::LCCollectionVec(EVENT::LCIO::TRACKERDATA)) {}
+
+IMPL::LCCollectionVec *EUTelTelescopeReader::Frame::getCollection(std::string const &name) const {
+  auto const collection = _collections.find(name);
+  if(collection == _collections.end()) {
+    throw lcio::DataNotAvailableException("Collection " + name + " not found in the telescope frame");
+  }
+  return collection->second.get();
+}
+
+EUTelTelescopeReader::EUTelTelescopeReader(std::string const &fileName,
+                                           std::vector<std::string> const &collectionNames,
+                                           size_t prefetchFrames)
+#if LCIO_VERSION_GE(2, 14)
+    : _reader(new MT::LCReader(MT::LCReader::directAccess)),
+#else
+    : _reader(IOIMPL::LCFactory::getInstance()->createLCReader(IO::LCReader::directAccess)),
+#endif
+      _collectionNames(collectionNames), _prefetchFrames(canPrefetch() ? prefetchFrames : 0), _nEvents(0),
+      _next(), _nextFetched(false), _index(), _thread(), _mutex(), _condition(), _queue(),
+      _started(false), _finished(false), _stop(false), _error() {
+  _reader->open(fileName);
+  _nEvents = _reader->getNumberOfEvents();
+}
+
+bool EUTelTelescopeReader::canPrefetch() {
+#if LCIO_VERSION_GE(2, 14)
+  return true;
+#else
+  return false;
+#endif
+}
+
+EUTelTelescopeReader::~EUTelTelescopeReader() {
+  if(_thread.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _condition.notify_all();
+    _thread.join();
+  }
+  _reader->close();
+}
+
+void EUTelTelescopeReader::skip(size_t nFrames) {
+  //nothing read ahead, LCIO can skip without unpacking
+  if(!_started && !_nextFetched) {
+    _reader->skipNEvents(static_cast<int>(nFrames));
+    return;
+  }
+  for(size_t i = 0; i < nFrames && take(); ++i) {
+  }
+}
+
+EUTelTelescopeReader::FramePtr EUTelTelescopeReader::peek() {
+  if(!_nextFetched) fetch();
+  return _next;
+}
+
+EUTelTelescopeReader::FramePtr EUTelTelescopeReader::next() {
+  FramePtr frame = take();
+  if(frame) _index.push_back({frame->getRunNumber(), frame->getEventNumber(), frame->getTimeStamp()});
+  return frame;
+}
+
+EUTelTelescopeReader::FramePtr EUTelTelescopeReader::take() {
+  FramePtr frame = peek();
+  _nextFetched = false;
+  _next.reset();
+  return frame;
+}
+
+size_t EUTelTelescopeReader::readUntil(lcio::long64 timeLimit, std::vector<FramePtr> &frames) {
+  size_t nFrames = 0;
+  for(FramePtr frame = peek(); frame && frame->getTimeStamp() < timeLimit; frame = peek()) {
+    frames.push_back(next());
+    ++nFrames;
+  }
+  return nFrames;
+}
+
+size_t EUTelTelescopeReader::findTimeStamp(lcio::long64 timeStamp) const {
+  auto const entry = std::lower_bound(_index.begin(), _index.end(), timeStamp,
+                                      [](IndexEntry const &a, lcio::long64 b) { return a.timeStamp < b; });
+  return static_cast<size_t>(entry - _index.begin());
+}
+
+void EUTelTelescopeReader::fetch() {
+  _nextFetched = true;
+  if(_prefetchFrames == 0) {
+    _next = readFrame();
+    return;
+  }
+
+  if(!_started) {
+    _started = true;
+    _thread = std::thread(&EUTelTelescopeReader::prefetchLoop, this);
+  }
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  _condition.wait(lock, [this] { return !_queue.empty() || _finished; });
+  if(_queue.empty()) {
+    _next.reset();
+    if(_error) {
+      std::exception_ptr error = _error;
+      _error = nullptr;
+      std::rethrow_exception(error);
+    }
+    return;
+  }
+  _next = std::move(_queue.front());
+  _queue.pop_front();
+  lock.unlock();
+  _condition.notify_all();
+}
+
+void EUTelTelescopeReader::prefetchLoop() {
+  while(true) {
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _condition.wait(lock, [this] { return _queue.size() < _prefetchFrames || _stop; });
+      if(_stop) return;
+    }
+
+    FramePtr frame;
+    std::exception_ptr error;
+    try {
+      frame = readFrame();
+    } catch(...) {
+      error = std::current_exception();
+    }
+
+    bool const finished = !frame;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if(finished) {
+        _finished = true;
+        _error = error;
+      } else {
+        _queue.push_back(std::move(frame));
+      }
+    }
+    _condition.notify_all();
+    if(finished) return;
+  }
+}
+
+EUTelTelescopeReader::FramePtr EUTelTelescopeReader::readFrame() {
+#if LCIO_VERSION_GE(2, 14)
+  std::unique_ptr<EVENT::LCEvent> const ownedEvent = _reader->readNextEvent();
+  EVENT::LCEvent *event = ownedEvent.get();
+#else
+  //deleted by LCIO on the next read
+  EVENT::LCEvent *event = _reader->readNextEvent();
+#endif
+  if(!event) return FramePtr();
+
+  std::shared_ptr<Frame> frame(new Frame());
+  frame->_runNumber = event->getRunNumber();
+  frame->_eventNumber = event->getEventNumber();
+  frame->_timeStamp = event->getTimeStamp();
+
+  EVENT::StringVec const *eventCollections = event->getCollectionNames();
+  auto const available = [eventCollections](std::string const &name) {
+    return std::find(eventCollections->begin(), eventCollections->end(), name) != eventCollections->end();
+  };
+
+  //the data first, so that the pulses can point to the copies
+  std::unordered_map<EVENT::TrackerData const *, IMPL::TrackerDataImpl *> dataCopies;
+  for(int pass = 0; pass < 2; ++pass) {
+    std::string const type = pass == 0 ? EVENT::LCIO::TRACKERDATA : EVENT::LCIO::TRACKERPULSE;
+    for(auto const &name : _collectionNames) {
+      if(!available(name)) continue;
+      EVENT::LCCollection *source = event->getCollection(name);
+      if(source->getTypeName() != type) {
+        if(pass == 1 && source->getTypeName() != EVENT::LCIO::TRACKERDATA) {
+          throw lcio::Exception("Telescope collection " + name + " of type " + source->getTypeName() +
+                                " can not be copied, only TrackerData and TrackerPulse can");
+        }
+        continue;
+      }
+
+      std::unique_ptr<IMPL::LCCollectionVec> copy(new IMPL::LCCollectionVec(type));
+      copy->setFlag(source->getFlag());
+      copyParameters(source->getParameters(), copy->parameters());
+      int const nElements = source->getNumberOfElements();
+      copy->reserve(static_cast<size_t>(nElements));
+      for(int i = 0; i < nElements; ++i) {
+        if(pass == 0) {
+          auto const *data = dynamic_cast<EVENT::TrackerData const *>(source->getElementAt(i));
+          IMPL::TrackerDataImpl *dataCopy = copyTrackerData(data);
+          dataCopies[data] = dataCopy;
+          copy->push_back(dataCopy);
+          continue;
+        }
+
+        auto const *pulse = dynamic_cast<EVENT::TrackerPulse const *>(source->getElementAt(i));
+        auto *pulseCopy = new IMPL::TrackerPulseImpl();
+        pulseCopy->setCellID0(pulse->getCellID0());
+        pulseCopy->setCellID1(pulse->getCellID1());
+        pulseCopy->setTime(pulse->getTime());
+        pulseCopy->setCharge(pulse->getCharge());
+        pulseCopy->setQuality(pulse->getQuality());
+        pulseCopy->setCovMatrix(pulse->getCovMatrix());
+        if(EVENT::TrackerData const *data = pulse->getTrackerData()) {
+          auto const dataCopy = dataCopies.find(data);
+          if(dataCopy != dataCopies.end()) {
+            pulseCopy->setTrackerData(dataCopy->second);
+          } else {
+            IMPL::TrackerDataImpl *orphan = copyTrackerData(data);
+            dataCopies[data] = orphan;
+            frame->_orphans->push_back(orphan);
+            pulseCopy->setTrackerData(orphan);
+          }
+        }
+        copy->push_back(pulseCopy);
+      }
+      frame->_collections[name] = std::move(copy);
+    }
+  }
+  return frame;
+}
@@ -17,6 +17,7 @@
 
 #include "EUTELESCOPE.h"
 #include <cmath>
+#include <limits>
 #include <memory>
 #include <type_traits>
 
@@ -44,6 +45,9 @@ using namespace eutelescope;
 using namespace marlin;
 
 
+constexpr double EUTelTripletGBLUtility::cutPlotRange;
+constexpr double EUTelTripletGBLUtility::searchMargin;
+
 EUTelTripletGBLUtility::EUTelTripletGBLUtility(){}
 
 Eigen::Matrix<double, 5,5> EUTelTripletGBLUtility::JacobianPointToPoint( double ds ) {
@@ -63,40 +67,40 @@ void EUTelTripletGBLUtility::bookHistos(){
   //cut plots
   marlin::AIDAProcessor::tree(parent)->mkdir("Cuts");
   
-  upstreamTripletSlopeX = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/upstreamTripletSlopeCutX", 1000, -3, 3 ); //binning to be reviewed
+  upstreamTripletSlopeX = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/upstreamTripletSlopeCutX", 1000, -cutPlotRange, cutPlotRange ); //binning to be reviewed
   upstreamTripletSlopeX->setTitle( "Upstream Triplet Slope X;Upstream Triplet Slope X [mrad];Counts" );
   
-  upstreamTripletSlopeY = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/upstreamTripletSlopeCutY", 1000, -3, 3 ); //binning to be reviewed
+  upstreamTripletSlopeY = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/upstreamTripletSlopeCutY", 1000, -cutPlotRange, cutPlotRange ); //binning to be reviewed
   upstreamTripletSlopeY->setTitle( "Upstream Triplet Slope Y;Upstream Triplet Slope Y [mrad];Counts" );
   
-  downstreamTripletSlopeX = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/downstreamTripletSlopeCutX", 1000, -3, 3 ); //binning to be reviewed
+  downstreamTripletSlopeX = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/downstreamTripletSlopeCutX", 1000, -cutPlotRange, cutPlotRange ); //binning to be reviewed
   downstreamTripletSlopeX->setTitle( "Downstream Triplet Slope X;Downstream Triplet Slope X [mrad];Counts" );
   
-  downstreamTripletSlopeY = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/downstreamTripletSlopeCutY", 1000, -3, 3 ); //binning to be reviewed
+  downstreamTripletSlopeY = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/downstreamTripletSlopeCutY", 1000, -cutPlotRange, cutPlotRange ); //binning to be reviewed
   downstreamTripletSlopeY->setTitle( "Downstream Triplet Slope Y;Downstream Triplet Slope Y [mrad];Counts" );
   
-  upstreamTripletResidualX = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/upstreamTripletResidualCutX", 1000, -3, 3 ); //binning to be reviewed
+  upstreamTripletResidualX = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/upstreamTripletResidualCutX", 1000, -cutPlotRange, cutPlotRange ); //binning to be reviewed
   upstreamTripletResidualX->setTitle( "Upstream Triplet Residual X;Upstream Triplet Residual X [mm];Counts" );
   
-  upstreamTripletResidualY = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/upstreamTripletResidualCutY", 1000, -3, 3 ); //binning to be reviewed
+  upstreamTripletResidualY = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/upstreamTripletResidualCutY", 1000, -cutPlotRange, cutPlotRange ); //binning to be reviewed
   upstreamTripletResidualY->setTitle( "Upstream Triplet Residual Y;Upstream Triplet Residual Y [mm];Counts" );
   
-  downstreamTripletResidualX = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/downstreamTripletResidualCutX", 1000, -3, 3 ); //binning to be reviewed
+  downstreamTripletResidualX = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/downstreamTripletResidualCutX", 1000, -cutPlotRange, cutPlotRange ); //binning to be reviewed
   downstreamTripletResidualX->setTitle( "Downstream Triplet Residual X;Downstream Triplet Residual X [mm];Counts" );
   
-  downstreamTripletResidualY = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/downstreamTripletResidualCutY", 1000, -3, 3 ); //binning to be reviewed
+  downstreamTripletResidualY = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/downstreamTripletResidualCutY", 1000, -cutPlotRange, cutPlotRange ); //binning to be reviewed
   downstreamTripletResidualY->setTitle( "Downstream Triplet Residual Y;Downstream Triplet Residual Y [mm];Counts" );
   
-  tripletMatchingResidualX = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/tripletMatchingResidualCutX", 1000, -3, 3 ); //binning to be reviewed
+  tripletMatchingResidualX = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/tripletMatchingResidualCutX", 1000, -cutPlotRange, cutPlotRange ); //binning to be reviewed
   tripletMatchingResidualX->setTitle( "Triplet Matching Residual X;Triplet Matching Residual X [mm];Counts" );
   
-  tripletMatchingResidualY = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/tripletMatchingResidualCutY", 1000, -3, 3 ); //binning to be reviewed
+  tripletMatchingResidualY = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/tripletMatchingResidualCutY", 1000, -cutPlotRange, cutPlotRange ); //binning to be reviewed
   tripletMatchingResidualY->setTitle( "Triplet Matching Residual Y;Triplet Matching Residual Y [mm];Counts" );
   
-  DUTMatchingResidualX = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/DUTMatchingResidualCutX", 1000, -3, 3 ); //binning to be reviewed
+  DUTMatchingResidualX = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/DUTMatchingResidualCutX", 1000, -cutPlotRange, cutPlotRange ); //binning to be reviewed
   DUTMatchingResidualX->setTitle( "DUT Matching Residual local X;DUT Matching Residual local X [mm];Counts" );
   
-  DUTMatchingResidualY = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/DUTMatchingResidualCutY", 1000, -3, 3 ); //binning to be reviewed
+  DUTMatchingResidualY = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/DUTMatchingResidualCutY", 1000, -cutPlotRange, cutPlotRange ); //binning to be reviewed
   DUTMatchingResidualY->setTitle( "DUT Matching Residual local Y;DUT Matching Residual local Y [mm];Counts" );
   
   DUTHitNumber = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/DUTHitNumber", 21, -0.5, 20.5 ); //binning to be reviewed
@@ -108,38 +112,67 @@ void EUTelTripletGBLUtility::MatchTriplets(std::vector<triplet> const & up, std:
 
   // Cut on the matching of two triplets [mm]
 
+  // Triplet impact points at the matching position, computed once
+  std::vector<double> xUp, yUp, xDown, yDown;
+  xUp.reserve(up.size());
+  yUp.reserve(up.size());
   for( auto& trip: up ){
+    xUp.push_back(trip.getx_at(z_match));
+    yUp.push_back(trip.gety_at(z_match));
+  }
+  xDown.reserve(down.size());
+  yDown.reserve(down.size());
+  for( auto& drip: down ){
+    xDown.push_back(drip.getx_at(z_match));
+    yDown.push_back(drip.gety_at(z_match));
+  }
+
+  // check if the triplets are isolated. use at least double the trip_machting_cut for isolation in order to avoid double matching
+  std::vector<char> isolatedUp, isolatedDown;
+  FlagIsolated(xUp, yUp, trip_matching_cut*2.0001, isolatedUp);
+  FlagIsolated(xDown, yDown, trip_matching_cut*2.0001, isolatedDown);
+
+  EUTelPointGrid downGrid;
+  downGrid.build(xDown, yDown, cutPlotRange);
+  std::vector<size_t> candidates;
+  double const lowest = std::numeric_limits<double>::lowest();
+  double const highest = std::numeric_limits<double>::max();
+  double const plotWindow = cutPlotRange + searchMargin;
+  double const window = trip_matching_cut + searchMargin;
+
+  for( size_t iUp = 0; iUp < up.size(); ++iUp ){
 
     // Track impact position at Matching Point from Upstream:
-    double xA = trip.getx_at(z_match); // triplet impact point at matching position
-    double yA = trip.gety_at(z_match);
+    double xA = xUp[iUp]; // triplet impact point at matching position
+    double yA = yUp[iUp];
 
-    // check if trip is isolated. use at least double the trip_machting_cut for isolation in order to avoid double matching
-    bool IsolatedTrip = IsTripletIsolated(trip, up, z_match, trip_matching_cut*2.0001);
+    bool IsolatedTrip = isolatedUp[iUp];
     streamlog_out(DEBUG4) << "  Is triplet isolated? " << IsolatedTrip << std::endl;
 
-    for( auto& drip: down ){
+    //cut plots, one entry per driplet on each axis, the overflow is skipped
+    if( tripletMatchingResidualX ) {
+      downGrid.query(xA - plotWindow, xA + plotWindow, lowest, highest, candidates);
+      for( auto iDown: candidates ) tripletMatchingResidualX->fill(xDown[iDown] - xA);
+      downGrid.query(lowest, highest, yA - plotWindow, yA + plotWindow, candidates);
+      for( auto iDown: candidates ) tripletMatchingResidualY->fill(yDown[iDown] - yA);
+    }
+
+    // only the driplets which can be matched are looked at
+    downGrid.query(xA - window, xA + window, yA - window, yA + window, candidates);
+    for( auto iDown: candidates ){
 
       // Track impact position at Matching Point from Downstream:
-      double xB = drip.getx_at(z_match); // triplet impact point at matching position
-      double yB = drip.gety_at(z_match);
+      double xB = xDown[iDown]; // triplet impact point at matching position
+      double yB = yDown[iDown];
 
       // check if drip is isolated
-      bool IsolatedDrip = IsTripletIsolated(drip, down, z_match, trip_matching_cut*2.0001);
+      bool IsolatedDrip = isolatedDown[iDown];
       streamlog_out(DEBUG4) << "  Is driplet isolated? " << IsolatedDrip << std::endl;
 
-
-      // Build a track candidate from one upstream and one downstream triplet:
-      EUTelTripletGBLUtility::track newtrack(trip,drip);
-
       // driplet - triplet
       double dx = xB - xA; 
       double dy = yB - yA;
 
-      
-      //cut plots
-      tripletMatchingResidualX->fill(dx);
-      tripletMatchingResidualY->fill(dy);
       // match driplet and triplet:
       streamlog_out(DEBUG4) << "  Distance for matching x: " << fabs(dx)<< std::endl;
       streamlog_out(DEBUG4) << "  Distance for matching y: " << fabs(dy)<< std::endl;
@@ -154,7 +187,8 @@ void EUTelTripletGBLUtility::MatchTriplets(std::vector<triplet> const & up, std:
       streamlog_out(DEBUG4) << "  Trip and Drip isolated " << std::endl;      
 
       // Add the track to the vector if trip/drip are isolated, the triplets are matched, and all other cuts are passed
-      tracks.push_back(newtrack);
+      // Build a track candidate from one upstream and one downstream triplet:
+      tracks.emplace_back(up[iUp], down[iDown]);
 
     } // Downstream
   } // Upstream
@@ -163,6 +197,27 @@ void EUTelTripletGBLUtility::MatchTriplets(std::vector<triplet> const & up, std:
   //return tracks;
 }
 
+void EUTelTripletGBLUtility::FlagIsolated(std::vector<double> const & x, std::vector<double> const & y, double isolation_cut, std::vector<char> & isolated) {
+
+  isolated.assign(x.size(), 1);
+  EUTelPointGrid grid;
+  grid.build(x, y, isolation_cut);
+  std::vector<size_t> neighbours;
+  for( size_t i = 0; i < x.size(); ++i ){
+    grid.query(x[i] - isolation_cut, x[i] + isolation_cut, y[i] - isolation_cut, y[i] + isolation_cut, neighbours);
+    for( auto j: neighbours ){
+      if( j == i ) continue;
+      // same distance as in IsTripletIsolated()
+      double ddA = sqrt( fabs(x[j] - x[i])*fabs(x[j] - x[i]) 
+	  + fabs(y[j] - y[i])*fabs(y[j] - y[i]) );
+      if( ddA < isolation_cut ) {
+        isolated[i] = 0;
+        break;
+      }
+    }
+  }
+}
+
 bool EUTelTripletGBLUtility::IsTripletIsolated(EUTelTripletGBLUtility::triplet const & it, std::vector<EUTelTripletGBLUtility::triplet> const & trip, double z_match, double isolation_cut) { // isolation_cut is defaulted to 0.3 mm
   bool IsolatedTrip = true;
 
@@ -187,30 +242,44 @@ bool EUTelTripletGBLUtility::IsTripletIsolated(EUTelTripletGBLUtility::triplet c
 }
 
 bool EUTelTripletGBLUtility::AttachDUT(EUTelTripletGBLUtility::triplet & triplet, std::vector<EUTelTripletGBLUtility::hit> const & hits, unsigned int dutID,  std::vector<float> dist_cuts){
+	return AttachDUT(triplet, hits, HitGrid(hits, dutID), dist_cuts);
+}
 
-	auto zPos = geo::gGeometry().getPlaneZPosition(dutID);
+bool EUTelTripletGBLUtility::AttachDUT(EUTelTripletGBLUtility::triplet & triplet, std::vector<EUTelTripletGBLUtility::hit> const & hits, HitGrid const & dutHits, std::vector<float> const & dist_cuts){
+
+	auto dutID = dutHits.getPlane();
+	auto zPos = geo::gGeometry().getPlaneZPosition(static_cast<int>(dutID));
 	int minHitIx = -1;
 	double minDist = std::numeric_limits<float>::max();
 
 	auto trX = triplet.getx_at(zPos);
 	auto trY = triplet.gety_at(zPos);
-	size_t ix = 0;	
-	for(auto& hit: hits) {
-		if(hit.plane == dutID) {
-			auto hitX = hit.x;
-			auto hitY = hit.y;
-			auto distX = fabs(trX-hitX);
-			auto distY = fabs(trY-hitY);
-            double dist = distX*distX + distY*distY;
-			DUTMatchingResidualX->fill(trX-hitX);
-			DUTMatchingResidualY->fill(trY-hitY);
-			if(distX <= dist_cuts.at(0) && distY <= dist_cuts.at(1) && dist < minDist ){
-				minHitIx = static_cast<int>(ix);
-				DUTHitNumber->fill(dutID);
-				minDist = dist;
-			}
+
+	//cut plots, one entry per DUT hit on each axis, the overflow is skipped
+	std::vector<size_t> candidates;
+	if(DUTMatchingResidualX) {
+		dutHits.queryX(trX - cutPlotRange - searchMargin, trX + cutPlotRange + searchMargin, candidates);
+		for(auto ix: candidates) DUTMatchingResidualX->fill(trX-hits[ix].x);
+		dutHits.queryY(trY - cutPlotRange - searchMargin, trY + cutPlotRange + searchMargin, candidates);
+		for(auto ix: candidates) DUTMatchingResidualY->fill(trY-hits[ix].y);
+	}
+
+	//only the hits which can pass the cuts are looked at, in their original order
+	double const windowX = dist_cuts.at(0) + searchMargin;
+	double const windowY = dist_cuts.at(1) + searchMargin;
+	dutHits.query(trX - windowX, trX + windowX, trY - windowY, trY + windowY, candidates);
+	for(auto ix: candidates) {
+		auto& hit = hits[ix];
+		auto hitX = hit.x;
+		auto hitY = hit.y;
+		auto distX = fabs(trX-hitX);
+		auto distY = fabs(trY-hitY);
+		double dist = distX*distX + distY*distY;
+		if(distX <= dist_cuts.at(0) && distY <= dist_cuts.at(1) && dist < minDist ){
+			minHitIx = static_cast<int>(ix);
+			if(DUTHitNumber) DUTHitNumber->fill(dutID);
+			minDist = dist;
 		}
-		++ix;
 	}
 
 	if(minHitIx != -1) {
@@ -220,6 +289,25 @@ bool EUTelTripletGBLUtility::AttachDUT(EUTelTripletGBLUtility::triplet & triplet
 return false;
 }
 
+EUTelTripletGBLUtility::HitGrid::HitGrid(std::vector<hit> const & hits, unsigned int plane) : _plane(plane), _hitIndices(), _zMin(0.), _zMax(0.), _grid() {
+	std::vector<double> x, y;
+	for(size_t i = 0; i < hits.size(); ++i) {
+		if(hits[i].plane != plane) continue;
+		if(_hitIndices.empty() || hits[i].z < _zMin) _zMin = hits[i].z;
+		if(_hitIndices.empty() || hits[i].z > _zMax) _zMax = hits[i].z;
+		_hitIndices.push_back(i);
+		x.push_back(hits[i].x);
+		y.push_back(hits[i].y);
+	}
+	_grid.build(x, y, cutPlotRange);
+}
+
+void EUTelTripletGBLUtility::HitGrid::query(double xMin, double xMax, double yMin, double yMax, std::vector<size_t> & result) const {
+	_grid.query(xMin, xMax, yMin, yMax, result);
+	//the grid indices follow the hit order, so the result stays sorted
+	for(auto& index: result) index = _hitIndices[index];
+}
+
 EUTelTripletGBLUtility::track::track(triplet up, triplet down) : upstream(up), downstream(down) {}
 
 double EUTelTripletGBLUtility::track::kink_x() {
@@ -13,12 +13,15 @@
 #include "EUTelFFClusterImpl.h"
 #include "EUTelSparseClusterImpl.h"
 #include "EUTelSparseClusterImpl.h"
+#include "EUTelTrackerDataView.h"
 #include "EUTelVirtualCluster.h"
 
 // lcio includes <.h>
 #include <EVENT/LCEvent.h>
 
+#include <algorithm>
 #include <cstdio>
+#include <utility>
 
 using namespace std;
 
@@ -161,6 +164,82 @@ namespace eutelescope {
       return noisyPixelMap;
     }
 
+    EUTelPerSensor<EUTelPixelMask>
+    readNoisyPixelMasks(LCEvent *event,
+                        std::string const &noisyPixelCollectionName) {
+
+      EUTelPerSensor<EUTelPixelMask> noisyPixelMasks;
+
+      // Try to obtain the collection
+      LCCollectionVec *noisyPixelCollectionVec = nullptr;
+      try {
+        noisyPixelCollectionVec = static_cast<LCCollectionVec *>(
+            event->getCollection(noisyPixelCollectionName));
+      } catch (...) {
+        if (!noisyPixelCollectionName.empty()) {
+          streamlog_out(WARNING1) << "noisyPixelCollectionName "
+                                  << noisyPixelCollectionName.c_str()
+                                  << " not found" << std::endl;
+          streamlog_out(WARNING1)
+              << "READ CAREFULLY: This means that no noisy pixels will be "
+                 "removed, despite the processor successfully running!"
+              << std::endl;
+        }
+        return noisyPixelMasks;
+      }
+
+      // First pass: the hot pixels of each sensor, for the mask ranges
+      CellIDDecoder<TrackerDataImpl> cellDecoder(noisyPixelCollectionVec);
+      std::map<int, std::vector<std::pair<int, int>>> noisyPixels;
+
+      for (int i = 0; i < noisyPixelCollectionVec->getNumberOfElements(); i++) {
+        TrackerDataImpl *noisyPixelData = dynamic_cast<TrackerDataImpl *>(
+            noisyPixelCollectionVec->getElementAt(i));
+        int sensorID = static_cast<int>(cellDecoder(noisyPixelData)["sensorID"]);
+        int pixelType = static_cast<int>(cellDecoder(noisyPixelData)["sparsePixelType"]);
+
+        auto &sensorPixels = noisyPixels[sensorID];
+        if (pixelType == kEUTelGenericSparsePixel) {
+          EUTelTrackerDataView pixels(noisyPixelData, pixelType);
+          for (size_t iPixel = 0; iPixel < pixels.size(); ++iPixel) {
+            sensorPixels.emplace_back(pixels.getXCoord(iPixel),
+                                      pixels.getYCoord(iPixel));
+          }
+        } else {
+          streamlog_out(ERROR5)
+              << "The noisy pixel collection is corrupted, it does not contain "
+                 "the right pixel type. Something is wrong!"
+              << std::endl;
+        }
+      }
+
+      // Second pass: one mask per sensor over the bounding box
+      for (auto &sensorPixels : noisyPixels) {
+        auto const &pixels = sensorPixels.second;
+        EUTelPixelRange range;
+        if (!pixels.empty()) {
+          auto xRange = std::minmax_element(
+              pixels.begin(), pixels.end(),
+              [](std::pair<int, int> const &a, std::pair<int, int> const &b) {
+                return a.first < b.first;
+              });
+          auto yRange = std::minmax_element(
+              pixels.begin(), pixels.end(),
+              [](std::pair<int, int> const &a, std::pair<int, int> const &b) {
+                return a.second < b.second;
+              });
+          range = EUTelPixelRange(xRange.first->first, xRange.second->first,
+                                  yRange.first->second, yRange.second->second);
+        }
+        auto &mask = noisyPixelMasks.insert(sensorPixels.first, EUTelPixelMask(range));
+        for (auto const &pixel : pixels) mask.set(pixel.first, pixel.second);
+        streamlog_out(MESSAGE5) << "Read in " << mask.count()
+                                << " noisy pixels on plane " << sensorPixels.first
+                                << std::endl;
+      }
+      return noisyPixelMasks;
+    }
+
     std::unique_ptr<EUTelTrackerDataInterfacer>
     getSparseData(IMPL::TrackerDataImpl *const data, int type) {
       return getSparseData(data, static_cast<SparsePixelType>(type));
@@ -0,0 +1,97 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelWorkerPool.h"
+
+using namespace eutelescope;
+
+EUTelWorkerPool::EUTelWorkerPool(unsigned nThreads)
+    : _workers(), _mutex(), _startCondition(), _doneCondition(),
+      _task(nullptr), _nTasks(0), _nextTask(0), _generation(0),
+      _busyWorkers(0), _stop(false), _error() {
+  for(unsigned iThread = 1; iThread < nThreads; ++iThread) {
+    _workers.emplace_back(&EUTelWorkerPool::workerLoop, this, iThread);
+  }
+}
+
+EUTelWorkerPool::~EUTelWorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _startCondition.notify_all();
+  for(auto &worker : _workers) worker.join();
+}
+
+void EUTelWorkerPool::parallelFor(size_t n, Task const &task) {
+
+  //nothing to share, save the synchronisation
+  if(_workers.empty() || n < 2) {
+    for(size_t i = 0; i < n; ++i) task(i, 0);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _task = &task;
+    _nTasks = n;
+    _nextTask = 0;
+    _error = nullptr;
+    _busyWorkers = static_cast<unsigned>(_workers.size());
+    ++_generation;
+  }
+  _startCondition.notify_all();
+
+  runTasks(0);
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  _doneCondition.wait(lock, [this] { return _busyWorkers == 0; });
+  _task = nullptr;
+  if(_error) {
+    std::exception_ptr error = _error;
+    _error = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+void EUTelWorkerPool::runTasks(unsigned threadIndex) {
+  size_t i = 0;
+  while((i = _nextTask.fetch_add(1)) < _nTasks) {
+    try {
+      (*_task)(i, threadIndex);
+    } catch(...) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if(!_error) _error = std::current_exception();
+      //skip whatever is left
+      _nextTask = _nTasks;
+    }
+  }
+}
+
+void EUTelWorkerPool::workerLoop(unsigned threadIndex) {
+  size_t seenGeneration = 0;
+  for(;;) {
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _startCondition.wait(lock, [this, seenGeneration] {
+        return _stop || _generation != seenGeneration;
+      });
+      if(_stop) return;
+      seenGeneration = _generation;
+    }
+
+    runTasks(threadIndex);
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if(--_busyWorkers == 0) _doneCondition.notify_one();
+    }
+  }
+}
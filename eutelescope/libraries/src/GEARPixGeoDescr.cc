@@ -47,5 +47,15 @@ namespace eutelescope {
       return std::make_pair(0, 0);
     }
 
+    bool GEARPixGeoDescr::fillPixelBoxes() {
+      // Equal pixels, the rows (along x) and pixels (along y) divide the
+      // sensitive area
+      int const nX = _maxIndexX + 1, nY = _maxIndexY + 1;
+      setPixelBlock(0, _maxIndexX, 0, _maxIndexY, -_sizeSensitiveAreaX / 2.,
+                    _sizeSensitiveAreaX / nX, -_sizeSensitiveAreaY / 2.,
+                    _sizeSensitiveAreaY / nY);
+      return true;
+    }
+
   } // namespace geo
 } // namespace eutelescope
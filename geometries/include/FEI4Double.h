@@ -32,6 +32,8 @@ namespace eutelescope {
       std::pair<int, int> getPixIndex(char const *);
 
     protected:
+      bool fillPixelBoxes();
+
       TGeoMaterial *matSi;
       TGeoMedium *Si;
       TGeoVolume *plane;
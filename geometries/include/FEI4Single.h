@@ -28,6 +28,8 @@ namespace eutelescope {
       std::pair<int, int> getPixIndex(char const *);
 
     protected:
+      bool fillPixelBoxes();
+
       TGeoMaterial *matSi;
       TGeoMedium *Si;
       TGeoVolume *plane;
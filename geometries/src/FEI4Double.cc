@@ -88,6 +88,15 @@ namespace eutelescope {
       return std::make_pair(0, 0);
     }
 
+    bool FEI4Double::fillPixelBoxes() {
+      // Pixel 0|0 is in the upper left corner, y counts down; the two
+      // columns at the chip boundary are 450 microns wide
+      setPixelBlock(0, 78, 0, 335, -20.2, 0.25, 8.4, -0.05);
+      setPixelBlock(79, 80, 0, 335, -0.45, 0.45, 8.4, -0.05);
+      setPixelBlock(81, 159, 0, 335, 0.45, 0.25, 8.4, -0.05);
+      return true;
+    }
+
     EUTelGenericPixGeoDescr *maker() {
       FEI4Double *mPixGeoDescr = new FEI4Double();
       return dynamic_cast<EUTelGenericPixGeoDescr *>(mPixGeoDescr);
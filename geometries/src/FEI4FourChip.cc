@@ -105,6 +105,19 @@ namespace eutelescope {
       return std::make_pair(0, 0);
     }
 
+    bool FEI4FourChip::fillPixelBoxes() {
+      // Two double chips, the lower one first, each with 450 microns wide
+      // columns at the chip boundary
+      for (int doublechip = 0; doublechip < 2; ++doublechip) {
+        int const firstY = 336 * doublechip;
+        double const edgeY = (doublechip ? 9.19 : -9.19) - 8.4;
+        setPixelBlock(0, 78, firstY, firstY + 335, -20.2, 0.25, edgeY, 0.05);
+        setPixelBlock(79, 80, firstY, firstY + 335, -0.45, 0.45, edgeY, 0.05);
+        setPixelBlock(81, 159, firstY, firstY + 335, 0.45, 0.25, edgeY, 0.05);
+      }
+      return true;
+    }
+
     EUTelGenericPixGeoDescr *maker() {
       FEI4FourChip *mPixGeoDescr = new FEI4FourChip();
       return dynamic_cast<EUTelGenericPixGeoDescr *>(mPixGeoDescr);
@@ -49,6 +49,12 @@ namespace eutelescope {
       return std::make_pair(0, 0);
     }
 
+    bool FEI4Single::fillPixelBoxes() {
+      // Pixel 0|0 is in the upper left corner, y counts down
+      setPixelBlock(0, 79, 0, 335, -10.0, 0.25, 8.4, -0.05);
+      return true;
+    }
+
     EUTelGenericPixGeoDescr *maker() {
       FEI4Single *mPixGeoDescr = new FEI4Single();
       return dynamic_cast<EUTelGenericPixGeoDescr *>(mPixGeoDescr);
@@ -78,6 +78,15 @@ namespace eutelescope {
       return std::make_pair(0, 0);
     }
 
+    bool FEI4Single400uEdge::fillPixelBoxes() {
+      // Pixel 0|0 is in the upper left corner, y counts down; the two edge
+      // columns are 400 microns wide
+      setPixelBlock(0, 0, 0, 335, -10.15, 0.4, 8.4, -0.05);
+      setPixelBlock(1, 78, 0, 335, -9.75, 0.25, 8.4, -0.05);
+      setPixelBlock(79, 79, 0, 335, 9.75, 0.4, 8.4, -0.05);
+      return true;
+    }
+
     EUTelGenericPixGeoDescr *maker() {
       FEI4Single400uEdge *mPixGeoDescr = new FEI4Single400uEdge();
       return dynamic_cast<EUTelGenericPixGeoDescr *>(mPixGeoDescr);
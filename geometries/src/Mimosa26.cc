@@ -44,6 +44,12 @@ namespace eutelescope {
       return std::make_pair(0, 0);
     }
 
+    bool Mimosa26::fillPixelBoxes() {
+      // The rows (along x) and pixels (along y) divide the sensitive area
+      setPixelBlock(0, 1151, 0, 575, -10.6, 21.2 / 1152, -5.3, 10.6 / 576);
+      return true;
+    }
+
     EUTelGenericPixGeoDescr *maker() {
       Mimosa26 *mPixGeoDescr = new Mimosa26();
       return dynamic_cast<EUTelGenericPixGeoDescr *>(mPixGeoDescr);
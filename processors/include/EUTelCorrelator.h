@@ -26,8 +26,10 @@
 #endif
 
 // system includes <>
+#include <cstddef>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace eutelescope {
@@ -155,12 +157,52 @@ namespace eutelescope {
     //! Cluster collection list (EVENT::StringVec)
     EVENT::StringVec _clusterCollectionVec;
 
-	//! Function for guessing the sensor offset
+    //! Centre of gravity and charge of a cluster, or global position of a hit
+    struct CachedPoint {
+      float x, y;
+      float charge;
+    };
+
+    //! Points of the current event grouped by sensor
+    /*! Each pulse or hit is decoded once per event. The points of the
+     *  sensor at position i of _sensorIDVec are [start[i], start[i+1]).
+     */
+    struct PointCache {
+      std::vector<CachedPoint> points;
+      std::vector<size_t> start;
+      //! Decoded points with the position of their sensor, before grouping
+      std::vector<std::pair<size_t, CachedPoint>> decoded;
+
+      size_t size(size_t sensor) const { return start[sensor + 1] - start[sensor]; }
+      CachedPoint const *begin(size_t sensor) const { return points.data() + start[sensor]; }
+
+      //! Group the decoded points by sensor, keeping their order within a sensor
+      void group(size_t nSensors);
+    };
+
+    //! Function for guessing the sensor offset
+    /*! Returns the X and Y offsets of the internal sensor followed by
+     *  the centre of the internal cluster.
+     */
     std::vector<double> guessSensorOffset(int internalSensorID,
                                           int externalSensorID,
-                                          std::vector<double> cluCenter);
+                                          CachedPoint const &internalCluster,
+                                          CachedPoint const &externalCluster) const;
 
   private:
+    //! Decode the clusters of all the cluster collections into _clusterCache
+    void cacheClusters(LCEvent *event);
+
+    //! Decode the hits into _hitCache, in the global frame
+    void cacheHits(LCEvent *event);
+
+    //! Position of a sensor in _sensorIDVec, -1 for an unknown or excluded one
+    int sensorIndex(int sensorID) const {
+      return (sensorID >= 0 && static_cast<size_t>(sensorID) < _sensorIndex.size())
+                 ? _sensorIndex[static_cast<size_t>(sensorID)]
+                 : -1;
+    }
+
     //! Initialization flag
     bool _isInitialize;
 
@@ -186,6 +228,14 @@ namespace eutelescope {
         _hitXCorrShiftMatrix;
     std::map<unsigned int, std::map<unsigned int, AIDA::IHistogram2D *>>
         _hitYCorrShiftMatrix;
+
+    //! The same histograms indexed by the positions of the sensor pair
+    /*! Entry from * n + to for the sensors at positions from and to of
+     *  _sensorIDVec, nullptr if the pair is not correlated.
+     */
+    std::vector<AIDA::IHistogram2D *> _clusterXPairs, _clusterYPairs;
+    std::vector<AIDA::IHistogram2D *> _hitXPairs, _hitYPairs;
+    std::vector<AIDA::IHistogram2D *> _hitXShiftPairs, _hitYShiftPairs;
 #endif
 
     //! boolean to store if cluster/hit collection exists
@@ -197,6 +247,23 @@ namespace eutelescope {
     
     //! map of Sensor ID and z position
     std::map<int, int> _sensorIDtoZ;
+
+    //! Position in _sensorIDVec indexed by sensor ID, -1 if not correlated
+    std::vector<int> _sensorIndex;
+
+    //! Pitch and position of the centre of each sensor, for guessSensorOffset
+    struct SensorOffsetTerms {
+      double xPitch, yPitch;
+      double xCentre, yCentre;
+    };
+    std::vector<SensorOffsetTerms> _offsetTerms;
+
+    //! Clusters and hits of the current event
+    PointCache _clusterCache;
+    PointCache _hitCache;
+
+    //! Hits of the other sensors correlated to an external hit
+    std::vector<std::pair<size_t, CachedPoint>> _correlatedHits;
   };
   
   //! A global instance of the processor
@@ -15,6 +15,9 @@
 // eutelescope includes ".h"
 #include "EUTelUtility.h"
 #include "EUTelTripletGBLUtility.h"
+#include "EUTelWorkerPool.h"
+#include "EUTelMaterialBudgetTable.h"
+#include "EUTelColumnarFile.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -29,13 +32,15 @@
 #include <AIDA/IBaseHistogram.h>
 #endif
 
-//for gbl::MilleBinary
+//for gbl::MilleBinary and gbl::GblTrajectory
 #include "include/MilleBinary.h"
+#include "include/GblTrajectory.h"
 
 // system includes <>
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 #include <limits>
 
 namespace eutelescope {
@@ -93,6 +98,72 @@ namespace eutelescope {
 
     protected:
       static int const NO_PRINT_EVENT_COUNTER = 3;
+
+      //! Telescope arm (or DUT) providing the hit of a plane
+      enum class PlaneRole { upstream, downstream, dut };
+
+      //! Track independent part of the GBL trajectory of one plane
+      /*! The plane sequence and the material are the same for all the
+       *  tracks, so are the Jacobians, the scatterers, the SUT kink
+       *  derivatives and the Millepede labels. They are computed once in
+       *  init(), a track only adds its measurements and alignment
+       *  derivatives.
+       */
+      struct PlaneTemplate {
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+        int sensorID;
+        PlaneRole role;
+        bool isExcluded;
+        bool isSUT;
+        //! Jacobian from the previous point to the plane
+        Eigen::Matrix<double,5,5> jacobian;
+        //! Jacobians to the two air scatterers following the plane
+        Eigen::Matrix<double,5,5> jacobianAirLeft;
+        Eigen::Matrix<double,5,5> jacobianAirRight;
+        //! Local derivatives of the SUT kinks, used if hasSUTLocals
+        bool hasSUTLocals;
+        Eigen::Matrix<double,2,4> sutDerivatives;
+        //! Millepede labels of the alignment parameters of the plane
+        std::vector<int> globalLabels;
+        //! GBL label of the plane point
+        unsigned int label;
+      };
+
+      //! Everything known about one matched track before and after its fit
+      /*! Filled serially from the triplets, fitted in parallel and then
+       *  consumed serially in track order, which keeps the histograms, the
+       *  output collection and the Millepede binary identical to the
+       *  serial processing.
+       */
+      struct TrackFit {
+        EUTelTripletGBLUtility::triplet const *upstream;
+        //! Hit on each plane, nullptr if there is none
+        std::vector<EUTelTripletGBLUtility::hit const *> hits;
+        //! Residual to the upstream triplet of each measured plane
+        std::vector<double> rx;
+        std::vector<double> ry;
+        //! Scattering weights of the planes and of the air, for a track dependent material
+        std::vector<Eigen::Vector2d> wscatSi;
+        std::vector<Eigen::Vector2d> wscatAir;
+        std::unique_ptr<gbl::GblTrajectory> trajectory;
+        double chi2;
+        int ndf;
+        double lostWeight;
+      };
+
+      //! Fill _planeTemplates and _pointArcLength, called at the end of init()
+      void buildTrajectoryTemplate();
+
+      //! Build and fit the trajectory of a track using the points of an arena
+      void fitTrack(TrackFit &fit, std::vector<gbl::GblPoint> &points) const;
+
+      //! Highland scattering weights of a scatterer of radLength x/X0
+      /*! Zero, meaning no scatterer at all, below a minimal x/X0.
+       */
+      Eigen::Vector2d scatteringWeight(double radLength, double totalRadLength) const;
+
+      //! Fill the scattering weights of a track from the material budget table
+      void trackScatteringWeights(TrackFit &fit) const;
     
       //! Ordered sensor ID
       /*! Within the processor all the loops are done up to _nPlanes and
@@ -116,6 +187,16 @@ namespace eutelescope {
       std::vector<double> _planeRadLength;
       std::vector<Eigen::Vector2d> _planeWscatSi;
       std::vector<Eigen::Vector2d> _planeWscatAir;
+
+      //! Material budget along the direction of each track
+      /*! If set, the scattering weights of every track are computed from
+       *  its upstream triplet slope and _materialBudgetTable, instead of
+       *  the per plane constants in _planeWscatSi and _planeWscatAir.
+       */
+      int _trackDependentMaterial;
+      double _materialTableMaxSlope;
+      int _materialTableNodes;
+      EUTelMaterialBudgetTable _materialBudgetTable;
       std::vector<Eigen::Vector2d> _planeMeasPrec;
       std::vector<float> _xResolutionVec;
       std::vector<float> _yResolutionVec;
@@ -169,6 +250,41 @@ namespace eutelescope {
       int _suggestAlignmentCuts;
       int _dumpTracks;
 
+      //! Columnar track output, written if _columnarOutputFile is not empty
+      /*! One row per track and plane, the fitted track, its kinks, the hit
+       *  and the residual, appended without creating any LCIO object.
+       *  Positions and residuals are in mm, slopes and kinks in mrad, the
+       *  hit and residual columns are NaN on a plane without a hit.
+       */
+      std::string _columnarOutputFile;
+      EUTelColumnarWriter _columnarOutput;
+      struct {
+        EUTelColumnarWriter::IntColumn run, event, track, sensorID, ndf;
+        EUTelColumnarWriter::FloatColumn chi2, x, y, z, slopeX, slopeY, kinkX, kinkY;
+        EUTelColumnarWriter::FloatColumn hitX, hitY, residualX, residualY;
+      } _columns;
+
+      //! Number of threads
+      /*! The matched tracks of an event are fitted in parallel by this
+       *  many threads. The output is identical to the serial processing.
+       */
+      int _nThreads;
+
+      //! Worker threads, created in init()
+      std::unique_ptr<EUTelWorkerPool> _workerPool;
+
+      //! Trajectory template, one entry per plane in z order
+      std::vector<PlaneTemplate, Eigen::aligned_allocator<PlaneTemplate>> _planeTemplates;
+
+      //! Arc length of all the GBL points, planes and air scatterers
+      std::vector<double> _pointArcLength;
+
+      //! Per thread GBL point buffers, reused for all the tracks
+      std::vector<std::vector<gbl::GblPoint>> _pointArenas;
+
+      //! Per track fits of the current event, kept to reuse their buffers
+      std::vector<TrackFit> _trackFits;
+
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
     //histograms: hits, triplets and tracks
     AIDA::IHistogram1D * hist1D_nTelescopeHits;
@@ -35,8 +35,10 @@
 #include <AIDA/IBaseHistogram.h>
 #endif
 #include <IMPL/LCCollectionVec.h>
+#include <IMPL/TrackerHitImpl.h>
 
 // system includes <>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -75,6 +77,48 @@ namespace eutelescope {
     
     //parameter
     bool _undoAlignment;
+
+    //! Transform the positions of the input hits instead of copying them
+    /*! Only possible for hits created in the same job, LCIO forbids to
+     *  modify the data read from a file.
+     */
+    bool _transformInPlace;
+
+    //! Position of a field in the 64 bit cell ID
+    struct CellIDField {
+      unsigned offset;
+      unsigned width;
+      std::uint64_t mask;
+      bool isSigned;
+
+      std::int64_t decode(std::uint64_t cellID) const {
+        std::uint64_t const value = (cellID & mask) >> offset;
+        if(isSigned && (value >> (width - 1)) != 0) {
+          return static_cast<std::int64_t>(value) - (std::int64_t(1) << width);
+        }
+        return static_cast<std::int64_t>(value);
+      }
+    };
+
+    //! Locate the sensorID and properties fields of an encoding
+    void setEncoding(std::string const &encoding);
+
+    //! Encoding _sensorIDField and _propertiesField belong to
+    std::string _encoding;
+    CellIDField _sensorIDField;
+    CellIDField _propertiesField;
+
+    //! Per event buffers, the hits grouped by sensor
+    std::vector<IMPL::TrackerHitImpl *> _hits;
+    std::vector<std::uint64_t> _cellIDs;
+    std::vector<int> _sensorIDs;
+    //! First entry of each sensor in the grouped order, sensor ID indexed
+    std::vector<size_t> _sensorStart;
+    std::vector<size_t> _sensorNext;
+    //! Position of each hit in the grouped order
+    std::vector<size_t> _groupedIndex;
+    //! Hit positions in the grouped order, x, y, z for each hit
+    std::vector<double> _positions;
   };
 
   //! A global instance of the processor
@@ -12,6 +12,7 @@
 #ifdef USE_GEAR
 // eutelescope includes ".h"
 #include "EUTelUtility.h"
+#include "EUTelWorkerPool.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -31,15 +32,22 @@
 #endif
 
 #include <IMPL/LCCollectionVec.h>
+#include <IMPL/TrackerDataImpl.h>
+#include <IMPL/TrackerPulseImpl.h>
 
 // system includes <>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
 
 namespace eutelescope {
 
+  namespace geo {
+    struct EUTelPlaneCache;
+  }
+
   //! Hit maker processor
   /*! Beyond this cryptic name there is a simple as important
    *  processor. This is the place were clusters found in the
@@ -223,6 +231,10 @@ namespace eutelescope {
    *  amount of memory and consequently slowing down the full
    *  processing.
    *
+   *  @param NumberOfThreads Optional number of threads used to compute
+   *  the cluster positions of one event in parallel. Hits are always
+   *  stored in the order of the input clusters.
+   *
    */
 
   class EUTelHitMaker : public marlin::Processor {
@@ -337,6 +349,41 @@ namespace eutelescope {
     std::map<int, AIDA::IBaseHistogram *> _hitLocalHistos;
     std::map<int, AIDA::IBaseHistogram *> _hitTelescopeHistos;
     #endif
+
+    //! Number of threads
+    /*! The cluster positions of an event are computed in parallel by
+     *  this many threads. The output is identical to the serial
+     *  processing.
+     */
+    int _nThreads;
+
+    //! Worker threads, created in init()
+    std::unique_ptr<EUTelWorkerPool> _workerPool;
+
+    //! Everything needed to turn one cluster into a hit
+    /*! Filled serially from the cell IDs and the geometry, so that the
+     *  position computation does not touch any shared state.
+     */
+    struct HitJob {
+      IMPL::TrackerPulseImpl *pulse = nullptr;
+      IMPL::TrackerDataImpl *trackerData = nullptr;
+      int sensorID = 0;
+      ClusterType clusterType = kEUTelSparseClusterImpl;
+      SparsePixelType pixelType = kUnknownPixelType;
+      //! Cached size, pitch and resolution of the sensor
+      geo::EUTelPlaneCache const *plane = nullptr;
+      //! Centre of gravity in pixel index units (not for generic clusters)
+      float xCoG = 0.f, yCoG = 0.f;
+      //! Hit position in the local frame, in mm
+      double localPos[3] = {0., 0., 0.};
+      //! Hit position as stored: global frame unless local coordinates are requested, in mm
+      double hitPos[3] = {0., 0., 0.};
+    };
+
+    //! Compute the local hit position of a cluster
+    /*! Thread safe, only reads the cluster data of the job.
+     */
+    static void computeLocalPosition(HitJob &job);
   };
 
   //! A global instance of the processor
@@ -12,6 +12,7 @@
 // eutelescope includes ".h"
 #include "EUTelEventImpl.h"
 #include "EUTelGenericSparsePixel.h"
+#include "EUTelPixelMatrix.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -118,8 +119,8 @@ namespace eutelescope {
     /*! False is everything is OK, true otherwise */
     bool _wrongDataFormat;
 
-    //! Map linking the noise vectors of each plane to the plane ID
-    std::map<int, std::vector<int>> _noisyPixelMap;
+    //! Hot pixel mask of each plane, indexed by the plane ID
+    EUTelPerSensor<EUTelPixelMask> _noisyPixelMasks;
 
     //! Map counting the removed hot pixels per plane
     std::map<int, int> _maskedNoisyClusters;
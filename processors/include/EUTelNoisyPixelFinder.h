@@ -12,6 +12,7 @@
 // eutelescope includes ".h"
 #include "EUTelEventImpl.h"
 #include "EUTelGenericSparsePixel.h"
+#include "EUTelPixelMatrix.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -30,18 +31,6 @@
 
 namespace eutelescope {
 
-  //! Simple helper struct for a sensor pixel layout
-  /*  Contains the pixel count as well as the offset values
-   *  this is necessay if fore example pixel indices range from
-   *  50-99 instead of 0-50. The offset allows mapping to a
-   *  range from 0 to (pixel count - 1) which is required to
-   *  access the array in which hits are counted.
-   */
-  struct sensor {
-    int offX, offY;
-    int sizeX, sizeY;
-  };
-
   //! Processor to write out hot pixels
   /*! This processor is used to keep hot matrix out from the analysis
    *  procedure. It checks if pixels fired above a certain frequency
@@ -172,21 +161,12 @@ namespace eutelescope {
     //! Maximum allowed firing frequency
     float _maxAllowedFiringFreq;
 
-    //! Vector of map arrays, keeps record of hit pixels
-    /*! The vector elements are sorted by Detector ID
-     *  For each Detector unique ID element a map of pixels is created.
-     *  Key is a (sensor) unique pixel Id (to be addressed via
-     *  _inverse_hitIndexMapVec)
-     */
-    std::map<int, sensor> _sensorMap;
-
-    //! Map holding the 2D-"array" which counts the hits
-    /*! The key is the sensorID and the array is implemented as
-     *  a vector of vectors. They are resized initially so there
-     *  is no real overhead with using std::vectors instead of
-     * arrays.
+    //! Hit counters of each sensor
+    /*! The key is the sensorID. Each counter matrix spans the pixel
+     *  index range given by the geometry, which also provides the
+     *  offsets if the pixel indices do not start at 0.
      */
-    std::map<int, std::vector<std::vector<long int>>> _hitVecMap;
+    EUTelPerSensor<EUTelPixelCounter> _hitCounters;
 
     //! Map for storing the hot pixels in a std::vector as a value
     /*! The key is once again the sensorID.
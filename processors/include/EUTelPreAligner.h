@@ -27,74 +27,80 @@
 #endif
 
 // system includes <>
+#include <algorithm>
 #include <cstdio>
 #include <iostream>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace eutelescope {
 
   //class implementation of PreAligner
+  /*! Histograms the residuals of one plane to the fixed plane. The bins
+   *  are surrounded by an underflow and an overflow bin so that a point
+   *  is binned without any branch, and the peaks can be estimated at any
+   *  time while the points are added.
+   */
   class PreAligner {
   
   private:
+    static constexpr int nBins = 400;
+
+    //! nBins bins with the underflow at 0 and the overflow at nBins + 1
     std::vector<int> histoX, histoY;
     float minX, maxX;
     float range;
     float zPos;
     int iden;
+    int entries;
     
+    //! Bin of a value, NaN goes to the underflow
+    static size_t bin(float value, float minX, float scale) {
+      float const position = std::max(0.f, (value - minX) * scale + 1.f);
+      return static_cast<size_t>(std::min(position, static_cast<float>(nBins + 1)));
+    }
+
     //! function to get maximum bin of given histogram
-    float getMaxBin(std::vector<int> &histo) {
-      int maxBin(0), maxVal(0);
-      //loop over bins
-      for(size_t ibin = 0; ibin < histo.size(); ibin++) {
-	if(histo.at(ibin) > maxVal) {
+    /*! Returns the mean bin number (0 for the first bin) of the highest
+     *  bin and its two neighbours, weighted by their content.
+     */
+    float getMaxBin(std::vector<int> const &histo) const {
+      int maxBin(1), maxVal(0);
+      //loop over bins, without the underflow and the overflow
+      for(int ibin = 1; ibin <= nBins; ibin++) {
+	if(histo[static_cast<size_t>(ibin)] > maxVal) {
 	  maxBin = ibin;
-	  maxVal = histo.at(ibin);
+	  maxVal = histo[static_cast<size_t>(ibin)];
 	}
       }
       
       //check if maxBin is not at the edges
-      if(maxBin == 0 || maxBin == static_cast<int>(histo.size())) {
+      if(maxBin == 1 || maxBin == nBins) {
         streamlog_out(WARNING3)
 	  << "At least one sensor frame might be empty or heavily "
 	  "misaligned. Please check the GEAR file!"
-	  << " MaxBin: " << maxBin << " histo.size(): " << histo.size()
+	  << " MaxBin: " << maxBin - 1 << " histo.size(): " << nBins
 	  << std::endl;
-        return static_cast<float>(maxBin);
+        return static_cast<float>(maxBin - 1);
       }
       	
       //get weighted position from three neighboring bins:
-      float weight(0.0);
-      double pos1(0.0);
-      double pos2(0.0);
-      double pos3(0.0);
-      try {
-	//use logarithms to be safe even with large number of bin entries
-	pos1 = log(maxBin - 1) + log(histo.at(maxBin - 1));
-	pos2 = log(maxBin) + log(histo.at(maxBin));
-	pos3 = log(maxBin + 1) + log(histo.at(maxBin + 1));
-	weight = log((histo.at(maxBin - 1)) + (histo.at(maxBin)) +
-                     (histo.at(maxBin + 1)));
-      } catch(...) {
-	streamlog_out(ERROR) 
-	  << "Could not execute prealignment bin content retrieval. The "
-	  "sensor frame might be empty or heavily misaligned. Please "
-	  "check the GEAR file!"
-	  << std::endl;
-	  return(maxBin);
+      double weight(0.0), sum(0.0);
+      for(int ibin = maxBin - 1; ibin <= maxBin + 1; ibin++) {
+	weight += histo[static_cast<size_t>(ibin)];
+	sum += static_cast<double>(ibin - 1) * histo[static_cast<size_t>(ibin)];
       }
-      return (exp(pos1-weight) + exp(pos2-weight) + exp(pos3-weight));
+      return static_cast<float>(sum / weight);
     }
     
   public:
   PreAligner(float zPos, int iden)
-    : minX(-20.0), maxX(20.0), range(maxX - minX), zPos(zPos), iden(iden) {
+    : minX(-20.0), maxX(20.0), range(maxX - minX), zPos(zPos), iden(iden), entries(0) {
       
-      histoX.assign(400, 0); // 500 bins
-      histoY.assign(400, 0);
+      histoX.assign(nBins + 2, 0);
+      histoY.assign(nBins + 2, 0);
     }
     
     void *current() { return this; }
@@ -106,23 +112,26 @@ namespace eutelescope {
     int getIden() const { 
       return (iden); 
     }
+
+    //! Number of points added, in or out of bounds
+    int getEntries() const {
+      return (entries);
+    }
     
-    //add point if within bounds, throw away data that is out of bounds
+    //add point, data out of bounds goes to the underflow and overflow bins
     void addPoint(float x, float y) {
-      try {
-	histoX.at(static_cast<int>((x - minX)*400./range)) += 1;
-      } catch(std::out_of_range &e) {;}
-      try {
-	histoY.at(static_cast<int>((y - minX)*400./range)) += 1;
-      } catch(std::out_of_range &e) {;}
+      float const scale = nBins / range;
+      ++histoX[bin(x, minX, scale)];
+      ++histoY[bin(y, minX, scale)];
+      ++entries;
     }	
     
-    float getPeakX() { 
-      return (getMaxBin(histoX)*range/400. + minX); 
+    float getPeakX() const { 
+      return (getMaxBin(histoX)*range/nBins + minX); 
     }
     
-    float getPeakY() { 
-      return (getMaxBin(histoY)*range/400. + minX); 
+    float getPeakY() const { 
+      return (getMaxBin(histoY)*range/nBins + minX); 
     }
   };
   
@@ -178,6 +187,39 @@ namespace eutelescope {
     //! Boolean for turning histogram creation on and off
     bool _histogramSwitch;
 
+    //! Number of events between two estimations of the offsets
+    int _convergenceInterval;
+
+    //! Largest change of the offsets [mm] between two estimations for convergence
+    /*! Once every plane has converged the offsets are final and the
+     *  remaining events are ignored, a value <= 0 disables this.
+     */
+    float _convergenceTolerance;
+
+    //! Stop the processing of the job once the offsets have converged
+    bool _stopWhenConverged;
+
+    //! Whether the offsets have converged, no more points are added then
+    bool _converged;
+
+    //! Offsets of each prealigner at the previous estimation
+    std::vector<float> _lastPeakX, _lastPeakY;
+
+    //! Check the convergence of the offsets of all prealigners
+    bool checkConvergence();
+
+    //! Index in _preAligners indexed by sensor ID, -1 for the fixed or an unknown plane
+    std::vector<int> _preAlignerIndex;
+
+    //! Hits of the current event on the fixed plane and on the other planes
+    std::vector<std::pair<float, float>> _refHits;
+    struct PlaneHit {
+      size_t preAligner;
+      float x, y;
+    };
+    std::vector<PlaneHit> _planeHits;
+    std::vector<PlaneHit> _correlatedHits;
+
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
     std::map<unsigned int, AIDA::IBaseHistogram *> _hitXCorr;
     std::map<unsigned int, AIDA::IBaseHistogram *> _hitYCorr;
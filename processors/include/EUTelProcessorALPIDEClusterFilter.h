@@ -13,10 +13,14 @@
 #ifdef USE_GEAR
 // eutelescope includes ".h"
 #include "EUTelEventImpl.h"
+#include "EUTelMultiEventClusterFilter.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
 
+// system includes <>
+#include <memory>
+
 namespace eutelescope {
 
   class EUTelProcessorALPIDEClusterFilter : public marlin::Processor {
@@ -26,11 +30,13 @@ namespace eutelescope {
     bool _clusterAvailable;
     LCCollectionVec *zsInputDataCollectionVec;
     std::string _zsDataCollectionName;
-    std::vector<std::vector<std::vector<std::vector<int>>>>PixelsOfEvents;
-    std::vector<std::vector<std::vector<std::vector<int>>>>PixelsOfEventsAfterShift;
-    unsigned int _nDeep;
+    //! Number of following events in which a cluster is searched for
+    int _nDeep;
     float _Range;
 
+    //! The last _nDeep + 1 events, see EUTelMultiEventClusterFilter
+    std::unique_ptr<EUTelMultiEventClusterFilter> _filter;
+
 
   public:
     virtual Processor * newProcessor() {
@@ -41,14 +47,14 @@ namespace eutelescope {
 
   
     virtual void init ();
-    virtual bool SameCluster(int iEvent, int iCluster, int jEvent,int jCluster);
-    virtual void AddCluster(int iEvent, int iCluster, int jEvent,int jCluster);
-    virtual void DeleteCluster(int jEvents, int jCluster);
     virtual void processEvent (LCEvent * evt);
     virtual void end();
-    virtual void readCollections(LCCollectionVec * zsInputDataCollectionVec);
+    //! Add the clusters of the event to the filter window
+    /*! @return true if the oldest event of the window has been filtered
+     *  and has to be written out
+     */
+    virtual bool readCollections(LCCollectionVec * zsInputDataCollectionVec);
     virtual void writeCollection(LCCollectionVec * sparseClusterCollectionVec, LCCollectionVec * pulseCollection);
-    virtual void filter();
     
   protected:
     //! Pulse collection size
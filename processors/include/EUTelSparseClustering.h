@@ -12,6 +12,9 @@
 // eutelescope includes ".h"
 #include "EUTELESCOPE.h"
 #include "EUTelExceptions.h"
+#include "EUTelSparseClusterFinder.h"
+#include "EUTelTrackerDataView.h"
+#include "EUTelWorkerPool.h"
 
 // marlin includes ".h"
 #include "marlin/EventModifier.h"
@@ -29,11 +32,13 @@
 
 // lcio includes <.h>
 #include <IMPL/LCCollectionVec.h>
+#include <IMPL/TrackerDataImpl.h>
 #include <IMPL/TrackerRawDataImpl.h>
 
 // system includes <>
 #include <cmath>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -79,6 +84,10 @@ namespace eutelescope {
    *
    *  @param PulseCollectionName The name of the output TrackerPulse collection.
    *
+   *  @param NumberOfThreads Optional number of threads used to cluster the
+   *  sensors of one event in parallel. The output collections keep the
+   *  input sensor order, so the result does not depend on this number.
+   *
    */
 
   class EUTelSparseClustering : public marlin::Processor,
@@ -281,6 +290,30 @@ namespace eutelescope {
 
     //! Squared cut value for distance in pixel index count (integer!)
     int _sparseMinDistanceSquared;
+
+    //! Cluster finder for each sensor
+    /*! Each finder holds an occupancy grid sized from the pixel index
+     *  range of its sensor, which is reused event after event.
+     */
+    std::map<int, EUTelSparseClusterFinder> _clusterFinderMap;
+
+    //! Number of threads
+    /*! The sensors of an event are clustered in parallel by this many
+     *  threads. The output is identical to the serial processing.
+     */
+    int _nThreads;
+
+    //! Worker threads, created in init()
+    std::unique_ptr<EUTelWorkerPool> _workerPool;
+
+    //! Clustering work for one sensor of the current event
+    struct SensorJob {
+      int sensorID;
+      SparsePixelType type;
+      EUTelTrackerDataView pixels;
+      EUTelSparseClusterFinder *finder;
+      std::vector<std::unique_ptr<IMPL::TrackerDataImpl>> clusters;
+    };
   };
 
   //! A global instance of the processor
@@ -29,9 +29,54 @@
 // system includes <>
 #include <string>
 #include <list>
+#include <map>
+#include <vector>
+
+class TH1;
+class TH1D;
+class TH2D;
+class TH3D;
 
 namespace alibava
 {
+    //! Handle of a histogram booked through the AlibavaBaseProcessor registry
+    /*! Only the index of the histogram in the registry, typed so that a
+     *  handle is filled with as many values as its histogram has axes. A
+     *  default constructed handle, or one booked with the histograms
+     *  switched off, is invalid and filling it does nothing.
+     */
+    template < class T >
+    class AlibavaHistoHandle
+    {
+	public:
+
+	    AlibavaHistoHandle ( ) : _index ( -1 )
+	    {
+	    }
+
+	    explicit AlibavaHistoHandle ( int index ) : _index ( index )
+	    {
+	    }
+
+	    bool isValid ( ) const
+	    {
+		return _index >= 0;
+	    }
+
+	    int getIndex ( ) const
+	    {
+		return _index;
+	    }
+
+	private:
+
+	    int _index;
+    };
+
+    typedef AlibavaHistoHandle < TH1D > AlibavaHisto1D;
+    typedef AlibavaHistoHandle < TH2D > AlibavaHisto2D;
+    typedef AlibavaHistoHandle < TH3D > AlibavaHisto3D;
+
     // Pedestal and noise  processor for Marlin.
     class AlibavaBaseProcessor : public marlin::Processor
     {
@@ -46,6 +91,71 @@ namespace alibava
 	    // checks if the root object exists in _rootObjectMap
 	    bool doesRootObjectExists ( std::string aHistoName );
 
+	    // Histogram registry
+	    /* The histograms filled per event are booked once with bookHisto1D,
+	     * bookHisto2D or bookHisto3D, which also put them in _rootObjectMap,
+	     * and filled through the handles returned. A fill only appends to a
+	     * buffer of the histogram, the buffers are passed to ROOT in one go
+	     * when full and by flushHistos ( ), which has to be called before
+	     * the histograms are read or written, at the latest in end ( ).
+	     */
+
+	    // books a histogram, or returns the handle of the one already booked with that name
+	    // with _fillHistograms false nothing is booked and the handle is invalid
+	    AlibavaHisto1D bookHisto1D ( std::string name, std::string title, int nBinsX, double minX, double maxX );
+	    AlibavaHisto2D bookHisto2D ( std::string name, std::string title, int nBinsX, double minX, double maxX, int nBinsY, double minY, double maxY );
+	    AlibavaHisto3D bookHisto3D ( std::string name, std::string title, int nBinsX, double minX, double maxX, int nBinsY, double minY, double maxY, int nBinsZ, double minZ, double maxZ );
+
+	    void fillHisto ( AlibavaHisto1D histo, double x, double w = 1.0 )
+	    {
+		if ( histo.isValid ( ) )
+		{
+		    HistoBuffer & buffer = _histoBuffers[histo.getIndex ( )];
+		    buffer.x.push_back ( x );
+		    buffer.w.push_back ( w );
+		    if ( buffer.w.size ( ) == HISTOBUFFERSIZE ) flushHisto ( histo.getIndex ( ) );
+		}
+	    }
+
+	    void fillHisto ( AlibavaHisto2D histo, double x, double y, double w = 1.0 )
+	    {
+		if ( histo.isValid ( ) )
+		{
+		    HistoBuffer & buffer = _histoBuffers[histo.getIndex ( )];
+		    buffer.x.push_back ( x );
+		    buffer.y.push_back ( y );
+		    buffer.w.push_back ( w );
+		    if ( buffer.w.size ( ) == HISTOBUFFERSIZE ) flushHisto ( histo.getIndex ( ) );
+		}
+	    }
+
+	    void fillHisto ( AlibavaHisto3D histo, double x, double y, double z, double w = 1.0 )
+	    {
+		if ( histo.isValid ( ) )
+		{
+		    HistoBuffer & buffer = _histoBuffers[histo.getIndex ( )];
+		    buffer.x.push_back ( x );
+		    buffer.y.push_back ( y );
+		    buffer.z.push_back ( z );
+		    buffer.w.push_back ( w );
+		    if ( buffer.w.size ( ) == HISTOBUFFERSIZE ) flushHisto ( histo.getIndex ( ) );
+		}
+	    }
+
+	    // passes the buffered fills of all the booked histograms to ROOT
+	    void flushHistos ( );
+
+	    // the histogram of a handle, its buffered fills passed to ROOT, nullptr if the handle is invalid
+	    TH1D * getHisto ( AlibavaHisto1D histo );
+	    TH2D * getHisto ( AlibavaHisto2D histo );
+	    TH3D * getHisto ( AlibavaHisto3D histo );
+
+	    // registers the FillHistograms parameter, to switch the booking and filling of the histograms off
+	    void registerHistogramSwitch ( );
+
+	    // whether the histograms are booked and filled
+	    bool _fillHistograms;
+
 	    // Input/Output Collection
 	    // getter and setter for _inputCollectionName
 	    void setInputCollectionName ( std::string inputCollectionName );
@@ -209,6 +319,31 @@ namespace alibava
 
 	    bool _isCalibrationValid;
 
+	    // the fills kept in a buffer before a histogram is flushed
+	    static const size_t HISTOBUFFERSIZE = 512;
+
+	    // a histogram of the registry and its buffered fills
+	    struct HistoBuffer
+	    {
+		TH1 * histo;
+		int dimension;
+		std::vector < double > x, y, z, w;
+	    };
+
+	    std::vector < HistoBuffer > _histoBuffers;
+
+	    // the index of each histogram in _histoBuffers, only used at booking time
+	    std::map < std::string, int > _histoIndex;
+
+	    static const int HISTONOTFOUND = -2;
+
+	    // index of a booked histogram, HISTONOTFOUND if there is none with that name
+	    int findHisto ( std::string name, int dimension );
+
+	    int registerHisto ( std::string name, TH1 * histo, int dimension );
+
+	    void flushHisto ( int index );
+
     };
 
     //! A global instance of the processor
@@ -12,6 +12,9 @@
 #include "AlibavaBaseProcessor.h"
 #include "AlibavaEventImpl.h"
 
+// eutelescope includes ".h"
+#include "EUTelStripClusterFinder.h"
+
 // marlin includes ".h"
 #include "marlin/Processor.h"
 
@@ -32,6 +35,8 @@
 // system includes <>
 #include <string>
 #include <list>
+#include <memory>
+#include <vector>
 
 using namespace std;
 
@@ -142,6 +147,34 @@ namespace alibava
 
 	protected:
 
+	    //! The histograms filled per event
+	    AlibavaHisto2D _clustersVsEventsHisto;
+	    AlibavaHisto1D _clusterSizeHisto;
+	    AlibavaHisto1D _clusterCOGEtaHisto;
+	    AlibavaHisto1D _clusterHitmapHisto;
+	    AlibavaHisto1D _seedHitmapHisto;
+	    AlibavaHisto1D _etaIntegralHisto;
+	    AlibavaHisto1D _etaHisto;
+	    AlibavaHisto2D _neighbourChargeHisto;
+	    AlibavaHisto1D _clusterSignalHisto;
+	    AlibavaHisto1D _clusterSNRHisto;
+	    AlibavaHisto1D _seedChargeHisto;
+	    AlibavaHisto1D _cogHisto;
+	    AlibavaHisto2D _etaTDCHisto;
+	    AlibavaHisto2D _etaPosHisto;
+	    AlibavaHisto1D _signalLeft2Histo;
+	    AlibavaHisto1D _signalLeft1Histo;
+	    AlibavaHisto1D _signalRight1Histo;
+	    AlibavaHisto1D _signalRight2Histo;
+	    AlibavaHisto1D _zetaHisto;
+	    AlibavaHisto1D _sigmaHisto;
+
+	    //! The cluster finder of each chip, set up in processRunHeader
+	    std::unique_ptr < eutelescope::EUTelStripClusterFinder > _finders[ALIBAVA::NOOFCHIPS];
+
+	    //! The clusters of a chip in the current event, kept to reuse its memory
+	    std::vector < eutelescope::EUTelStripClusterFinder::Cluster > _clusters;
+
 	    IMPL::LCRunHeaderImpl* _runHeader;
 
     };
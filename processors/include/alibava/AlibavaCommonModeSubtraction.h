@@ -11,6 +11,9 @@
 // alibava includes ".h"
 #include "AlibavaBaseProcessor.h"
 
+// eutelescope includes ".h"
+#include "EUTelStripCommonMode.h"
+
 // marlin includes ".h"
 #include "marlin/Processor.h"
 
@@ -24,6 +27,7 @@
 // system includes <>
 #include <string>
 #include <list>
+#include <memory>
 
 namespace alibava
 {
@@ -63,6 +67,9 @@ namespace alibava
 
 		std::string getSignalCorrectionName ( );
 
+		// the channel mask of each selected chip
+		std::unique_ptr < eutelescope::EUTelStripCommonMode > _kernels[ALIBAVA::NOOFCHIPS];
+
 	};
 
 	//! A global instance of the processor
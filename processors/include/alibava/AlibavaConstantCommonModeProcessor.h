@@ -13,6 +13,9 @@
 // alibava includes ".h"
 #include "AlibavaBaseProcessor.h"
 
+// eutelescope includes ".h"
+#include "EUTelStripCommonMode.h"
+
 // marlin includes ".h"
 #include "marlin/Processor.h"
 
@@ -26,6 +29,7 @@
 // system includes <>
 #include <string>
 #include <list>
+#include <memory>
 
 namespace alibava
 {
@@ -92,6 +96,9 @@ namespace alibava
 
 	    EVENT::FloatVec _commonmodeerror;
 
+	    // the common mode computation of each selected chip, with its channel mask
+	    std::unique_ptr < eutelescope::EUTelStripCommonMode > _kernels[ALIBAVA::NOOFCHIPS];
+
     };
 
     AlibavaConstantCommonModeProcessor gAlibavaConstantCommonModeProcessor;
@@ -105,6 +105,14 @@ namespace alibava
 
 	protected:
 
+	    //! The correlation histograms
+	    AlibavaHisto2D _correlationXHisto;
+	    AlibavaHisto2D _correlationYHisto;
+	    AlibavaHisto2D _correlationZHisto;
+	    AlibavaHisto2D _correlationEventHisto;
+	    AlibavaHisto3D _correlationAllHisto;
+	    AlibavaHisto2D _correlationHisto;
+
     };
 
     AlibavaMerger gAlibavaMerger;
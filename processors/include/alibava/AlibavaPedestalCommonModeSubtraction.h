@@ -0,0 +1,104 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+#ifndef ALIBAVAPEDESTALCOMMONMODESUBTRACTION_H
+#define ALIBAVAPEDESTALCOMMONMODESUBTRACTION_H 1
+
+// alibava includes ".h"
+#include "AlibavaBaseProcessor.h"
+
+// eutelescope includes ".h"
+#include "EUTelStripCommonMode.h"
+
+// marlin includes ".h"
+#include "marlin/Processor.h"
+
+// lcio includes <.h>
+#include <IMPL/LCRunHeaderImpl.h>
+#include <IMPL/TrackerDataImpl.h>
+
+// ROOT includes <>
+#include "TObject.h"
+
+// system includes <>
+#include <string>
+#include <list>
+#include <memory>
+
+namespace alibava
+{
+    //! Pedestal subtraction, common mode computation and common mode subtraction in one processor
+    /*! Does the work of AlibavaPedestalSubtraction, AlibavaConstantCommonModeProcessor
+     *  and AlibavaCommonModeSubtraction on each chip with a single
+     *  eutelescope::EUTelStripCommonMode, without going through the
+     *  intermediate collections. Those are only written if their names are
+     *  set: the pedestal subtracted data, the common mode and the common
+     *  mode error.
+     *
+     *  Only the summary histograms are filled, not the ones of each channel.
+     */
+    class AlibavaPedestalCommonModeSubtraction : public alibava::AlibavaBaseProcessor
+    {
+	public:
+
+	    virtual Processor * newProcessor ( )
+	    {
+		return new AlibavaPedestalCommonModeSubtraction;
+	    }
+
+	    AlibavaPedestalCommonModeSubtraction ( );
+
+	    virtual void init ( );
+
+	    virtual void processRunHeader ( LCRunHeader * run );
+
+	    virtual void processEvent ( LCEvent * evt );
+
+	    virtual void check ( LCEvent * evt );
+
+	    void bookHistos ( );
+
+	    void fillHistos ( EVENT::FloatVec const & corrected, EVENT::FloatVec const & commonmode, int chipnum );
+
+	    virtual void end ( );
+
+	    // Pedestal subtracted data collection name, not written if empty
+	    std::string _pedestalSubtractedCollectionName;
+
+	    // Common mode collection name, not written if empty
+	    std::string _commonmodeCollectionName;
+
+	    // Common mode error collection name, not written if empty
+	    std::string _commonmodeerrorCollectionName;
+
+	    int _Niteration;
+
+	    float _NoiseDeviation;
+
+	    std::string _commonmodeMethod;
+
+	protected:
+
+	    std::string getCommonCorrectionName ( );
+
+	    std::string getSignalCorrectionName ( );
+
+	    // the pedestals and channel mask of each selected chip
+	    std::unique_ptr < eutelescope::EUTelStripCommonMode > _kernels[ALIBAVA::NOOFCHIPS];
+
+	    AlibavaHisto1D _commonHisto;
+	    AlibavaHisto1D _signalHisto;
+
+    };
+
+    //! A global instance of the processor
+    AlibavaPedestalCommonModeSubtraction gAlibavaPedestalCommonModeSubtraction;
+}
+
+#endif
@@ -12,6 +12,10 @@
 
 // alibava includes ".h"
 #include "AlibavaBaseProcessor.h"
+#include "ALIBAVA.h"
+
+// eutelescope includes ".h"
+#include "EUTelRunningPedestalNoise.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -26,6 +30,7 @@
 // system includes <>
 #include <string>
 #include <list>
+#include <memory>
 
 namespace alibava
 {
@@ -71,6 +76,12 @@ namespace alibava
 	    //! The name of the fits used to calculate pedestal and noise
 	    std::string _chanDataFitName;
 
+	    //! The temperature histogram
+	    AlibavaHisto1D _temperatureHisto;
+
+	    //! The histograms used to calculate pedestal and noise, invalid for the masked channels
+	    AlibavaHisto1D _chanDataHistos[ALIBAVA::NOOFCHIPS][ALIBAVA::NOOFCHANNELS];
+
 	    //! The function that returns name of the histogram for each channel
 	    std::string getChanDataHistoName ( unsigned int ichip, unsigned int ichan );
 
@@ -86,6 +97,32 @@ namespace alibava
 	    //! Calculates and saves pedestal and noise values
 	    void calculatePedestalNoise ( );
 
+	    //! How pedestal and noise are estimated: "histogram" or "moments"
+	    /*! "histogram" fills a histogram per channel and fits a Gaussian to
+	     *  it at the end, "moments" only keeps the running mean and
+	     *  variance of each channel, see eutelescope::EUTelRunningPedestalNoise.
+	     *  The channel histograms are then not booked.
+	     */
+	    std::string _estimator;
+
+	    //! The maximum number of outlier rejection iterations of the moments estimator, 0 to switch it off
+	    int _rejectionIterations;
+
+	    //! The outlier rejection cut of the moments estimator, in units of noise
+	    float _rejectionCut;
+
+	    //! The number of events stored for the outlier rejection, 0 for all
+	    int _maxStoredEvents;
+
+	    //! The moments estimators, per chip
+	    std::unique_ptr < eutelescope::EUTelRunningPedestalNoise > _moments[ALIBAVA::NOOFCHIPS];
+
+	    //! Whether the moments estimator is used
+	    bool useMoments ( ) const
+	    {
+		return _estimator == "moments";
+	    }
+
     };
 
     //! A global instance of the processor
@@ -11,8 +11,19 @@
 // marlin includes ".h"
 #include "marlin/Processor.h"
 
+// eutelescope includes ".h"
+#include "EUTelStripClusterFinder.h"
+
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+// aida includes <.h>
+#include <AIDA/IHistogram1D.h>
+#endif
+
 // system includes <>
 #include <string>
+#include <map>
+#include <memory>
+#include <vector>
 
 namespace eutelescope
 {
@@ -68,6 +79,18 @@ namespace eutelescope
 
 	    std::map < std::string, AIDA::IBaseHistogram * > _aidaHistoMap;
 
+	    //! The histogram name + sensorID, nullptr if it was not booked
+	    AIDA::IHistogram1D * getHisto ( const std::string & name, int sensorID );
+
+	    //! Groups the hit strips, resized to the number of channels when needed
+	    std::unique_ptr < EUTelStripClusterFinder > _finder;
+
+	    //! The clusters of a sensor in the current event
+	    std::vector < EUTelStripClusterFinder::Cluster > _clusters;
+
+	    //! The strip signals rebuilt from zero suppressed data
+	    std::vector < float > _signal;
+
     };
 
     //! A global instance of the processor
@@ -8,6 +8,9 @@
 #ifndef CBCHITRECOVERY_H
 #define CBCHITRECOVERY_H 1
 
+// eutelescope includes ".h"
+#include "EUTelPointGrid.h"
+
 // marlin includes ".h"
 #include "marlin/Processor.h"
 
@@ -18,6 +21,7 @@
 // system includes <>
 #include <string>
 #include <map>
+#include <vector>
 
 namespace eutelescope
 {
@@ -83,6 +87,17 @@ namespace eutelescope
 
             std::map < std::string, AIDA::IBaseHistogram * > _aidaHistoMap;
 
+            //! Fill histoName with the residuals of the hits within range of trackX
+            void fillResiduals(const std::vector<double> &hitX, const std::vector<double> &hitY, double trackX, double range, const std::string &histoName);
+
+            //! The hits of a plane binned by position, and the ones near the track
+            EUTelPointGrid _hitGrid;
+            std::vector<size_t> _candidates;
+
+            //! Half range of the virtual and real DUT residual histograms, in mm
+            double _virtualResidualRange;
+            double _dutResidualRange;
+
     };
 
     //! A global instance of the processor
@@ -8,11 +8,15 @@
 #ifndef CMSBuncher_H
 #define CMSBuncher_H 1
 
+// eutelescope includes ".h"
+#include "EUTelTelescopeReader.h"
+
 // marlin includes ".h"
 #include "marlin/Processor.h"
 #include "marlin/DataSourceProcessor.h"
 
 // system includes <>
+#include <memory>
 #include <string>
 
 namespace eutelescope
@@ -33,31 +37,21 @@ namespace eutelescope
 
 	    virtual void end ( );
 
-	    bool _telescopeopen;
-
-	    LCEvent* _storeevt;
-
 	    std::string _telescopeFile;
 
-	    long _frametime;
-
 	    long _bunchtime;
 
 	    int _evtcount;
 
-	    bool _usestorageevent;
-
 	    int _singleframetime;
 
-	    int _maxevents;
+	    int _prefetchFrames;
 
 	    std::string _inputCollectionName;
 
 	    std::string _outputCollectionName;
 
-	    LCReader* lcReader;
-
-	    LCEvent *readTelescope ();
+	    std::unique_ptr < EUTelTelescopeReader > _telescopeReader;
 
 	protected:
 
@@ -8,10 +8,14 @@
 #ifndef CMSMERGER_H
 #define CMSMERGER_H 1
 
+// eutelescope includes ".h"
+#include "EUTelTelescopeReader.h"
+
 // marlin includes ".h"
 #include "marlin/Processor.h"
 
 // system includes <>
+#include <memory>
 #include <string>
 
 namespace eutelescope
@@ -34,25 +38,19 @@ namespace eutelescope
 
 	    bool _eventmerge;
 
-	    bool _telescopeopen;
-
 	    int _correlationPlaneID;
 
 	    int _eventdifferenceTelescope;
 
 	    int _eventdifferenceCBC;
 
-	    int _maxevents;
-
 	    int _multiplicity;
 
-	    int _readcount;
-
-	    LCEvent* _storeevt;
+	    int _prefetchFrames;
 
-	    LCEvent *readTelescope ( );
+	    EUTelTelescopeReader::FramePtr _storedFrame;
 
-	    LCReader* lcReader;
+	    std::unique_ptr < EUTelTelescopeReader > _telescopeReader;
 
 	    long _cbceventtime;
 
@@ -10,6 +10,7 @@
 
 // eutelescope includes ".h"
 #include "EUTelUtility.h"
+#include "EUTelPointGrid.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -17,6 +18,9 @@
 // lcio includes <.h>
 #include <EVENT/LCRunHeader.h>
 #include <EVENT/LCEvent.h>
+#include <IMPL/LCCollectionVec.h>
+#include <IMPL/TrackerDataImpl.h>
+#include <IMPL/TrackerHitImpl.h>
 
 // system includes <>
 #include <string>
@@ -76,8 +80,25 @@ namespace eutelescope
 
 	    int _totalpl2;
 
+	    //! Fill the correlation and failed distance plots with every hit pair, not only the ones within MaxResidual
+	    bool _fillAllPairHistograms;
+
 	    TrackerHitImpl* cloneHit ( TrackerHitImpl *inputHit );
 
+	    //! A DUT hit with the centre of gravity and the charge of its cluster
+	    struct StubHit
+	    {
+		TrackerHitImpl * hit;
+		TrackerDataImpl * cluster;
+		float x, y, q;
+	    };
+
+	    //! Decode the clusters of the hits at the given indices of the collection
+	    std::vector < StubHit > decodeHits ( LCCollectionVec * collection, const std::vector < int > & indices );
+
+	    //! The plane 2 hits of the event, binned by cluster position
+	    EUTelPointGrid _plane2Grid;
+
 	private:
 
     };
@@ -16,6 +16,7 @@
 // eutelescope includes ".h"
 #include "EUTELESCOPE.h"
 #include "EUTelExceptions.h"
+#include "EUTelFixedFrameClusterFinder.h"
 #include "EUTelGeometryTelescopeGeoDescription.h"
 
 // marlin includes ".h"
@@ -442,8 +443,15 @@ namespace eutelescope {
      *  range. For this reason, during the clustering, a check on the
      *  validity of the x, y pair is required.
      *
+     *  The search itself is done by an EUTelFixedFrameClusterFinder
+     *  per sensor, kept in _ffClusterFinderMap. It walks the cluster
+     *  window with a precomputed table of pixel offsets, and the x, y
+     *  validity check is done only for the seeds close enough to the
+     *  frame edge for the window to leave the matrix.
+     *
      *  @throw IncompatibleDataSetException in the case the two
-     *  collections are found to be incompatible
+     *  collections are found to be incompatible, or the frame size
+     *  differs from the geometry
      *
      *  @param evt The LCIO event has passed by processEvent(LCEvent*)
      *  @param pulse The collection of pulses to append the found
@@ -710,6 +718,15 @@ namespace eutelescope {
      */
     std::vector<std::pair<float, unsigned int>> _seedCandidateMap;
 
+    //! Fixed frame cluster finder of each sensorID
+    /*! Created at the first NZS frame of a sensor and kept, with its
+     *  buffers, for all the following events.
+     */
+    std::map<int, EUTelFixedFrameClusterFinder> _ffClusterFinderMap;
+
+    //! Clusters of the last fixed frame search
+    std::vector<EUTelFixedFrameClusterFinder::Cluster> _ffClusters;
+
     //! Total cluster found
     /*! This is a map correlating the sensorID number and the
      *  total number of clusters found on that sensor.
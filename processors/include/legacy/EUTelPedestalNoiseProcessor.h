@@ -28,6 +28,7 @@
 #include <cmath>
 #include <list>
 #include <string>
+#include <utility>
 
 namespace eutelescope {
 
@@ -97,6 +98,21 @@ namespace eutelescope {
    *  event. This is done only in the otherLoop because a first
    *  estimation of the noise is required.
    *
+   *  <h4>Single pass</h4>
+   *  Each loop is a full pass over the input, rewinding the data
+   *  files, so the default configuration reads the input three or
+   *  four times. Setting @a SinglePassMaxFrames to a positive value
+   *  the raw frames are instead read once and kept in memory, and
+   *  all the loops are done on this buffer. A frame takes one byte
+   *  per pixel, the difference from the first buffered frame, plus
+   *  a few bytes for each pixel differing by more than 127 ADC
+   *  counts: about 4 MB for a telescope of six Mimosa26.
+   *  The buffer is bounded: when it is full the frames read so far
+   *  are used, as if @a LastEvent was reached. The maximum and
+   *  minimum signals of the pre-loop are taken from the buffered
+   *  frames, without any additional pass, and only the MeanRMS
+   *  algorithm is available.
+   *
    *
    *  @since Since version v00-00-09 the geometrical information
    *  (namely the number of detectors and the min and max along X and
@@ -168,6 +184,9 @@ namespace eutelescope {
    *  <h2>Other controls</h2>
    *  @param FirstEvent First event to be used for pedestal calculation
    *  @param LastEvent Last event to be used for pedestal calculation
+   *  @param SinglePassMaxFrames Maximum number of frames buffered
+   *  for the single pass mode, 0 to loop over the input files. Each
+   *  frame takes about one byte per pixel
    *  @param OutputPedeFile Name of the output pedestal file
    *  @param ASCIIOutputSwitch To enable/disable the generation of
    *  ASCII output files
@@ -425,6 +444,8 @@ namespace eutelescope {
      *  EORE or when the MaxRecordNumber was set to low to loop over
      *  all the needed record. To check this is very easy because we
      *  just have to crosscheck if _iLoop is equal to noOfCMIterations.
+     *  In the single pass mode, this error cannot occur: the frames
+     *  still in the buffer are used here.
      */
     virtual void end();
 
@@ -482,6 +503,56 @@ namespace eutelescope {
     //! Simple rewind
     virtual void simpleRewind();
 
+    //! Buffer the frame of the current event
+    /*! Used instead of the loops when _singlePassMaxFrames is
+     *  positive. It stores the ADC values of all the detectors into
+     *  _frameBuffer, as differences from _referenceFrame, and calls
+     *  processFrameBuffer() when the event range is over or the
+     *  buffer is full.
+     *
+     *  @param event The current LCEvent.
+     */
+    void bufferFrame(LCEvent *event);
+
+    //! Do all the loops on the buffered frames
+    /*! The same sequence of loops as with the rewind, each loop
+     *  ending with finalizeProcessor(bool) which finally writes the
+     *  output file.
+     *
+     *  @throw StopProcessingException when the output file is written
+     */
+    void processFrameBuffer();
+
+    //! ADC values of some consecutive pixels of a buffered frame
+    /*! @param iFrame The buffered frame
+     *  @param first The first pixel in the frame
+     *  @param nPixel The number of pixels
+     *  @param adcValues Output array of at least nPixel values
+     */
+    void decodeFrame(size_t iFrame, size_t first, size_t nPixel,
+                     short *adcValues) const;
+
+    //! Pedestal and noise from the buffered frames
+    /*! One loop over the buffer with per pixel sums of the signal and
+     *  of its square, the result goes into _tempPede and _tempNoise.
+     *
+     *  @param commonModeSuppression false for the first loop, true
+     *  for the common mode iterations which also reject the hit
+     *  candidates and the bad pixels
+     */
+    void accumulateFrames(bool commonModeSuppression);
+
+    //! Common mode of a detector in a buffered frame
+    /*! The per pixel correction is written into _commonModeCor with
+     *  the same algorithms as otherLoop(LCEvent*).
+     *
+     *  @return false if the frame has to be skipped for this detector
+     */
+    bool frameCommonMode(size_t iDetector, short const *adcValues);
+
+    //! Additional masking loop on the buffered frames
+    void countFiringFrames();
+
     //! Initialize the geometry
     /*! This method is used to get from the current event.
      *
@@ -995,6 +1066,56 @@ namespace eutelescope {
 
     //! Additional bad masking loop
     bool _additionalMaskingLoop;
+
+    //! Maximum number of buffered frames, 0 to loop over the input
+    int _singlePassMaxFrames;
+
+    //! The buffered frames
+    /*! One frame after the other, each frame being the ADC values of
+     *  all the detectors one after the other, minus the ones of
+     *  _referenceFrame. The differences out of the 8 bit range are
+     *  replaced by _frameEscape and kept in _escapedValues.
+     */
+    std::vector<signed char> _frameBuffer;
+
+    //! The first buffered frame
+    ShortVec _referenceFrame;
+
+    //! The ADC values not fitting into _frameBuffer
+    /*! The pixel in the frame and its ADC value, sorted by frame and
+     *  by pixel.
+     */
+    std::vector<std::pair<unsigned int, short>> _escapedValues;
+
+    //! First escaped value of each buffered frame, plus the total
+    std::vector<size_t> _escapeOffset;
+
+    //! The mark of an escaped value in _frameBuffer
+    static signed char const _frameEscape = -128;
+
+    //! A decoded frame
+    ShortVec _decodedFrame;
+
+    //! Number of buffered frames
+    size_t _nFrames;
+
+    //! Number of pixels of a frame
+    size_t _frameSize;
+
+    //! Position of each detector in a frame, plus the frame size
+    std::vector<size_t> _pixelOffset;
+
+    //! Frame with the maximum signal of each pixel, -1 without pre-loop
+    std::vector<int> _maxFrame;
+
+    //! Frame with the minimum signal of each pixel, -1 without pre-loop
+    std::vector<int> _minFrame;
+
+    //! Frames skipped by the common mode in any loop
+    std::vector<char> _skippedFrame;
+
+    //! Common mode correction of each pixel of a detector
+    FloatVec _commonModeCor;
   };
 
   //! A global instance of the processor
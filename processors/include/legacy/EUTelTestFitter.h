@@ -85,7 +85,9 @@ namespace eutelescope {
    *  \li Calculate number of fit hypothesis (including missing hit possibility)
    *  \li Search the list of fit hypotheses to find the one with best
    *     \f$ \chi^{2} \f$ (including ``penalties'' for missing hits or
-   *     skipped planes)
+   *     skipped planes). Hypotheses are built plane by plane: the fit
+   *     of a partial track predicts its position in the next planes
+   *     and the hits too far from it (see below) are not considered
    *  \li Accept the fit if \f$ \chi^{2} \f$ is below threshold
    *  \li Write fitted track to output \c Track collection; measured
    *     particle positions corrected for alignment and fitted positions
@@ -288,6 +290,15 @@ namespace eutelescope {
    *      small, so preselection parameters \e  SlopeDistanceMax
    *      \e SlopeXLimit and  \e SlopeYLimit  can be set to small values)
    *
+   * \li The fit of each partial track gives the lowest \f$ \chi^{2} \f$
+   *     of any track obtained by adding hits to it: \f$ \chi^{2} \f$
+   *     increases by \f$ r^{2}/(\sigma^{2}_{hit}+\sigma^{2}_{fit}) \f$
+   *     for a hit at distance \f$ r \f$ from the predicted position.
+   *     Hits which would bring the partial track above \e Chi2Max are
+   *     skipped together with all hypotheses including them. This
+   *     does not change the reconstructed tracks, but is only
+   *     efficient if \e Chi2Max is not too large.
+   *
    * \li Do not allow for missing hits (set \e AllowMissingHits to 0).
    *     This reduces number of fit hypothesis and improves fit performance.
    *
@@ -422,6 +433,16 @@ namespace eutelescope {
     //! Solve matrix equation
     int GaussjSolve(double *alfa, double *beta, int n);
 
+    //! Store the last fit as partial track ending in plane \c lastPlane
+    void StorePartialFit(int lastPlane, double chi2);
+
+    //! \f$ \chi^{2} \f$ of the partial track ending in plane
+    //! \c lastPlane extended by the hit selected in plane \c plane
+    /*! This is the \f$ \chi^{2} \f$ the full fit would give, computed
+     *  from the position and error predicted by the partial fit.
+     */
+    double ExtendedChi2(int lastPlane, int plane) const;
+
     //! Silicon planes parameters as described in GEAR
     /*! This structure actually contains the following:
      *  @li A reference to the telescope geoemtry and layout
@@ -557,6 +578,16 @@ namespace eutelescope {
     int *_planeChoice;
     type_fitcount *_planeMod;
 
+    // Fits of the partial tracks, indexed by their last fired plane
+    // (negative chi2 if not fitted), with the fitted positions and
+    // errors in all planes
+
+    double *_partialChi2;
+    double *_partialFitX;
+    double *_partialFitEx;
+    double *_partialFitY;
+    double *_partialFitEy;
+
     // Fitting algorithm arrays
 
     double *_planeX;
@@ -156,6 +156,20 @@ void EUTelCorrelator::init() {
        static_cast<int>(it - _sensorIDVec.begin())));
   }
 
+  //sensor ID -> position lookup and the geometry used by guessSensorOffset
+  for(size_t index = 0; index < _sensorIDVec.size(); ++index) {
+    int const sensorID = _sensorIDVec[index];
+    if(sensorID < 0) continue;
+    if(static_cast<size_t>(sensorID) >= _sensorIndex.size()) {
+      _sensorIndex.resize(static_cast<size_t>(sensorID) + 1, -1);
+    }
+    _sensorIndex[static_cast<size_t>(sensorID)] = static_cast<int>(index);
+    _offsetTerms.push_back(SensorOffsetTerms{
+	geo::gGeometry().getPlaneXPitch(sensorID), geo::gGeometry().getPlaneYPitch(sensorID),
+	geo::gGeometry().getPlaneXPosition(sensorID) + geo::gGeometry().getPlaneXSize(sensorID) / 2.,
+	geo::gGeometry().getPlaneYPosition(sensorID) + geo::gGeometry().getPlaneYSize(sensorID) / 2.});
+  }
+
   //reset run and event counters
   _iRun = 0;
   _iEvt = 0;
@@ -269,303 +283,161 @@ void EUTelCorrelator::processEvent(LCEvent *event) {
     _isInitialize = true;
   }
   
-  //[IF] hasCluster
-  if(_hasClusterCollection && !_hasHitCollection) {
-    
-    //[START] loop over collection (external)
-    for(size_t eCol = 0; eCol < _clusterCollectionVec.size(); eCol++) {
-    
-      std::string externalInputClusterCollectionName =
-	_clusterCollectionVec[eCol];
-      
-      LCCollectionVec *externalInputClusterCollection =
-	static_cast<LCCollectionVec *>(
-	   event->getCollection(externalInputClusterCollectionName));
-      CellIDDecoder<TrackerPulseImpl> pulseCellDecoder(
-          externalInputClusterCollection);
-
-      //[START] loop over cluster (external)
-      for(size_t iExt = 0; iExt < externalInputClusterCollection->size();
-	  ++iExt) {
+  size_t const nSensors = _sensorIDVec.size();
 
-        TrackerPulseImpl *externalPulse = static_cast<TrackerPulseImpl *>(
-            externalInputClusterCollection->getElementAt(iExt));
-
-        EUTelVirtualCluster *externalCluster;
-
-        ClusterType type = static_cast<ClusterType>(
-            static_cast<int>((pulseCellDecoder(externalPulse)["type"])));
-	
-        //check that the type of cluster is ok
-        if(type == kEUTelDFFClusterImpl) {
-          externalCluster = new EUTelDFFClusterImpl(
-              static_cast<TrackerDataImpl *>(externalPulse->getTrackerData()));
-        } else if(type == kEUTelBrickedClusterImpl) {
-          externalCluster = new EUTelBrickedClusterImpl(
-              static_cast<TrackerDataImpl *>(externalPulse->getTrackerData()));
-        } else if(type == kEUTelFFClusterImpl) {
-          externalCluster = new EUTelFFClusterImpl(
-              static_cast<TrackerDataImpl *>(externalPulse->getTrackerData()));
-        } else if(type == kEUTelSparseClusterImpl) {
-          externalCluster = new EUTelSparseClusterImpl<EUTelGenericSparsePixel>(
-              static_cast<TrackerDataImpl *>(externalPulse->getTrackerData()));
-          if(externalCluster != nullptr &&
-              externalCluster->getTotalCharge() < _clusterChargeMin) {
-            delete externalCluster;
-            continue;
-          }
-        } else {
-          continue;
-        }	
-
-        int externalSensorID = pulseCellDecoder(externalPulse)["sensorID"];
-
-        streamlog_out(DEBUG1) << "externalSensorID : " << externalSensorID
-                              << " externalCluster=" << externalCluster
-                              << std::endl;
-
-	//get coordinates of external seed
-        float externalXCenter = 0.;
-        float externalYCenter = 0.;
-        externalCluster->getCenterOfGravity(externalXCenter, externalYCenter);
-        
-        //check minimal charge requirement
-        if(externalCluster->getTotalCharge() <= _clusterChargeMin) {
-          delete externalCluster;
-          continue;
-        }
-
-	//[START] loop over collection (internal)
-        for(size_t iCol = 0; iCol < _clusterCollectionVec.size(); iCol++) {
-        
-          std::string internalInputClusterCollectionName =
-              _clusterCollectionVec[iCol];
-
-          LCCollectionVec *internalInputClusterCollection =
-              static_cast<LCCollectionVec *>(
-                  event->getCollection(internalInputClusterCollectionName));
-          CellIDDecoder<TrackerPulseImpl> pulseCellDecoder(
-              internalInputClusterCollection);
-
-	  //[START] loop over cluster (internal)
-          for(size_t iInt = 0; iInt < internalInputClusterCollection->size();
-               ++iInt) {
-
-            TrackerPulseImpl *internalPulse = static_cast<TrackerPulseImpl *>(
-                internalInputClusterCollection->getElementAt(iInt));
-
-            EUTelVirtualCluster *internalCluster;
-
-            ClusterType type = static_cast<ClusterType>(
-                static_cast<int>((pulseCellDecoder(internalPulse)["type"])));
-
-            //check that the type of cluster is ok
-            if(type == kEUTelDFFClusterImpl) {
-              internalCluster =
-                  new EUTelDFFClusterImpl(static_cast<TrackerDataImpl *>(
-                      internalPulse->getTrackerData()));
-            } else if(type == kEUTelBrickedClusterImpl) {
-              internalCluster =
-                  new EUTelBrickedClusterImpl(static_cast<TrackerDataImpl *>(
-                      internalPulse->getTrackerData()));
-            } else if(type == kEUTelFFClusterImpl) {
-              internalCluster =
-                  new EUTelFFClusterImpl(static_cast<TrackerDataImpl *>(
-                      internalPulse->getTrackerData()));
-            } else if(type == kEUTelSparseClusterImpl) {
-              internalCluster =
-                  new EUTelSparseClusterImpl<EUTelGenericSparsePixel>(
-                      static_cast<TrackerDataImpl *>(
-                          internalPulse->getTrackerData()));
-              if(internalCluster != nullptr &&
-                  internalCluster->getTotalCharge() < _clusterChargeMin) {
-                delete internalCluster;
-                continue;
-              }
-            } else {
-              continue;
-			}
-			
-	    //check charge requirement
-            if(internalCluster->getTotalCharge() < _clusterChargeMin) {
-              delete internalCluster;
-              continue;
-            }
-
-            int internalSensorID = pulseCellDecoder(internalPulse)["sensorID"];
-
-            if((internalSensorID != getFixedPlaneID() &&
-                externalSensorID == getFixedPlaneID()) ||
-	       (_sensorIDtoZ.at(internalSensorID) >
-		_sensorIDtoZ.at(externalSensorID))) {
-	      
-	      //get coordinates of internal seed
-              float internalXCenter = 0.;
-              float internalYCenter = 0.;
-              internalCluster->getCenterOfGravity(internalXCenter,
-                                                  internalYCenter);
-
-              streamlog_out(DEBUG5) << "Filling histo for " 
-              << "extID " << externalSensorID << " and intID " 
-	      << internalSensorID << std::endl;
-              
-              //input coordinates in correlation matrix (for X and Y)
-              _clusterXCorrelationMatrix[externalSensorID][internalSensorID]
-                  ->fill(externalXCenter, internalXCenter);
-              _clusterYCorrelationMatrix[externalSensorID][internalSensorID]
-                  ->fill(externalYCenter, internalYCenter);    
-              streamlog_out(MESSAGE1)
-                  << " ex " << externalSensorID << " = [" << externalXCenter
-                  << ":" << externalYCenter << "]"
-                  << " in " << internalSensorID << " = [" << internalXCenter
-                  << ":" << internalYCenter << "]" << std::endl;
-            }
-
-            delete internalCluster;
-          }//[END] loop over cluster (internal)
-        }//[END] loop over collection (internal)
-
-        delete externalCluster;
-      }//[END] loop over cluster (external)
-    }//[END] loop over collection (external)
+  //the histograms are booked for the collections of the first event only
+  //[IF] hasCluster
+  if(_hasClusterCollection && !_hasHitCollection && !_clusterXPairs.empty()) {
+    cacheClusters(event);
+    float const chargeMin = static_cast<float>(_clusterChargeMin);
+
+    //[START] loop over sensor pairs
+    for(size_t from = 0; from < nSensors; ++from) {
+      for(size_t to = 0; to < nSensors; ++to) {
+	auto xHisto = _clusterXPairs[from * nSensors + to];
+	auto yHisto = _clusterYPairs[from * nSensors + to];
+	if(xHisto == nullptr) continue;
+
+	CachedPoint const *external = _clusterCache.begin(from);
+	CachedPoint const *internal = _clusterCache.begin(to);
+	size_t const nExternal = _clusterCache.size(from);
+	size_t const nInternal = _clusterCache.size(to);
+	for(size_t iExt = 0; iExt < nExternal; ++iExt) {
+	  //the external clusters need more than the minimal charge
+	  if(external[iExt].charge <= chargeMin) continue;
+	  for(size_t iInt = 0; iInt < nInternal; ++iInt) {
+	    if(internal[iInt].charge < chargeMin) continue;
+	    xHisto->fill(external[iExt].x, internal[iInt].x);
+	    yHisto->fill(external[iExt].y, internal[iInt].y);
+	  }
+	}
+      }
+    }//[END] loop over sensor pairs
   }//[ENDIF] hasCluster
   
   //[IF] hasCollection
-  if(_hasHitCollection) {
-
-    LCCollectionVec *inputHitCollection = static_cast<LCCollectionVec *>(
-        event->getCollection(_inputHitCollectionName));
-    UTIL::CellIDDecoder<TrackerHitImpl> hitDecoder(EUTELESCOPE::HITENCODING);
+  if(_hasHitCollection && !_hitXPairs.empty()) {
+    cacheHits(event);
+
+    //[START] loop over sensors (external)
+    for(size_t from = 0; from < nSensors; ++from) {
+      CachedPoint const *external = _hitCache.begin(from);
+      for(size_t iExt = 0; iExt < _hitCache.size(from); ++iExt) {
+	CachedPoint const &ext = external[iExt];
+
+	//collect the hits of the other planes within the correlation band
+	_correlatedHits.clear();
+	for(size_t to = 0; to < nSensors; ++to) {
+	  if(_hitXPairs[from * nSensors + to] == nullptr) continue;
+	  float const xMin = _residualsXMin[to], xMax = _residualsXMax[to];
+	  float const yMin = _residualsYMin[to], yMax = _residualsYMax[to];
+	  CachedPoint const *internal = _hitCache.begin(to);
+	  for(size_t iInt = 0; iInt < _hitCache.size(to); ++iInt) {
+	    double const dx = static_cast<double>(ext.x) - internal[iInt].x;
+	    double const dy = static_cast<double>(ext.y) - internal[iInt].y;
+	    if(dx < xMax && xMin < dx && dy < yMax && yMin < dy) {
+	      _correlatedHits.emplace_back(to, internal[iInt]);
+	    }
+	  }
+	}
+
+	//[IF] check for minimal number of correlated hits, the external one included
+	if(static_cast<int>(_correlatedHits.size()) + 1 > _minNumberOfCorrelatedHits) {
+	  for(auto const &correlated : _correlatedHits) {
+	    size_t const pair = from * nSensors + correlated.first;
+	    CachedPoint const &in = correlated.second;
+	    _hitXPairs[pair]->fill(ext.x, in.x);
+	    _hitYPairs[pair]->fill(ext.y, in.y);
+	    //assumption: all rotations were done in hitmaker processor
+	    _hitXShiftPairs[pair]->fill(ext.x, ext.x - in.x);
+	    _hitYShiftPairs[pair]->fill(ext.y, ext.y - in.y);
+	  }
+	}//[ENDIF]
+      }
+    }//[END] loop over sensors (external)
+  }//[ENDIF] hasCollection
+#endif
+}
 
-    streamlog_out(MESSAGE2) << "inputHitCollection "
-                            << _inputHitCollectionName.c_str() << std::endl;
+void EUTelCorrelator::PointCache::group(size_t nSensors) {
+  //counting sort: start[s] becomes the first entry of sensor s
+  start.assign(nSensors + 1, 0);
+  for(auto const &entry : decoded) ++start[entry.first + 1];
+  for(size_t sensor = 0; sensor < nSensors; ++sensor) start[sensor + 1] += start[sensor];
+
+  //start[s] is used as the insertion point, it ends as the first entry of s + 1
+  points.resize(decoded.size());
+  for(auto const &entry : decoded) points[start[entry.first]++] = entry.second;
+  for(size_t sensor = nSensors; sensor > 0; --sensor) start[sensor] = start[sensor - 1];
+  start[0] = 0;
+}
 
-    //[START] loop over collection (external) 
-    for(size_t iExt = 0; iExt < inputHitCollection->size(); ++iExt) {
-    
-      std::vector<double> trackXVec;
-      std::vector<double> trackYVec;
-      std::vector<int> planeIDVec;
-      trackXVec.clear();
-      trackYVec.clear();
-      planeIDVec.clear();
-
-      //get external hit
-      TrackerHitImpl *externalHit =
-          static_cast<TrackerHitImpl *>(inputHitCollection->getElementAt(iExt));
-      double *externalPosition =
-          const_cast<double *>(externalHit->getPosition());
-      int externalSensorID = hitDecoder(externalHit)["sensorID"];
-      double etrackPointLocal[] = {externalPosition[0], externalPosition[1],
-                                   externalPosition[2]};
-      double etrackPointGlobal[] = {externalPosition[0], externalPosition[1],
-                                    externalPosition[2]};
-
-      //check for coordinate system
-      if(hitDecoder(externalHit)["properties"] != kHitInGlobalCoord) {
-      	//transfer to global frame
-        geo::gGeometry().local2Master(externalSensorID, etrackPointLocal,
-                                      etrackPointGlobal);
+void EUTelCorrelator::cacheClusters(LCEvent *event) {
+  _clusterCache.decoded.clear();
+
+  //[START] loop over collections
+  for(auto const &collectionName : _clusterCollectionVec) {
+    LCCollectionVec *collection = static_cast<LCCollectionVec *>(event->getCollection(collectionName));
+    CellIDDecoder<TrackerPulseImpl> pulseCellDecoder(collection);
+
+    //[START] loop over clusters
+    for(size_t iPulse = 0; iPulse < collection->size(); ++iPulse) {
+      TrackerPulseImpl *pulse = static_cast<TrackerPulseImpl *>(collection->getElementAt(static_cast<int>(iPulse)));
+      int const index = sensorIndex(pulseCellDecoder(pulse)["sensorID"]);
+      if(index < 0) continue;
+
+      ClusterType type = static_cast<ClusterType>(static_cast<int>(pulseCellDecoder(pulse)["type"]));
+      TrackerDataImpl *data = static_cast<TrackerDataImpl *>(pulse->getTrackerData());
+      CachedPoint point = {0.f, 0.f, 0.f};
+
+      //decode the cluster on the stack, its centre of gravity is computed once
+      auto decode = [&point](EUTelVirtualCluster const &cluster) {
+	cluster.getCenterOfGravity(point.x, point.y);
+	point.charge = cluster.getTotalCharge();
+      };
+      if(type == kEUTelDFFClusterImpl) {
+	decode(EUTelDFFClusterImpl(data));
+      } else if(type == kEUTelBrickedClusterImpl) {
+	decode(EUTelBrickedClusterImpl(data));
+      } else if(type == kEUTelFFClusterImpl) {
+	decode(EUTelFFClusterImpl(data));
+      } else if(type == kEUTelSparseClusterImpl) {
+	decode(EUTelSparseClusterImpl<EUTelGenericSparsePixel>(data));
       } else {
-        //do nothing, already in global telescope frame
+	continue;
       }
+      _clusterCache.decoded.emplace_back(static_cast<size_t>(index), point);
+    }//[END] loop over clusters
+  }//[END] loop over collections
 
-      trackXVec.push_back(etrackPointGlobal[0]);
-      trackYVec.push_back(etrackPointGlobal[1]);
-      planeIDVec.push_back(externalSensorID);
-
-      streamlog_out(MESSAGE2)
-          << "extPlane:" << externalSensorID << " at local position: " << etrackPointLocal[0]
-          << " " << etrackPointLocal[1]
-          << " and global position: " << etrackPointGlobal[0] << " " << etrackPointGlobal[1]
-          << std::endl;
-
-      //[START] loop over collection (internal)
-      for(size_t iInt = 0; iInt < inputHitCollection->size(); ++iInt) {
-
-        TrackerHitImpl *internalHit = static_cast<TrackerHitImpl *>(
-            inputHitCollection->getElementAt(iInt));
-
-        double *internalPosition =
-            const_cast<double *>(internalHit->getPosition());
-        int internalSensorID = hitDecoder(internalHit)["sensorID"];
-        double itrackPointLocal[] = {internalPosition[0], internalPosition[1],
-                                     internalPosition[2]};
-        double itrackPointGlobal[] = {internalPosition[0], internalPosition[1],
-                                      internalPosition[2]};
-
-	//check for coordinate system
-        if(hitDecoder(internalHit)["properties"] != kHitInGlobalCoord) {
-	  //transfer to global frame
-          geo::gGeometry().local2Master(internalSensorID, itrackPointLocal,
-                                        itrackPointGlobal);
-        } else {
-          //do nothing, already in global telescope frame
-        }
-
-	//[IF] check planes
-	if((internalSensorID != getFixedPlaneID() &&
-	    externalSensorID == getFixedPlaneID()) ||
-	   (_sensorIDtoZ.at(internalSensorID) >
-	    _sensorIDtoZ.at(externalSensorID))) {
-
-          int iz = _sensorIDtoZ.at(internalSensorID);
-
-	  //[IF] check residual requirement
-          if(((etrackPointGlobal[0] - itrackPointGlobal[0]) <
-               _residualsXMax[iz]) &&
-	     (_residualsXMin[iz] <
-               (etrackPointGlobal[0] - itrackPointGlobal[0])) &&
-	     ((etrackPointGlobal[1] - itrackPointGlobal[1]) <
-               _residualsYMax[iz]) &&
-	     (_residualsYMin[iz] <
-	      (etrackPointGlobal[1] - itrackPointGlobal[1]))) {
-
-            trackXVec.push_back(itrackPointGlobal[0]);
-            trackYVec.push_back(itrackPointGlobal[1]);
-            planeIDVec.push_back(internalSensorID);
-	    
-            streamlog_out(MESSAGE2) << "intPlane:" << internalSensorID
-                                    << " at loc position: " << itrackPointLocal[0] << " "
-                                    << itrackPointLocal[1] 
-                                    << " and global position: " << itrackPointGlobal[0] << " "
-                                    << itrackPointGlobal[1] << std::endl;
-          }//[ENDIF] check residual requirement
-        }//[ENDIF] check planes
-      }//[END] loop over collection (internal)
-
-      std::vector<int> planeID_unique = planeIDVec;          
-      
-      //remove duplicates
-      std::vector<int>::iterator p_end;
-      
-      p_end = unique(planeID_unique.begin(),planeID_unique.end()); 
-      //FIXME: should there be real erasing, change function... (jha92)
-      //planeID_unique.erase(p_end,planeID_unique.end());
-      
-      //[IF] check for minimal number of correlated hits
-      if(static_cast<int>(planeID_unique.size()) > _minNumberOfCorrelatedHits &&
-          trackXVec.size() == trackYVec.size()) {
-                        
-        size_t indexPlane = 0;
-        
-          for(size_t i = 0; i < trackXVec.size(); i++) {
-            if(i == indexPlane) continue; //skip as this one is not booked
-            
-            _hitXCorrelationMatrix[planeIDVec[indexPlane]][planeIDVec[i]]->fill(
-                trackXVec[indexPlane], trackXVec[i]);
-            _hitYCorrelationMatrix[planeIDVec[indexPlane]][planeIDVec[i]]->fill(
-                trackYVec[indexPlane], trackYVec[i]);
-            //assumption: all rotations were done in hitmaker processor
-            _hitXCorrShiftMatrix[planeIDVec[indexPlane]][planeIDVec[i]]->fill(
-                trackXVec[indexPlane], trackXVec[indexPlane] - trackXVec[i]);
-            _hitYCorrShiftMatrix[planeIDVec[indexPlane]][planeIDVec[i]]->fill(
-                trackYVec[indexPlane], trackYVec[indexPlane] - trackYVec[i]);
-          }
-      } //[ENDIF]
-    }//[END] loop over collection (external)
-  }//[ENDIF] hasCollection
-#endif
+  _clusterCache.group(_sensorIDVec.size());
+}
+
+void EUTelCorrelator::cacheHits(LCEvent *event) {
+  _hitCache.decoded.clear();
+
+  LCCollectionVec *inputHitCollection = static_cast<LCCollectionVec *>(event->getCollection(_inputHitCollectionName));
+  UTIL::CellIDDecoder<TrackerHitImpl> hitDecoder(EUTELESCOPE::HITENCODING);
+
+  //[START] loop over hits
+  for(size_t iHit = 0; iHit < inputHitCollection->size(); ++iHit) {
+    TrackerHitImpl *hit = static_cast<TrackerHitImpl *>(inputHitCollection->getElementAt(static_cast<int>(iHit)));
+    auto const &decoded = hitDecoder(hit);
+    int const sensorID = decoded["sensorID"];
+    int const index = sensorIndex(sensorID);
+    if(index < 0) continue;
+
+    double globalPosition[3] = {hit->getPosition()[0], hit->getPosition()[1], hit->getPosition()[2]};
+    //check for coordinate system, transfer to the global frame if needed
+    if(decoded["properties"] != kHitInGlobalCoord) {
+      geo::gGeometry().local2Master(sensorID, hit->getPosition(), globalPosition);
+    }
+    _hitCache.decoded.emplace_back(static_cast<size_t>(index),
+				   CachedPoint{static_cast<float>(globalPosition[0]),
+					       static_cast<float>(globalPosition[1]), 0.f});
+  }//[END] loop over hits
+
+  _hitCache.group(_sensorIDVec.size());
 }
 
 void EUTelCorrelator::end() {
@@ -764,6 +636,27 @@ void EUTelCorrelator::bookHistos() {
         _hitYCorrShiftMatrix[fromID] = innerMapYHitShift;
       }//[END] loop over sensors (from)
     }//[ENDIF] hit correlation
+
+    //pair tables of the event loop, nullptr for the pairs without histograms
+    size_t const nSensors = _sensorIDVec.size();
+    auto pairTable = [this, nSensors](std::map<unsigned int, std::map<unsigned int, AIDA::IHistogram2D *>> &matrix,
+				      std::vector<AIDA::IHistogram2D *> &table) {
+      table.assign(nSensors * nSensors, nullptr);
+      for(size_t from = 0; from < nSensors; ++from) {
+	auto const fromHistos = matrix.find(static_cast<unsigned int>(_sensorIDVec[from]));
+	if(fromHistos == matrix.end()) continue;
+	for(size_t to = 0; to < nSensors; ++to) {
+	  auto const histo = fromHistos->second.find(static_cast<unsigned int>(_sensorIDVec[to]));
+	  if(histo != fromHistos->second.end()) table[from * nSensors + to] = histo->second;
+	}
+      }
+    };
+    pairTable(_clusterXCorrelationMatrix, _clusterXPairs);
+    pairTable(_clusterYCorrelationMatrix, _clusterYPairs);
+    pairTable(_hitXCorrelationMatrix, _hitXPairs);
+    pairTable(_hitYCorrelationMatrix, _hitYPairs);
+    pairTable(_hitXCorrShiftMatrix, _hitXShiftPairs);
+    pairTable(_hitYCorrShiftMatrix, _hitYShiftPairs);
     
   } catch(lcio::Exception &e) {
 
@@ -775,60 +668,26 @@ void EUTelCorrelator::bookHistos() {
 }
 
 std::vector<double> EUTelCorrelator::guessSensorOffset(int internalSensorID, int externalSensorID,
-						       std::vector<double> cluCenter) {
-  double internalXCenter = cluCenter.at(0);
-  double internalYCenter = cluCenter.at(1);
-  double externalXCenter = cluCenter.at(2);
-  double externalYCenter = cluCenter.at(3);
-
-  double xDet_in =
-    internalXCenter * geo::gGeometry().getPlaneXPitch(internalSensorID);
-  double yDet_in =
-    internalYCenter * geo::gGeometry().getPlaneYPitch(internalSensorID);
-  double xDet_ex =
-    externalXCenter * geo::gGeometry().getPlaneXPitch(externalSensorID);
-  double yDet_ex =
-    externalYCenter * geo::gGeometry().getPlaneYPitch(externalSensorID);
-  
-  double xCoo_in = internalXCenter;
-  double yCoo_in = internalYCenter;
-  
-  //get rotated sensors coordinates (in mm or um)
-  double xPos_in = xDet_in;
-  double yPos_in = yDet_in;
-  double xPos_ex = xDet_ex;
-  double yPos_ex = yDet_ex;
-  
-  double xCooPos_in = xCoo_in;
-  double yCooPos_in = yCoo_in;
-  
-  //get rotated sensor coordinates (only in pixel number: col number)
-  xPos_in += geo::gGeometry().getPlaneXPosition(internalSensorID) +
-    geo::gGeometry().getPlaneXSize(internalSensorID) / 2.;
-  
-  xCooPos_in = xCooPos_in;
-  
-  yPos_in += geo::gGeometry().getPlaneYPosition(internalSensorID) +
-    geo::gGeometry().getPlaneYSize(internalSensorID) / 2.;
-  
-  yCooPos_in = yCooPos_in;
-  
-  xPos_ex += geo::gGeometry().getPlaneXPosition(externalSensorID) +
-    geo::gGeometry().getPlaneXSize(externalSensorID) / 2.;
-  
-  yPos_ex += geo::gGeometry().getPlaneYPosition(externalSensorID) +
-    geo::gGeometry().getPlaneYSize(externalSensorID) / 2.;
-  
-  std::vector<double> cluster_offset;
-  
-  cluster_offset.push_back(-(xPos_in - xPos_ex));
-  cluster_offset.push_back(-(yPos_in - yPos_ex));
-  
-  //add also internal sensor X and Y coord
-  cluster_offset.push_back(xCooPos_in);
-  cluster_offset.push_back(yCooPos_in);
-
-  return cluster_offset;
+						       CachedPoint const &internalCluster,
+						       CachedPoint const &externalCluster) const {
+  int const internalIndex = sensorIndex(internalSensorID);
+  int const externalIndex = sensorIndex(externalSensorID);
+  if(internalIndex < 0 || externalIndex < 0) {
+    throw InvalidParameterException("No sensor offset for the excluded or unknown sensors " +
+				    std::to_string(internalSensorID) + " and " + std::to_string(externalSensorID));
+  }
+  SensorOffsetTerms const &in = _offsetTerms[static_cast<size_t>(internalIndex)];
+  SensorOffsetTerms const &ex = _offsetTerms[static_cast<size_t>(externalIndex)];
+
+  //position of the cluster centres on the sensors, from the centre of the sensor
+  double const xPos_in = internalCluster.x * in.xPitch + in.xCentre;
+  double const yPos_in = internalCluster.y * in.yPitch + in.yCentre;
+  double const xPos_ex = externalCluster.x * ex.xPitch + ex.xCentre;
+  double const yPos_ex = externalCluster.y * ex.yPitch + ex.yCentre;
+
+  //offsets, then the internal sensor X and Y coord (pixel number)
+  return std::vector<double>{-(xPos_in - xPos_ex), -(yPos_in - yPos_ex),
+			     internalCluster.x, internalCluster.y};
 }
 
 #endif // USE_GEAR
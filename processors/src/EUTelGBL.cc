@@ -73,6 +73,14 @@ using namespace lcio;
 using namespace marlin;
 using namespace eutelescope;
 
+namespace {
+  //! Scatterers with less material are left out of the trajectory
+  /*! A gap of zero length or a sensor in vacuum would otherwise give a
+   *  vanishing scattering angle and an infinite weight.
+   */
+  constexpr double minScatteringRadLength = 1e-7;
+}
+
 EUTelGBL::EUTelGBL(): Processor("EUTelGBL") {
 
   _description = "EUTelGBL uses the MILLE program to write data files for MILLEPEDE II.";
@@ -167,6 +175,12 @@ EUTelGBL::EUTelGBL(): Processor("EUTelGBL") {
 			    _dumpTracks,
 			    1);
 
+  registerOptionalParameter("columnarOutputFile",
+			    "File to write the tracks, kinks, hits and residuals of every plane to as columns "
+			    "(readable with EUTelColumnarReader), empty for none",
+			    _columnarOutputFile,
+			    std::string{});
+
   registerOptionalParameter("fixedXShift",
 			    "List of planes which should be fixed in X direction",
 			    _FixedXShift,
@@ -247,6 +261,27 @@ EUTelGBL::EUTelGBL(): Processor("EUTelGBL") {
 			    "Name of the steering file for the pede program",
 			    _pedeSteerfileName,
 			    std::string{"steer_mille.txt"});
+
+  registerOptionalParameter("NumberOfThreads",
+			    "Number of threads used to fit the tracks of an event in parallel (1 == serial)",
+			    _nThreads,
+			    1);
+
+  registerOptionalParameter("trackDependentMaterial",
+			    "Set to 1 to compute the scattering of every track from the material along its direction "
+			    "instead of using a fixed material budget per plane",
+			    _trackDependentMaterial,
+			    0);
+
+  registerOptionalParameter("materialTableMaxSlope",
+			    "Largest track slope dx/dz, dy/dz [rad] tabulated for the track dependent material",
+			    _materialTableMaxSlope,
+			    0.05);
+
+  registerOptionalParameter("materialTableNodes",
+			    "Number of tabulated slopes along each of dx/dz, dy/dz for the track dependent material",
+			    _materialTableNodes,
+			    11);
 }
 
 
@@ -299,16 +334,25 @@ void EUTelGBL::init() {
   }
 
   for(auto& radLen: _planeRadLength) {
-      //Paper showed HL predicts too high angle, at least for biased measurement. 
-      double tetSi = _kappa*0.0136 * sqrt(radLen) / _eBeam * ( 1 + 0.038*std::log(totalRadLength) );
-      _planeWscatSi.emplace_back( 1.0/(tetSi*tetSi), 1.0/(tetSi*tetSi) );
+      _planeWscatSi.emplace_back( scatteringWeight(radLen, totalRadLength) );
   }
 
   for(size_t ipl = 0; ipl < _nPlanes-1; ipl++) {
     auto distplane = _planePosition[ipl+1] - _planePosition[ipl]; // in [mm]
     double epsAir =   0.5*distplane  / radLengthAir;
-    double tetAir = _kappa*0.0136 * sqrt(epsAir) / _eBeam * ( 1 + 0.038*std::log(totalRadLength) );
-    _planeWscatAir.emplace_back( 1.0/(tetAir*tetAir), 1.0/(tetAir*tetAir) );
+    _planeWscatAir.emplace_back( scatteringWeight(epsAir, totalRadLength) );
+  }
+
+  //the TGeo navigator is only used here, the fits read the table from any thread
+  if(_trackDependentMaterial) {
+    if(_materialTableNodes < 2) {
+      streamlog_out(ERROR5) << "materialTableNodes has to be at least 2, not " << _materialTableNodes << std::endl;
+      exit(-1);
+    }
+    geo::gGeometry().buildMaterialBudgetTable(_materialTableMaxSlope, static_cast<unsigned>(_materialTableNodes));
+    _materialBudgetTable = geo::gGeometry().getMaterialBudgetTable();
+    streamlog_out(MESSAGE4) << "Scattering computed per track from the material budget up to slopes of "
+			    << _materialTableMaxSlope << " rad" << std::endl;
   }
 
   //FIXME: Really needed this output?
@@ -351,6 +395,28 @@ void EUTelGBL::init() {
   bookHistos(_sensorIDVec);
   gblutil.setParent(this);
   gblutil.bookHistos();
+
+  if(!_columnarOutputFile.empty()) {
+    _columns.run = _columnarOutput.addIntColumn("run");
+    _columns.event = _columnarOutput.addIntColumn("event");
+    _columns.track = _columnarOutput.addIntColumn("track");
+    _columns.sensorID = _columnarOutput.addIntColumn("sensorID");
+    _columns.ndf = _columnarOutput.addIntColumn("ndf");
+    _columns.chi2 = _columnarOutput.addFloatColumn("chi2");
+    _columns.x = _columnarOutput.addFloatColumn("x");
+    _columns.y = _columnarOutput.addFloatColumn("y");
+    _columns.z = _columnarOutput.addFloatColumn("z");
+    _columns.slopeX = _columnarOutput.addFloatColumn("slopeX");
+    _columns.slopeY = _columnarOutput.addFloatColumn("slopeY");
+    _columns.kinkX = _columnarOutput.addFloatColumn("kinkX");
+    _columns.kinkY = _columnarOutput.addFloatColumn("kinkY");
+    _columns.hitX = _columnarOutput.addFloatColumn("hitX");
+    _columns.hitY = _columnarOutput.addFloatColumn("hitY");
+    _columns.residualX = _columnarOutput.addFloatColumn("residualX");
+    _columns.residualY = _columnarOutput.addFloatColumn("residualY");
+    _columnarOutput.open(_columnarOutputFile);
+    streamlog_out( MESSAGE4 ) << "Writing the tracks as columns to " << _columnarOutputFile << std::endl;
+  }
   
   //only for alignment
   if(_performAlignment){ 
@@ -448,6 +514,12 @@ void EUTelGBL::init() {
     }
     // end writing the pede steering file
   }
+
+  buildTrajectoryTemplate();
+
+  _workerPool = std::make_unique<EUTelWorkerPool>(static_cast<unsigned>(std::max(_nThreads, 1)));
+  _pointArenas.assign(_workerPool->size(), std::vector<gbl::GblPoint>());
+  for(auto& arena: _pointArenas) arena.reserve(_pointArcLength.size());
   streamlog_out( MESSAGE2 ) << "end of init" << std::endl;
 }
 
@@ -467,6 +539,217 @@ inline Eigen::Matrix<double,5,5> Jac55new( double ds ) {
   return jac;
 }
 
+void EUTelGBL::buildTrajectoryTemplate() {
+
+  _planeTemplates.clear();
+  _pointArcLength.clear();
+
+  //the SUT kink derivatives only depend on the plane positions
+  double SUT_zpos = 0.;
+  double SUT_thickness = 0.;
+  if(_SUT_ID > 0) {
+    SUT_zpos = geo::gGeometry().getPlaneZPosition(_SUT_ID);
+    SUT_thickness = geo::gGeometry().getPlaneZSize(_SUT_ID);
+  }
+
+  //number of alignment parameters per plane
+  int nAlignPar = 0;
+  if(_performAlignment) {
+    if(_alignMode == Utility::alignMode::XYShiftsRotZ) nAlignPar = 3; //x, y, rotZ
+    else if(_alignMode == Utility::alignMode::XYZShiftsRotXYZ) nAlignPar = 6; //x, y, rotZ, z, rotX, rotY
+  }
+
+  //arc length at the first measurement plane is 0
+  double s = 0;
+  double step = 0.0;
+
+  for(size_t ipl = 0; ipl < _nPlanes; ++ipl) {
+    PlaneTemplate plane;
+    auto sensorID = _sensorIDVec[ipl];
+    plane.sensorID = sensorID;
+
+    if(std::find(_upstreamTriplet_IDs.begin(), _upstreamTriplet_IDs.end(), 
+		 sensorID) != _upstreamTriplet_IDs.end()) {
+      plane.role = PlaneRole::upstream;
+    } else if(std::find(_downstreamTriplet_IDs.begin(), _downstreamTriplet_IDs.end(), 
+			sensorID) != _downstreamTriplet_IDs.end()) {
+      plane.role = PlaneRole::downstream;
+    } else {
+      plane.role = PlaneRole::dut;
+    }
+    plane.isExcluded = std::find(std::begin(_excludedPlanes), std::end(_excludedPlanes), 
+				 sensorID) != _excludedPlanes.end();
+    //no scatterer for the SUT in order to have an unbiased estimation of the kink
+    plane.isSUT = (sensorID == _SUT_ID);
+
+    //transport matrix in (q/p, x', y', x, y) space
+    plane.jacobian = Jac55new( step );
+    s += step;
+    _pointArcLength.push_back( s );
+    plane.label = static_cast<unsigned int>(_pointArcLength.size());
+
+    //for SUT: add local parameter for kink estimation for the planes after the SUT
+    double distSUT = _planePosition[ipl] - SUT_zpos;
+    plane.hasSUTLocals = (_SUT_ID > 0 && distSUT > 0);
+    plane.sutDerivatives = Eigen::Matrix<double,2,4>::Zero();
+    if(plane.hasSUTLocals) {
+      plane.sutDerivatives(0,0) = (distSUT - SUT_thickness/sqrt(12)); //first scatterer in target
+      plane.sutDerivatives(1,1) = (distSUT - SUT_thickness/sqrt(12)); 
+      plane.sutDerivatives(0,2) = (distSUT + SUT_thickness/sqrt(12)); //second scatterer in target
+      plane.sutDerivatives(1,3) = (distSUT + SUT_thickness/sqrt(12)); 
+    }
+
+    for(int iPar = 1; iPar <= nAlignPar; ++iPar) {
+      plane.globalLabels.push_back( sensorID * 10 + iPar );
+    }
+
+    //two air scatterers in between planes
+    plane.jacobianAirLeft = Eigen::Matrix<double,5,5>::Identity();
+    plane.jacobianAirRight = Eigen::Matrix<double,5,5>::Identity();
+    if( ipl < _nPlanes-1 ) {
+      double distplane = _planePosition[ipl+1] - _planePosition[ipl];
+      step = 0.21*distplane; //in [mm]
+      plane.jacobianAirLeft = Jac55new( step );
+      s += step;
+      _pointArcLength.push_back( s );
+      step = 0.58*distplane; //in [mm]
+      plane.jacobianAirRight = Jac55new( step );
+      s += step;
+      _pointArcLength.push_back( s );
+      step = 0.21*distplane; //remaining distance to next plane, in [mm]
+    }
+
+    _planeTemplates.push_back(plane);
+  }
+}
+
+Eigen::Vector2d EUTelGBL::scatteringWeight(double radLength, double totalRadLength) const {
+  if(radLength < minScatteringRadLength) return Eigen::Vector2d::Zero();
+  //Paper showed HL predicts too high angle, at least for biased measurement. 
+  double tet = _kappa*0.0136 * sqrt(radLength) / _eBeam * ( 1 + 0.038*std::log(totalRadLength) );
+  return Eigen::Vector2d( 1.0/(tet*tet), 1.0/(tet*tet) );
+}
+
+void EUTelGBL::trackScatteringWeights(TrackFit &fit) const {
+  auto tripletSlope = fit.upstream->slope();
+
+  fit.wscatSi.resize(_nPlanes);
+  fit.wscatAir.resize(_nPlanes-1);
+  //x/X0 first, the weights need the total along the track
+  double totalRadLength = 0;
+  for(size_t ipl = 0; ipl < _nPlanes; ++ipl) {
+    int sensorID = _planeTemplates[ipl].sensorID;
+    double radLen = _materialBudgetTable.getSensorRadLength(sensorID, tripletSlope.x, tripletSlope.y);
+    fit.wscatSi[ipl](0) = radLen;
+    totalRadLength += radLen;
+    if( ipl < _nPlanes-1 ) {
+      //shared by the two air scatterers
+      double epsAir = 0.5*_materialBudgetTable.getGapRadLength(sensorID, tripletSlope.x, tripletSlope.y);
+      fit.wscatAir[ipl](0) = epsAir;
+      totalRadLength += 2*epsAir;
+    }
+  }
+  for(auto& w: fit.wscatSi) w = scatteringWeight(w(0), totalRadLength);
+  for(auto& w: fit.wscatAir) w = scatteringWeight(w(0), totalRadLength);
+}
+
+void EUTelGBL::fitTrack(TrackFit &fit, std::vector<gbl::GblPoint> &points) const {
+
+  Eigen::Matrix2d proL2m = Eigen::Matrix2d::Identity();
+  Eigen::Vector2d scat = Eigen::Vector2d::Zero();
+
+  //GBL with triplet A as seed
+  auto const & uptriplet = *fit.upstream;
+  //need triplet slope to compute residual
+  auto tripletSlope = uptriplet.slope();
+
+  //define alignment derivatives, the hit dependent entries are set per plane
+  Eigen::Matrix<double,2,3> alDer3 = Eigen::Matrix<double,2,3>::Zero();
+  Eigen::Matrix<double,3,6> alDer6 = Eigen::Matrix<double,3,6>::Zero();
+  alDer3(0,0) = 1.0; // dx/dx
+  alDer3(1,1) = 1.0; // dy/dy
+  alDer6(0,0) = 1.0; // dx/dx
+  alDer6(0,2) = tripletSlope.x; // dx/dz
+  alDer6(1,1) = 1.0; // dy/dy
+  alDer6(1,2) = tripletSlope.y; // dy/dz
+  alDer6(2,2) = 1.0; // dz/dz
+
+  //scattering from the material along this track, or the per plane constants
+  if(_trackDependentMaterial) trackScatteringWeights(fit);
+  auto const & wscatSi = _trackDependentMaterial ? fit.wscatSi : _planeWscatSi;
+  auto const & wscatAir = _trackDependentMaterial ? fit.wscatAir : _planeWscatAir;
+
+  //GBL point vector for the trajectory (in [mm])
+  points.clear();
+
+  //[START] loop over all planes
+  for(size_t ipl = 0; ipl < _nPlanes; ++ipl) {
+    auto const & plane = _planeTemplates[ipl];
+    auto const * hit = fit.hits[ipl];
+
+    points.emplace_back( plane.jacobian );
+    auto & point = points.back();
+
+    //if there is a hit, add a measurement to the point
+    //for excluded plane: want to know if there is a hit, but don't process it here
+    if(hit && !plane.isExcluded) {
+      double xs = uptriplet.getx_at(hit->z);
+      double ys = uptriplet.gety_at(hit->z);
+
+      //add residuals as hit to triplet
+      fit.rx[ipl] = (hit->x - xs);
+      fit.ry[ipl] = (hit->y - ys);
+
+      //fill measurement vector for GBL
+      Eigen::Vector2d meas(fit.rx[ipl], fit.ry[ipl]);
+      point.addMeasurement( proL2m, meas, _planeMeasPrec[ipl] );
+
+      if(plane.hasSUTLocals) {
+	point.addLocals( plane.sutDerivatives );
+      }
+
+      //only during alignment
+      if(_performAlignment) {
+	//alignMode: x,y shifts and rotation z
+	if( _alignMode == Utility::alignMode::XYShiftsRotZ ) {
+	  alDer3(0,2) = -ys; //dx/dphi
+	  alDer3(1,2) =  xs; //dy/dphi
+	  point.addGlobals( plane.globalLabels, alDer3 );
+	} 
+	//alignMode: x,y,z shifts and rotation x,y,z
+	else if( _alignMode == Utility::alignMode::XYZShiftsRotXYZ ) {
+	  double z = hit->z;
+	  //FIXME: a bit hacky? : deltaz cannot be zero, otherwise this mode doesn't work
+	  if ( z < 1E-9 ) z = 1E-9;
+	  alDer6(0,4) = z; //dx/db
+	  alDer6(0,5) = -ys; //dx/dg
+	  alDer6(1,3) = -z; //dy/da
+	  alDer6(1,5) = xs; //dy/dg
+	  alDer6(2,3) = ys; //dz/da
+	  alDer6(2,4) = -xs; //dz/db
+	  point.addGlobals( plane.globalLabels, alDer6 );
+	}
+      }
+    }
+
+    //a zero weight is a scatterer without material
+    if(!plane.isSUT && wscatSi[ipl](0) > 0) {
+      point.addScatterer( scat, wscatSi[ipl] );
+    }
+
+    //fill up with two air scatters in between planes
+    if( ipl < _nPlanes-1 ) {
+      points.emplace_back( plane.jacobianAirLeft );
+      if(wscatAir[ipl](0) > 0) points.back().addScatterer( scat, wscatAir[ipl] );
+      points.emplace_back( plane.jacobianAirRight );
+      if(wscatAir[ipl](0) > 0) points.back().addScatterer( scat, wscatAir[ipl] );
+    }
+  }//[END] loop over all planes
+
+  fit.trajectory = std::make_unique<gbl::GblTrajectory>(points, false); // curvature = false
+  fit.trajectory->fit( fit.chi2, fit.ndf, fit.lostWeight );
+}
+
 void EUTelGBL::processEvent( LCEvent * event ) {
 
   if(_iEvt % 1000 == 0) {
@@ -480,8 +763,9 @@ void EUTelGBL::processEvent( LCEvent * event ) {
       << std::endl;
   }
   
-  //FIXME?: compiler doesn't like it inside an if clause
-  LCCollectionVec* _outputTracks = new LCCollectionVec(LCIO::LCGENERICOBJECT);
+  //the generic objects are only created if they are dumped
+  std::unique_ptr<LCCollectionVec> outputTracks;
+  if(_dumpTracks) outputTracks = std::make_unique<LCCollectionVec>(LCIO::LCGENERICOBJECT);
   
   if(_nTotalTracks > static_cast<size_t>(_maxTrackCandidatesTotal)) {
     throw StopProcessingException(this);
@@ -568,247 +852,115 @@ void EUTelGBL::processEvent( LCEvent * event ) {
 
   if(!_DUT_IDs.empty())
     {
+      //bin the DUT hits once, they are looked up for every track
+      std::vector<EUTelTripletGBLUtility::HitGrid> dutHitGrids;
+      dutHitGrids.reserve(_DUT_IDs.size());
+      for(auto dutID: _DUT_IDs) {
+	dutHitGrids.emplace_back(dutHitsVec, static_cast<unsigned int>(dutID));
+      }
       for(auto& track: matchedTripletVec) {    
-	for(auto dutID: _DUT_IDs) {
+	for(size_t iDUT = 0; iDUT < _DUT_IDs.size(); ++iDUT) {
+	  auto dutID = _DUT_IDs[iDUT];
 	  //either attach DUT to upstream
 	  if(_isSensorUpstream[dutID]) {
-	    gblutil.AttachDUT(track.get_upstream(), dutHitsVec, dutID, _dutCuts);
+	    gblutil.AttachDUT(track.get_upstream(), dutHitsVec, dutHitGrids[iDUT], _dutCuts);
 	  }
 	  //or to downstream
 	  else {
-	    gblutil.AttachDUT(track.get_downstream(), dutHitsVec, dutID, _dutCuts);
+	    gblutil.AttachDUT(track.get_downstream(), dutHitsVec, dutHitGrids[iDUT], _dutCuts);
 	  }
 	}
       }
     }
 
-  //[START] loop over matched tracks
-  for(auto& track: matchedTripletVec) 
+  //[START] resolve the hits of the matched tracks
+  //the fits below only read from the triplets and the trajectory template
+  size_t nFits = 0;
+  std::vector<int> fitIndex(matchedTripletVec.size(), -1);
+  for(size_t iTrack = 0; iTrack < matchedTripletVec.size(); ++iTrack)
     {
-      //GBL point vector for the trajectory (in [mm])
-      //GBL with triplet A as seed
-      std::vector<gbl::GblPoint> traj_points;
-      //build up trajectory:
-      std::vector<unsigned int> labelVec;
-      vector<double> sPoint;
-      
-      //arc length at the first measurement plane is 0
-      double s = 0;
-      
-      Eigen::Matrix2d proL2m = Eigen::Matrix2d::Identity();
-      Eigen::Vector2d scat = Eigen::Vector2d::Zero();
-      
-      auto uptriplet = track.get_upstream();
-      auto downtriplet = track.get_downstream();
-      //need triplet slope to compute residual
-      auto tripletSlope = uptriplet.slope();
-      
-      std::vector<EUTelTripletGBLUtility::hit> DUThits;
-      for(auto it = uptriplet.DUT_begin(); it != uptriplet.DUT_end(); ++it){
-	DUThits.emplace_back(it->second);
-      }
-      for(auto it = downtriplet.DUT_begin(); it != downtriplet.DUT_end(); ++it){
-	DUThits.emplace_back(it->second);
-      }
-      
-      if(_printEventCounter < NO_PRINT_EVENT_COUNTER) 
-	streamlog_out(DEBUG2) << "Track has " << DUThits.size() << " DUT hits" << std::endl;
-      
+      auto& uptriplet = matchedTripletVec[iTrack].get_upstream();
+      auto& downtriplet = matchedTripletVec[iTrack].get_downstream();
+
       //selection of tracks with a hit on a selected/required plane
       if(_requiredPlane!=-1) {
         bool rejectTrack = true;
-	for(auto& checkhits: DUThits) {
-          if(int(checkhits.plane) == _requiredPlane) {
-	    rejectTrack = false;
-	    break;
+	for(auto arm: {&uptriplet, &downtriplet}) {
+	  for(auto it = arm->DUT_begin(); it != arm->DUT_end(); ++it) {
+	    if(static_cast<int>(it->second.plane) == _requiredPlane) rejectTrack = false;
 	  }
 	}
         if(rejectTrack) continue;
       }
-      
-      //FIXME: to be used only during alignment. Matrix defined outside if clause to 
-      //avoid complaints from compiler. Could be done better
-      
-      //define alignment derivatives
-      Eigen::Matrix<double,2,3> alDer3;
-      Eigen::Matrix<double, 3,6> alDer6;
-      
-      if(_performAlignment){ 
-	
-	alDer3(0,0) = 1.0; // dx/dx
-	alDer3(1,0) = 0.0; // dy/dx
-	alDer3(0,1) = 0.0; // dx/dy
-	alDer3(1,1) = 1.0; // dy/dy
-	
-	alDer6(0,0) = 1.0; // dx/dx
-	alDer6(0,1) = 0.0; // dx/dy
-	alDer6(0,2) = tripletSlope.x; // dx/dz
-	alDer6(0,3) = 0.0; // dx/da
-	alDer6(1,0) = 0.0; // dy/dx
-	alDer6(1,1) = 1.0; // dy/dy
-	alDer6(1,2) = tripletSlope.y; // dy/dz
-	alDer6(1,4) = 0.0; // dy/db
-	alDer6(2,0) = 0.0; // dz/dx
-	alDer6(2,1) = 0.0; // dz/dy
-	alDer6(2,2) = 1.0; // dz/dz
-	alDer6(2,5) = 0.0; // dz/dg
-      }
-      
-      std::vector<double> rx (_nPlanes, -1.0);
-      std::vector<double> ry (_nPlanes, -1.0);
-      std::vector<bool> hasHit (_nPlanes, false);
-      
-      double step = 0.0;
-      unsigned int iLabel;
-      
-      //[START] loop over all planes
-      for(size_t ipl=0; ipl<_nPlanes; ++ipl) {
-
-	//add all the planes: up/downstream telescope will have hits, DUTs maybe
-	EUTelTripletGBLUtility::hit const *hit = nullptr;
-	auto sensorID = _sensorIDVec[ipl];
-
-	if(std::find(_upstreamTriplet_IDs.begin(), _upstreamTriplet_IDs.end(), 
-		     sensorID) != _upstreamTriplet_IDs.end()) {
-	  hit = &uptriplet.gethit(sensorID);
-	} else if(std::find(_downstreamTriplet_IDs.begin(), _downstreamTriplet_IDs.end(), 
-			    sensorID) != _downstreamTriplet_IDs.end()) {
-	  hit = &downtriplet.gethit(sensorID);
-	} else if(uptriplet.has_DUT(sensorID)) {
-	  hit = &uptriplet.get_DUT_Hit(sensorID);
-	} else if(downtriplet.has_DUT(sensorID)) {
-	  hit = &downtriplet.get_DUT_Hit(sensorID);
+
+      if(_trackFits.size() <= nFits) _trackFits.emplace_back();
+      auto& fit = _trackFits[nFits];
+      fitIndex[iTrack] = static_cast<int>(nFits++);
+
+      fit.upstream = &uptriplet;
+      fit.hits.assign(_nPlanes, nullptr);
+      fit.rx.assign(_nPlanes, -1.0);
+      fit.ry.assign(_nPlanes, -1.0);
+
+      //add all the planes: up/downstream telescope will have hits, DUTs maybe
+      for(size_t ipl = 0; ipl < _nPlanes; ++ipl) {
+	auto const & plane = _planeTemplates[ipl];
+	if(plane.role == PlaneRole::upstream) {
+	  fit.hits[ipl] = &uptriplet.gethit(plane.sensorID);
+	} else if(plane.role == PlaneRole::downstream) {
+	  fit.hits[ipl] = &downtriplet.gethit(plane.sensorID);
+	} else if(uptriplet.has_DUT(plane.sensorID)) {
+	  fit.hits[ipl] = &uptriplet.get_DUT_Hit(plane.sensorID);
+	} else if(downtriplet.has_DUT(plane.sensorID)) {
+	  fit.hits[ipl] = &downtriplet.get_DUT_Hit(plane.sensorID);
 	}
+      }
+    }//[END] resolve the hits of the matched tracks
 
-	//if there is no hit, take plane position from the geo description
-	double zz = hit ? hit->z : _planePosition[ipl];// [mm]
-	
-	//transport matrix in (q/p, x', y', x, y) space
-	auto jacPointToPoint = Jac55new( step );
-	auto point = gbl::GblPoint( jacPointToPoint );
-	s += step;
-	
-	if(hit) {
-	  hasHit[ipl] = true; 
-	  //if there is a hit, add a measurement to the point
-	  //for excluded plane: want to know if there is a hit, but don't process it here
-	  if(std::find(std::begin(_excludedPlanes), std::end(_excludedPlanes), 
-		       _sensorIDVec[ipl]) == _excludedPlanes.end()){
-	    double xs = uptriplet.getx_at(zz);
-	    double ys = uptriplet.gety_at(zz);
-	    
-	    if(_printEventCounter < NO_PRINT_EVENT_COUNTER)
-	      streamlog_out(DEBUG2) << "xs = " << xs << "   ys = " << ys << std::endl;
-	    //add residuals as hit to triplet
-	    rx[ipl] = (hit->x - xs);
-	    ry[ipl] = (hit->y - ys);
-	    
-	    //fill measurement vector for GBL
-	    Eigen::Vector2d meas(rx[ipl], ry[ipl]);
-	    point.addMeasurement( proL2m, meas, _planeMeasPrec[ipl] );
-	    
-	    //for SUT: add local parameter for kink estimation for the planes after the SUT
-	    if(_SUT_ID > 0){
-	      //FIXME: very sloppy. SUT_zpos should not be retrieved every time
-	      double SUT_zpos = geo::gGeometry().getPlaneZPosition(_SUT_ID);
-	      double distSUT = _planePosition[ipl] - SUT_zpos; 
-	      if(distSUT > 0){
-		//FIXME: definition can stay here or should be moved out?
-		Eigen::Matrix<double,2,4> addDer = Eigen::Matrix<double,2,4>::Zero();
-		double thickness = geo::gGeometry().getPlaneZSize(_SUT_ID);
-		addDer(0,0) = (distSUT - thickness/sqrt(12)); //first scatterer in target
-		addDer(1,1) = (distSUT - thickness/sqrt(12)); 
-		addDer(0,2) = (distSUT + thickness/sqrt(12)); //second scatterer in target
-		addDer(1,3) = (distSUT + thickness/sqrt(12)); 
-		point.addLocals(addDer);
-	      }
-	    }
+  //the tracks are independent, fit them in parallel
+  _workerPool->parallelFor(nFits, [this](size_t iFit, unsigned thread) {
+    fitTrack(_trackFits[iFit], _pointArenas[thread]);
+  });
 
-	    //only during alignment
-	    if(_performAlignment) {	      
-	      //alignMode: x,y shifts and rotation z. TO BE FIXED
-	    if( _alignMode == Utility::alignMode::XYShiftsRotZ ) {
-		std::vector<int> globalLabels(3);
-		globalLabels[0] = _sensorIDVec[ipl] * 10 + 1; //x
-		globalLabels[1] = _sensorIDVec[ipl] * 10 + 2; //y
-		globalLabels[2] = _sensorIDVec[ipl] * 10 + 3; //rotZ
-		alDer3(0,2) = -ys; //dx/dphi
-		alDer3(1,2) =  xs; //dy/dphi
-		point.addGlobals( globalLabels, alDer3 );
-	      } 
-	      //alignMode: x,y,z shifts and rotation x,y,z
-	      else if( _alignMode == Utility::alignMode::XYZShiftsRotXYZ ) {
-		double z = hit->z;
-		//FIXME: a bit hacky? : deltaz cannot be zero, otherwise this mode doesn't work
-		if ( z < 1E-9 ) z = 1E-9;
-		std::vector<int> globalLabels(6);
-		globalLabels[0] = _sensorIDVec[ipl] * 10 + 1; //x
-		globalLabels[1] = _sensorIDVec[ipl] * 10 + 2; //y
-		globalLabels[2] = _sensorIDVec[ipl] * 10 + 3; //rotZ
-		globalLabels[3] = _sensorIDVec[ipl] * 10 + 4; //z
-		globalLabels[4] = _sensorIDVec[ipl] * 10 + 5; //rotX
-		globalLabels[5] = _sensorIDVec[ipl] * 10 + 6; //rotY
-        alDer6(0,4) = z; //dx/db
-        alDer6(0,5) = -ys; //dx/dg
-        alDer6(1,3) = -z; //dy/da
-        alDer6(1,5) = xs; //dy/dg
-        alDer6(2,3) = ys; //dz/da
-        alDer6(2,4) = -xs; //dz/db
-        point.addGlobals( globalLabels, alDer6 );
-	      }
-	    }
-	  }
-	}
-	
-	//don't add a scatterer for the SUT in order to have an unbiased estimation of the kink
-	if(_sensorIDVec[ipl] != _SUT_ID) {
-	  point.addScatterer( scat, _planeWscatSi[ipl] );
-	}
-	sPoint.push_back( s );
-	iLabel = sPoint.size();
-	labelVec.push_back(iLabel);
-	traj_points.push_back(point);
-
-	//fill up with two air scatters in between planes
-	if( ipl < _nPlanes-1 ) {
-	  double distplane = _planePosition[ipl+1] - _planePosition[ipl];
-	  step = 0.21*distplane; //in [mm]
-	  auto point_left = gbl::GblPoint( Jac55new( step ) );
-	  point_left.addScatterer( scat, _planeWscatAir[ipl] );
-	  s += step;
-	  traj_points.push_back(point_left);
-	  sPoint.push_back( s );
-	  step = 0.58*distplane; //in [mm]
-	  auto point_right = gbl::GblPoint( Jac55new( step ) );
-	  point_right.addScatterer( scat, _planeWscatAir[ipl] );
-	  s += step;
-	  traj_points.push_back(point_right);
-	  sPoint.push_back( s );
-	  step = 0.21*distplane; //remaining distance to next plane, in [mm]
-	}
-	
-      }//[END] loop over all planes
+  //[START] loop over matched tracks
+  for(size_t iTrack = 0; iTrack < matchedTripletVec.size(); ++iTrack)
+    {
+      auto& uptriplet = matchedTripletVec[iTrack].get_upstream();
+      auto& downtriplet = matchedTripletVec[iTrack].get_downstream();
+
+      if(_printEventCounter < NO_PRINT_EVENT_COUNTER) 
+	streamlog_out(DEBUG2) << "Track has " << uptriplet.number_DUTs() + downtriplet.number_DUTs()
+			      << " DUT hits" << std::endl;
+
+      //rejected by the required plane selection
+      if(fitIndex[iTrack] < 0) continue;
+
+      auto& fit = _trackFits[static_cast<size_t>(fitIndex[iTrack])];
+      auto& traj = *fit.trajectory;
+      double Chi2 = fit.chi2;
+      int Ndf = fit.ndf;
+
+      //need triplet slope to compute residual
+      auto tripletSlope = uptriplet.slope();
 
-      double Chi2;
-      int Ndf;
-      double lostWeight;
-      
-      gbl::GblTrajectory traj(traj_points, false); // curvature = false
-      traj.fit( Chi2, Ndf, lostWeight);
-      
       if(_printEventCounter < NO_PRINT_EVENT_COUNTER){
+	for(size_t ipl = 0; ipl < _nPlanes; ++ipl) {
+	  if(fit.hits[ipl] && !_planeTemplates[ipl].isExcluded) {
+	    streamlog_out(DEBUG2) << "xs = " << uptriplet.getx_at(fit.hits[ipl]->z)
+				  << "   ys = " << uptriplet.gety_at(fit.hits[ipl]->z) << std::endl;
+	  }
+	}
 	streamlog_out(DEBUG4) << "traj with " << traj.getNumPoints() << " points:" << std::endl;
-	for( size_t ipl = 0; ipl < sPoint.size(); ++ipl ){
+	for( size_t ipl = 0; ipl < _pointArcLength.size(); ++ipl ){
 	  streamlog_out(DEBUG4) << "  GBL point " << ipl;
-	  streamlog_out(DEBUG4) << "  z " << sPoint[ipl]; 
+	  streamlog_out(DEBUG4) << "  z " << _pointArcLength[ipl]; 
 	  streamlog_out(DEBUG4) << std::endl;
 	}
-	//FIXME: why is here size hardcoded to 6?
-	for( size_t ipl = 0; ipl < 6; ++ipl ){
-	  streamlog_out(DEBUG4) << " plane " << ipl << ", lab " << labelVec[ipl];
-	  streamlog_out(DEBUG4) << " z " << sPoint[labelVec[ipl]-1];
-	  streamlog_out(DEBUG4) << "  dx " << rx[ipl];
-	  streamlog_out(DEBUG4) << "  dy " << ry[ipl];
+	for( size_t ipl = 0; ipl < _nPlanes; ++ipl ){
+	  streamlog_out(DEBUG4) << " plane " << ipl << ", lab " << _planeTemplates[ipl].label;
+	  streamlog_out(DEBUG4) << " z " << _pointArcLength[_planeTemplates[ipl].label-1];
+	  streamlog_out(DEBUG4) << "  dx " << fit.rx[ipl];
+	  streamlog_out(DEBUG4) << "  dy " << fit.ry[ipl];
 	  streamlog_out(DEBUG4) << "  chi2 " << Chi2;
 	  streamlog_out(DEBUG4) << "  ndf " << Ndf;
 	  streamlog_out(DEBUG4) << std::endl;
@@ -845,84 +997,96 @@ void EUTelGBL::processEvent( LCEvent * event ) {
       Eigen::VectorXd aDownWeights(ndim);
       
       for(size_t ix = 0; ix < _nPlanes; ++ix) {
-	int ipos = labelVec[ix];
+	int ipos = _planeTemplates[ix].label;
 	traj.getResults( ipos, localPar, localCov );
 	
-	//FIXME: compiler doesn't like it outside an if clause
-	IMPL::LCGenericObjectImpl* thisTrack = new IMPL::LCGenericObjectImpl();
 	//track = q/p, x', y', x, y
 	//        0,   1,  2,  3, 4
 	hist1D_gblAngleX[ix]->fill( localPar[1]*1E3 );
 	hist1D_gblAngleY[ix]->fill( localPar[2]*1E3 ); 
 	
+	//track position on the plane (global system)
+	double trackX = uptriplet.getx_at(_planePosition[ix]) + localPar[3];
+	double trackY = uptriplet.gety_at(_planePosition[ix]) + localPar[4];
+
+	//kink angles [mrad]
+	double kinkX = (localPar[1] - prevAngleX)*1E3;
+	double kinkY = (localPar[2] - prevAngleY)*1E3;
+	if(_sensorIDVec[ix]==_SUT_ID) {
+	  kinkX = (localPar[5]+localPar[7])*1E3;
+	  kinkY = (localPar[6]+localPar[8])*1E3;
+	}
+
 	//check for an hit on plane
-	if(hasHit[ix]) {
+	double residualX = 0;
+	double residualY = 0;
+	auto hit = fit.hits[ix];
+	if(hit) {
 	  //check: plane is not excluded
-	  if(std::find(std::begin(_excludedPlanes), std::end(_excludedPlanes),
-		       _sensorIDVec[ix]) == _excludedPlanes.end()){
+	  if(!_planeTemplates[ix].isExcluded){
 	    traj.getMeasResults( ipos, ndata, aResiduals, aMeasErrors,
 				 aResErrors, aDownWeights );
-	    hist1D_gblResidX[ix]->fill( (aResiduals[0])*1E3 );
-	    hist1D_gblResidY[ix]->fill( (aResiduals[1])*1E3 );
+	    residualX = aResiduals[0];
+	    residualY = aResiduals[1];
 	    hist1D_gblPullX[ix]->fill( aResiduals[0]/aResErrors[0] );
 	    hist1D_gblPullY[ix]->fill( aResiduals[1]/aResErrors[1] );
 	  } 
 	  //check: plane is excluded
 	  else {
-	    EUTelTripletGBLUtility::hit const * hit = nullptr;
-	    if(std::find(_upstreamTriplet_IDs.begin(), _upstreamTriplet_IDs.end(),
-			 _sensorIDVec[ix]) != _upstreamTriplet_IDs.end()) {
-	      hit = &uptriplet.gethit(_sensorIDVec[ix]);
-	    } else if(std::find(_downstreamTriplet_IDs.begin(), _downstreamTriplet_IDs.end(),
-				_sensorIDVec[ix]) != _downstreamTriplet_IDs.end()) {
-	      hit = &downtriplet.gethit(_sensorIDVec[ix]);
-	    } else if(uptriplet.has_DUT(_sensorIDVec[ix])) {
-	      hit = &uptriplet.get_DUT_Hit(_sensorIDVec[ix]);
-	    } else if(downtriplet.has_DUT(_sensorIDVec[ix])) {
-	      hit = &downtriplet.get_DUT_Hit(_sensorIDVec[ix]);
-	    }
-	    hist1D_gblResidX[ix]->fill(hit->x*1E3 - uptriplet.getx_at(_planePosition[ix]) *1E3 - localPar[3]*1E3);
-	    hist1D_gblResidY[ix]->fill(hit->y*1E3 - uptriplet.gety_at(_planePosition[ix]) *1E3 - localPar[4]*1E3);
+	    residualX = hit->x - trackX;
+	    residualY = hit->y - trackY;
 	  }
+	  hist1D_gblResidX[ix]->fill( residualX*1E3 );
+	  hist1D_gblResidY[ix]->fill( residualY*1E3 );
 	}
 	
 	if(_dumpTracks) { //CHECK ME CAREFULLY
+	  auto thisTrack = new IMPL::LCGenericObjectImpl();
 	  thisTrack->setIntVal(0, _sensorIDVec[ix]); //sensor ID is an int
 	  thisTrack->setIntVal(1, Ndf); //Ndf is an int
 	  thisTrack->setIntVal(2, numbertracks);
 	  thisTrack->setFloatVal(0, Chi2); //chi2
-	  thisTrack->setFloatVal(1, uptriplet.getx_at(_planePosition[ix]) + localPar[3]); // x track position (global system)
-	  thisTrack->setFloatVal(2, uptriplet.gety_at(_planePosition[ix]) + localPar[4]); // y track position (global system)
+	  thisTrack->setFloatVal(1, trackX); // x track position (global system)
+	  thisTrack->setFloatVal(2, trackY); // y track position (global system)
 	  thisTrack->setFloatVal(3, _planePosition[ix]); // z of the plane, FIXME: we should use z hit position if possible
 	  thisTrack->setFloatVal(4, (tripletSlope.x + localPar[1])*1E3); // FIXME: check if the sign is right
 	  thisTrack->setFloatVal(5, (tripletSlope.x + localPar[2])*1E3); // FIXME: check if the sign is right
-	  
-	  if(_sensorIDVec[ix]!=_SUT_ID) {
-	    thisTrack->setFloatVal(6, (localPar[1] - prevAngleX)*1E3 ); // kink angle in x in mrad
-	    thisTrack->setFloatVal(7, (localPar[2] - prevAngleY)*1E3 ); // kink angle in y in mrad
-	  } else {
-	    thisTrack->setFloatVal(6, (localPar[5]+localPar[7])*1E3 ); 
-	    thisTrack->setFloatVal(7, (localPar[6]+localPar[8])*1E3 );  
+	  thisTrack->setFloatVal(6, kinkX); // kink angle in x in mrad
+	  thisTrack->setFloatVal(7, kinkY); // kink angle in y in mrad
+	  outputTracks->push_back(static_cast<EVENT::LCGenericObject*>(thisTrack));
+	}
+
+	if(_columnarOutput.isOpen()) {
+	  _columnarOutput.set(_columns.run, event->getRunNumber());
+	  _columnarOutput.set(_columns.event, event->getEventNumber());
+	  _columnarOutput.set(_columns.track, numbertracks);
+	  _columnarOutput.set(_columns.sensorID, _sensorIDVec[ix]);
+	  _columnarOutput.set(_columns.ndf, Ndf);
+	  _columnarOutput.set(_columns.chi2, static_cast<float>(Chi2));
+	  _columnarOutput.set(_columns.x, static_cast<float>(trackX));
+	  _columnarOutput.set(_columns.y, static_cast<float>(trackY));
+	  _columnarOutput.set(_columns.z, static_cast<float>(_planePosition[ix]));
+	  _columnarOutput.set(_columns.slopeX, static_cast<float>((tripletSlope.x + localPar[1])*1E3));
+	  _columnarOutput.set(_columns.slopeY, static_cast<float>((tripletSlope.y + localPar[2])*1E3));
+	  _columnarOutput.set(_columns.kinkX, static_cast<float>(kinkX));
+	  _columnarOutput.set(_columns.kinkY, static_cast<float>(kinkY));
+	  //the hit columns stay NaN without a hit
+	  if(hit) {
+	    _columnarOutput.set(_columns.hitX, static_cast<float>(hit->x));
+	    _columnarOutput.set(_columns.hitY, static_cast<float>(hit->y));
+	    _columnarOutput.set(_columns.residualX, static_cast<float>(residualX));
+	    _columnarOutput.set(_columns.residualY, static_cast<float>(residualY));
 	  }
-	  
-	  _outputTracks->push_back(static_cast<EVENT::LCGenericObject*>(thisTrack));
+	  _columnarOutput.endRow();
 	}
 	
 	//fill kink angle histograms [mrad]
-	if(_sensorIDVec[ix]!=_SUT_ID){
-	  hist1D_gblKinkX[ix]->fill( (localPar[1] - prevAngleX)*1E3 );
-	  hist1D_gblKinkY[ix]->fill( (localPar[2] - prevAngleY)*1E3 );
-	} else {
-	  hist1D_gblKinkX[ix]->fill( (localPar[5]+localPar[7])*1E3 );
-	  hist1D_gblKinkY[ix]->fill( (localPar[6]+localPar[8])*1E3 );
-
+	hist1D_gblKinkX[ix]->fill( kinkX );
+	hist1D_gblKinkY[ix]->fill( kinkY );
+	if(_sensorIDVec[ix]==_SUT_ID) {
 	  //FIXME: newly added kink maps
-	  profile2D_gblSUTKinkXvsXY->fill(uptriplet.getx_at(_planePosition[ix])+localPar[3],
-					  uptriplet.gety_at(_planePosition[ix])+localPar[4],
-					  fabs(localPar[5]+localPar[7])*1E3 );
-	  profile2D_gblSUTKinkYvsXY->fill(uptriplet.getx_at(_planePosition[ix])+localPar[3],
-					  uptriplet.gety_at(_planePosition[ix])+localPar[4],
-					  fabs(localPar[6]+localPar[8])*1E3 );
+	  profile2D_gblSUTKinkXvsXY->fill(trackX, trackY, fabs(kinkX) );
+	  profile2D_gblSUTKinkYvsXY->fill(trackX, trackY, fabs(kinkY) );
 	}
 	
 	prevAngleX = localPar[1];
@@ -937,7 +1101,7 @@ void EUTelGBL::processEvent( LCEvent * event ) {
    numbertracks++;
     }//[END] loop over matched tracks
   
-  if(_dumpTracks) event->addCollection(_outputTracks,"TracksCollection");
+  if(_dumpTracks) event->addCollection(outputTracks.release(),"TracksCollection");
   hist1D_nTracksPerEvent->fill( numbertracks );
   
   //count events
@@ -947,6 +1111,11 @@ void EUTelGBL::processEvent( LCEvent * event ) {
 void EUTelGBL::end() {
 
   milleAlignGBL.reset(nullptr);
+  if(_columnarOutput.isOpen()) {
+    _columnarOutput.close();
+    streamlog_out( MESSAGE5 ) << "Wrote " << _columnarOutput.getNRows() << " track points to "
+			      << _columnarOutputFile << std::endl;
+  }
   //if user wishes alignment cut suggestion
   if(_suggestAlignmentCuts) {
   	gblutil.determineBestCuts();
@@ -21,17 +21,21 @@
 #include "marlin/Global.h"
 
 // lcio includes <.h>
+#include <UTIL/BitField64.h>
 #include <UTIL/CellIDEncoder.h>
-#include <UTIL/CellIDDecoder.h>
+#include <Exceptions.h>
 
 // system includes <>
+#include <algorithm>
+#include <cstdlib>
 #include <vector>
 
 using namespace eutelescope;
 
 EUTelHitCoordinateTransformer::EUTelHitCoordinateTransformer()
   :Processor("EUTelHitCoordinateTransformer"),
-   _hitCollectionNameInput(), _hitCollectionNameOutput(), _undoAlignment(false) {
+   _hitCollectionNameInput(), _hitCollectionNameOutput(), _undoAlignment(false),
+   _transformInPlace(false) {
 
   _description = "EUTelHitCoordinateTransformer is responsible to change local "
                  "coordinates to global using the EUTelGeometryClass.";
@@ -52,6 +56,12 @@ EUTelHitCoordinateTransformer::EUTelHitCoordinateTransformer()
 			    "Set to true to undo the alignment instead",
 			    _undoAlignment,
 			    false);
+
+  registerOptionalParameter("TransformInPlace",
+			    "Set to true to transform the input hits themselves instead of writing "
+			    "transformed copies to the output collection (only for hits created in the same job)",
+			    _transformInPlace,
+			    false);
 }
 
 void EUTelHitCoordinateTransformer::init() {
@@ -84,52 +94,29 @@ void EUTelHitCoordinateTransformer::processEvent(LCEvent* event)
     return;
   }
 
-  //opens collection for output
-  LCCollectionVec* outputCollection = nullptr;
-  try {
-    outputCollection = static_cast<LCCollectionVec*> (event->getCollection(_hitCollectionNameOutput));
-  } catch(...) {
-    outputCollection = new LCCollectionVec(LCIO::TRACKERHIT);
-  }
-
   //get encoding from input
   std::string encoding = inputCollection->getParameters().getStringVal( LCIO::CellIDEncoding );
   if(encoding.empty()) {
     encoding = EUTELESCOPE::HITENCODING;
   }
-
-  //get decoder
-  lcio::CellIDDecoder<TrackerHitImpl> hitDecoder(encoding);
-  lcio::UTIL::CellIDReencoder<TrackerHitImpl> cellReencoder(encoding, outputCollection);
-  
-  //[START] loop over hits
-  for(int iHit = 0; iHit < inputCollection->getNumberOfElements(); ++iHit) {  
-    
-    TrackerHitImpl* inputHit = static_cast<TrackerHitImpl*>(inputCollection->getElementAt(iHit));
-    TrackerHitImpl* outputHit = new IMPL::TrackerHitImpl(); 
-    
-    //get some basic information
-    int properties = hitDecoder(inputHit)["properties"];
-    int sensorID = hitDecoder(inputHit)["sensorID"];
-				
-    //use local2masterHit/master2localHit function in EUTelGeometryTelescopeDescription
-    //to translate input/output position		
-    const double* inputPos = inputHit->getPosition();
-    double outputPos[3];
-    
-    //transform local->global
-    if(!(properties & kHitInGlobalCoord) && !_undoAlignment) {
-      streamlog_out(DEBUG0) << "Transforming hit from local to global!" << std::endl;
-      geo::gGeometry().local2Master(sensorID, inputPos, outputPos);
-    } 
-    //transform global->local
-    else if((properties & kHitInGlobalCoord) && _undoAlignment) {
-      streamlog_out(DEBUG0) << "Transforming hit from global to local!" << std::endl;
-      geo::gGeometry().master2Local(sensorID, inputPos, outputPos);
-    } 
-    //error case
-    else {
-      std::cout << "Properties: " << properties << std::endl;
+  if(encoding != _encoding) setEncoding(encoding);
+
+  //the properties bit telling the frame of the hits, flipped by the transformation
+  std::uint64_t const globalBit = std::uint64_t(kHitInGlobalCoord) << _propertiesField.offset;
+
+  //[START] decode the cell IDs with the precomputed masks
+  size_t const nHits = static_cast<size_t>(inputCollection->getNumberOfElements());
+  _hits.resize(nHits);
+  _cellIDs.resize(nHits);
+  _sensorIDs.resize(nHits);
+  int maxSensorID = -1;
+  for(size_t iHit = 0; iHit < nHits; ++iHit) {
+    auto hit = static_cast<TrackerHitImpl*>(inputCollection->getElementAt(static_cast<int>(iHit)));
+    std::uint64_t const cellID = (std::uint64_t(static_cast<std::uint32_t>(hit->getCellID0()))) |
+                                 (std::uint64_t(static_cast<std::uint32_t>(hit->getCellID1())) << 32);
+    bool const isGlobal = (cellID & globalBit) != 0;
+    if(isGlobal != _undoAlignment) {
+      streamlog_out(ERROR5) << "Properties: " << _propertiesField.decode(cellID) << std::endl;
       std::string errMsg;
       if(!_undoAlignment) {
 	errMsg = "Provided global hit, but trying to transform into global. Something is wrong!";
@@ -138,26 +125,86 @@ void EUTelHitCoordinateTransformer::processEvent(LCEvent* event)
       }
       throw InvalidGeometryException(errMsg);
     }
-	
-    //fill new outputHit with information
-    outputHit->setPosition(outputPos);
+    int const sensorID = static_cast<int>(_sensorIDField.decode(cellID));
+    if(sensorID < 0) {
+      throw InvalidGeometryException("Hit with the invalid sensor ID " + std::to_string(sensorID));
+    }
+    _hits[iHit] = hit;
+    _cellIDs[iHit] = cellID ^ globalBit;
+    _sensorIDs[iHit] = sensorID;
+    maxSensorID = std::max(maxSensorID, sensorID);
+  }//[END] decode the cell IDs
+
+  //[START] group the hits by sensor (counting sort, stable)
+  _sensorStart.assign(static_cast<size_t>(maxSensorID + 2), 0);
+  for(int sensorID : _sensorIDs) ++_sensorStart[static_cast<size_t>(sensorID) + 1];
+  for(size_t iSensor = 1; iSensor < _sensorStart.size(); ++iSensor) {
+    _sensorStart[iSensor] += _sensorStart[iSensor - 1];
+  }
+  _groupedIndex.resize(nHits);
+  _positions.resize(3 * nHits);
+  _sensorNext.assign(_sensorStart.begin(), _sensorStart.end() - 1);
+  for(size_t iHit = 0; iHit < nHits; ++iHit) {
+    size_t const slot = _sensorNext[static_cast<size_t>(_sensorIDs[iHit])]++;
+    _groupedIndex[iHit] = slot;
+    std::copy(_hits[iHit]->getPosition(), _hits[iHit]->getPosition() + 3, &_positions[3 * slot]);
+  }//[END] group the hits by sensor
+
+  //one affine transformation per sensor over all its hits
+  for(size_t iSensor = 0; iSensor + 1 < _sensorStart.size(); ++iSensor) {
+    size_t const first = _sensorStart[iSensor];
+    size_t const nSensorHits = _sensorStart[iSensor + 1] - first;
+    if(nSensorHits == 0) continue;
+    double* positions = &_positions[3 * first];
+    if(!_undoAlignment) {
+      geo::gGeometry().local2Master(static_cast<int>(iSensor), positions, positions, nSensorHits);
+    } else {
+      geo::gGeometry().master2Local(static_cast<int>(iSensor), positions, positions, nSensorHits);
+    }
+  }
+
+  //[START] rewrite the input hits
+  if(_transformInPlace) {
+    try {
+      for(size_t iHit = 0; iHit < nHits; ++iHit) {
+	auto hit = _hits[iHit];
+	hit->setPosition(&_positions[3 * _groupedIndex[iHit]]);
+	hit->setCellID0(static_cast<int>(_cellIDs[iHit] & 0xffffffff));
+	hit->setCellID1(static_cast<int>(_cellIDs[iHit] >> 32));
+      }
+    } catch(lcio::ReadOnlyException& e) {
+      streamlog_out( ERROR5 ) << "The hits of " << _hitCollectionNameInput << " are read only, "
+			      << "TransformInPlace can only be used on hits created in the same job" << std::endl;
+      exit(-1);
+    }
+    return;
+  }//[END] rewrite the input hits
+
+  //opens collection for output
+  LCCollectionVec* outputCollection = nullptr;
+  try {
+    outputCollection = static_cast<LCCollectionVec*> (event->getCollection(_hitCollectionNameOutput));
+  } catch(...) {
+    outputCollection = new LCCollectionVec(LCIO::TRACKERHIT);
+  }
+  //sets the encoding and the cell ID flag of the output collection
+  lcio::CellIDEncoder<TrackerHitImpl> outputEncoder(encoding, outputCollection);
+  outputCollection->reserve(outputCollection->size() + nHits);
+
+  //[START] copy the hits with their new position and frame
+  for(size_t iHit = 0; iHit < nHits; ++iHit) {
+    auto inputHit = _hits[iHit];
+    TrackerHitImpl* outputHit = new IMPL::TrackerHitImpl();
+    outputHit->setPosition(&_positions[3 * _groupedIndex[iHit]]);
     outputHit->setCovMatrix( inputHit->getCovMatrix());
     outputHit->setType( inputHit->getType() );
     outputHit->setTime( inputHit->getTime() );
-    outputHit->setCellID0( inputHit->getCellID0() );
-    outputHit->setCellID1( inputHit->getCellID1() );
+    outputHit->setCellID0(static_cast<int>(_cellIDs[iHit] & 0xffffffff));
+    outputHit->setCellID1(static_cast<int>(_cellIDs[iHit] >> 32));
     outputHit->setQuality( inputHit->getQuality() );
     outputHit->rawHits() = inputHit->getRawHits();
-    
-    //and reencode hit
-    cellReencoder.readValues(outputHit);
-    //^= is a bitwise XOR i.e. will switch the coordinate system
-    cellReencoder["properties"] = properties ^= kHitInGlobalCoord;
-    cellReencoder.setCellID(outputHit);
-    //finally store it in collection
     outputCollection->push_back(outputHit);
-
-  }//[END] loop over hits
+  }//[END] copy the hits
 	
   //push the hit for this event onto the collection
   try {	
@@ -167,6 +214,18 @@ void EUTelHitCoordinateTransformer::processEvent(LCEvent* event)
   }
 }
 
+void EUTelHitCoordinateTransformer::setEncoding(std::string const& encoding)
+{
+  lcio::BitField64 fields(encoding);
+  auto locate = [&fields](std::string const& name) {
+    auto const& field = fields[name];
+    return CellIDField{ field.offset(), field.width(), static_cast<std::uint64_t>(field.mask()), field.isSigned() };
+  };
+  _sensorIDField = locate("sensorID");
+  _propertiesField = locate("properties");
+  _encoding = encoding;
+}
+
 void EUTelHitCoordinateTransformer::end()
 {
   streamlog_out(MESSAGE4) << "Successfully finished" << std::endl;
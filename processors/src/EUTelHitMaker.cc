@@ -20,6 +20,7 @@
 #include "EUTelGeometricClusterImpl.h"
 #include "EUTelSimpleVirtualCluster.h"
 #include "EUTelSparseClusterImpl.h"
+#include "EUTelTrackerDataView.h"
 
 #include "EUTelGeometryTelescopeGeoDescription.h"
 #include "EUTelExceptions.h"
@@ -59,7 +60,8 @@ using namespace eutelescope;
 EUTelHitMaker::EUTelHitMaker()
     : Processor("EUTelHitMaker"), _pulseCollectionName(),
       _hitCollectionName(), _switchLocalCoordinates(false), _histogramSwitch(true),
-      _iRun(0), _iEvt(0), _alreadyBookedSensorID() {
+      _iRun(0), _iEvt(0), _alreadyBookedSensorID(), _nThreads(1),
+      _workerPool() {
  
   _description = "EUTelHitMaker is responsible to translate cluster "
                  "centers from the local frame of reference \n to the external "
@@ -86,6 +88,11 @@ EUTelHitMaker::EUTelHitMaker()
 			    "Switch for histogram plotting (default: true)",
 			    _histogramSwitch,
 			    true);
+
+  registerOptionalParameter("NumberOfThreads",
+			    "Number of threads used to compute the cluster positions of an event in parallel (1 == serial)",
+			    _nThreads,
+			    1);
 }
 
 void EUTelHitMaker::init() {
@@ -101,6 +108,9 @@ void EUTelHitMaker::init() {
                                              EUTELESCOPE::DUMPGEOROOT);
 
   _histogramSwitch = true;
+
+  //the worker threads live for the whole job
+  _workerPool = std::make_unique<EUTelWorkerPool>(static_cast<unsigned>(std::max(_nThreads, 1)));
 }
 
 void EUTelHitMaker::processRunHeader(LCRunHeader *rdr) {
@@ -169,23 +179,27 @@ void EUTelHitMaker::processEvent(LCEvent *event) {
       EUTELESCOPE::ZSDATADEFAULTENCODING);
 
   int oldDetectorID = -100;
-  double xSize = 0., ySize = 0.;
-  double resolutionX = 0., resolutionY = 0.;
-  double xPitch = 0., yPitch = 0.;
+  auto const &geometry = geo::gGeometry();
+  geo::EUTelPlaneCache const *plane = nullptr;
+
+  //first decode the clusters and pick up the sensor information, this touches
+  //the cell ID decoders, the histogram booking and the geometry: stay serial
+  std::vector<HitJob> hitJobs(static_cast<size_t>(pulseCollection->getNumberOfElements()));
 
   //[START] loop over cluster
-  for(int iCluster = 0; iCluster < pulseCollection->getNumberOfElements();
-       iCluster++) {
-    TrackerPulseImpl *pulse = dynamic_cast<TrackerPulseImpl *>(
-        pulseCollection->getElementAt(iCluster));
-    TrackerDataImpl *trackerData =
-        dynamic_cast<TrackerDataImpl *>(pulse->getTrackerData());
-
-    int sensorID = clusterCellDecoder(pulse)["sensorID"];
-    ClusterType clusterType = static_cast<ClusterType>(
-        static_cast<int>(clusterCellDecoder(pulse)["type"]));
-    SparsePixelType pixelType = static_cast<SparsePixelType>(
-        static_cast<int>(cellDecoder(trackerData)["sparsePixelType"]));
+  for(size_t iCluster = 0; iCluster < hitJobs.size(); iCluster++) {
+    auto& job = hitJobs[iCluster];
+    job.pulse = dynamic_cast<TrackerPulseImpl *>(
+        pulseCollection->getElementAt(static_cast<int>(iCluster)));
+    job.trackerData =
+        dynamic_cast<TrackerDataImpl *>(job.pulse->getTrackerData());
+
+    int sensorID = clusterCellDecoder(job.pulse)["sensorID"];
+    job.sensorID = sensorID;
+    job.clusterType = static_cast<ClusterType>(
+        static_cast<int>(clusterCellDecoder(job.pulse)["type"]));
+    job.pixelType = static_cast<SparsePixelType>(
+        static_cast<int>(cellDecoder(job.trackerData)["sparsePixelType"]));
 
     //there could be several clusters belonging to the same
     //detector. So update the geometry information only if this new
@@ -199,122 +213,61 @@ void EUTelHitMaker::processEvent(LCEvent *event) {
       }
 
       //all values given in mm
-      resolutionX = geo::gGeometry().getPlaneXResolution(sensorID);
-      resolutionY = geo::gGeometry().getPlaneYResolution(sensorID);
-      xSize = geo::gGeometry().getPlaneXSize(sensorID);
-      ySize = geo::gGeometry().getPlaneYSize(sensorID);
-      xPitch = geo::gGeometry().getPlaneXPitch(sensorID);
-      yPitch = geo::gGeometry().getPlaneYPitch(sensorID);
+      plane = &geometry.getPlaneCache(sensorID);
     }
+    job.plane = plane;
 
-    //LOCAL coordinate system!
-    double telPos[3];
-    
-    //[IF] cluster type
-    if(clusterType == kEUTelGenericSparseClusterImpl) {
-      float xPos = 0;
-      float yPos = 0;
-
-      //for genericSparseCluster: need to know underlying pixel type
-      if(pixelType == kEUTelGenericSparsePixel) {
-        EUTelGenericSparseClusterImpl<EUTelGenericSparsePixel> cluster(
-            trackerData);
-        cluster.getCenterOfGravity(xPos, yPos);
-
-        //for non-geometric clusters: getCenterOfGravity will return it in
-        //pixel indices space, i.e have to transform into mm via the dimensions
-        xPos = (xPos + 0.5) * xPitch - xSize / 2.;
-        yPos = (yPos + 0.5) * yPitch - ySize / 2.;
-      
-      } else if(pixelType == kEUTelGeometricPixel) {
-        EUTelGeometricClusterImpl cluster(trackerData);
-        cluster.getGeometricCenterOfGravity(xPos, yPos);
-      
-      } else {
-        streamlog_out(ERROR4) << "We do not support pixel type: " << pixelType
-                              << " for kEUTelGenericSparseClusterImpl"
-                              << std::endl;
-        throw UnknownDataTypeException(
-            "Pixel type not supported for kEUTelGenericSparseClusterImpl");
-      }
+    if(job.clusterType == kEUTelGenericSparseClusterImpl &&
+       job.pixelType != kEUTelGenericSparsePixel && job.pixelType != kEUTelGeometricPixel) {
+      streamlog_out(ERROR4) << "We do not support pixel type: " << job.pixelType
+                            << " for kEUTelGenericSparseClusterImpl"
+                            << std::endl;
+      throw UnknownDataTypeException(
+          "Pixel type not supported for kEUTelGenericSparseClusterImpl");
+    }
 
-      telPos[0] = xPos;
-      telPos[1] = yPos;
-      telPos[2] = 0;
+    //!HACK TAKI:
+    //! In case of a bricked cluster, we have to make sure to get the normal
+    //! CoG first. The one without the global seed coordinate correction
+    //! (caused by pixel rows being skewed). That one has to be eta-corrected
+    //! and the global coordinate correction has to be applied on top of that!
+    //! This is not available from the sparse cluster interface used below.
+    if(job.clusterType == kEUTelBrickedClusterImpl) {
+      streamlog_out(ERROR4) << " .COULD NOT CREATE EUTelBrickedClusterImpl* !!!" << std::endl;
+      throw UnknownDataTypeException(
+          "COULD NOT CREATE EUTelBrickedClusterImpl* !!!");
     }
-    //[ELSE] cluster type
-	else {
-      EUTelSparseClusterImpl<EUTelGenericSparsePixel> *cluster =
-          new EUTelSparseClusterImpl<EUTelGenericSparsePixel>(trackerData);
-
-      // get the position of the seed pixel (in pixel number)
-      int xCluSeed = 0;
-      int yCluSeed = 0;
-      cluster->getSeedCoord(xCluSeed, yCluSeed);
-
-      //with the charge center of gravity calculation, we get a shift
-      //from the seed pixel center due to the charge distribution. Those
-      //two numbers are the correction values in the case the Eta
-      //correction is not applied.
-
-      //!HACK TAKI:
-      //! In case of a bricked cluster, we have to make sure to get the normal
-      //! CoG first.
-      //! The one without the global seed coordinate correction (caused by pixel
-      //! rows being skewed).
-      //! That one has to be eta-corrected and the global coordinate correction
-      //! has to be applied on top of that!
-      //! So prepare a brickedCluster pointer now:
-
-      EUTelBrickedClusterImpl *p_tmpBrickedCluster = nullptr;
-      if(clusterType == kEUTelBrickedClusterImpl) {
-        p_tmpBrickedCluster = dynamic_cast<EUTelBrickedClusterImpl *>(cluster);
-        if(p_tmpBrickedCluster == nullptr) {
-          streamlog_out(ERROR4) << " .COULD NOT CREATE EUTelBrickedClusterImpl* !!!" << std::endl;
-          throw UnknownDataTypeException(
-              "COULD NOT CREATE EUTelBrickedClusterImpl* !!!");
-        }
-      }
+  }//[END] loop over cluster
 
-      float xShift = 0.;
-      float yShift = 0.;
-      cluster->getCenterOfGravityShift(xShift, yShift);
-      double xCorrection = static_cast<double>(xShift);
-      double yCorrection = static_cast<double>(yShift);
+  //the cluster positions only depend on the cluster itself and the cached
+  //plane placement, which is read-only here
+  bool const toGlobal = !_switchLocalCoordinates;
+  _workerPool->parallelFor(hitJobs.size(), [&hitJobs, &geometry, toGlobal](size_t iJob, unsigned) {
+    auto &job = hitJobs[iJob];
+    computeLocalPosition(job);
+    if(toGlobal) {
+      geometry.local2Master(job.sensorID, job.localPos, job.hitPos);
+    } else {
+      std::copy(job.localPos, job.localPos + 3, job.hitPos);
+    }
+  });
 
-      //rescale the pixel number in millimeter
-      double xDet =
-          (static_cast<double>(xCluSeed) + xCorrection + 0.5) * xPitch;
-      double yDet =
-          (static_cast<double>(yCluSeed) + yCorrection + 0.5) * yPitch;
+  //[START] loop over cluster
+  for(size_t iCluster = 0; iCluster < hitJobs.size(); iCluster++) {
+    auto& job = hitJobs[iCluster];
+    int sensorID = job.sensorID;
 
-      //FIXME? check the hack from Havard:
-      float xCoG(0.0f), yCoG(0.0f);
-      cluster->getCenterOfGravity(xCoG, yCoG);
-      xDet = (xCoG + 0.5) * xPitch;
-      yDet = (yCoG + 0.5) * yPitch;
+    //LOCAL coordinate system!
+    double telPos[3] = {job.localPos[0], job.localPos[1], job.localPos[2]};
 
+    if(job.clusterType != kEUTelGenericSparseClusterImpl) {
       streamlog_out(DEBUG1)
           << "cluster[" << setw(4) << iCluster << "] on sensor[" << setw(3)
-          << sensorID << "] at [" << setw(8) << setprecision(3) << xCoG << ":"
-          << setw(8) << setprecision(3) << yCoG << "]"
-          << " ->  [" << setw(8) << setprecision(3) << xDet << ":" << setw(8)
-          << setprecision(3) << yDet << "]" << std::endl;
-
-      //We have calculated the cluster hit position in terms of distance along
-      //the X and Y axis.
-      //However we still do not have the sensor centre as the origin of the
-      //coordinate system.
-      //To do this we need to deduct xSize/2 and ySize/2 for the respective
-      //cluster X/Y position
-
-      telPos[0] = xDet - xSize / 2.;
-      telPos[1] = yDet - ySize / 2.;
-      telPos[2] = 0.;
-
-      delete cluster;
-      cluster = nullptr;
-    }//[END] cluster type
+          << sensorID << "] at [" << setw(8) << setprecision(3) << job.xCoG << ":"
+          << setw(8) << setprecision(3) << job.yCoG << "]"
+          << " ->  [" << setw(8) << setprecision(3) << telPos[0] + job.plane->xSize / 2. << ":" << setw(8)
+          << setprecision(3) << telPos[1] + job.plane->ySize / 2. << "]" << std::endl;
+    }
 
 	//plot hits in the EUTelescope local frame; this frame has the
 	//coordinate centre at the sensor centre
@@ -333,12 +286,9 @@ void EUTelHitMaker::processEvent(LCEvent *event) {
     }
 #endif
 
-    if(!_switchLocalCoordinates) {
-      // NOW !!
-      // GLOBAL coordinate system !!!
-      const double localPos[3] = {telPos[0], telPos[1], telPos[2]};
-      geo::gGeometry().local2Master(sensorID, localPos, telPos);
-    }
+    // NOW !!
+    // GLOBAL coordinate system (unless switched off) !!!
+    std::copy(job.hitPos, job.hitPos + 3, telPos);
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
     if(_histogramSwitch) {
@@ -359,17 +309,17 @@ void EUTelHitMaker::processEvent(LCEvent *event) {
     TrackerHitImpl *hit = new TrackerHitImpl;
     hit->setPosition(&telPos[0]);
     float cov[TRKHITNCOVMATRIX] = {0., 0., 0., 0., 0., 0.};
-    double resx = resolutionX;
-    double resy = resolutionY;
+    double resx = job.plane->xResolution;
+    double resy = job.plane->yResolution;
     cov[0] = resx * resx; //cov(x,x)
     cov[2] = resy * resy; //cov(y,y)
     hit->setCovMatrix(cov);
-    hit->setType(clusterType);
-    hit->setTime(pulse->getTime());
+    hit->setType(job.clusterType);
+    hit->setTime(job.pulse->getTime());
 
     //prepare a LCObjectVec to store the current cluster
     LCObjectVec clusterVec;
-    clusterVec.push_back(trackerData);
+    clusterVec.push_back(job.trackerData);
 
     //add the clusterVec to the hit
     hit->rawHits() = clusterVec;
@@ -397,6 +347,64 @@ void EUTelHitMaker::processEvent(LCEvent *event) {
   if(isFirstEvent()) _isFirstEvent = false;
 }
 
+void EUTelHitMaker::computeLocalPosition(HitJob &job) {
+
+  //[IF] cluster type
+  if(job.clusterType == kEUTelGenericSparseClusterImpl) {
+    float xPos = 0;
+    float yPos = 0;
+
+    //for genericSparseCluster: need to know underlying pixel type
+    if(job.pixelType == kEUTelGenericSparsePixel) {
+      EUTelGenericSparseClusterImpl<EUTelGenericSparsePixel> cluster(
+          job.trackerData);
+      cluster.getCenterOfGravity(xPos, yPos);
+
+      //for non-geometric clusters: getCenterOfGravity will return it in
+      //pixel indices space, i.e have to transform into mm via the dimensions
+      xPos = (xPos + 0.5) * job.plane->xPitch - job.plane->xSize / 2.;
+      yPos = (yPos + 0.5) * job.plane->yPitch - job.plane->ySize / 2.;
+    } else {
+      EUTelGeometricClusterImpl cluster(job.trackerData);
+      cluster.getGeometricCenterOfGravity(xPos, yPos);
+    }
+
+    job.localPos[0] = xPos;
+    job.localPos[1] = yPos;
+    job.localPos[2] = 0;
+    return;
+  }
+
+  //[ELSE IF] cluster type
+  if(job.clusterType == kEUTelSparseClusterImpl) {
+    //plain sparse clusters: the centre of gravity is computed straight from
+    //the charge values, without creating the cluster and pixel objects
+    EUTelTrackerDataView pixels(job.trackerData, kEUTelGenericSparsePixel);
+    pixels.getCenterOfGravity(job.xCoG, job.yCoG);
+  }
+  //[ELSE] cluster type
+  else {
+    //FIXME? check the hack from Havard: the charge centre of gravity is
+    //used directly instead of the seed pixel plus the centre of gravity shift
+    EUTelSparseClusterImpl<EUTelGenericSparsePixel> cluster(job.trackerData);
+    cluster.getCenterOfGravity(job.xCoG, job.yCoG);
+  }//[END] cluster type
+
+  //rescale the pixel number in millimeter
+  double xDet = (job.xCoG + 0.5) * job.plane->xPitch;
+  double yDet = (job.yCoG + 0.5) * job.plane->yPitch;
+
+  //We have calculated the cluster hit position in terms of distance along
+  //the X and Y axis.
+  //However we still do not have the sensor centre as the origin of the
+  //coordinate system.
+  //To do this we need to deduct xSize/2 and ySize/2 for the respective
+  //cluster X/Y position
+  job.localPos[0] = xDet - job.plane->xSize / 2.;
+  job.localPos[1] = yDet - job.plane->ySize / 2.;
+  job.localPos[2] = 0.;
+}
+
 void EUTelHitMaker::end() {
   streamlog_out(MESSAGE4) << "Successfully finished" << endl;
 }
@@ -13,6 +13,7 @@
 #include "EUTELESCOPE.h"
 #include "EUTelRunHeaderImpl.h"
 #include "EUTelTrackerDataInterfacerImpl.h"
+#include "EUTelTrackerDataView.h"
 #include "EUTelUtility.h"
 
 // marlin includes ".h"
@@ -84,8 +85,8 @@ namespace eutelescope {
   void EUTelNoisyClusterMasker::processEvent(LCEvent *event) {
     if (_firstEvent) {
       //noisy pixel collection stores all thot pixels in event #1, thus read it
-      _noisyPixelMap =
-          Utility::readNoisyPixelList(event, _noisyPixelCollectionName);
+      _noisyPixelMasks =
+          Utility::readNoisyPixelMasks(event, _noisyPixelCollectionName);
       _firstEvent = false;
     }
 
@@ -100,6 +101,9 @@ namespace eutelescope {
 
     //prepare decoder for input data
     CellIDDecoder<TrackerPulseImpl> cellDecoder(pulseInputCollectionVec);
+    //and the one for the attached tracker data
+    CellIDDecoder<TrackerDataImpl> trackerDecoder(
+        EUTELESCOPE::ZSCLUSTERDEFAULTENCODING);
 
     //read the encoding string from the input collection
     std::string encoding = pulseInputCollectionVec->
@@ -116,26 +120,22 @@ namespace eutelescope {
           pulseInputCollectionVec->getElementAt(iPulse));
       int sensorID = cellDecoder(pulseData)["sensorID"];
 
-      //get noise vector for the given plane
-      std::vector<int> *noiseVector = &(_noisyPixelMap[sensorID]);
+      //get the hot pixel mask for the given plane, nothing to do without one
+      EUTelPixelMask const *noiseMask = _noisyPixelMasks.find(sensorID);
+      if(noiseMask == nullptr || noiseMask->count() == 0) continue;
 
       //each pulse has tracker data attached to it
       TrackerDataImpl *trackerData =
           dynamic_cast<TrackerDataImpl *>(pulseData->getTrackerData());
-      //decoder for tracker data
-      CellIDDecoder<TrackerDataImpl> trackerDecoder(
-          EUTELESCOPE::ZSCLUSTERDEFAULTENCODING);
       int pixelType = trackerDecoder(trackerData)["sparsePixelType"];
 
-      //interface to sparsified data
-      auto sparseData = Utility::getSparseData(trackerData, pixelType);
+      //read the pixel indices straight from the charge values
+      EUTelTrackerDataView pixels(trackerData, pixelType);
       bool noisy = false;
 
       //[START] loop over all hits
-      for(auto &pixelRef : *sparseData) {
-        auto &pixel = pixelRef.get();
-        if(std::binary_search(noiseVector->begin(), noiseVector->end(),
-                Utility::cantorEncode(pixel.getXCoord(), pixel.getYCoord()))) {
+      for(size_t iPixel = 0; iPixel < pixels.size(); ++iPixel) {
+        if(noiseMask->test(pixels.getXCoord(iPixel), pixels.getYCoord(iPixel))) {
           noisy = true;
           break;
         }
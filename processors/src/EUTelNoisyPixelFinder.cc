@@ -12,6 +12,7 @@
 #include "EUTELESCOPE.h"
 #include "EUTelRunHeaderImpl.h"
 #include "EUTelTrackerDataInterfacerImpl.h"
+#include "EUTelTrackerDataView.h"
 
 // eutelescope geometry
 #include "EUTelGenericPixGeoDescr.h"
@@ -116,35 +117,18 @@ namespace eutelescope {
         minX = minY = maxX = maxY = 0;
         geoDescr->getPixelIndexRange(minX, maxX, minY, maxY);
 
-        //a sensor structs holds all the helpful information
-        sensor thisSensor;
-        thisSensor.offX  = minX;
-        thisSensor.sizeX = maxX-minX+1;
-        thisSensor.offY  = minY;
-        thisSensor.sizeY = maxY-minY+1;
-
-        //this is the 2-dimensional array used to store all the pixels, it is
-        //implemented as a vector of vectors
-        //first the x-entries-vector
-        std::vector<std::vector<long int>> hitVecP =
-            std::vector<std::vector<long int>>(thisSensor.sizeX);
-
-        //and the y-entries vector
-        for(auto &ihit : hitVecP) {
-          //resize it now
-          ihit.resize(thisSensor.sizeY, 0);
-        }
+        //a dense matrix of 32 bit counters over all the pixel indices
+        EUTelPixelRange range(minX, maxX, minY, maxY);
 
-		//make vector for firing frequency
-	    auto& firingFreqVec = _firingFreqForAllPixels[sensorID];
-	    firingFreqVec.resize(thisSensor.sizeX*thisSensor.sizeY);
+        //make vector for firing frequency
+        auto& firingFreqVec = _firingFreqForAllPixels[sensorID];
+        firingFreqVec.resize(range.size());
 
         //collection to later hold the hot pixels
         std::vector<EUTelGenericSparsePixel> noisyPixelMap;
 
         //store all the collections/pointers in the corresponding maps
-        _sensorMap[sensorID] = thisSensor;
-        _hitVecMap[sensorID] = hitVecP;
+        _hitCounters.insert(sensorID, EUTelPixelCounter(range));
         _noisyPixelMap[sensorID] = noisyPixelMap;
       } catch (std::runtime_error &e) {
         streamlog_out(ERROR0) << "Noisy pixel masker could not retrieve plane "
@@ -195,8 +179,7 @@ namespace eutelescope {
             zsInputCollectionVec->getElementAt(iDetector));
         int sensorID = static_cast<int>(cellDecoder(zsData)["sensorID"]);
 
-        sensor *currentSensor = &_sensorMap[sensorID];
-        std::vector<std::vector<long int>> *hitArray = &_hitVecMap[sensorID];
+        EUTelPixelCounter *hitCounter = _hitCounters.find(sensorID);
 
         //if this is an excluded sensor go to the next element
         bool foundExcludedSensor = false;
@@ -205,25 +188,19 @@ namespace eutelescope {
         }
         if(foundExcludedSensor) continue;
 
-        //now prepare the EUTelescope interface to sparsified data
+        //now prepare a view on the sparsified data, no pixel objects needed
         int pixelType = cellDecoder(zsData)["sparsePixelType"];
-        auto sparseData = Utility::getSparseData(zsData, pixelType);
-
-        //loop over all pixels in the sparseData object, these are the hit pixels
-        for(auto &pixelRef : *sparseData) {
-          auto &pixel = pixelRef.get();
+        EUTelTrackerDataView pixels(zsData, pixelType);
+        auto xColumn = pixels.x();
+        auto yColumn = pixels.y();
 
-          //compute the address in the array-like-structure, any offset
-          //has to be substracted (array index starts at 0)
-          int indexX = pixel.getXCoord() - currentSensor->offX;
-          int indexY = pixel.getYCoord() - currentSensor->offY;
+        //loop over all pixels in the view, these are the hit pixels
+        for(size_t iPixel = 0; iPixel < pixels.size(); ++iPixel) {
 
-          try {
-            //increment the hit counter for this pixel
-            (hitArray->at(indexX)).at(indexY)++;
-          } catch(std::out_of_range &e) {
+          //increment the hit counter for this pixel
+          if(hitCounter == nullptr || !hitCounter->increment(xColumn[iPixel], yColumn[iPixel])) {
             streamlog_out(ERROR5)
-                << "Pixel: " << pixel.getXCoord() << "|" << pixel.getYCoord()
+                << "Pixel: " << xColumn[iPixel] << "|" << yColumn[iPixel]
                 << " on plane: " << sensorID << " fired." << std::endl
                 << "This pixel is out of the range defined by the geometry. "
                    "Either your data is corrupted or your pixel geometry not "
@@ -312,7 +289,7 @@ namespace eutelescope {
           << std::endl;
 
       //[START] loop over all the sensors in sensorMap
-      for(auto &thisSensor : _sensorMap) {
+      for(auto &thisSensor : _hitCounters) {
         auto sensorID = thisSensor.first;
         streamlog_out(MESSAGE3) << "~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~"
                                    "~~~~~~~~~~~~~~~~~~~~~~~"
@@ -325,31 +302,28 @@ namespace eutelescope {
                                    "~~~~~~~~~~~~~~~~~~~~~~~"
                                 << std::endl;
 
-        //get the corresponding hit array-like vector of vectors
-        std::vector<std::vector<long int>> *hitVector = &_hitVecMap[sensorID];
-        //and the sensor which stores offsets
-        sensor *currentSensor = &_sensorMap[sensorID];
-		auto& firingFreqVec = _firingFreqForAllPixels[sensorID]; 
-
-        //[START] loop over all pixels
-        for(auto xIt = hitVector->begin(); xIt != hitVector->end(); ++xIt) {
-          for(auto yIt = xIt->begin(); yIt != xIt->end(); ++yIt) {
-            //compute the firing frequency
-            double fireFreq = static_cast<double>(*yIt) / static_cast<double>(_iEvt);
-            firingFreqVec.push_back(fireFreq);
-            //if larger than the allowed one, write pixel into a collection
-            if(fireFreq > _maxAllowedFiringFreq) {
-              streamlog_out(MESSAGE3)
-                  << "Pixel: " << xIt - hitVector->begin() + currentSensor->offX
-                  << "|" << yIt - xIt->begin() + currentSensor->offY
-                  << " fired " << fireFreq << std::endl;
-              EUTelGenericSparsePixel pixel;
-              pixel.setXCoord(xIt - hitVector->begin() + currentSensor->offX);
-              pixel.setYCoord(yIt - xIt->begin() + currentSensor->offY);
-              pixel.setSignal(fireFreq);
-              //writing it out
-              _noisyPixelMap[sensorID].push_back(pixel);
-            }
+        //get the corresponding hit counters and their pixel range
+        auto const &range = thisSensor.second.getRange();
+        auto const &hitCounts = thisSensor.second.getCounts();
+        auto& firingFreqVec = _firingFreqForAllPixels[sensorID]; 
+
+        //[START] loop over all pixels, x-major as the counters are stored
+        for(size_t iPixel = 0; iPixel < hitCounts.size(); ++iPixel) {
+          //compute the firing frequency
+          double fireFreq = static_cast<double>(hitCounts[iPixel]) / static_cast<double>(_iEvt);
+          firingFreqVec.push_back(fireFreq);
+          //if larger than the allowed one, write pixel into a collection
+          if(fireFreq > _maxAllowedFiringFreq) {
+            streamlog_out(MESSAGE3)
+                << "Pixel: " << range.getX(iPixel)
+                << "|" << range.getY(iPixel)
+                << " fired " << fireFreq << std::endl;
+            EUTelGenericSparsePixel pixel;
+            pixel.setXCoord(range.getX(iPixel));
+            pixel.setYCoord(range.getY(iPixel));
+            pixel.setSignal(fireFreq);
+            //writing it out
+            _noisyPixelMap[sensorID].push_back(pixel);
           }
         }//[END] loop over pixel
       }//[END] loop over sensors
@@ -460,7 +434,9 @@ namespace eutelescope {
     //[START] loop of sensors
     for(auto det : _sensorIDVec) {
       
-      sensor *currentSensor = &_sensorMap[det];
+      EUTelPixelCounter const *hitCounter = _hitCounters.find(det);
+      if(hitCounter == nullptr) continue;
+      auto const &range = hitCounter->getRange();
       
       //create folder for current detector
       std::string basePath = "detector_" + std::to_string(det);
@@ -487,12 +463,12 @@ namespace eutelescope {
     
       //create 2D histogram: firing frequency
       std::string histName_firingFreq2D = basePath+"/FiringFrequency2D_det";
-      int xBin = currentSensor->sizeX + 1;
-      double xMin = static_cast<double>(currentSensor->offX) - 0.5;
-      double xMax = static_cast<double>(currentSensor->offX + currentSensor->sizeX) + 0.5;
-      int yBin 	= currentSensor->sizeY + 1;
-      double yMin = static_cast<double>(currentSensor->offY) - 0.5;
-      double yMax = static_cast<double>(currentSensor->offY + currentSensor->sizeY) + 0.5;
+      int xBin = static_cast<int>(range.getSizeX()) + 1;
+      double xMin = static_cast<double>(range.getMinX()) - 0.5;
+      double xMax = static_cast<double>(range.getMaxX() + 1) + 0.5;
+      int yBin 	= static_cast<int>(range.getSizeY()) + 1;
+      double yMin = static_cast<double>(range.getMinY()) - 0.5;
+      double yMax = static_cast<double>(range.getMaxY() + 1) + 0.5;
       AIDA::IHistogram2D *hist2D_firingFreq = marlin::AIDAProcessor::histogramFactory(this)->
 	createHistogram2D(histName_firingFreq2D, xBin, xMin, xMax, yBin, yMin, yMax);
       hist2D_firingFreq->setTitle("Firing frequency map of hot pixels; Pixel Index X; Pixel Index Y; Percent (%)");
@@ -142,6 +142,24 @@ EUTelPreAligner::EUTelPreAligner()
 			    "The list of sensor IDs for which the Y coordinate  shall be excluded.",
 			    _excludedPlanesYCoord,
 			    std::vector<int>());
+
+  registerOptionalParameter("ConvergenceInterval",
+			    "Number of events between two estimations of the offsets (default: 1000)",
+			    _convergenceInterval,
+			    1000);
+
+  registerOptionalParameter("ConvergenceTolerance",
+			    "Largest change [mm] of every offset between two estimations for them to be "
+			    "final, the remaining events are then ignored; 0 to use all the required events "
+			    "(default: 0.01)",
+			    _convergenceTolerance,
+			    0.01f);
+
+  registerOptionalParameter("StopWhenConverged",
+			    "Stop the processing of the job once the offsets are final, only for jobs "
+			    "doing nothing but the prealignment (default: false)",
+			    _stopWhenConverged,
+			    false);
 }
 
 void EUTelPreAligner::init() {
@@ -160,9 +178,17 @@ void EUTelPreAligner::init() {
     _sensorIDtoZOrderMap.insert(std::make_pair(sensorID, static_cast<int>(index)));
   
     if(sensorID != _fixedID) {
+      if(sensorID >= 0 && static_cast<size_t>(sensorID) >= _preAlignerIndex.size()) {
+	_preAlignerIndex.resize(static_cast<size_t>(sensorID) + 1, -1);
+      }
+      if(sensorID >= 0) _preAlignerIndex[static_cast<size_t>(sensorID)] = static_cast<int>(_preAligners.size());
       _preAligners.push_back(PreAligner(geo::gGeometry().getPlaneZPosition(sensorID),sensorID));
     }	
   }	
+
+  _converged = false;
+  _lastPeakX.assign(_preAligners.size(), std::numeric_limits<float>::quiet_NaN());
+  _lastPeakY.assign(_preAligners.size(), std::numeric_limits<float>::quiet_NaN());
 }
 
 void EUTelPreAligner::processRunHeader(LCRunHeader *rdr) {
@@ -183,8 +209,8 @@ void EUTelPreAligner::processEvent(LCEvent *event) {
 
   ++_iEvt;
 
-  //if number of required events reached, stop
-  if(_iEvt > _requiredEvents)
+  //if number of required events reached or the offsets are final, stop
+  if(_iEvt > _requiredEvents || _converged)
     return;
 
   EUTelEventImpl *evt = static_cast<EUTelEventImpl *>(event);
@@ -206,86 +232,67 @@ void EUTelPreAligner::processEvent(LCEvent *event) {
         evt->getCollection(_inputHitCollectionName));
     UTIL::CellIDDecoder<TrackerHitImpl> hitDecoder(EUTELESCOPE::HITENCODING);
 
-    std::vector<float> residX;
-    std::vector<float> residY;
-    std::vector<PreAligner *> prealign;
+    //[START] decode the hits once, sorting them into fixed plane and other hits
+    _refHits.clear();
+    _planeHits.clear();
+    for(size_t iHit = 0; iHit < inputCollectionVec->size(); iHit++) {
 
-    //[START] loop over hits in fixed plane
-    for(size_t ref = 0; ref < inputCollectionVec->size(); ref++) {
-
-      TrackerHitImpl *refHit =
-          dynamic_cast<TrackerHitImpl *>(inputCollectionVec->getElementAt(ref));
-      const double *refPos = refHit->getPosition();
-      int sensorID = hitDecoder(refHit)["sensorID"];
-      
-      //identify fixed plane
-      if(sensorID != _fixedID)
-        continue;
+      TrackerHitImpl *hit = dynamic_cast<TrackerHitImpl *>(
+          inputCollectionVec->getElementAt(static_cast<int>(iHit)));
+      const double *pos = hit->getPosition();
+      int sensorID = hitDecoder(hit)["sensorID"];
 
-      residX.clear();
-      residY.clear();
-      prealign.clear();
-
-	  //[START] loop over other hits
-      for(size_t iHit = 0; iHit < inputCollectionVec->size(); iHit++) {
-
-        TrackerHitImpl *hit = dynamic_cast<TrackerHitImpl *>(
-            inputCollectionVec->getElementAt(iHit));
-        const double *pos = hit->getPosition();
-        int iHitID = hitDecoder(hit)["sensorID"];
-
-		//if fixed plane, skip
-        if(iHitID == _fixedID)
-          continue;
-          
-        bool gotIt(false);
-
-		//[START] loop over preAligners
-        for(size_t ii = 0; ii < _preAligners.size(); ii++) {
+      if(sensorID == _fixedID) {
+	_refHits.emplace_back(static_cast<float>(pos[0]), static_cast<float>(pos[1]));
+	continue;
+      }
 
-          PreAligner &pa = _preAligners.at(ii);
+      int const index = (sensorID >= 0 && static_cast<size_t>(sensorID) < _preAlignerIndex.size())
+	? _preAlignerIndex[static_cast<size_t>(sensorID)] : -1;
+      if(index < 0) {
+	streamlog_out(ERROR5) << "Mismatched hit at " << pos[2] << endl;
+	continue;
+      }
+      _planeHits.push_back(PlaneHit{static_cast<size_t>(index), static_cast<float>(pos[0]),
+				    static_cast<float>(pos[1])});
+    }//[END] decode the hits
 
-          if(pa.getIden() != iHitID)
-          	continue;
-   
-   	      gotIt = true;
-
-          double correlationX = refPos[0] - pos[0];
-          double correlationY = refPos[1] - pos[1];
-          int idZ = _sensorIDtoZOrderMap[iHitID];
-
-          if((_residualsXMin[idZ] < correlationX) &&
-              (correlationX < _residualsXMax[idZ]) &&
-              (_residualsYMin[idZ] < correlationY) &&
-              (correlationY < _residualsYMax[idZ])) {
-            residX.push_back(correlationX);
-            residY.push_back(correlationY);
-            prealign.push_back(&pa);
-          }
-          break;
-        }//[END] loop over prealigners
-        
-        if(!gotIt) {
-          streamlog_out(ERROR5) << "Mismatched hit at " << pos[2] << endl;
-        }
+    //[START] loop over hits in fixed plane
+    for(auto const &refHit : _refHits) {
+
+      _correlatedHits.clear();
+
+      //[START] loop over other hits
+      for(auto const &planeHit : _planeHits) {
+	double correlationX = refHit.first - planeHit.x;
+	double correlationY = refHit.second - planeHit.y;
+	int idZ = _sensorIDtoZOrderMap[_preAligners[planeHit.preAligner].getIden()];
+
+	if((_residualsXMin[idZ] < correlationX) &&
+	   (correlationX < _residualsXMax[idZ]) &&
+	   (_residualsYMin[idZ] < correlationY) &&
+	   (correlationY < _residualsYMax[idZ])) {
+	  _correlatedHits.push_back(PlaneHit{planeHit.preAligner, static_cast<float>(correlationX),
+					     static_cast<float>(correlationY)});
+	}
       }//[END] loop over other hits
       
-      if(prealign.size() > static_cast<unsigned int>(_minNumberOfCorrelatedHits) 
-      		&& residX.size() == residY.size()) {
+      if(_correlatedHits.size() > static_cast<unsigned int>(_minNumberOfCorrelatedHits)) {
       		
       	//[START] loop over prealigners
-        for(unsigned int ii = 0; ii < prealign.size(); ii++) {
-        
-           prealign.at(ii)->addPoint(residX.at(ii), residY.at(ii));
+        for(auto const &correlated : _correlatedHits) {
+          PreAligner &pa = _preAligners[correlated.preAligner];
+          pa.addPoint(correlated.x, correlated.y);
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
           if(_histogramSwitch) {
-            (dynamic_cast<AIDA::IHistogram1D *>(
-                 _hitXCorr[prealign.at(ii)->getIden()]))
-                ->fill(residX.at(ii));
-            (dynamic_cast<AIDA::IHistogram1D *>(
-                 _hitYCorr[prealign.at(ii)->getIden()]))
-                ->fill(residY.at(ii));
+            auto histoX = _hitXCorr.find(pa.getIden());
+            auto histoY = _hitYCorr.find(pa.getIden());
+            //the excluded planes have no histograms
+            if(histoX != _hitXCorr.end()) {
+              dynamic_cast<AIDA::IHistogram1D *>(histoX->second)->fill(correlated.x);
+              dynamic_cast<AIDA::IHistogram1D *>(histoY->second)->fill(correlated.y);
+            }
           }
 #endif
         }//[END] loop over prealigners
@@ -300,6 +307,43 @@ void EUTelPreAligner::processEvent(LCEvent *event) {
 
   if(isFirstEvent())
     _isFirstEvent = false;
+
+  //periodic estimation of the offsets
+  if(_convergenceTolerance > 0 && _convergenceInterval > 0 && _iEvt % _convergenceInterval == 0 &&
+     checkConvergence()) {
+    _converged = true;
+    streamlog_out(MESSAGE5) << "Prealignment offsets converged within " << _convergenceTolerance
+			    << " mm after " << _iEvt << " events" << std::endl;
+    if(_stopWhenConverged) throw marlin::StopProcessingException(this);
+  }
+}
+
+bool EUTelPreAligner::checkConvergence() {
+  //a plane needs some entries before its offsets are trusted
+  int const minEntries = 100;
+
+  bool converged = true;
+  for(size_t ii = 0; ii < _preAligners.size(); ii++) {
+    PreAligner const &pa = _preAligners[ii];
+    int sensorID = pa.getIden();
+    //excluded planes get no offset, they do not need to converge
+    if(find(_excludedPlanes.begin(), _excludedPlanes.end(), sensorID) != _excludedPlanes.end()) continue;
+
+    bool const useX = find(_excludedPlanesXCoord.begin(), _excludedPlanesXCoord.end(), sensorID) == _excludedPlanesXCoord.end();
+    bool const useY = find(_excludedPlanesYCoord.begin(), _excludedPlanesYCoord.end(), sensorID) == _excludedPlanesYCoord.end();
+    float const peakX = useX ? pa.getPeakX() : 0.f;
+    float const peakY = useY ? pa.getPeakY() : 0.f;
+
+    //NaN at the first estimation, the comparisons are false then
+    if(pa.getEntries() < minEntries ||
+       !(std::abs(peakX - _lastPeakX[ii]) < _convergenceTolerance) ||
+       !(std::abs(peakY - _lastPeakY[ii]) < _convergenceTolerance)) {
+      converged = false;
+    }
+    _lastPeakX[ii] = peakX;
+    _lastPeakY[ii] = peakY;
+  }
+  return converged;
 }
 
 void EUTelPreAligner::end() {
@@ -2,6 +2,8 @@
 #include "EUTelProcessorALPIDEClusterFilter.h"
 #include "EUTelFFClusterImpl.h"
 #include "EUTelSparseClusterImpl.h"
+#include "EUTelTrackerDataView.h"
+#include "EUTelExceptions.h"
 
 // lcio includes <.h>
 #include <IMPL/TrackerPulseImpl.h>
@@ -18,7 +20,8 @@ using namespace lcio;
 EUTelProcessorALPIDEClusterFilter::EUTelProcessorALPIDEClusterFilter () : Processor("EUTelProcessorALPIDEClusterFilter"),
 _zsDataCollectionName(""),
 _nDeep(2),
-_Range(0.1),
+_Range(0.1f),
+_filter(),
 _initialPulseCollectionSize(0),
 _pulseCollectionName(""),
 _sparseClusterCollectionName(""),
@@ -36,174 +39,83 @@ _totClusterMap()
                              "Cluster (output) collection name to _sparseClusterCollectionName",
                              _sparseClusterCollectionName, string("filtered_zsdata"));
 
-}
-
+    registerOptionalParameter("FilterDepth",
+                              "Number of following events in which a cluster is searched for and removed",
+                              _nDeep, 2);
 
-void EUTelProcessorALPIDEClusterFilter::init(){
 }
 
 
-bool EUTelProcessorALPIDEClusterFilter::SameCluster(int iEvent, int iCluster, int jEvent,int jCluster)
-{
-	int nSame=0;
-	for(unsigned int iPixel=0; iPixel<PixelsOfEvents[iEvent][iCluster].size(); iPixel++)
-	{
-		for(unsigned int jPixel=0; jPixel<PixelsOfEvents[jEvent][jCluster].size(); jPixel++)
-		{
-			if(PixelsOfEvents[iEvent][iCluster][iPixel][0]==PixelsOfEvents[jEvent][jCluster][jPixel][0] && 
-			PixelsOfEvents[iEvent][iCluster][iPixel][1]==PixelsOfEvents[jEvent][jCluster][jPixel][1] &&
-			PixelsOfEvents[iEvent][iCluster][iPixel][2]==PixelsOfEvents[jEvent][jCluster][jPixel][2] &&
-			PixelsOfEvents[iEvent][iCluster][iPixel][3]==PixelsOfEvents[jEvent][jCluster][jPixel][3])
-			{
-				nSame++;
-				break;
-			}
-		}
-	}
-	if(nSame>PixelsOfEvents[iEvent][iCluster].size() * _Range || nSame>PixelsOfEvents[jEvent][jCluster].size() * _Range) return true;
-	return false;
-}
-
-void EUTelProcessorALPIDEClusterFilter::AddCluster(int iEvent, int iCluster, int jEvent,int jCluster)
-{
-	for(unsigned int jPixel=0; jPixel<PixelsOfEvents[jEvent][jCluster].size(); jPixel++)
-	{
-		bool samePixel=false;
-		for(unsigned int iPixel=0; iPixel<PixelsOfEvents[iEvent][iCluster].size(); iPixel++)
-		{
-			if(PixelsOfEvents[iEvent][iCluster][iPixel][0]==PixelsOfEvents[jEvent][jCluster][jPixel][0] && 
-			PixelsOfEvents[iEvent][iCluster][iPixel][1]==PixelsOfEvents[jEvent][jCluster][jPixel][1] &&
-			PixelsOfEvents[iEvent][iCluster][iPixel][2]==PixelsOfEvents[jEvent][jCluster][jPixel][2] &&
-			PixelsOfEvents[iEvent][iCluster][iPixel][3]==PixelsOfEvents[jEvent][jCluster][jPixel][3])
-			{
-				samePixel=true;
-				break;
-			}
-		}
-		if(!samePixel) PixelsOfEvents[iEvent][iCluster].push_back(PixelsOfEvents[jEvent][jCluster][jPixel]);
+void EUTelProcessorALPIDEClusterFilter::init(){
+	if(_nDeep < 1) {
+		throw InvalidParameterException("FilterDepth has to be at least 1");
 	}
+	_filter = std::make_unique<EUTelMultiEventClusterFilter>(static_cast<unsigned>(_nDeep), _Range);
 }
 
-void EUTelProcessorALPIDEClusterFilter::DeleteCluster(int jEvent, int jCluster){
-	PixelsOfEvents[jEvent].erase(PixelsOfEvents[jEvent].begin()+jCluster);
-}
-
-void EUTelProcessorALPIDEClusterFilter::readCollections (LCCollectionVec * zsInputDataCollectionVec) {
-        vector<vector<vector<int>>>EventPixels;
+bool EUTelProcessorALPIDEClusterFilter::readCollections (LCCollectionVec * zsInputDataCollectionVec) {
+	CellIDDecoder<TrackerDataImpl> cellDecoder( zsInputDataCollectionVec );
+	_filter->beginEvent();
 	for ( size_t actualCluster=0 ; actualCluster<zsInputDataCollectionVec->size(); actualCluster++) {
-		CellIDDecoder<TrackerDataImpl> cellDecoder( zsInputDataCollectionVec );
 		TrackerDataImpl * zsData = dynamic_cast< TrackerDataImpl * > ( zsInputDataCollectionVec->getElementAt(actualCluster) );
-		SparsePixelType   type   = static_cast<SparsePixelType> ( static_cast<int> (cellDecoder( zsData )["sparsePixelType"]) );
-
-		int clusterSize = zsData->getChargeValues().size()/4;
-		vector<int> X(clusterSize);
-		vector<int> Y(clusterSize);
+		int type = static_cast<int>(cellDecoder( zsData )["sparsePixelType"]);
 		if ( type == kEUTelGenericSparsePixel )
 		{
-			vector<vector<int> > pixVector;
-			auto sparseData = EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>(zsData);	
-			for(size_t iPixel = 0; iPixel < sparseData.size(); iPixel++ )
+			_filter->addCluster(static_cast<int>(cellDecoder(zsData)["sensorID"]), type, zsData->getTime());
+			EUTelTrackerDataView pixels(zsData, type);
+			for(size_t iPixel = 0; iPixel < pixels.size(); iPixel++ )
 			{
-				auto& pixel = sparseData.at( iPixel );
-				X[iPixel] = pixel.getXCoord();
-				Y[iPixel] = pixel.getYCoord();
-				vector<int> pix;
-				pix.push_back(X[iPixel]);
-				pix.push_back(Y[iPixel]);
-				//pix[2] will be the sensor id.
-				pix.push_back(static_cast<int>(cellDecoder(zsData)["sensorID"]));
-				//pix[3] will be the pixel type.
-				pix.push_back(static_cast<int>(cellDecoder( zsData )["sparsePixelType"]));
-				//pix[4] will be the time (it is like an id) of the cluster
-				pix.push_back(zsData->getTime());
-				//pix[5] will bw Signal
-				pix.push_back(pixel.getSignal());
-				//pix[6] will be the time (from the pixel)
-				pix.push_back(pixel.getTime());
-				pixVector.push_back(pix);
+				//the signal is stored as an integer, as it always was
+				_filter->addPixel(pixels.getXCoord(iPixel), pixels.getYCoord(iPixel),
+				                  static_cast<int>(pixels.getSignal(iPixel)), pixels.getTime(iPixel));
 			}
-			EventPixels.push_back(pixVector);
 		}
 	}
-	if(EventPixels.size()!=0) {
- 	   	PixelsOfEvents.push_back(EventPixels);
-        }
-
+	return _filter->endEvent();
 }
 
 void EUTelProcessorALPIDEClusterFilter::writeCollection (LCCollectionVec * sparseClusterCollectionVec, LCCollectionVec * pulseCollection) {
 	CellIDEncoder<TrackerDataImpl> idZSClusterEncoder( EUTELESCOPE::ZSCLUSTERDEFAULTENCODING, sparseClusterCollectionVec );
 	CellIDEncoder<TrackerPulseImpl> idZSPulseEncoder(EUTELESCOPE::PULSEDEFAULTENCODING, pulseCollection);
-	if(PixelsOfEvents.size()>_nDeep) {
-		for(unsigned int iCluster=0; iCluster<PixelsOfEvents[0].size();iCluster++) {
-			// prepare a TrackerData to store the cluster candidate
-                        auto zsCluster = std::make_unique<TrackerDataImpl>();
-                        // prepare a reimplementation of sparsified cluster
-                        auto sparseCluster = std::make_unique<EUTelSparseClusterImpl<EUTelGenericSparsePixel>>(zsCluster.get());
-			int sensorID = 0;
-			int TYPE = 0;
-			int TIME = 0;
+	for(size_t iCluster=0; iCluster<_filter->getNumberOfClusters(); iCluster++) {
+		if(!_filter->isKept(iCluster) || _filter->pixelsBegin(iCluster) == _filter->pixelsEnd(iCluster)) continue;
 
-			while(PixelsOfEvents[0][iCluster].size()>0)
-			{
-				EUTelGenericSparsePixel Pixel;
-				Pixel.setXCoord(PixelsOfEvents[0][iCluster][0][0]);
-				Pixel.setYCoord(PixelsOfEvents[0][iCluster][0][1]);
-				Pixel.setTime(PixelsOfEvents[0][iCluster][0][6]);
-				Pixel.setSignal(PixelsOfEvents[0][iCluster][0][5]);
-				sensorID=PixelsOfEvents[0][iCluster][0][2];
-				TYPE=PixelsOfEvents[0][iCluster][0][3];
-				TIME=PixelsOfEvents[0][iCluster][0][4];
-				PixelsOfEvents[0][iCluster].erase(PixelsOfEvents[0][iCluster].begin());
-				sparseCluster->push_back( Pixel );
-			}
-			if ( sparseCluster->size() > 0)
-			{
-				// set the ID for this zsCluster
-                                idZSClusterEncoder["sensorID"] = sensorID;
-				idZSClusterEncoder["sparsePixelType"]= TYPE;
-                	        idZSClusterEncoder["quality"] = 0;
-    	                        idZSClusterEncoder.setCellID( zsCluster.get() );
-                	        zsCluster->setTime(TIME);
+		// prepare a TrackerData to store the cluster candidate
+		auto zsCluster = std::make_unique<TrackerDataImpl>();
+		// prepare a reimplementation of sparsified cluster
+		auto sparseCluster = std::make_unique<EUTelSparseClusterImpl<EUTelGenericSparsePixel>>(zsCluster.get());
+		int sensorID = _filter->getSensorID(iCluster);
+		int TIME = _filter->getTime(iCluster);
 
-				// add it to the cluster collection
-    	                        sparseClusterCollectionVec->push_back( zsCluster.get() );
-
-				// prepare a pulse for this cluster
-                	        auto zsPulse = std::make_unique<TrackerPulseImpl>();
-    	                        idZSPulseEncoder["sensorID"] = sensorID;
-                	        idZSPulseEncoder["type"] = static_cast<int>(kEUTelSparseClusterImpl);
-    	                        idZSPulseEncoder.setCellID( zsPulse.get() );
-                	        zsPulse->setTime(TIME);
-    	                        zsPulse->setTrackerData( zsCluster.release() );
-                	        pulseCollection->push_back( zsPulse.release() );
-				_totClusterMap[sensorID] +=1;
-			}
-		}
-		PixelsOfEvents.erase(PixelsOfEvents.begin());
-	}
-}
-
-void EUTelProcessorALPIDEClusterFilter::filter () {
-	if(PixelsOfEvents.size()>_nDeep)
-	{
-		for(unsigned int iCluster=0; iCluster<PixelsOfEvents[0].size(); iCluster++)
+		for(auto pixel = _filter->pixelsBegin(iCluster); pixel != _filter->pixelsEnd(iCluster); ++pixel)
 		{
-			for(unsigned int jEvent=1; jEvent<=_nDeep; jEvent++)
-			{
-				bool wasSameCluster=false;
-				for(unsigned int jCluster=0; jCluster<PixelsOfEvents[jEvent].size(); jCluster++)
-				{
-					if(SameCluster(0,iCluster,jEvent,jCluster))
-					{
-						//AddCluster(0,iCluster,jEvent,jCluster);
-						DeleteCluster(jEvent,jCluster);
-						wasSameCluster=true;
-					}
-				}
-				if(!wasSameCluster) break;
-			}
+			EUTelGenericSparsePixel Pixel;
+			Pixel.setXCoord(pixel->x);
+			Pixel.setYCoord(pixel->y);
+			Pixel.setTime(pixel->time);
+			Pixel.setSignal(pixel->signal);
+			sparseCluster->push_back( Pixel );
 		}
+
+		// set the ID for this zsCluster
+		idZSClusterEncoder["sensorID"] = sensorID;
+		idZSClusterEncoder["sparsePixelType"]= _filter->getType(iCluster);
+		idZSClusterEncoder["quality"] = 0;
+		idZSClusterEncoder.setCellID( zsCluster.get() );
+		zsCluster->setTime(TIME);
+
+		// add it to the cluster collection
+		sparseClusterCollectionVec->push_back( zsCluster.get() );
+
+		// prepare a pulse for this cluster
+		auto zsPulse = std::make_unique<TrackerPulseImpl>();
+		idZSPulseEncoder["sensorID"] = sensorID;
+		idZSPulseEncoder["type"] = static_cast<int>(kEUTelSparseClusterImpl);
+		idZSPulseEncoder.setCellID( zsPulse.get() );
+		zsPulse->setTime(TIME);
+		zsPulse->setTrackerData( zsCluster.release() );
+		pulseCollection->push_back( zsPulse.release() );
+		_totClusterMap[sensorID] +=1;
 	}
 }
 
@@ -259,9 +171,9 @@ void EUTelProcessorALPIDEClusterFilter::processEvent (LCEvent * evt) {
                 pulseCollection = new LCCollectionVec(LCIO::TRACKERPULSE);
         }
 	if(_clusterAvailable) {
-		readCollections(zsInputDataCollectionVec);
-		filter();
-		writeCollection(sparseClusterCollectionVec, pulseCollection);
+		if(readCollections(zsInputDataCollectionVec)) {
+			writeCollection(sparseClusterCollectionVec, pulseCollection);
+		}
 	}
 	if ( ! isDummyAlreadyExisting )
         {
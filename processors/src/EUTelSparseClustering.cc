@@ -17,6 +17,7 @@
 // eutelescope data specific
 #include "EUTelSparseClusterImpl.h"
 #include "EUTelTrackerDataInterfacerImpl.h"
+#include "EUTelTrackerDataView.h"
 
 // eutelescope geometry
 #include "EUTelGenericPixGeoDescr.h"
@@ -47,10 +48,12 @@
 #endif
 
 // system includes <>
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <vector>
 
 using namespace lcio;
@@ -62,7 +65,8 @@ EUTelSparseClustering::EUTelSparseClustering()
       _pulseCollectionName(""), _initialPulseCollectionSize(0), _iRun(0),
       _iEvt(0), _fillHistos(false), _totalClusterMap(), _noOfDetector(0), 
       _excludedPlanes(), _isGeometryReady(false), _sensorIDVec(), _zsInputDataCollectionVec(nullptr),
-      _pulseCollectionVec(nullptr), _sparseMinDistanceSquared(2) {
+      _pulseCollectionVec(nullptr), _sparseMinDistanceSquared(2), _clusterFinderMap(),
+      _nThreads(1), _workerPool() {
 
   _description = "EUTelSparseClustering is looking for clusters into "
                  "a calibrated pixel matrix.";
@@ -94,6 +98,11 @@ EUTelSparseClustering::EUTelSparseClustering()
 			     _sparseMinDistanceSquared,
 			     2);
 
+  registerOptionalParameter("NumberOfThreads",
+			    "Number of threads used to cluster the sensors of an event in parallel (1 == serial)",
+			    _nThreads,
+			    1);
+
   _isFirstEvent = true;
 }
 
@@ -102,6 +111,9 @@ void EUTelSparseClustering::init() {
   //usually a good idea to do
   printParameters();
 
+  //the worker threads live for the whole job
+  _workerPool = std::make_unique<EUTelWorkerPool>(static_cast<unsigned>(std::max(_nThreads, 1)));
+
   //init new geometry
   geo::gGeometry().initializeTGeoDescription(EUTELESCOPE::GEOFILENAME,
                                              EUTELESCOPE::DUMPGEOROOT);
@@ -127,6 +139,7 @@ void EUTelSparseClustering::initializeGeometry(LCEvent *event){
   //the input collection can contain only a fraction of all the sensors
   _noOfDetector = 0;
   _sensorIDVec.clear();
+  _clusterFinderMap.clear();
 
   streamlog_out(DEBUG5) << "Initializing geometry" << std::endl;
 
@@ -138,8 +151,9 @@ void EUTelSparseClustering::initializeGeometry(LCEvent *event){
 
     for(size_t icoll = 0; icoll < _zsInputDataCollectionVec->size(); ++icoll) {
       auto data = dynamic_cast<TrackerDataImpl*>(_zsInputDataCollectionVec->getElementAt(icoll));
-      _sensorIDVec.push_back(cellDecoder(data)["sensorID"]);
-      _totalClusterMap.insert(std::make_pair(cellDecoder(data)["sensorID"], 0));
+      int sensorID = cellDecoder(data)["sensorID"];
+      _sensorIDVec.push_back(sensorID);
+      _totalClusterMap.insert(std::make_pair(sensorID, 0));
     }
   } catch(lcio::DataNotAvailableException&) {
     streamlog_out(DEBUG5) << "Could not find the input collection: "
@@ -257,6 +271,12 @@ void EUTelSparseClustering::sparseClustering(LCEvent *evt, LCCollectionVec *puls
       EUTELESCOPE::PULSEDEFAULTENCODING, pulseCollection);
 
   //in the zsInputDataCollectionVec we should have one TrackerData for each detector working in ZS mode
+  //first collect the sensors to be clustered, everything touching shared state
+  //(cell ID decoding, geometry) is done here, serially
+  std::vector<SensorJob> sensorJobs;
+  sensorJobs.reserve(_zsInputDataCollectionVec->size());
+  bool uniqueSensors = true;
+
   //[START] loop over ZS detectors
   for(size_t iDetector = 0; iDetector < _zsInputDataCollectionVec->size(); iDetector++) {
     // get the TrackerData and guess which kind of sparsified data it contains
@@ -275,66 +295,71 @@ void EUTelSparseClustering::sparseClustering(LCEvent *evt, LCCollectionVec *puls
     }
     if(foundExcludedSensor)	continue;
 
-    auto sparseData = Utility::getSparseData(zsData, type);
-    auto hitPixelVec = sparseData->getPixels();
-    std::vector<std::reference_wrapper<EUTelBaseSparsePixel const>> newlyAdded;
+    //group the pixels into clusters using the per sensor occupancy grid,
+    //which spans the pixel index range of the sensor
+    auto finderIt = _clusterFinderMap.find(sensorID);
+    if(finderIt == _clusterFinderMap.end()) {
+      int minX, maxX, minY, maxY;
+      minX = maxX = minY = maxY = 0;
+      geo::gGeometry().getPixGeoDescr(sensorID)->getPixelIndexRange(minX, maxX, minY, maxY);
+      finderIt = _clusterFinderMap.emplace(std::piecewise_construct, std::forward_as_tuple(sensorID),
+                                           std::forward_as_tuple(minX, maxX, minY, maxY, _sparseMinDistanceSquared)).first;
+    }
+    for(auto& job: sensorJobs) {
+      if(job.sensorID == sensorID) uniqueSensors = false;
+    }
+
+    //read the pixels straight from the charge values, no pixel objects needed
+    sensorJobs.push_back(SensorJob{sensorID, type, EUTelTrackerDataView(zsData, type), &finderIt->second, {}});
+  }//[END] loop over ZS detectors
+
+  //the cluster search itself only touches the job, so the sensors can be
+  //processed in parallel; a sensor appearing twice shares its finder, in
+  //that (unusual) case stay serial
+  auto clusterSensor = [&sensorJobs](size_t iJob, unsigned) {
+    auto& job = sensorJobs[iJob];
+    auto& clusterFinder = *job.finder;
+    clusterFinder.clear();
+    clusterFinder.reserve(job.pixels.size());
+    auto xColumn = job.pixels.x();
+    auto yColumn = job.pixels.y();
+    for(size_t iPixel = 0; iPixel < job.pixels.size(); ++iPixel) {
+      clusterFinder.addPixel(xColumn[iPixel], yColumn[iPixel]);
+    }
+    size_t noOfClusters = clusterFinder.findClusters();
 
-    //[START] loop over cluster candidates
-    while(!hitPixelVec.empty()) {
+    job.clusters.reserve(noOfClusters);
+    for(size_t iCluster = 0; iCluster < noOfClusters; ++iCluster) {
       //prepare a TrackerData to store the cluster candidate
-      std::unique_ptr<TrackerDataImpl> zsCluster = std::make_unique<TrackerDataImpl>();
-      //prepare a reimplementation of sparsified cluster
-      auto sparseCluster = Utility::getClusterData(zsCluster.get(), type);
-
-      //take any pixel, e.g. the first one, add it to the cluster as well as 
-      //the newly added pixels
-      newlyAdded.push_back(hitPixelVec.front());
-      sparseCluster->push_back(hitPixelVec.front().get());
-      //now remove it from the original collection
-      hitPixelVec.erase(hitPixelVec.begin());
-
-      //now process all newly added pixels, initially this is the just previously 
-      //added one but in the process of neighbour finding more new pixels are added
-      while(!newlyAdded.empty()) {
-        bool newlyDone = true;
-        //check against all pixels in the hitPixelVec
-        for(auto hitVec = hitPixelVec.begin(); hitVec != hitPixelVec.end(); ++hitVec) {
-          //get the relevant infos from the newly added pixel
-          auto x_add = newlyAdded.front().get().getXCoord();
-          auto y_add = newlyAdded.front().get().getYCoord();
-
-          //and the pixel we test against
-          auto x_test = (hitVec->get()).getXCoord();
-          auto y_test = (hitVec->get()).getYCoord();
-
-          auto dX = x_add - x_test;
-          auto dY = y_add - y_test;
-          int distance = dX * dX + dY * dY;
-          //if they pass the spatial cut, add them
-          if(distance <= _sparseMinDistanceSquared) {
-            //add them to the cluster as well as to the newly added ones
-            newlyAdded.push_back(*hitVec);
-            sparseCluster->push_back(*hitVec);
-            //and remove it from the original collection
-            hitPixelVec.erase(hitVec);
-            //for test pixel there might be other neighbours, we still have to check
-            newlyDone = false;
-            break;
-          }
-        }//[END] for-loop over all pixels
-
-        //if no neighbours are found, we can delete the pixel from the newly added;
-        //tested against _ALL_ non cluster pixels, there are no other pixels
-        //which could be neighbours
-        if(newlyDone)	newlyAdded.erase(newlyAdded.begin());
-        
-      }//[END] loop over newly added
+      auto zsCluster = std::make_unique<TrackerDataImpl>();
+
+      //the pixels come in the same order as the former neighbour search, their
+      //records are copied as they are, which is what the sparse cluster
+      //interface would write for the same pixel type
+      auto clusterRange = clusterFinder.getCluster(iCluster);
+      auto& clusterChargeValues = zsCluster->chargeValues();
+      clusterChargeValues.reserve(static_cast<size_t>(clusterRange.second - clusterRange.first) * job.pixels.stride());
+      for(auto pixelIt = clusterRange.first; pixelIt != clusterRange.second; ++pixelIt) {
+        job.pixels.appendPixel(*pixelIt, clusterChargeValues);
+      }
+      job.clusters.push_back(std::move(zsCluster));
+    }
+  };
+  if(uniqueSensors) {
+    _workerPool->parallelFor(sensorJobs.size(), clusterSensor);
+  } else {
+    for(size_t iJob = 0; iJob < sensorJobs.size(); ++iJob) clusterSensor(iJob, 0);
+  }
 
+  //finally store the clusters, in the input sensor order
+  for(auto& job: sensorJobs) {
+    //[START] loop over clusters
+    for(auto& zsCluster: job.clusters) {
       //now process the found cluster
-      if(sparseCluster->size() > 0) {
+      if(!zsCluster->getChargeValues().empty()) {
         //set the ID for this zsCluster
-        idZSClusterEncoder["sensorID"] = sensorID;
-        idZSClusterEncoder["sparsePixelType"] = static_cast<int>(type);
+        idZSClusterEncoder["sensorID"] = job.sensorID;
+        idZSClusterEncoder["sparsePixelType"] = static_cast<int>(job.type);
         idZSClusterEncoder["quality"] = 0;
         idZSClusterEncoder.setCellID(zsCluster.get());
 
@@ -343,20 +368,20 @@ void EUTelSparseClustering::sparseClustering(LCEvent *evt, LCCollectionVec *puls
 
         //prepare a pulse for this cluster
         std::unique_ptr<TrackerPulseImpl> zsPulse = std::make_unique<TrackerPulseImpl>();
-        idZSPulseEncoder["sensorID"] = sensorID;
+        idZSPulseEncoder["sensorID"] = job.sensorID;
         idZSPulseEncoder["type"] = static_cast<int>(kEUTelSparseClusterImpl);
         idZSPulseEncoder.setCellID(zsPulse.get());
         zsPulse->setTrackerData(zsCluster.release());
         pulseCollection->push_back(zsPulse.release());
 
         //increment the totalClusterMap
-        _totalClusterMap[sensorID] += 1;
+        _totalClusterMap[job.sensorID] += 1;
       } else {
         //cluster candidate is not passing the threshold... forget about them, 
         //the memory should be automatically cleaned by smart ptr's
       }
-    }//[END] loop over cluster candidates
-  }//[END] loop over ZS detectors
+    }//[END] loop over clusters
+  }
 
   //if sparseClusterCollectionVec isn't empty, add it to the current event
   if(!isDummyAlreadyExisting) {
@@ -30,6 +30,9 @@
 
 // ROOT includes ".h"
 #include "TObject.h"
+#include "TH1D.h"
+#include "TH2D.h"
+#include "TH3D.h"
 
 // system includes <>
 #include <string>
@@ -44,6 +47,7 @@ using namespace alibava;
 
 AlibavaBaseProcessor::AlibavaBaseProcessor ( std::string processorName ) : Processor ( processorName ),
 _rootObjectMap ( ),
+_fillHistograms ( true ),
 _inputCollectionName ( ALIBAVA::NOTSET ),
 _outputCollectionName ( ALIBAVA::NOTSET ),
 _pedestalFile ( ALIBAVA::NOTSET ),
@@ -60,7 +64,9 @@ _noiseMap ( ),
 _chargeCalMap ( ),
 _isPedestalValid ( false ),
 _isNoiseValid ( false ),
-_isCalibrationValid ( false )
+_isCalibrationValid ( false ),
+_histoBuffers ( ),
+_histoIndex ( )
 {
     // Modify processor description
     _description = "AlibavaBaseProcessor";
@@ -76,6 +82,159 @@ bool AlibavaBaseProcessor::doesRootObjectExists ( std::string aHistoName )
     return it != _rootObjectMap.end ( );
 }
 
+// Histogram registry
+int AlibavaBaseProcessor::registerHisto ( std::string name, TH1 * histo, int dimension )
+{
+    int index = static_cast < int > ( _histoBuffers.size ( ) );
+    _histoBuffers.push_back ( HistoBuffer ( ) );
+    HistoBuffer & buffer = _histoBuffers.back ( );
+    buffer.histo = histo;
+    buffer.dimension = dimension;
+    buffer.x.reserve ( HISTOBUFFERSIZE );
+    if ( dimension > 1 ) buffer.y.reserve ( HISTOBUFFERSIZE );
+    if ( dimension > 2 ) buffer.z.reserve ( HISTOBUFFERSIZE );
+    buffer.w.reserve ( HISTOBUFFERSIZE );
+
+    _histoIndex.insert ( make_pair ( name, index ) );
+    _rootObjectMap.insert ( make_pair ( name, histo ) );
+    return index;
+}
+
+// -1 for a histogram booked with another dimension, the handle is then invalid
+int AlibavaBaseProcessor::findHisto ( std::string name, int dimension )
+{
+    map < string, int > ::const_iterator it = _histoIndex.find ( name );
+    if ( it == _histoIndex.end ( ) )
+    {
+	return HISTONOTFOUND;
+    }
+    if ( _histoBuffers[it -> second].dimension != dimension )
+    {
+	streamlog_out ( ERROR5 ) << "Histogram " << name << " is already booked with " << _histoBuffers[it -> second].dimension << " dimensions, not " << dimension << "!" << endl;
+	return -1;
+    }
+    return it -> second;
+}
+
+AlibavaHisto1D AlibavaBaseProcessor::bookHisto1D ( std::string name, std::string title, int nBinsX, double minX, double maxX )
+{
+    if ( !_fillHistograms )
+    {
+	return AlibavaHisto1D ( );
+    }
+    int index = findHisto ( name, 1 );
+    if ( index != HISTONOTFOUND )
+    {
+	return AlibavaHisto1D ( index );
+    }
+    TH1D * histo = new TH1D ( name.c_str ( ), title.c_str ( ), nBinsX, minX, maxX );
+    return AlibavaHisto1D ( registerHisto ( name, histo, 1 ) );
+}
+
+AlibavaHisto2D AlibavaBaseProcessor::bookHisto2D ( std::string name, std::string title, int nBinsX, double minX, double maxX, int nBinsY, double minY, double maxY )
+{
+    if ( !_fillHistograms )
+    {
+	return AlibavaHisto2D ( );
+    }
+    int index = findHisto ( name, 2 );
+    if ( index != HISTONOTFOUND )
+    {
+	return AlibavaHisto2D ( index );
+    }
+    TH2D * histo = new TH2D ( name.c_str ( ), title.c_str ( ), nBinsX, minX, maxX, nBinsY, minY, maxY );
+    return AlibavaHisto2D ( registerHisto ( name, histo, 2 ) );
+}
+
+AlibavaHisto3D AlibavaBaseProcessor::bookHisto3D ( std::string name, std::string title, int nBinsX, double minX, double maxX, int nBinsY, double minY, double maxY, int nBinsZ, double minZ, double maxZ )
+{
+    if ( !_fillHistograms )
+    {
+	return AlibavaHisto3D ( );
+    }
+    int index = findHisto ( name, 3 );
+    if ( index != HISTONOTFOUND )
+    {
+	return AlibavaHisto3D ( index );
+    }
+    TH3D * histo = new TH3D ( name.c_str ( ), title.c_str ( ), nBinsX, minX, maxX, nBinsY, minY, maxY, nBinsZ, minZ, maxZ );
+    return AlibavaHisto3D ( registerHisto ( name, histo, 3 ) );
+}
+
+void AlibavaBaseProcessor::flushHisto ( int index )
+{
+    HistoBuffer & buffer = _histoBuffers[index];
+    int n = static_cast < int > ( buffer.w.size ( ) );
+    if ( n == 0 )
+    {
+	return;
+    }
+    if ( buffer.dimension == 1 )
+    {
+	buffer.histo -> FillN ( n, buffer.x.data ( ), buffer.w.data ( ), 1 );
+    }
+    else if ( buffer.dimension == 2 )
+    {
+	buffer.histo -> FillN ( n, buffer.x.data ( ), buffer.y.data ( ), buffer.w.data ( ), 1 );
+    }
+    else
+    {
+	// TH3 has no FillN
+	TH3 * histo = static_cast < TH3* > ( buffer.histo );
+	for ( int i = 0; i < n; i++ )
+	{
+	    histo -> Fill ( buffer.x[i], buffer.y[i], buffer.z[i], buffer.w[i] );
+	}
+    }
+    buffer.x.clear ( );
+    buffer.y.clear ( );
+    buffer.z.clear ( );
+    buffer.w.clear ( );
+}
+
+void AlibavaBaseProcessor::flushHistos ( )
+{
+    for ( size_t i = 0; i < _histoBuffers.size ( ); i++ )
+    {
+	flushHisto ( static_cast < int > ( i ) );
+    }
+}
+
+TH1D * AlibavaBaseProcessor::getHisto ( AlibavaHisto1D histo )
+{
+    if ( !histo.isValid ( ) )
+    {
+	return nullptr;
+    }
+    flushHisto ( histo.getIndex ( ) );
+    return static_cast < TH1D* > ( _histoBuffers[histo.getIndex ( )].histo );
+}
+
+TH2D * AlibavaBaseProcessor::getHisto ( AlibavaHisto2D histo )
+{
+    if ( !histo.isValid ( ) )
+    {
+	return nullptr;
+    }
+    flushHisto ( histo.getIndex ( ) );
+    return static_cast < TH2D* > ( _histoBuffers[histo.getIndex ( )].histo );
+}
+
+TH3D * AlibavaBaseProcessor::getHisto ( AlibavaHisto3D histo )
+{
+    if ( !histo.isValid ( ) )
+    {
+	return nullptr;
+    }
+    flushHisto ( histo.getIndex ( ) );
+    return static_cast < TH3D* > ( _histoBuffers[histo.getIndex ( )].histo );
+}
+
+void AlibavaBaseProcessor::registerHistogramSwitch ( )
+{
+    registerOptionalParameter ( "FillHistograms", "Book and fill the histograms of this processor, switch off for production passes", _fillHistograms, true );
+}
+
 // Input/Output Collection
 // Getter and setter for _inputCollectionName
 void AlibavaBaseProcessor::setInputCollectionName ( std::string inputCollectionName )
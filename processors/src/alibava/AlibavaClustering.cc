@@ -72,7 +72,9 @@ using namespace eutelescope;
 AlibavaClustering::AlibavaClustering ( ) : AlibavaBaseProcessor ( "AlibavaClustering" ),
 _clusterCollectionName ( ALIBAVA::NOTSET ),
 _clustercharge ( ),
-_clustercount ( 0 )
+_clustercount ( 0 ),
+_finders ( ),
+_clusters ( )
 {
 
     // modify processor description
@@ -121,6 +123,8 @@ _clustercount ( 0 )
 
     registerOptionalParameter ( "FIRCollectionName", "If filtering is used, it is saved into this collection", _filteredCollectionName, string ( "filteredcollection" ) );
 
+    registerHistogramSwitch ( );
+
 }
 
 void AlibavaClustering::init ( )
@@ -187,6 +191,27 @@ void AlibavaClustering::processRunHeader ( LCRunHeader * rdr )
 
     setPedestals ( );
 
+    // one cluster finder per chip, with the noise and the channel mask of the chip
+    EVENT::IntVec chipVec = getChipSelection ( );
+    for ( unsigned int i = 0; i < chipVec.size ( ); i++ )
+    {
+	int chipnum = chipVec[i];
+	_finders[chipnum].reset ( new eutelescope::EUTelStripClusterFinder ( ALIBAVA::NOOFCHANNELS, _seedcut, _clustercut, _polarity ) );
+	if ( isNoiseValid ( ) )
+	{
+	    _finders[chipnum] -> setNoise ( getNoiseOfChip ( chipnum ) );
+	}
+	else
+	{
+	    streamlog_out ( ERROR5 ) << "The noise values for chip " << chipnum << " are not set properly!" << endl;
+	    exit ( -1 );
+	}
+	for ( int ichan = 0; ichan < ALIBAVA::NOOFCHANNELS; ichan++ )
+	{
+	    _finders[chipnum] -> setMasked ( ichan, isMasked ( chipnum, ichan ) );
+	}
+    }
+
     bookHistos ( );
 
 }
@@ -362,407 +387,159 @@ void AlibavaClustering::findSeedClusters(TrackerDataImpl * trkdata, LCCollection
 	filteredcollectionVec -> push_back ( newdataImpl );
     }
 
-    // cluster count in this event
-    int nClusters = 0;
-
-    // a vector with the cluster info, 0 for no cluster and nClusters for the individual cluster,
-    // e.g. {0,0,0,0,0,0}, then  {0,1,0,0,0,0} after finding the first cluster, {0,1,0,2,2,0} after finding the second, etc.
-    std::vector < int > clusterNumber;
-    clusterNumber.assign ( datavec.size ( ), 0 );
+    // encoders:
+    CellIDEncoder < TrackerPulseImpl > pulseEncoder ( eutelescope::EUTELESCOPE::PULSEDEFAULTENCODING, clusterCollection );
+    CellIDEncoder < TrackerDataImpl > dataEncoder ( eutelescope::EUTELESCOPE::ZSCLUSTERDEFAULTENCODING, sparseClusterCollectionVec );
 
-    // go through all channels
-    for ( size_t ichan = 0; ichan < datavec.size ( );ichan++ )
+    if ( !isChipValid ( chipnum ) || !_finders[chipnum] || datavec.size ( ) != _finders[chipnum] -> getNStrips ( ) )
     {
-	streamlog_out ( DEBUG3 ) << "Channel loop " << ichan << endl;
+	streamlog_out ( ERROR5 ) << "Chip " << chipnum << " with " << datavec.size ( ) << " channels can not be clustered in event " << alibavaEvent -> getEventNumber ( ) << " !" << endl;
+	return;
+    }
 
-	float noise = 0.0;
-	float seedlevel = 0.0;
-	float clusterlevel = 0.0;
+    // seeds, neighbours and splitting in a single pass over the channels
+    _finders[chipnum] -> findClusters ( datavec.data ( ), _clusters );
 
-	// this is the noise level we get from the previous steps
-	if ( isMasked ( chipnum, ichan ) == false )
+    // cluster count in this event
+    int nClusters = 0;
+
+    int const nchan = static_cast < int > ( datavec.size ( ) );
+    for ( size_t icluster = 0; icluster < _clusters.size ( ); icluster++ )
+    {
+	const eutelescope::EUTelStripClusterFinder::Cluster & cluster = _clusters[icluster];
+	int ichan = cluster.seedStrip;
+	int lowerlimit = cluster.firstStrip;
+	int upperlimit = cluster.lastStrip;
+	int clusize = cluster.getSize ( );
+
+	// allow a cut on the clustersize
+	if ( ( clusize < _clusterminsize ) || ( clusize > _clustermaxsize ) )
 	{
-	    // get the noise levels
-	    noise = getNoiseAtChannel ( chipnum, ichan );
-	    streamlog_out ( DEBUG4 ) << "Channel " << ichan << " has a noise level of | " << noise << " | ADCs" << endl;
-	    streamlog_out ( DEBUG4 ) << "Channel " << ichan << " has a signal level of " << datavec[ichan] << " ADCs" << endl;
+	    streamlog_out ( DEBUG5 ) << "Failed clustersize cut! Limits are: " << _clusterminsize << " to " << _clustermaxsize << " , this cluster has size: " << clusize << " !" << endl;
+	    continue;
+	}
 
-	    // the level for a seed
-	    seedlevel = _seedcut * noise;
-	    streamlog_out ( DEBUG4 ) << "Seed level is " << seedlevel * _polarity << endl;
+	// anything past here is an accepted cluster
+	streamlog_out ( DEBUG5 ) << "Found a cluster in event: " << alibavaEvent -> getEventNumber ( ) << " on channels " << lowerlimit << " to " << upperlimit << " with seed " << ichan << endl;
 
-	    // the level for a cluster
-	    clusterlevel = _clustercut * noise;
-	    streamlog_out ( DEBUG4 ) << "Cluster level is " << clusterlevel * _polarity << endl;
+	// increment cluster count
+	nClusters++;
 
-	}
-	else
+	// record the charge to the left and right of the seed to spot asymetries:
+	if ( ichan >= 3 && ichan + 3 < nchan && isMasked ( chipnum, ichan - 2 ) == false && isMasked ( chipnum, ichan - 1 ) == false && isMasked ( chipnum, ichan + 1 ) == false && isMasked ( chipnum, ichan + 2 ) == false )
 	{
-	    // all levels should be 0
-	    streamlog_out ( DEBUG3 ) << "Channel " << ichan << " is masked. Setting noise level to " << noise << endl;
+	    _clustercharge[0] += fabs ( datavec[ichan - 2] );
+	    _clustercharge[1] += fabs ( datavec[ichan - 1] );
+	    _clustercharge[2] += fabs ( datavec[ichan] );
+	    _clustercharge[3] += fabs ( datavec[ichan + 1] );
+	    _clustercharge[4] += fabs ( datavec[ichan + 2] );
+	    fillChargeDistHisto ( datavec[ichan - 3] * _polarity, datavec[ichan - 2] * _polarity, datavec[ichan - 1] * _polarity, datavec[ichan] * _polarity, datavec[ichan + 1] * _polarity, datavec[ichan + 2] * _polarity, datavec[ichan + 3] * _polarity );
 	}
 
-	// if a channel passes the seed cluster clut, use only positive ADCs to check! The noise levels from previous steps will always be positive!
-	// we also disalow a seed next to a bad channel
-	if ( ( datavec[ichan] * _polarity ) >= seedlevel && ( isMasked ( chipnum, ichan ) == false ) && ( isMasked ( chipnum, ichan + 1 ) == false ) && ( isMasked ( chipnum, ichan - 1 ) == false ) )
+	// let's calculate the eta distribution, only works for clustersize >1
+	// actually this is not the official definition of eta, but this helps nonetheless
+	if ( clusize > 1 )
 	{
-
-	    streamlog_out ( DEBUG4 ) << "Found seed on channel " << ichan << " with seed of " << datavec[ichan] * _polarity << endl;
-
-	    // now check if any neighbours pass the cluster cut
-	    // the cluster starts out with size 1, so nothing left or right
-	    int posclustersize = 0;
-	    int negclustersize = 0;
-
-	    // look right
-	    bool posdir = true;
-	    // does this channel exist?
-	    while ( ( ichan + posclustersize + 1 ) < datavec.size ( ) && posdir == true )
+	    float etaleft = 0;
+	    float etaright = 0;
+	    float cogpos = static_cast < float > ( cluster.cog );
+	    for ( int j = lowerlimit; j <= upperlimit; j++ )
 	    {
-		if ( ( datavec[ichan + posclustersize + 1] * _polarity ) >= ( _clustercut * getNoiseAtChannel ( chipnum, ichan + posclustersize + 1 ) ) && ( isMasked ( chipnum, ichan + posclustersize + 1 ) == false ) )
+		if ( float ( j ) < cogpos )
 		{
-
-		    posclustersize += 1;
-		    streamlog_out ( DEBUG3 ) << "Found large cluster in event: " << alibavaEvent -> getEventNumber ( ) << endl;
-		    // if this happens, we have found a second seed in this cluster with a higher ADC count
-		    // since ichan goes to the right, this feature can only be found here.
-
-		    // don't compare ACDs, look for ADC/seedlevel
-		    if ( ( ( datavec[ichan + posclustersize + 1] * _polarity ) / ( getNoiseAtChannel ( chipnum, ichan + posclustersize + 1 ) * _seedcut )  ) > ( ( datavec[ichan] * _polarity ) / seedlevel ) )
-		    {
-
-			streamlog_out ( DEBUG4 ) << "Found multiple seeds in a cluster in event " << alibavaEvent -> getEventNumber ( ) << " ... splitting!" << endl;
-			streamlog_out ( DEBUG4 ) << ( ( datavec[ichan + posclustersize + 1] * _polarity ) / ( getNoiseAtChannel ( chipnum, ichan + posclustersize + 1 ) * _seedcut )  ) << " > " << ( ( datavec[ichan] * _polarity ) / seedlevel ) << endl;
-			// two options: if they touch, we simply move the seed position to the right one and inc negativesize, if they don't touch, we split:
-			if ( posclustersize == 1 )
-			{
-
-			    streamlog_out ( DEBUG5 ) << "Moving the seed in event: " << alibavaEvent -> getEventNumber ( ) << endl;
-
-			    // move ichan and negclustersize
-			    ichan++;
-			    negclustersize++;
-
-			    // now posclustersize has to go down, since we shifted the cluster seed position 
-			    posclustersize--;
-			}
-
-			// if there are clusters below the seed between two seeds, we give them to the highest and split
-			if ( posclustersize >= 2 )
-			{
-			    streamlog_out ( DEBUG5 ) << "Splitting the cluster between seeds in event: " << alibavaEvent -> getEventNumber ( ) << endl;
-
-			    // setting this to zero, let the higher seed find the inbetween strip when looping
-			    posclustersize = 0;
-			    posdir = false;
-			}
-
-			if ( posclustersize >= 3 )
-			{
-			    // just report 
-			    streamlog_out ( WARNING5 ) << "Multiple clusters between seeds in event: " << alibavaEvent -> getEventNumber ( ) << " ! The noise levels could be false!" << endl;
-			}
-
-		    }
+		    etaleft += fabs ( datavec[j] );
 		}
-		else
+		else if ( float ( j ) > cogpos )
 		{
-		    posdir = false;
+		    etaright += fabs ( datavec[j] );
 		}
 	    }
+	    fillEtaHisto ( etaleft / ( etaleft + etaright ) );
 
-	    // look left
-	    bool negdir = true;
-	    // does this channel exist?
-	    while ( negdir == true )
-	    {
-		// the channel has to fullfill 3 conditions: a) be above cluster level, b) not be masked and c) not be above the seed cut. c) is so that we don't refind clusters after splitting.
-		if ( ( datavec[ichan - negclustersize - 1] * _polarity ) >= ( _clustercut * getNoiseAtChannel ( chipnum, ichan - negclustersize - 1 ) ) && ( isMasked ( chipnum, ichan - negclustersize - 1 ) == false ) && ( datavec[ichan - negclustersize - 1] * _polarity ) < ( _seedcut * getNoiseAtChannel ( chipnum, ichan - negclustersize - 1 ) ) )
-		{
-		    streamlog_out ( DEBUG3 ) << "Found large cluster in event: " << alibavaEvent -> getEventNumber ( ) << endl;
-		    negclustersize += 1;
-		}
-		else
-		{
-		    negdir = false;
-		}
-	    }
-
-	    // save the cluster information
-	    int lowerlimit = ichan - negclustersize;
-	    int upperlimit = ichan + posclustersize;
-	    int clusize = upperlimit - lowerlimit + 1;
-
-	    // allow a cut on the clustersize
-	    if ( ( clusize >= _clusterminsize ) && ( clusize <= _clustermaxsize ) )
-	    {
-
-		// anything past here is an accepted cluster
-		streamlog_out ( DEBUG5 ) << "Found a cluster in event: " << alibavaEvent -> getEventNumber ( ) << endl;
-
-		// increment cluster count
-		nClusters++;
-
-		// debug output
-		if ( clusize > 1 )
-		{
-		    streamlog_out ( DEBUG4 ) << "Clustersize: " << clusize << endl;
-		}
-
-		// fill the clusterNumber vector with the position of the individual clusters
-		for ( int icluster = lowerlimit; icluster <= upperlimit; icluster++ )
-		{
-		    clusterNumber.at ( icluster ) = nClusters;
-		    streamlog_out ( DEBUG3 ) << "Wrote cluster to clusterNumber at position(s): " <<  icluster << endl;
-		}
-
-		// record the charge to the left and right of the seed to spot asymetries:
-		if ( isMasked ( chipnum, ichan - 2 ) == false && isMasked ( chipnum, ichan - 1 ) == false && isMasked ( chipnum, ichan + 1 ) == false && isMasked ( chipnum, ichan + 2 ) == false )
-		{
-		    _clustercharge[0] += fabs ( datavec[ichan - 2] );
-		    _clustercharge[1] += fabs ( datavec[ichan - 1] );
-		    _clustercharge[2] += fabs ( datavec[ichan] );
-		    _clustercharge[3] += fabs ( datavec[ichan + 1] );
-		    _clustercharge[4] += fabs ( datavec[ichan + 2] );
-		    fillChargeDistHisto ( datavec[ichan - 3] * _polarity, datavec[ichan - 2] * _polarity, datavec[ichan - 1] * _polarity, datavec[ichan] * _polarity, datavec[ichan + 1] * _polarity, datavec[ichan + 2] * _polarity, datavec[ichan + 3] * _polarity );
-		}
-
-		// let's calculate the eta distribution, only works for clustersize >1
-		// actually this is not the official definition of eta, but this helps nonetheless
-		if ( clusize > 1 )
-		{
-		    float etaleft = 0;
-		    float etaright = 0;
-		    float cogpos = 0;
-		    float totalsignal = 0;
-		    float weight = 0;
-		    for ( int i = lowerlimit; i <= upperlimit; i++ )
-		    {
-			totalsignal += fabs ( datavec[i] );
-			weight += fabs ( datavec[i] * i );
-		    }
-		    cogpos = weight / totalsignal;
-		    for ( int j = lowerlimit; j <= upperlimit; j++ )
-		    {
-			if ( float ( j ) < cogpos )
-			{
-			    etaleft += fabs ( datavec[j] );
-			}
-			else if ( float ( j ) > cogpos )
-			{
-			    etaright += fabs ( datavec[j] );
-			}
-		    }
-		    float etaratio = etaleft / ( etaleft + etaright );
-		    fillEtaHisto ( etaratio );
-
-		    // CoG control plot:
-		    if ( clusize >= 2 )
-		    {
-			fillCogHisto ( cogpos - ichan );
-		    }
-		}
-
-		// do the real calculation of eta:
-		// require good channels left and right so we don't bias
-		if ( isMasked ( chipnum, ichan - 1 ) == false && isMasked ( chipnum, ichan + 1 ) == false )
-		{
-		    float etaleft_a = 0;
-		    float etaright_a = 0;
-		    float etaleft_b = 0;
-		    float etaright_b = 0;
-		    float etaratio = -1;
-
-		    // divison by noise can be added by removeing comments
-		    etaleft_a = datavec[ichan - 1] * _polarity;// / getNoiseAtChannel(chipnum,ichan-1);
-		    etaright_a = datavec[ichan] * _polarity;// / getNoiseAtChannel(chipnum,ichan);
-
-		    etaright_b = datavec[ichan + 1] * _polarity;// / getNoiseAtChannel(chipnum,ichan+1);
-		    etaleft_b = datavec[ichan] * _polarity;// / getNoiseAtChannel(chipnum,ichan);
-
-		    if ( etaleft_a > etaright_b )
-		    {
-			etaratio = etaleft_a / ( etaleft_a + etaright_a );
-			fillEtaHisto2 ( etaratio );
-			fillEtaHisto2TDC ( etaratio, tdc );
-			fillEtaHistoPos ( etaratio, ichan + dchip );
-			streamlog_out ( DEBUG2 ) << "Eta2: left side ratio written: " << etaratio << endl; 
-		    }
-		    else if ( etaright_b > etaleft_a )
-		    {
-			etaratio = etaleft_b / ( etaleft_b + etaright_b );
-			fillEtaHisto2 ( etaratio );
-			fillEtaHisto2TDC ( etaratio, tdc );
-			fillEtaHistoPos ( etaratio, ichan + dchip );
-			streamlog_out ( DEBUG2 ) << "Eta2: right side ratio written:" << etaratio << endl;
-		    }
-		    else
-		    {
-			streamlog_out ( DEBUG2 ) << "Eta2: no eta here (" << alibavaEvent -> getEventNumber ( ) << ") because fail! ela:" << etaleft_a << " era: " << etaright_a << " elb: "<< etaleft_b << " erb: " << etaright_b << endl;
-		    }
-		}
-
-		// fill the cluster signal and snr histos
-		float clustersignal = 0.0;
-		float clusternoise = 0.0;
-		for ( int i = ( lowerlimit ); i <= ( upperlimit ); i++ )
-		{
-		    clustersignal += _polarity * datavec[i];
-		    clusternoise += getNoiseAtChannel ( chipnum, i );
-		}
-		fillSignalHisto ( clustersignal );
-		fillSNRHisto ( clustersignal / clusternoise );
-
-		// fill the seed charge histogram
-		fillSeedChargeHisto ( _polarity * datavec[ichan] );
-
-		// the overall cluster count in this run
-		_clustercount++;
-
-		// fill the clustersize histo
-		fillClusterHisto ( clusize );
-
-		// fill the hitmap histogram
-		fillHitmapHisto ( ichan + dchip, negclustersize, posclustersize );
-
-		// fill the seed histogram
-		fillSeedHisto ( ichan + dchip );
-
-		// final: move the ichan var so that we dont include a seed channel in multiple clusters
-		if ( ( ichan + posclustersize + 1 ) < datavec.size ( ) )
-		{
-		    // this channel is the first one next to a previous cluster and below
-		    // the clustercut so it will fail the  seed check in the next check
-		    ichan = ichan + posclustersize + 1;
-		}
-
-	    }
-	    else
-	    {
-		streamlog_out ( DEBUG5 ) << "Failed clustersize cut! Limits are: " << _clusterminsize << " to " << _clustermaxsize << " , this cluster has size: " << clusize << " !" << endl;
-	    } // done clustersize cut
-
-	} // done going over all seeds
-    } // done going over all channels in this event
+	    // CoG control plot:
+	    fillCogHisto ( cogpos - ichan );
+	}
 
-    // more debug output
-    if ( nClusters >= 1 )
-    {
-	streamlog_out ( DEBUG4 ) << "Clusters in this event: " << nClusters << endl;
-    }
+	// the real eta: seed and its larger neighbour, both neighbours good so we don't bias
+	if ( cluster.eta >= 0 )
+	{
+	    float etaratio = static_cast < float > ( cluster.eta );
+	    fillEtaHisto2 ( etaratio );
+	    fillEtaHisto2TDC ( etaratio, tdc );
+	    fillEtaHistoPos ( etaratio, ichan + dchip );
+	    streamlog_out ( DEBUG2 ) << "Eta2: ratio written: " << etaratio << endl;
+	}
 
-    fillclusterspereventhisto ( nClusters, alibavaEvent -> getEventNumber ( ) );
+	// fill the cluster signal and snr histos
+	fillSignalHisto ( cluster.charge );
+	fillSNRHisto ( cluster.charge / cluster.noise );
 
-    // now output the clusters we have found
-    // encoders:
-    CellIDEncoder < TrackerPulseImpl > pulseEncoder ( eutelescope::EUTELESCOPE::PULSEDEFAULTENCODING, clusterCollection );
-    CellIDEncoder < TrackerDataImpl > dataEncoder ( eutelescope::EUTELESCOPE::ZSCLUSTERDEFAULTENCODING, sparseClusterCollectionVec );
-    //CellIDEncoder<TrackerDataImpl> dataEncoder (EUTELESCOPE::ZSCLUSTERDEFAULTENCODING, sparseClusterCollectionVec );
+	// fill the seed charge histogram
+	fillSeedChargeHisto ( _polarity * datavec[ichan] );
 
-    // What have we found?
-    for ( unsigned int icluster = 0; icluster < clusterNumber.size ( ); icluster++ )
-    {
-	streamlog_out ( DEBUG3 ) << "Pos: " << icluster << " , Value: " << clusterNumber.at ( icluster ) << endl;
-    }
+	// the overall cluster count in this run
+	_clustercount++;
 
-    // Decode datavec into pixelvec, each strip goes into a Pixel
-    // Move to positive ADCs only, since identification has already happend. This is for EUTelSimpleSparsePixel.
+	// fill the clustersize histo
+	fillClusterHisto ( clusize );
 
-    //std::vector<eutelescope::EUTelGenericSparsePixel* > PixelVec;
-    std::vector < EUTelGenericSparsePixel > PixelVec;
-    eutelescope::EUTelGenericSparsePixel Pixel;
+	// fill the hitmap histogram
+	fillHitmapHisto ( ichan + dchip, ichan - lowerlimit, upperlimit - ichan );
 
-    for ( unsigned int iPixel = 0; iPixel < datavec.size ( ); iPixel++ )
-    {
+	// fill the seed histogram
+	fillSeedHisto ( ichan + dchip );
 
-	// The missing coordinate, as passed through by the struct
-	float missingvalue = 0.0;
+	// now let's move this out into trackerpulses and trackerdata
+	// each strip goes into a pixel, with positive ADCs only, since identification has already happened
+	std::unique_ptr < TrackerDataImpl > zsCluster = std::make_unique < TrackerDataImpl > ( );
+	auto sparseCluster = std::unique_ptr < EUTelTrackerDataInterfacer > ( new EUTelTrackerDataInterfacerImpl < EUTelGenericSparsePixel > ( zsCluster.get ( ) ) );
 
-	// chip 1 gets channels inc'ed by 128
-	// select the sensor orientation, we give each "pixel" the missing coordinate on the unsensitive axis
-	if ( _nonsensitiveaxis == "x" )
-	{
-	    if ( chipnum == 0 )
-	    {
-		Pixel.setXCoord ( missingvalue );
-		Pixel.setYCoord ( iPixel );
-	    }
-	    if ( chipnum == 1 )
-	    {
-		Pixel.setXCoord ( missingvalue );
-		Pixel.setYCoord ( iPixel + ALIBAVA::NOOFCHANNELS );
-	    }
-	}
-	if ( _nonsensitiveaxis == "y" )
+	for ( int istrip = lowerlimit; istrip <= upperlimit; istrip++ )
 	{
-	    if ( chipnum == 0 )
+	    // chip 1 gets channels inc'ed by 128
+	    // select the sensor orientation, we give each "pixel" the missing coordinate 0 on the unsensitive axis
+	    EUTelGenericSparsePixel Pixel;
+	    if ( _nonsensitiveaxis == "x" )
 	    {
-		Pixel.setXCoord ( iPixel );
-		Pixel.setYCoord ( missingvalue );
+		Pixel.setXCoord ( 0 );
+		Pixel.setYCoord ( istrip + dchip );
 	    }
-	    if ( chipnum == 1 )
+	    if ( _nonsensitiveaxis == "y" )
 	    {
-		Pixel.setXCoord ( iPixel + ALIBAVA::NOOFCHANNELS );
-		Pixel.setYCoord ( missingvalue );
+		Pixel.setXCoord ( istrip + dchip );
+		Pixel.setYCoord ( 0 );
 	    }
-	}
 
-	// Charge times 100 to get precision, since telescope cluster charge is of type short!
-	// This may be changed in future eutelescope releases
-	Pixel.setSignal ( datavec[iPixel] * _polarity * 100.0 );
-	PixelVec.push_back ( Pixel );
-
-	streamlog_out ( DEBUG3 ) << "Decoded pixel with coordinates: ( " << Pixel.getXCoord ( ) << " , " << Pixel.getYCoord ( ) << " ) and charge: " << datavec[iPixel] << " !" << endl;
-	streamlog_out ( DEBUG3 ) << "Input was: " << PixelVec.at ( iPixel ) << endl;
-    }
-
-    // now let's move this out into trackerpulses and trackerdata
-    // iterate over the clusters
-    std::vector < int > ::iterator it;
-    for ( it = clusterNumber.begin ( ); it != clusterNumber.end ( ); ++it )
-    {
-	std::unique_ptr < TrackerDataImpl > zsCluster = std::make_unique < TrackerDataImpl > ( );
-        // prepare a reimplementation of sparsified cluster
-	auto sparseCluster = std::unique_ptr < EUTelTrackerDataInterfacer > ( new EUTelTrackerDataInterfacerImpl < EUTelGenericSparsePixel > ( zsCluster.get ( ) ) );
-
-	for ( unsigned int i = 0; i < datavec.size ( ); i++ )
-	{
-	    if ( ( clusterNumber.at ( i ) == *it ) && ( clusterNumber.at ( i ) > 0 ) )
-	    {
-		// put only these pixels in that ClusterCollection that belong to that cluster
-		auto temppix = PixelVec.at ( i );
-		sparseCluster -> push_back ( temppix );
-		streamlog_out ( DEBUG6 ) << "Adding strip " << i << " to cluster " << clusterNumber.at ( i ) << endl;
-		++it;
-	    }
+	    // Charge times 100 to get precision, since telescope cluster charge is of type short!
+	    // This may be changed in future eutelescope releases
+	    Pixel.setSignal ( datavec[istrip] * _polarity * 100.0 );
+	    sparseCluster -> push_back ( Pixel );
+	    streamlog_out ( DEBUG3 ) << "Adding strip " << istrip << " to cluster " << nClusters << " : " << Pixel << endl;
 	}
 
-	// now we have pixelClusters with the corresponding pixels (which have the xy and q info) in them
-	// this if stops making the "zero" cluster with all strips not in a cluster...
-	unsigned int clumin = 0;
-	unsigned int clumax = 0;
-	clumin = static_cast<unsigned int>( _clusterminsize );
-	clumax = static_cast<unsigned int>( _clustermaxsize );
-	if ( ( sparseCluster -> size ( ) >= clumin ) && ( sparseCluster -> size ( ) <= clumax ) )
-	{
-
-	    // this assumes six telescope planes, so the first chip will be plane 6, etc.
-	    dataEncoder["sensorID"] = 6;
-	    dataEncoder["sparsePixelType"] = static_cast < int > ( kEUTelSparseClusterImpl );
-	    dataEncoder["quality"] =  0;
-	    dataEncoder.setCellID ( zsCluster.get ( ) );
-	    sparseClusterCollectionVec -> push_back ( zsCluster.get ( ) );
+	// this assumes six telescope planes, so the first chip will be plane 6, etc.
+	dataEncoder["sensorID"] = 6;
+	dataEncoder["sparsePixelType"] = static_cast < int > ( kEUTelSparseClusterImpl );
+	dataEncoder["quality"] =  0;
+	dataEncoder.setCellID ( zsCluster.get ( ) );
+	sparseClusterCollectionVec -> push_back ( zsCluster.get ( ) );
 
-	    std::unique_ptr < TrackerPulseImpl > zsPulse = std::make_unique < TrackerPulseImpl > ( );
-	    pulseEncoder["sensorID"] = 6;
-	    pulseEncoder["type"] = static_cast < int > ( kEUTelSparseClusterImpl );
-	    pulseEncoder.setCellID ( zsPulse.get ( ) );
+	std::unique_ptr < TrackerPulseImpl > zsPulse = std::make_unique < TrackerPulseImpl > ( );
+	pulseEncoder["sensorID"] = 6;
+	pulseEncoder["type"] = static_cast < int > ( kEUTelSparseClusterImpl );
+	pulseEncoder.setCellID ( zsPulse.get ( ) );
 
-	    zsPulse -> setTrackerData ( zsCluster.release ( ) );
-	    clusterCollection -> push_back ( zsPulse.release ( ) );
+	zsPulse -> setTrackerData ( zsCluster.release ( ) );
+	clusterCollection -> push_back ( zsPulse.release ( ) );
+    }
 
-	}
+    // more debug output
+    if ( nClusters >= 1 )
+    {
+	streamlog_out ( DEBUG4 ) << "Clusters in this event: " << nClusters << endl;
     }
+
+    fillclusterspereventhisto ( nClusters, alibavaEvent -> getEventNumber ( ) );
 }
 
 void AlibavaClustering::check ( LCEvent * /* evt */ )
@@ -772,172 +549,126 @@ void AlibavaClustering::check ( LCEvent * /* evt */ )
 
 void AlibavaClustering::fillclusterspereventhisto ( int clusters, int event )
 {
-    if ( TH2D * histo = dynamic_cast < TH2D* > ( _rootObjectMap["ClustersVsEvents"] ) )
-    {
-	histo -> Fill ( event, clusters );
-    }
+    fillHisto ( _clustersVsEventsHisto, event, clusters );
 }
 
 void AlibavaClustering::fillHitmapHisto ( int ichan, int negclustersize, int posclustersize )
 {
-    if ( TH1D * histo = dynamic_cast < TH1D* > ( _rootObjectMap["ClusterHitmap"] ) )
+    for ( int i = ( ichan - negclustersize ); i <= ( ichan + posclustersize ); i++ )
     {
-	for ( int i = ( ichan - negclustersize ); i <= ( ichan + posclustersize ); i++ )
-	{
-	    histo -> Fill ( i );
-	}
+	fillHisto ( _clusterHitmapHisto, i );
     }
 }
 
 void AlibavaClustering::fillClusterHisto ( int clusize )
 {
-    if ( TH1D * histo = dynamic_cast < TH1D* > ( _rootObjectMap["ClusterSize"] ) )
-    {
-	histo -> Fill ( clusize );
-    }
+    fillHisto ( _clusterSizeHisto, clusize );
 }
 
 void AlibavaClustering::fillEtaHisto ( float etaratio )
 {
-    if ( TH1D * histo = dynamic_cast < TH1D* > ( _rootObjectMap["ClusterCOGEta"] ) )
-    {
-	histo -> Fill ( etaratio );
-    }
+    fillHisto ( _clusterCOGEtaHisto, etaratio );
 }
 
-void AlibavaClustering::fillEtaHisto2(float etaratio)
+void AlibavaClustering::fillEtaHisto2 ( float etaratio )
 {
-	if ( TH1D * histo = dynamic_cast < TH1D* > ( _rootObjectMap["EtaDistribution"] ) )
-	{
-		histo->Fill(etaratio);
-	}
+    fillHisto ( _etaHisto, etaratio );
 }
 
 void AlibavaClustering::fillEtaHisto2TDC ( float etaratio, float tdc )
 {
-    if ( TH2D * histo = dynamic_cast < TH2D* > ( _rootObjectMap["EtaDistributionTDC"] ) )
-    {
-	histo -> Fill ( etaratio, tdc );
-    }
+    fillHisto ( _etaTDCHisto, etaratio, tdc );
 }
 
 void AlibavaClustering::fillEtaHistoPos ( float etaratio, int ichan )
 {
-    if ( TH2D * histo = dynamic_cast < TH2D* > ( _rootObjectMap["EtaDistributionPos"] ) )
-    {
-	histo -> Fill ( etaratio, ichan );
-    }
+    fillHisto ( _etaPosHisto, etaratio, ichan );
 }
 
 void AlibavaClustering::fillSeedHisto ( int ichan )
 {
-    if ( TH1D * histo = dynamic_cast < TH1D* > ( _rootObjectMap["SeedHitmap"] ) )
-    {
-	histo -> Fill ( ichan );
-    }
+    fillHisto ( _seedHitmapHisto, ichan );
 }
 
 void AlibavaClustering::fillChargeDistHisto (float a, float b, float c, float d, float e, float f, float g )
 {
-    if ( TH2D * histo = dynamic_cast < TH2D* > ( _rootObjectMap["NeighbourChargeDistribution"] ) )
-    {
-	histo -> Fill ( -3.0, a / d );
-	histo -> Fill ( -2.0, b / d );
-	histo -> Fill ( -1.0, c / d );
-	histo -> Fill ( 0.0, d / d );
-	histo -> Fill ( 1.0, e / d );
-	histo -> Fill ( 2.0, f / d );
-	histo -> Fill ( 3.0, g / d );
-    }
-
-    if ( TH1D * histo = dynamic_cast < TH1D* > ( _rootObjectMap["SignalLeft2"] ) )
-    {
-	histo -> Fill ( b / d );
-    }
-
-    if ( TH1D * histo = dynamic_cast < TH1D* > ( _rootObjectMap["SignalLeft1"] ) )
-    {
-	histo -> Fill ( c / d );
-    }
-
-    if ( TH1D * histo = dynamic_cast < TH1D* > ( _rootObjectMap["SignalRight1"] ) )
-    {
-	histo -> Fill ( e / d );
-    }
-
-    if ( TH1D * histo = dynamic_cast < TH1D* > ( _rootObjectMap["SignalRight2"] ) )
-    {
-	histo -> Fill ( f / d );
-    }
+    fillHisto ( _neighbourChargeHisto, -3.0, a / d );
+    fillHisto ( _neighbourChargeHisto, -2.0, b / d );
+    fillHisto ( _neighbourChargeHisto, -1.0, c / d );
+    fillHisto ( _neighbourChargeHisto, 0.0, d / d );
+    fillHisto ( _neighbourChargeHisto, 1.0, e / d );
+    fillHisto ( _neighbourChargeHisto, 2.0, f / d );
+    fillHisto ( _neighbourChargeHisto, 3.0, g / d );
+
+    fillHisto ( _signalLeft2Histo, b / d );
+    fillHisto ( _signalLeft1Histo, c / d );
+    fillHisto ( _signalRight1Histo, e / d );
+    fillHisto ( _signalRight2Histo, f / d );
 
     // also fill some alternative histos: see thesis of Erik Butz
-    if ( TH1D * histo = dynamic_cast < TH1D* > ( _rootObjectMap["ZetaHisto"] ) )
-    {
-	histo -> Fill ( ( c + e ) / ( c + d + e ) );
-    }
-    if ( TH1D * histo = dynamic_cast < TH1D* > ( _rootObjectMap["SigmaHisto"] ) )
-    {
-	histo -> Fill ( ( c + e ) / ( 2 * d ) );
-    }
+    fillHisto ( _zetaHisto, ( c + e ) / ( c + d + e ) );
+    fillHisto ( _sigmaHisto, ( c + e ) / ( 2 * d ) );
 }
 
 void AlibavaClustering::fillSignalHisto ( float signal )
 {
-    if ( TH1D * histo = dynamic_cast < TH1D* > ( _rootObjectMap["SignalfromClusters"] ) )
-    {
-	histo -> Fill ( signal );
-    }
+    fillHisto ( _clusterSignalHisto, signal );
 }
 
 void AlibavaClustering::fillSNRHisto ( float signal )
 {
-    if ( TH1D * histo = dynamic_cast < TH1D* > ( _rootObjectMap["SNRfromClusters"] ) )
-    {
-	histo -> Fill ( signal );
-    }
+    fillHisto ( _clusterSNRHisto, signal );
 }
 
 void AlibavaClustering::fillSeedChargeHisto ( float signal )
 {
-    if ( TH1D * histo = dynamic_cast < TH1D* > ( _rootObjectMap["SignalfromSeeds"] ) )
-    {
-	histo -> Fill ( signal );
-    }
+    fillHisto ( _seedChargeHisto, signal );
 }
 
 void AlibavaClustering::fillCogHisto ( float cog )
 {
-    if ( TH1D * histo = dynamic_cast < TH1D* > ( _rootObjectMap["RelativeCoGPosition"] ) )
-    {
-	histo -> Fill ( cog );
-    }
+    fillHisto ( _cogHisto, cog );
 }
 
 void AlibavaClustering::end ( )
 {
+    flushHistos ( );
+
+    // the fits and the filter coefficients need the histograms
+    if ( !_fillHistograms )
+    {
+	if ( _writecoefficients == true )
+	{
+	    streamlog_out ( WARNING5 ) << "FillHistograms is off, no filter coefficients written to " << _filterFileName << " !" << endl;
+	}
+	streamlog_out ( MESSAGE4 ) << "Clustercount:" << _clustercount << endl;
+	streamlog_out ( MESSAGE4 ) << "Successfully finished" << endl;
+	return;
+    }
+
     // now that we have all the data, do a fit on the signal histos
     dolandaugausfit ( "SignalfromSeeds" );
     dolandaugausfit ( "SignalfromClusters" );
 
     // also do a fit on the neighbour charge histos
-    TH1D * histol2 = dynamic_cast < TH1D* > ( _rootObjectMap["SignalLeft2"] );
+    TH1D * histol2 = getHisto ( _signalLeft2Histo );
     TF1 * fitl2 = dynamic_cast < TF1* > ( _rootObjectMap["Signal Left 2 Fit"] );
     histol2 -> Fit ( fitl2, "Q" );
 
-    TH1D * histol1 = dynamic_cast < TH1D* > ( _rootObjectMap["SignalLeft1"] );
+    TH1D * histol1 = getHisto ( _signalLeft1Histo );
     TF1 * fitl1 = dynamic_cast < TF1* > ( _rootObjectMap["Signal Left 1 Fit"] );
     histol1 -> Fit ( fitl1, "Q" );
 
-    TH1D * histor1 = dynamic_cast < TH1D* > ( _rootObjectMap["SignalRight1"] );
+    TH1D * histor1 = getHisto ( _signalRight1Histo );
     TF1 * fitr1 = dynamic_cast < TF1* > ( _rootObjectMap["Signal Right 1 Fit"] );
     histor1 -> Fit ( fitr1, "Q" );
 
-    TH1D * histor2 = dynamic_cast < TH1D* > ( _rootObjectMap["SignalRight2"] );
+    TH1D * histor2 = getHisto ( _signalRight2Histo );
     TF1 * fitr2 = dynamic_cast < TF1* > ( _rootObjectMap["Signal Right 2 Fit"] );
     histor2 -> Fit ( fitr2, "Q" );
 
     // we can also do a fit on the neighbour eta to see if we still have asymetries...
-    TH1D * etaHisto2 = dynamic_cast < TH1D* > ( _rootObjectMap["EtaDistribution"] );
+    TH1D * etaHisto2 = getHisto ( _etaHisto );
     TF1 * etalfit = dynamic_cast < TF1* > ( _rootObjectMap["Eta Distribution left fit"] );
     etalfit -> SetRange ( -0.5, 0.5 );
     etaHisto2 -> Fit ( etalfit, "QR+" );
@@ -948,8 +679,8 @@ void AlibavaClustering::end ( )
     // make an integral of the track based eta distribution
     double counts = 0.0;
     double integral = 0.0;
-    TH1D * etahisto = dynamic_cast < TH1D* > ( _rootObjectMap["EtaDistribution"] );
-    TH1D * etaintegral = dynamic_cast < TH1D* > ( _rootObjectMap["EtaDistributionIntegral"] );
+    TH1D * etahisto = getHisto ( _etaHisto );
+    TH1D * etaintegral = getHisto ( _etaIntegralHisto );
     for ( int i = 1; i < etahisto -> GetNbinsX ( ); i++ )
     {
 	counts = etahisto -> GetBinContent ( i );
@@ -1001,59 +732,25 @@ void AlibavaClustering::bookHistos ( )
 {
     AIDAProcessor::tree ( this ) -> cd ( this -> name ( ) );
 
-    TH2D * cluevent = new TH2D ( "ClustersVsEvents", "", 5000, 0, 500000, 10, 0, 9 );
-    _rootObjectMap.insert ( make_pair ( "ClustersVsEvents", cluevent ) );
-    cluevent -> SetTitle ( "Clusters per Event vs. Event Nr;Event Nr.;Clusters in this Event");
+    _clustersVsEventsHisto = bookHisto2D ( "ClustersVsEvents", "Clusters per Event vs. Event Nr;Event Nr.;Clusters in this Event", 5000, 0, 500000, 10, 0, 9 );
 
     // a histogram showing the clustersize
-    string tempHistoName = "ClusterSize";
-    stringstream tempHistoTitle;
-    tempHistoTitle << tempHistoName << ";Clustersize;NumberofEntries";
-
-    TH1D * clusterHisto = new TH1D ( tempHistoName.c_str ( ), "", 4, 1, 5 );
-    _rootObjectMap.insert ( make_pair ( tempHistoName, clusterHisto ) );
-    string tmp_string = tempHistoTitle.str ( );
-    clusterHisto -> SetTitle ( tmp_string.c_str ( ) );
+    _clusterSizeHisto = bookHisto1D ( "ClusterSize", "ClusterSize;Clustersize;NumberofEntries", 4, 1, 5 );
 
     // a histogram showing the eta distribution
-    string tempHistoName2 = "ClusterCOGEta";
-    stringstream tempHistoTitle2;
-    tempHistoTitle2 << tempHistoName2 << ";Eta;NumberofEntries";
-
-    TH1D * etaHisto = new TH1D ( tempHistoName2.c_str ( ), "", 100, 0, 1 );
-    _rootObjectMap.insert ( make_pair ( tempHistoName2, etaHisto ) );
-    string tmp_string2 = tempHistoTitle2.str ( );
-    etaHisto -> SetTitle ( tmp_string2.c_str ( ) );
+    _clusterCOGEtaHisto = bookHisto1D ( "ClusterCOGEta", "ClusterCOGEta;Eta;NumberofEntries", 100, 0, 1 );
 
     // a hitmap histo
-    string tempHistoName3 = "ClusterHitmap";
-    stringstream tempHistoTitle3;
-    tempHistoTitle3 << tempHistoName3 << ";Channel;NumberofEntries";
-
-    TH1D * hitmapHisto = new TH1D ( tempHistoName3.c_str ( ), "", 256, 0, 255 );
-    _rootObjectMap.insert ( make_pair ( tempHistoName3, hitmapHisto ) );
-    string tmp_string3 = tempHistoTitle3.str ( );
-    hitmapHisto -> SetTitle ( tmp_string3.c_str ( ) );
+    _clusterHitmapHisto = bookHisto1D ( "ClusterHitmap", "ClusterHitmap;Channel;NumberofEntries", 256, 0, 255 );
 
     // a seed histo
-    string tempHistoName4 = "SeedHitmap";
-    stringstream tempHistoTitle4;
-    tempHistoTitle4 << tempHistoName4 << ";Channel;NumberofEntries";
+    _seedHitmapHisto = bookHisto1D ( "SeedHitmap", "SeedHitmap;Channel;NumberofEntries", 256, 0, 255 );
 
-    TH1D * seedHisto = new TH1D ( tempHistoName4.c_str ( ), "", 256, 0, 255 );
-    _rootObjectMap.insert ( make_pair ( tempHistoName4, seedHisto ) );
-    string tmp_string4 = tempHistoTitle4.str ( );
-    seedHisto -> SetTitle ( tmp_string4.c_str ( ) );
+    // an integral over the eta distribution
+    _etaIntegralHisto = bookHisto1D ( "EtaDistributionIntegral", "Eta Distribution Integral;Eta;NumberofEntries", 120, -1, 2 );
 
     // a histogram showing the eta distribution - alternative calculation
-    TH1D * etaintegral = new TH1D ( "EtaDistributionIntegral", "", 120, -1, 2 );
-    _rootObjectMap.insert ( make_pair ( "EtaDistributionIntegral", etaintegral ) );
-    etaintegral -> SetTitle ( "Eta Distribution Integral;Eta;NumberofEntries" );
-
-    // an integral over this plot
-    TH1D * etaHisto2 = new TH1D ( "EtaDistribution", "", 120, -1, 2 );
-    _rootObjectMap.insert ( make_pair ( "EtaDistribution", etaHisto2 ) );
-    etaHisto2 -> SetTitle ( "Eta Distribution;Eta;NumberofEntries" );
+    _etaHisto = bookHisto1D ( "EtaDistribution", "Eta Distribution;Eta;NumberofEntries", 120, -1, 2 );
 
     // two fits for this eta plot
     TF1 * etalfit = new TF1 ( "Eta Distribution left fit", "gaus" );
@@ -1063,76 +760,31 @@ void AlibavaClustering::bookHistos ( )
     _rootObjectMap.insert ( make_pair ( "Eta Distribution right fit", etarfit ) );
 
     // a histogram showing the charge distribution
-    string tempHistoName6 = "NeighbourChargeDistribution";
-    stringstream tempHistoTitle6;
-    tempHistoTitle6 << tempHistoName6 << ";Distance to seed;Strip charge / Seed charge";
-
-    TH2D * chargehisto = new TH2D ( tempHistoName6.c_str ( ), "", 7, -3.5, 3.5, 1000, -1, 1 );
-    _rootObjectMap.insert ( make_pair ( tempHistoName6, chargehisto ) );
-    string tmp_string6 = tempHistoTitle6.str ( );
-    chargehisto -> SetTitle ( tmp_string6.c_str ( ) );
+    _neighbourChargeHisto = bookHisto2D ( "NeighbourChargeDistribution", "NeighbourChargeDistribution;Distance to seed;Strip charge / Seed charge", 7, -3.5, 3.5, 1000, -1, 1 );
 
     // a histogram showing the cluster signals
-    string tempHistoName7 = "SignalfromClusters";
-    stringstream tempHistoTitle7;
-    tempHistoTitle7 << tempHistoName7 << ";Cluster signal (ADCs) * (-1);Number of Entries";
-
-    TH1D * clustersignalhisto = new TH1D ( tempHistoName7.c_str ( ), "", 1000, 0, 100 );
-    _rootObjectMap.insert ( make_pair ( tempHistoName7, clustersignalhisto ) );
-    string tmp_string7 = tempHistoTitle7.str ( );
-    clustersignalhisto -> SetTitle ( tmp_string7.c_str ( ) );
+    _clusterSignalHisto = bookHisto1D ( "SignalfromClusters", "SignalfromClusters;Cluster signal (ADCs) * (-1);Number of Entries", 1000, 0, 100 );
 
     // a histogram showing the cluster signal to noise ratio
-    string tempHistoName8 = "SNRfromClusters";
-    stringstream tempHistoTitle8;
-    tempHistoTitle8 << tempHistoName8 << ";Cluster SNR;Number of Entries";
-
-    TH1D * clustersnrhisto = new TH1D ( tempHistoName8.c_str ( ), "", 500, 0, 50 );
-    _rootObjectMap.insert ( make_pair ( tempHistoName8, clustersnrhisto ) );
-    string tmp_string8 = tempHistoTitle8.str ( );
-    clustersnrhisto -> SetTitle ( tmp_string8.c_str ( ) );
+    _clusterSNRHisto = bookHisto1D ( "SNRfromClusters", "SNRfromClusters;Cluster SNR;Number of Entries", 500, 0, 50 );
 
     // a histogram showing the seed charge
-    string tempHistoName9 = "SignalfromSeeds";
-    stringstream tempHistoTitle9;
-    tempHistoTitle9 << tempHistoName9 << ";Seed charge (ADCs) * (-1);Number of Entries";
-
-    TH1D * seedchargehisto = new TH1D ( tempHistoName9.c_str ( ), "", 1000, 0, 100 );
-    _rootObjectMap.insert ( make_pair ( tempHistoName9, seedchargehisto ) );
-    string tmp_string9 = tempHistoTitle9.str ( );
-    seedchargehisto -> SetTitle ( tmp_string9.c_str ( ) );
+    _seedChargeHisto = bookHisto1D ( "SignalfromSeeds", "SignalfromSeeds;Seed charge (ADCs) * (-1);Number of Entries", 1000, 0, 100 );
 
     // a cog control plot
-    TH1D * cogplot = new TH1D ( "RelativeCoGPosition", "", 1000, -2, 2 );
-    _rootObjectMap.insert ( make_pair ( "RelativeCoGPosition", cogplot ) );
-    cogplot -> SetTitle ( "Relative CoG Position;Relative CoG;Number of Entries" );
+    _cogHisto = bookHisto1D ( "RelativeCoGPosition", "Relative CoG Position;Relative CoG;Number of Entries", 1000, -2, 2 );
 
     // eta vs tdc
-    TH2D * etatdc = new TH2D ( "EtaDistributionTDC", "", 100, 0, 1, 20, 0, 100 );
-    _rootObjectMap.insert ( make_pair ( "EtaDistributionTDC", etatdc ) );
-    etatdc -> SetTitle ( "Eta distribution vs. Event TDC;Eta;TDC time [ns]" );
+    _etaTDCHisto = bookHisto2D ( "EtaDistributionTDC", "Eta distribution vs. Event TDC;Eta;TDC time [ns]", 100, 0, 1, 20, 0, 100 );
 
     // eta vs pos
-    TH2D * etapos = new TH2D ( "EtaDistributionPos", "", 100, 0, 1, 256, 0, 255 );
-    _rootObjectMap.insert ( make_pair ( "EtaDistributionPos", etapos ) );
-    etapos -> SetTitle ( "Eta distribution vs. Seed Position;Eta;Seed Strip" );
+    _etaPosHisto = bookHisto2D ( "EtaDistributionPos", "Eta distribution vs. Seed Position;Eta;Seed Strip", 100, 0, 1, 256, 0, 255 );
 
     // charge distribution plots for 2 neighbours left and right of a seed
-    TH1D * neighbour2left = new TH1D ( "SignalLeft2", "", 100, -2, 2 );
-    _rootObjectMap.insert ( make_pair ( "SignalLeft2", neighbour2left ) );
-    neighbour2left -> SetTitle ( "Signal Left 2;Relative Charge to Seed;Number of Entries" );
-
-    TH1D * neighbour1left = new TH1D ( "SignalLeft1", "", 100, -2, 2 );
-    _rootObjectMap.insert ( make_pair ( "SignalLeft1", neighbour1left ) );
-    neighbour1left -> SetTitle ( "Signal Left 1;Relative Charge to Seed;Number of Entries" );
-
-    TH1D * neighbour1right = new TH1D ("SignalRight1", "", 100, -2, 2 );
-    _rootObjectMap.insert ( make_pair ( "SignalRight1", neighbour1right ) );
-    neighbour1right -> SetTitle ( "Signal Right 1;Relative Charge to Seed;Number of Entries" );
-
-    TH1D * neighbour2right = new TH1D ( "SignalRight2", "", 100, -2, 2 );
-    _rootObjectMap.insert ( make_pair ( "SignalRight2", neighbour2right ) );
-    neighbour2right-> SetTitle ( "Signal Right 2;Relative Charge to Seed;Number of Entries" );
+    _signalLeft2Histo = bookHisto1D ( "SignalLeft2", "Signal Left 2;Relative Charge to Seed;Number of Entries", 100, -2, 2 );
+    _signalLeft1Histo = bookHisto1D ( "SignalLeft1", "Signal Left 1;Relative Charge to Seed;Number of Entries", 100, -2, 2 );
+    _signalRight1Histo = bookHisto1D ( "SignalRight1", "Signal Right 1;Relative Charge to Seed;Number of Entries", 100, -2, 2 );
+    _signalRight2Histo = bookHisto1D ( "SignalRight2", "Signal Right 2;Relative Charge to Seed;Number of Entries", 100, -2, 2 );
 
     TF1 * nl2 = new TF1 ( "Signal Left 2 Fit", "gaus" );
     _rootObjectMap.insert ( make_pair ( "Signal Left 2 Fit", nl2 ) );
@@ -1146,13 +798,9 @@ void AlibavaClustering::bookHistos ( )
     TF1 * nr2 = new TF1 ( "Signal Right 2 Fit", "gaus" );
     _rootObjectMap.insert ( make_pair ( "Signal Right 2 Fit", nr2 ) );
 
-    TH1D * zetahisto = new TH1D ( "ZetaHisto", "", 600, -3, 3 );
-    _rootObjectMap.insert ( make_pair ( "ZetaHisto", zetahisto ) );
-    zetahisto -> SetTitle ( "Zeta Distribution;Zeta;Number of Entries" );
+    _zetaHisto = bookHisto1D ( "ZetaHisto", "Zeta Distribution;Zeta;Number of Entries", 600, -3, 3 );
 
-    TH1D * sigmahisto = new TH1D ( "SigmaHisto", "", 600, -3, 3 );
-    _rootObjectMap.insert ( make_pair ( "SigmaHisto", sigmahisto ) );
-    sigmahisto -> SetTitle ( "Sigma Distribution;Sigma;Number of Entries" );
+    _sigmaHisto = bookHisto1D ( "SigmaHisto", "Sigma Distribution;Sigma;Number of Entries", 600, -3, 3 );
 
     streamlog_out ( MESSAGE1 )  << "End of Booking histograms. " << endl;
 }
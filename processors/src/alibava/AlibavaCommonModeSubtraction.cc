@@ -12,6 +12,9 @@
 #include "ALIBAVA.h"
 #include "AlibavaPedNoiCalIOManager.h"
 
+// eutelescope includes ".h"
+#include "EUTelStripCommonMode.h"
+
 // marlin includes ".h"
 #include "marlin/Processor.h"
 #include "marlin/Exceptions.h"
@@ -54,7 +57,8 @@ using namespace alibava;
 AlibavaCommonModeSubtraction::AlibavaCommonModeSubtraction ( ) : AlibavaBaseProcessor ( "AlibavaCommonModeSubtraction" ),
 _commonmodeCollectionName ( ALIBAVA::NOTSET ),
 _commonmodeerrorCollectionName ( ALIBAVA::NOTSET ),
-_chanDataHistoName ( "Common_and_Pedestal_subtracted_data_channel" )
+_chanDataHistoName ( "Common_and_Pedestal_subtracted_data_channel" ),
+_kernels ( )
 {
 
     // modify processor description
@@ -109,6 +113,18 @@ void AlibavaCommonModeSubtraction::processRunHeader ( LCRunHeader * rdr )
     // set channels to be used (if it is defined)
     setChannelsToBeUsed ( );
 
+    // the channel mask of each chip, applied by the subtraction
+    EVENT::IntVec chipVec = getChipSelection ( );
+    for ( unsigned int i = 0; i < chipVec.size ( ); i++ )
+    {
+	int chipnum = chipVec[i];
+	_kernels[chipnum].reset ( new eutelescope::EUTelStripCommonMode ( 0, 0, eutelescope::EUTelStripCommonMode::Method::constant ) );
+	for ( int ichan = 0; ichan < ALIBAVA::NOOFCHANNELS; ichan++ )
+	{
+	    _kernels[chipnum] -> setMasked ( ichan, isMasked ( chipnum, ichan ) );
+	}
+    }
+
     // if you want
     bookHistos ( );
 
@@ -153,7 +169,6 @@ void AlibavaCommonModeSubtraction::processEvent ( LCEvent * anEvent )
 		// get data from the collection
 		TrackerDataImpl * dataImpl = dynamic_cast < TrackerDataImpl * > ( dataColVec -> getElementAt ( i ) ) ;
 		TrackerDataImpl * cmmdImpl = dynamic_cast < TrackerDataImpl * > ( cmmdColVec -> getElementAt ( i ) ) ;
-		TrackerDataImpl * newdataImpl = new TrackerDataImpl ( );
 
 		// check that they belong to same chip
 		if ( ( getChipNum ( dataImpl ) ) != ( getChipNum ( cmmdImpl ) ) )
@@ -162,37 +177,34 @@ void AlibavaCommonModeSubtraction::processEvent ( LCEvent * anEvent )
 		}
 		int chipnum = getChipNum ( dataImpl );
 
-		// set chip number for newdataImpl
-		chipIDEncoder[ALIBAVA::ALIBAVADATA_ENCODE_CHIPNUM] = chipnum;
-		chipIDEncoder.setCellID ( newdataImpl );
-		FloatVec datavec, cmmdvec, newdatavec;
-		datavec = dataImpl -> getChargeValues ( );
-		cmmdvec = cmmdImpl -> getChargeValues ( );
-		newdatavec.clear ( );
+		FloatVec const & datavec = dataImpl -> getChargeValues ( );
+		FloatVec const & cmmdvec = cmmdImpl -> getChargeValues ( );
 		// check size of data sets are equal to ALIBAVA::NOOFCHANNELS
 		if ( int ( datavec.size ( ) ) != ALIBAVA::NOOFCHANNELS )
 		{
 		    streamlog_out ( ERROR5 ) << "Number of channels in input data is not equal to ALIBAVA::NOOFCHANNELS! "<< endl;
+		    continue;
 		}
 		if ( int ( cmmdvec.size ( ) ) != ALIBAVA::NOOFCHANNELS )
 		{
 		    streamlog_out ( ERROR5 ) << "Number of channels in common mode data is not equal to ALIBAVA::NOOFCHANNELS! " << endl;
+		    continue;
 		}
-
-		// now subtract common mode values from all channels
-		for ( size_t ichan = 0; ichan < datavec.size ( ); ichan++ )
+		if ( !isChipValid ( chipnum ) || !_kernels[chipnum] )
 		{
-		    if ( isMasked ( chipnum, ichan ) )
-		    {
-			newdatavec.push_back ( 0 );
-			continue;
-		    }
+		    streamlog_out ( ERROR5 ) << "Chip " << chipnum << " is not in the chip selection!" << endl;
+		    continue;
+		}
 
-		    float newdata = datavec[ichan] - cmmdvec[ichan];
+		TrackerDataImpl * newdataImpl = new TrackerDataImpl ( );
 
-		    //store it in new data vector
-		    newdatavec.push_back ( newdata );
-		}
+		// set chip number for newdataImpl
+		chipIDEncoder[ALIBAVA::ALIBAVADATA_ENCODE_CHIPNUM] = chipnum;
+		chipIDEncoder.setCellID ( newdataImpl );
+
+		// now subtract common mode values from all channels, the masked ones are set to 0
+		FloatVec newdatavec ( ALIBAVA::NOOFCHANNELS );
+		_kernels[chipnum] -> subtract ( datavec.data ( ), cmmdvec.data ( ), newdatavec.data ( ) );
 		newdataImpl -> setChargeValues ( newdatavec );
 		newColVec -> push_back ( newdataImpl );
 		fillHistos ( newdataImpl );
@@ -225,8 +237,7 @@ void AlibavaCommonModeSubtraction::end ( )
 void AlibavaCommonModeSubtraction::fillHistos ( TrackerDataImpl * trkdata )
 {
     // Fill the histograms with the corrected data
-    FloatVec datavec;
-    datavec = trkdata -> getChargeValues ( );
+    FloatVec const & datavec = trkdata -> getChargeValues ( );
     int chipnum = getChipNum ( trkdata );
 
     for ( size_t ichan = 0 ; ichan < datavec.size ( ) ; ichan++ )
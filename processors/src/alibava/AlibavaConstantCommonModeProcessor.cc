@@ -14,6 +14,9 @@
 #include "ALIBAVA.h"
 #include "AlibavaPedNoiCalIOManager.h"
 
+// eutelescope includes ".h"
+#include "EUTelStripCommonMode.h"
+
 // marlin includes ".h"
 #include "marlin/Processor.h"
 #include "marlin/Exceptions.h"
@@ -48,6 +51,8 @@
 #include <iostream>
 #include <sstream>
 #include <memory>
+#include <cstdlib>
+#include <algorithm>
 
 
 using namespace std;
@@ -63,7 +68,8 @@ _NoiseDeviation ( 2.5 ),
 _commonmodeHistoName ( "hcommonmode" ),
 _commonmodeerrorHistoName ( "hcommonmodeerror" ),
 _commonmode ( ),
-_commonmodeerror ( )
+_commonmodeerror ( ),
+_kernels ( )
 {
     // modify processor description
     _description = "AlibavaConstantCommonModeProcessor computes the common mode values of each chip and their errors";
@@ -105,6 +111,12 @@ void AlibavaConstantCommonModeProcessor::init ( )
 	streamlog_out ( MESSAGE4 ) << "The Global Parameter " << ALIBAVA::SKIPMASKEDEVENTS << " is not set! Masked events will be used!" << endl;
     }
 
+    if ( _commonmodeMethod != "constant" && _commonmodeMethod != "slope" )
+    {
+	streamlog_out ( ERROR5 ) << "Unknown common mode method " << _commonmodeMethod << ", it has to be constant or slope!" << endl;
+	exit ( -1 );
+    }
+
     printParameters ( );
 
 }
@@ -119,6 +131,19 @@ void AlibavaConstantCommonModeProcessor::processRunHeader ( LCRunHeader * rdr )
     setChipSelection ( arunHeader -> getChipSelection ( ) );
     setChannelsToBeUsed ( );
 
+    // one common mode kernel per chip, with the channel mask of the chip
+    eutelescope::EUTelStripCommonMode::Method const method = _commonmodeMethod == "constant" ? eutelescope::EUTelStripCommonMode::Method::constant : eutelescope::EUTelStripCommonMode::Method::slope;
+    EVENT::IntVec chipVec = getChipSelection ( );
+    for ( unsigned int i = 0; i < chipVec.size ( ); i++ )
+    {
+	int chipnum = chipVec[i];
+	_kernels[chipnum].reset ( new eutelescope::EUTelStripCommonMode ( static_cast < unsigned > ( std::max ( _Niteration, 0 ) ), _NoiseDeviation, method ) );
+	for ( int ichan = 0; ichan < ALIBAVA::NOOFCHANNELS; ichan++ )
+	{
+	    _kernels[chipnum] -> setMasked ( ichan, isMasked ( chipnum, ichan ) );
+	}
+    }
+
     bookHistos ( );
 
     // set number of skipped events to zero (defined in AlibavaBaseProcessor)
@@ -209,108 +234,39 @@ void AlibavaConstantCommonModeProcessor::end ( )
 
 void AlibavaConstantCommonModeProcessor::calculateConstantCommonMode ( TrackerDataImpl *trkdata )
 {
-    EVENT::FloatVec commonmodeVec;
-    EVENT::FloatVec commonmodeerrorVec;
-
-    FloatVec datavec;
-    datavec = trkdata -> getChargeValues ( );
+    FloatVec const & datavec = trkdata -> getChargeValues ( );
 
     int chipnum = getChipNum ( trkdata );
 
     streamlog_out ( DEBUG0 ) << "Chip " << chipnum << " of " << getNumberOfChips ( ) << ", now iterating..." << endl;
 
-    double sig = 0, tmpdouble = 0;
-    double mean_signal = 0;
-    double sigma_mean_signal = 0;
-    double delta = 0;
-    double a = 0;
-    double b = 0;
+    _commonmode.assign ( ALIBAVA::NOOFCHANNELS, 0 );
+    _commonmodeerror.assign ( ALIBAVA::NOOFCHANNELS, 0 );
 
-    for ( int i = 0; i < _Niteration; i++ )
+    if ( !isChipValid ( chipnum ) || !_kernels[chipnum] )
     {
-	int nchan = 0;
-	double total_signal = 0;
-	double total_signal_square = 0;
-	double channelcount = 0;
-	double channelcount_square = 0;
-	double chan_sig = 0;
-
-	// find mean value of signals
-	for ( int ichan = 0; ichan < int ( datavec.size ( ) ); ichan++ )
-	{
-	    if ( isMasked ( chipnum, ichan ) )
-	    {
-		continue;
-	    }
-
-	    sig = datavec[ichan];
-
-	    // First iteration: take everything
-	    if ( i == 0 )
-	    {
-		total_signal += sig;
-		total_signal_square += sig * sig;
-		nchan++;
-		channelcount += ichan;
-		channelcount_square += ichan * ichan;
-		chan_sig += ichan * sig;
-	    }
-	    else // exclude outliers
-	    {
-		tmpdouble = fabs ( ( sig - mean_signal ) / sigma_mean_signal );
-		if ( tmpdouble < _NoiseDeviation )
-		{
-		    total_signal += sig;
-		    total_signal_square += sig * sig;
-		    nchan++;
-		    channelcount += ichan;
-		    channelcount_square += ichan * ichan;
-		    chan_sig += ichan * sig;
-		}
-	    }
-	} // end of loop over channels
-
-	// slope corrections: commonmode = a + b * channr.
-	delta = nchan * channelcount_square - channelcount * channelcount;
-	a = ( channelcount_square * total_signal - channelcount * chan_sig ) / delta;
-	b = ( nchan * chan_sig - channelcount * total_signal ) / delta;
-
-	streamlog_out ( DEBUG0 ) << "Slop calculation: delta = " << delta << " , a = " << a << " , b = " << b << " !" << endl;
+	streamlog_out ( ERROR5 ) << "Chip " << chipnum << " is not in the chip selection, no common mode computed!" << endl;
+	return;
+    }
+    if ( int ( datavec.size ( ) ) != ALIBAVA::NOOFCHANNELS )
+    {
+	streamlog_out ( ERROR5 ) << "Number of channels in input data is not equal to ALIBAVA::NOOFCHANNELS, no common mode computed!" << endl;
+	return;
+    }
 
-	// here find the deviation from mean value
-	// standard deviation = SQRT( E[x^2] - E[x]^2 )
-	// where E denotes average value
-	if ( nchan > 0 )
-	{
-	    mean_signal = total_signal / nchan;
-	    sigma_mean_signal = sqrt ( total_signal_square / nchan - mean_signal * mean_signal );
-	}
+    // the iterations over the channels, see EUTelStripCommonMode
+    eutelescope::EUTelStripCommonMode::CommonMode commonmode = _kernels[chipnum] -> computeCommonMode ( datavec.data ( ) );
 
-    } // end of iterations
+    streamlog_out ( DEBUG0 ) << "Slope calculation: a = " << commonmode.offset << " , b = " << commonmode.slope << " !" << endl;
 
     streamlog_out ( DEBUG0 ) << "===============================================================================" << endl;
-    streamlog_out ( DEBUG0 ) << "Chip " << chipnum << " : CommonModeCorrection = " << mean_signal << ", CommonModeCorrectionError = " << sigma_mean_signal << endl;
+    streamlog_out ( DEBUG0 ) << "Chip " << chipnum << " : CommonModeCorrection = " << commonmode.mean << ", CommonModeCorrectionError = " << commonmode.sigma << endl;
 
     streamlog_out ( DEBUG0 ) << "===============================================================================" << endl;
 
-    // Now reloop over all channels and create the output vector. This will be the same for all channels if constant is used, otherwise the slope values are calculated.
-    for ( int ichan = 0; ichan < ALIBAVA::NOOFCHANNELS; ichan++ )
-    {
-	if ( _commonmodeMethod == "constant" )
-	{
-	    commonmodeVec.push_back ( mean_signal );
-	    commonmodeerrorVec.push_back ( sigma_mean_signal );
-	}
-
-	if ( _commonmodeMethod == "slope" )
-	{
-	    commonmodeVec.push_back ( a + b * ichan );
-	    commonmodeerrorVec.push_back ( sigma_mean_signal );
-	}
-    }
-
-    setCommonModeVec ( commonmodeVec );
-    setCommonModeErrorVec ( commonmodeerrorVec );
+    // The output vector is the same for all channels if constant is used, otherwise the slope values are calculated.
+    _kernels[chipnum] -> fillCommonMode ( commonmode, _commonmode.data ( ) );
+    _commonmodeerror.assign ( ALIBAVA::NOOFCHANNELS, float ( commonmode.sigma ) );
 }
 
 string AlibavaConstantCommonModeProcessor::getCommonCorrectionName ( )
@@ -106,6 +106,8 @@ AlibavaMerger::AlibavaMerger ( ) : AlibavaBaseProcessor ( "AlibavaMerger" )
 
     registerProcessorParameter ( "UnsensitiveAxis", "The unsensitive axis of our strip sensor", _nonsensitiveaxis, string ( "x" ) );
 
+    registerHistogramSwitch ( );
+
 }
 
 
@@ -176,35 +178,20 @@ LCEvent *AlibavaMerger::readTelescope ( )
 
 void AlibavaMerger::addCorrelation ( float ali_x, float ali_y, float ali_z, float tele_x, float tele_y, float tele_z, int event )
 {
-    if ( TH2D * signalHisto = dynamic_cast < TH2D* > ( _rootObjectMap["Correlation_X"] ) )
-    {
-	signalHisto -> Fill ( ali_x, tele_x );
-    }
-    if ( TH2D * signalHisto2 = dynamic_cast < TH2D* > ( _rootObjectMap["Correlation_Y"] ) )
+    fillHisto ( _correlationXHisto, ali_x, tele_x );
+    fillHisto ( _correlationYHisto, ali_y, tele_y );
+    fillHisto ( _correlationZHisto, ali_z, tele_z );
+    if ( _nonsensitiveaxis == "x" )
     {
-	signalHisto2 -> Fill ( ali_y, tele_y );
+	fillHisto ( _correlationEventHisto, event, ( tele_y / 576.0 - ali_y / 256.0 ) );
+	streamlog_out ( DEBUG4 ) << "Correlation distance in x, event : " << event << " " << tele_y / 576.0 - ali_y / 256.0 << endl;
     }
-    if ( TH2D * signalHisto3 = dynamic_cast < TH2D* > ( _rootObjectMap["Correlation_Z"] ) )
+    if ( _nonsensitiveaxis == "y" )
     {
-	signalHisto3 -> Fill ( ali_z, tele_z );
-    }
-    if ( TH2D * signalHisto4 = dynamic_cast < TH2D* > ( _rootObjectMap["Correlation_Event"] ) )
-    {
-	if ( _nonsensitiveaxis == "x" )
-	{
-	    signalHisto4 -> Fill ( event, ( tele_y / 576.0 - ali_y / 256.0 ) );
-	    streamlog_out ( DEBUG4 ) << "Correlation distance in x, event : " << event << " " << tele_y / 576.0 - ali_y / 256.0 << endl;
-	}
-	if ( _nonsensitiveaxis == "y" )
-	{
-	    signalHisto4 -> Fill ( event, ( tele_x / 1152.0 - ali_x / 256.0 ) );
-	    streamlog_out ( DEBUG4 ) << "Correlation distance in y, event : " << event << " " << tele_x / 1152.0 - ali_x / 256.0 << endl;
-	}
-    }
-    if ( TH3D * multihisto = dynamic_cast < TH3D* > ( _rootObjectMap["Correlation_All"] ) )
-    {
-	multihisto -> Fill ( ( tele_x / 1152.0 - ali_x / 1152.0 ), ( tele_y / 576.0 - ali_y / 256.0 ), event );
+	fillHisto ( _correlationEventHisto, event, ( tele_x / 1152.0 - ali_x / 256.0 ) );
+	streamlog_out ( DEBUG4 ) << "Correlation distance in y, event : " << event << " " << tele_x / 1152.0 - ali_x / 256.0 << endl;
     }
+    fillHisto ( _correlationAllHisto, ( tele_x / 1152.0 - ali_x / 1152.0 ), ( tele_y / 576.0 - ali_y / 256.0 ), event );
 }
 
 void AlibavaMerger::processEvent ( LCEvent * anEvent )
@@ -429,10 +416,7 @@ void AlibavaMerger::processEvent ( LCEvent * anEvent )
 	{
 	    for ( size_t j = 0; j < tele_corr.size ( ); j++ )
 	    {
-		if ( TH2D * histo = dynamic_cast < TH2D* > ( _rootObjectMap["Correlation"] ) )
-		{
-		    histo -> Fill ( ali_corr.at ( i ), tele_corr.at ( j ) );
-		}
+		fillHisto ( _correlationHisto, ali_corr.at ( i ), tele_corr.at ( j ) );
 	    }
 	}
     }
@@ -493,6 +477,8 @@ void AlibavaMerger::check ( LCEvent * /* evt */ )
 
 void AlibavaMerger::end( )
 {
+    flushHistos ( );
+
     // the telescope file is still open, we can now close it
     lcReader -> close ( ) ;
     delete lcReader ;
@@ -508,49 +494,29 @@ void AlibavaMerger::bookHistos ( )
 {
     if ( _nonsensitiveaxis == "x" )
     {
-	TH2D * signalHisto = new TH2D ( "Correlation_X", "", 1152, 0, 1151, 1152, 0, 1151 );
-	_rootObjectMap.insert ( make_pair ( "Correlation_X", signalHisto ) );
-	signalHisto -> SetTitle ( "Correlation in X;Alibava Average Channel;Telescope Average Pixel" );
-
-	TH2D * correlation = new TH2D ( "Correlation", "", 256, 0, 255, 576, 0, 575 );
-	_rootObjectMap.insert ( make_pair ( "Correlation", correlation ) );
-	correlation -> SetTitle ( "Correlation in Y;Alibava Channel;Telescope Pixel" );
+	_correlationXHisto = bookHisto2D ( "Correlation_X", "Correlation in X;Alibava Average Channel;Telescope Average Pixel", 1152, 0, 1151, 1152, 0, 1151 );
+	_correlationHisto = bookHisto2D ( "Correlation", "Correlation in Y;Alibava Channel;Telescope Pixel", 256, 0, 255, 576, 0, 575 );
     }
     else
     {
-	TH2D * signalHisto = new TH2D ( "Correlation_X", "", 256, 0, 255, 1152, 0, 1151 );
-	_rootObjectMap.insert ( make_pair ( "Correlation_X", signalHisto ) );
-	signalHisto -> SetTitle ( "Correlation in X;Alibava Average Channel;Telescope Average Pixel" );
+	_correlationXHisto = bookHisto2D ( "Correlation_X", "Correlation in X;Alibava Average Channel;Telescope Average Pixel", 256, 0, 255, 1152, 0, 1151 );
     }
 
     if (_nonsensitiveaxis == "y" )
     {
-	TH2D * signalHisto2 = new TH2D ( "Correlation_Y", "", 576, 0, 575, 576, 0, 575 );
-	_rootObjectMap.insert ( make_pair ( "Correlation_Y", signalHisto2 ) );
-	signalHisto2 -> SetTitle ( "Correlation in Y;Alibava Average Channel;Telescope Average Pixel" );
-
-	TH2D * correlation = new TH2D ( "Correlation", "", 256, 0, 255, 1152, 0, 1151 );
-	_rootObjectMap.insert ( make_pair ( "Correlation", correlation ) );
-	correlation -> SetTitle ( "Correlation in X;Alibava Channel;Telescope Pixel" );
+	_correlationYHisto = bookHisto2D ( "Correlation_Y", "Correlation in Y;Alibava Average Channel;Telescope Average Pixel", 576, 0, 575, 576, 0, 575 );
+	_correlationHisto = bookHisto2D ( "Correlation", "Correlation in X;Alibava Channel;Telescope Pixel", 256, 0, 255, 1152, 0, 1151 );
     }
     else
     {
-	TH2D * signalHisto2 = new TH2D ( "Correlation_Y", "", 256, 0, 255, 576, 0, 575 );
-	_rootObjectMap.insert ( make_pair ( "Correlation_Y", signalHisto2 ) );
-	signalHisto2 -> SetTitle ( "Correlation in Y;Alibava Average Channel;Telescope Average Pixel" );
+	_correlationYHisto = bookHisto2D ( "Correlation_Y", "Correlation in Y;Alibava Average Channel;Telescope Average Pixel", 256, 0, 255, 576, 0, 575 );
     }
 
-    TH2D * signalHisto3 = new TH2D ( "Correlation_Z", "", 256, 0, 255, 1152, 0, 1151 );
-    _rootObjectMap.insert ( make_pair ( "Correlation_Z", signalHisto3 ) );
-    signalHisto3 -> SetTitle ( "Correlation in Z;Alibava Average Channel;Telescope Average Pixel" );
+    _correlationZHisto = bookHisto2D ( "Correlation_Z", "Correlation in Z;Alibava Average Channel;Telescope Average Pixel", 256, 0, 255, 1152, 0, 1151 );
 
-    TH2D * signalHisto4 = new TH2D ( "Correlation_Event", "", 1000, 0, 500000, 100, -1, 1 );
-    _rootObjectMap.insert ( make_pair ( "Correlation_Event", signalHisto4 ) );
-    signalHisto4 -> SetTitle ( "Correlation over Events;Event Nr.;Telescope Average Pixel - ALiBaVa Average Strip" );
+    _correlationEventHisto = bookHisto2D ( "Correlation_Event", "Correlation over Events;Event Nr.;Telescope Average Pixel - ALiBaVa Average Strip", 1000, 0, 500000, 100, -1, 1 );
 
-    TH3D * multihisto = new TH3D ( "Correlation_All", "", 50, -1, 1, 50, -1, 1, 1000, 0, 500000 );
-    _rootObjectMap.insert ( make_pair ( "Correlation_All", multihisto ) );
-    multihisto -> SetTitle ( "Correlation over Events;Average Distance in X;Average Distance in Y;Event Nr." );
+    _correlationAllHisto = bookHisto3D ( "Correlation_All", "Correlation over Events;Average Distance in X;Average Distance in Y;Event Nr.", 50, -1, 1, 50, -1, 1, 1000, 0, 500000 );
 
     streamlog_out ( MESSAGE4 )  << "End of Booking histograms. " << endl;
 }
@@ -0,0 +1,322 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// alibava includes ".h"
+#include "AlibavaPedestalCommonModeSubtraction.h"
+#include "AlibavaRunHeaderImpl.h"
+#include "AlibavaEventImpl.h"
+#include "ALIBAVA.h"
+
+// eutelescope includes ".h"
+#include "EUTelStripCommonMode.h"
+
+// marlin includes ".h"
+#include "marlin/Processor.h"
+#include "marlin/Exceptions.h"
+#include "marlin/Global.h"
+
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+// aida includes <.h>
+#include <marlin/AIDAProcessor.h>
+#include <AIDA/ITree.h>
+#endif
+
+// lcio includes <.h>
+#include <lcio.h>
+#include <UTIL/CellIDEncoder.h>
+#include <IMPL/LCEventImpl.h>
+#include <IMPL/TrackerDataImpl.h>
+
+// system includes <>
+#include <string>
+#include <iostream>
+#include <memory>
+#include <cstdlib>
+#include <algorithm>
+
+using namespace std;
+using namespace lcio;
+using namespace marlin;
+using namespace alibava;
+
+namespace
+{
+    // appends the values of a chip to one of the output collections
+    void addChipData ( LCCollectionVec * collection, int chipnum, FloatVec const & values )
+    {
+	CellIDEncoder < TrackerDataImpl > chipIDEncoder ( ALIBAVA::ALIBAVADATA_ENCODE, collection );
+	TrackerDataImpl * data = new TrackerDataImpl ( );
+	data -> setChargeValues ( values );
+	chipIDEncoder[ALIBAVA::ALIBAVADATA_ENCODE_CHIPNUM] = chipnum;
+	chipIDEncoder.setCellID ( data );
+	collection -> push_back ( data );
+    }
+
+    // a new collection if it is to be written
+    std::unique_ptr < LCCollectionVec > newOptionalCollection ( std::string const & name )
+    {
+	return std::unique_ptr < LCCollectionVec > ( name.empty ( ) ? nullptr : new LCCollectionVec ( LCIO::TRACKERDATA ) );
+    }
+}
+
+AlibavaPedestalCommonModeSubtraction::AlibavaPedestalCommonModeSubtraction ( ) : AlibavaBaseProcessor ( "AlibavaPedestalCommonModeSubtraction" ),
+_pedestalSubtractedCollectionName ( "" ),
+_commonmodeCollectionName ( "" ),
+_commonmodeerrorCollectionName ( "" ),
+_Niteration ( 3 ),
+_NoiseDeviation ( 2.5 ),
+_commonmodeMethod ( "slope" ),
+_kernels ( )
+{
+    // modify processor description
+    _description = "AlibavaPedestalCommonModeSubtraction subtracts the pedestals from the input raw data, computes the common mode of each chip and subtracts it, in one step.";
+
+    // first register the input collection
+    registerInputCollection ( LCIO::TRACKERDATA, "InputCollectionName", "Input raw data collection name", _inputCollectionName, string ( "rawdata" ) );
+
+    registerOutputCollection ( LCIO::TRACKERDATA, "OutputCollectionName", "Output pedestal and common mode subtracted data collection name", _outputCollectionName, string ( "recodata_cmmd" ) );
+
+    registerProcessorParameter ( "PedestalInputFile", "The filename where the pedestal and noise values are stored", _pedestalFile, string ( "pedestal.slcio" ) );
+
+    registerProcessorParameter ( "PedestalCollectionName", "Pedestal collection name, better not to change", _pedestalCollectionName, string ( "pedestal" ) );
+
+    registerProcessorParameter ( "NoiseCollectionName", "Noise collection name, better not to change", _noiseCollectionName, string ( "noise" ) );
+
+    // now the optional parameters
+    registerOptionalParameter ( "PedestalSubtractedCollectionName", "If set, the pedestal subtracted data are written to this collection, as AlibavaPedestalSubtraction would", _pedestalSubtractedCollectionName, string ( "" ) );
+
+    registerOptionalParameter ( "CommonModeCollectionName", "If set, the common mode values are written to this collection, as AlibavaConstantCommonModeProcessor would", _commonmodeCollectionName, string ( "" ) );
+
+    registerOptionalParameter ( "CommonModeErrorCollectionName", "If set, the common mode errors are written to this collection, as AlibavaConstantCommonModeProcessor would", _commonmodeerrorCollectionName, string ( "" ) );
+
+    registerOptionalParameter ( "CommonModeErrorCalculationIteration", "The number of iterations that should be used in common mode calculation", _Niteration, 3 );
+
+    registerOptionalParameter ( "NoiseDeviation", "The limit to the deviation of noise. The data that exceeds this deviation will be considered as signal and not be included in common mode error calculation", _NoiseDeviation, 2.5f );
+
+    registerOptionalParameter ( "Method", "The method with which to calculate the common mode. Options are: constant or slope", _commonmodeMethod, string ( "slope" ) );
+
+    registerHistogramSwitch ( );
+}
+
+void AlibavaPedestalCommonModeSubtraction::init ( )
+{
+    streamlog_out ( MESSAGE4 ) << "Running init" << endl;
+
+    if ( Global::parameters -> isParameterSet ( ALIBAVA::CHANNELSTOBEUSED ) )
+    {
+	Global::parameters -> getStringVals ( ALIBAVA::CHANNELSTOBEUSED, _channelsToBeUsed );
+    }
+    else
+    {
+	streamlog_out ( MESSAGE4 ) << "The Global Parameter " << ALIBAVA::CHANNELSTOBEUSED << " is not set! All channels will be used!" << endl;
+    }
+
+    if ( Global::parameters -> isParameterSet ( ALIBAVA::SKIPMASKEDEVENTS ) )
+    {
+	_skipMaskedEvents = bool ( Global::parameters -> getIntVal ( ALIBAVA::SKIPMASKEDEVENTS ) );
+    }
+    else
+    {
+	streamlog_out ( MESSAGE4 ) << "The Global Parameter " << ALIBAVA::SKIPMASKEDEVENTS << " is not set! Masked events will be used!" << endl;
+    }
+
+    if ( _commonmodeMethod != "constant" && _commonmodeMethod != "slope" )
+    {
+	streamlog_out ( ERROR5 ) << "Unknown common mode method " << _commonmodeMethod << ", it has to be constant or slope!" << endl;
+	exit ( -1 );
+    }
+
+    printParameters ( );
+
+}
+
+void AlibavaPedestalCommonModeSubtraction::processRunHeader ( LCRunHeader * rdr )
+{
+    streamlog_out ( MESSAGE4 ) << "Running processRunHeader" << endl;
+
+    // Add processor name to the runheader
+    auto arunHeader = std::make_unique < AlibavaRunHeaderImpl > ( rdr );
+    arunHeader -> addProcessor ( type ( ) );
+
+    // get and set selected chips
+    setChipSelection ( arunHeader -> getChipSelection ( ) );
+
+    // set channels to be used (if it is defined)
+    setChannelsToBeUsed ( );
+
+    // set pedestal and noise values
+    setPedestals ( );
+
+    // one kernel per chip, with the pedestals and the channel mask of the chip
+    eutelescope::EUTelStripCommonMode::Method const method = _commonmodeMethod == "constant" ? eutelescope::EUTelStripCommonMode::Method::constant : eutelescope::EUTelStripCommonMode::Method::slope;
+    EVENT::IntVec chipVec = getChipSelection ( );
+    for ( unsigned int i = 0; i < chipVec.size ( ); i++ )
+    {
+	int chipnum = chipVec[i];
+	FloatVec pedVec = getPedestalOfChip ( chipnum );
+	if ( int ( pedVec.size ( ) ) != ALIBAVA::NOOFCHANNELS )
+	{
+	    streamlog_out ( ERROR5 ) << "Found " << pedVec.size ( ) << " pedestal values for chip " << chipnum << " instead of " << ALIBAVA::NOOFCHANNELS << "! Check " << _pedestalFile << endl;
+	    exit ( -1 );
+	}
+	_kernels[chipnum].reset ( new eutelescope::EUTelStripCommonMode ( static_cast < unsigned > ( std::max ( _Niteration, 0 ) ), _NoiseDeviation, method ) );
+	_kernels[chipnum] -> setPedestals ( pedVec.data ( ) );
+	for ( int ichan = 0; ichan < ALIBAVA::NOOFCHANNELS; ichan++ )
+	{
+	    _kernels[chipnum] -> setMasked ( ichan, isMasked ( chipnum, ichan ) );
+	}
+    }
+
+    bookHistos ( );
+
+    // set number of skipped events to zero (defined in AlibavaBaseProcessor)
+    _numberOfSkippedEvents = 0;
+}
+
+void AlibavaPedestalCommonModeSubtraction::processEvent ( LCEvent * anEvent )
+{
+    AlibavaEventImpl * alibavaEvent = static_cast < AlibavaEventImpl* > ( anEvent );
+
+    if ( _skipMaskedEvents && ( alibavaEvent -> isEventMasked ( ) ) )
+    {
+	_numberOfSkippedEvents++;
+	return;
+    }
+
+    // the intermediate collections only exist if they are written
+    std::unique_ptr < LCCollectionVec > newColVec ( new LCCollectionVec ( LCIO::TRACKERDATA ) );
+    std::unique_ptr < LCCollectionVec > pedsubColVec = newOptionalCollection ( _pedestalSubtractedCollectionName );
+    std::unique_ptr < LCCollectionVec > commonColVec = newOptionalCollection ( _commonmodeCollectionName );
+    std::unique_ptr < LCCollectionVec > commerrColVec = newOptionalCollection ( _commonmodeerrorCollectionName );
+
+    try
+    {
+	LCCollectionVec * collectionVec = dynamic_cast < LCCollectionVec * > ( alibavaEvent -> getCollection ( getInputCollectionName ( ) ) ) ;
+	int noOfChip = collectionVec -> getNumberOfElements ( );
+
+	FloatVec corrected ( ALIBAVA::NOOFCHANNELS );
+	FloatVec commonmode ( ALIBAVA::NOOFCHANNELS );
+	FloatVec pedsub ( pedsubColVec ? ALIBAVA::NOOFCHANNELS : 0 );
+
+	for ( int i = 0; i < noOfChip; ++i )
+	{
+	    // get data from the collection
+	    TrackerDataImpl * trkdata = dynamic_cast < TrackerDataImpl * > ( collectionVec -> getElementAt ( i ) ) ;
+	    int chipnum = getChipNum ( trkdata );
+	    FloatVec const & datavec = trkdata -> getChargeValues ( );
+
+	    if ( int ( datavec.size ( ) ) != ALIBAVA::NOOFCHANNELS )
+	    {
+		streamlog_out ( ERROR5 ) << "Number of channels in input data is not equal to ALIBAVA::NOOFCHANNELS! " << endl;
+		continue;
+	    }
+	    if ( !isChipValid ( chipnum ) || !_kernels[chipnum] )
+	    {
+		streamlog_out ( ERROR5 ) << "Chip " << chipnum << " is not in the chip selection!" << endl;
+		continue;
+	    }
+
+	    // pedestal, common mode and common mode subtraction
+	    eutelescope::EUTelStripCommonMode::CommonMode cm = _kernels[chipnum] -> process ( datavec.data ( ), corrected.data ( ), pedsubColVec ? pedsub.data ( ) : nullptr, commonmode.data ( ) );
+
+	    streamlog_out ( DEBUG0 ) << "Chip " << chipnum << " : CommonModeCorrection = " << cm.mean << ", CommonModeCorrectionError = " << cm.sigma << endl;
+
+	    addChipData ( newColVec.get ( ), chipnum, corrected );
+	    if ( pedsubColVec )
+	    {
+		addChipData ( pedsubColVec.get ( ), chipnum, pedsub );
+	    }
+	    if ( commonColVec )
+	    {
+		addChipData ( commonColVec.get ( ), chipnum, commonmode );
+	    }
+	    if ( commerrColVec )
+	    {
+		addChipData ( commerrColVec.get ( ), chipnum, FloatVec ( ALIBAVA::NOOFCHANNELS, float ( cm.sigma ) ) );
+	    }
+
+	    if ( _fillHistograms )
+	    {
+		fillHistos ( corrected, commonmode, chipnum );
+	    }
+	}
+    }
+    catch ( lcio::DataNotAvailableException& )
+    {
+	// do nothing again
+	streamlog_out ( ERROR5 ) << "Collection (" << getInputCollectionName ( ) << ") not found! " << endl;
+	return;
+    }
+
+    alibavaEvent -> addCollection ( newColVec.release ( ), getOutputCollectionName ( ) );
+    if ( pedsubColVec )
+    {
+	alibavaEvent -> addCollection ( pedsubColVec.release ( ), _pedestalSubtractedCollectionName );
+    }
+    if ( commonColVec )
+    {
+	alibavaEvent -> addCollection ( commonColVec.release ( ), _commonmodeCollectionName );
+    }
+    if ( commerrColVec )
+    {
+	alibavaEvent -> addCollection ( commerrColVec.release ( ), _commonmodeerrorCollectionName );
+    }
+}
+
+void AlibavaPedestalCommonModeSubtraction::check ( LCEvent * /* evt */ )
+{
+    // nothing to check here - could be used to fill check plots in reconstruction processor
+}
+
+void AlibavaPedestalCommonModeSubtraction::end ( )
+{
+    flushHistos ( );
+
+    if ( _numberOfSkippedEvents > 0 )
+    {
+	streamlog_out ( MESSAGE5 ) << _numberOfSkippedEvents << " events skipped since they are masked" << endl;
+    }
+    streamlog_out ( MESSAGE4 ) << "Successfully finished" << endl;
+}
+
+void AlibavaPedestalCommonModeSubtraction::fillHistos ( FloatVec const & corrected, FloatVec const & commonmode, int chipnum )
+{
+    for ( int ichan = 0; ichan < ALIBAVA::NOOFCHANNELS; ichan++ )
+    {
+	if ( _kernels[chipnum] -> isMasked ( ichan ) )
+	{
+	    continue;
+	}
+	fillHisto ( _commonHisto, commonmode[ichan] );
+	fillHisto ( _signalHisto, corrected[ichan] );
+    }
+}
+
+string AlibavaPedestalCommonModeSubtraction::getCommonCorrectionName ( )
+{
+    return "Common Mode Correction Values";
+}
+
+string AlibavaPedestalCommonModeSubtraction::getSignalCorrectionName ( )
+{
+    return "Final Pedestal Common Mode Corrected Signal";
+}
+
+void AlibavaPedestalCommonModeSubtraction::bookHistos ( )
+{
+    AIDAProcessor::tree ( this ) -> cd ( this -> name ( ) );
+
+    // a histogram showing the common mode values
+    _commonHisto = bookHisto1D ( getCommonCorrectionName ( ), getCommonCorrectionName ( ) + ";ADCs;NumberofEntries", 1000, -500, 500 );
+
+    // a histogram showing the corrected signals
+    _signalHisto = bookHisto1D ( getSignalCorrectionName ( ), getSignalCorrectionName ( ) + ";ADCs;NumberofEntries", 2000, -1000, 1000 );
+
+    streamlog_out ( MESSAGE1 )  << "End of booking histograms. " << endl;
+}
@@ -46,6 +46,7 @@
 #include <iostream>
 #include <sstream>
 #include <memory>
+#include <algorithm>
 
 using namespace std;
 using namespace lcio;
@@ -73,6 +74,14 @@ _chanDataFitName ( "Fit_chan" )
 
     registerOptionalParameter ( "NoiseCollectionName", "Noise collection name, better not to change", _noiseCollectionName, string ( "noise" ) );
 
+    registerOptionalParameter ( "Estimator", "How pedestal and noise are estimated: 'histogram' fits a Gaussian to a histogram per channel, 'moments' uses the running mean and standard deviation of each channel without any histogram", _estimator, string ( "histogram" ) );
+
+    registerOptionalParameter ( "OutlierRejectionIterations", "Moments estimator only: the maximum number of iterations rejecting signals beyond OutlierRejectionCut, 0 to switch the rejection off", _rejectionIterations, 3 );
+
+    registerOptionalParameter ( "OutlierRejectionCut", "Moments estimator only: signals further than this many times the noise from the pedestal are rejected", _rejectionCut, float ( 3.0 ) );
+
+    registerOptionalParameter ( "MaxStoredEvents", "Moments estimator only: the number of events stored for the outlier rejection, 0 for all of them", _maxStoredEvents, 10000 );
+
 }
 
 void AlibavaPedestalNoiseProcessor::init ( )
@@ -97,6 +106,12 @@ void AlibavaPedestalNoiseProcessor::init ( )
 	streamlog_out ( MESSAGE4 ) << "The Global Parameter " << ALIBAVA::SKIPMASKEDEVENTS << " is not set! Masked events will be used!" << endl;
     }
 
+    if ( _estimator != "histogram" && _estimator != "moments" )
+    {
+	streamlog_out ( ERROR5 ) << "Unknown estimator " << _estimator << "! Valid inputs are 'histogram' and 'moments'!" << endl;
+	exit ( -1 );
+    }
+
     printParameters ( );
 
 }
@@ -115,6 +130,15 @@ void AlibavaPedestalNoiseProcessor::processRunHeader ( LCRunHeader * rdr )
 
     bookHistos ( );
 
+    if ( useMoments ( ) )
+    {
+	EVENT::IntVec chipSelection = getChipSelection ( );
+	for ( unsigned int i = 0; i < chipSelection.size ( ); i++ )
+	{
+	    _moments[chipSelection[i]].reset ( new eutelescope::EUTelRunningPedestalNoise ( ALIBAVA::NOOFCHANNELS, static_cast < unsigned > ( std::max ( _rejectionIterations, 0 ) ), _rejectionCut, static_cast < size_t > ( std::max ( _maxStoredEvents, 0 ) ) ) );
+	}
+    }
+
     // set number of skipped events to zero (defined in AlibavaBaseProcessor)
     _numberOfSkippedEvents = 0;
 
@@ -139,8 +163,7 @@ void AlibavaPedestalNoiseProcessor::processEvent ( LCEvent * anEvent )
 	noOfDetector = collectionVec -> getNumberOfElements ( );
 
 	// fill temperature histogram
-	TH1D * temperatureHisto = dynamic_cast < TH1D* > ( _rootObjectMap[_temperatureHistoName] );
-	temperatureHisto -> Fill ( alibavaEvent -> getEventTemp ( ) );
+	fillHisto ( _temperatureHisto, alibavaEvent -> getEventTemp ( ) );
 
 	for ( size_t i = 0; i < noOfDetector; ++i )
 	{
@@ -161,6 +184,8 @@ void AlibavaPedestalNoiseProcessor::check ( LCEvent * /* evt */ )
 
 void AlibavaPedestalNoiseProcessor::end ( )
 {
+    flushHistos ( );
+
     calculatePedestalNoise ( );
 
     if ( _numberOfSkippedEvents > 0 )
@@ -172,7 +197,7 @@ void AlibavaPedestalNoiseProcessor::end ( )
 
 void AlibavaPedestalNoiseProcessor::calculatePedestalNoise ( )
 {
-    string tempHistoName,tempFitName;
+    string tempFitName;
     TCanvas *cc = new TCanvas ( "cc", "cc", 800, 600 );
 
     EVENT::IntVec chipSelection = getChipSelection ( );
@@ -181,6 +206,10 @@ void AlibavaPedestalNoiseProcessor::calculatePedestalNoise ( )
 	unsigned int ichip = chipSelection[i];
 	TH1D * hped = dynamic_cast < TH1D* > ( _rootObjectMap[getPedestalHistoName ( ichip ) ] );
 	TH1D * hnoi = dynamic_cast < TH1D* > ( _rootObjectMap[getNoiseHistoName ( ichip ) ] );
+	if ( useMoments ( ) )
+	{
+	    _moments[ichip] -> compute ( );
+	}
 	EVENT::FloatVec pedestalVec,noiseVec;
 	for ( int ichan = 0; ichan < ALIBAVA::NOOFCHANNELS; ichan++ )
 	{
@@ -191,11 +220,17 @@ void AlibavaPedestalNoiseProcessor::calculatePedestalNoise ( )
 		ped=0;
 		noi=0;
 	    }
+	    else if ( useMoments ( ) )
+	    {
+		ped = _moments[ichip] -> getPedestal ( ichan );
+		noi = _moments[ichip] -> getNoise ( ichan );
+		hped -> SetBinContent ( ichan + 1, ped );
+		hnoi -> SetBinContent ( ichan + 1, noi );
+	    }
 	    else
 	    {
 		tempFitName = getChanDataFitName ( ichip, ichan );
-		tempHistoName = getChanDataHistoName ( ichip, ichan );
-		TH1D * histo = dynamic_cast < TH1D* > ( _rootObjectMap[tempHistoName] );
+		TH1D * histo = getHisto ( _chanDataHistos[ichip][ichan] );
 		TF1 * tempfit = dynamic_cast < TF1* > ( _rootObjectMap[tempFitName] );
 		histo -> Fit ( tempfit, "Q" );
 		ped = tempfit -> GetParameter ( 1 );
@@ -243,11 +278,20 @@ string AlibavaPedestalNoiseProcessor::getNoiseHistoName ( unsigned int ichip )
 
 void AlibavaPedestalNoiseProcessor::fillHistos ( TrackerDataImpl * trkdata )
 {
-    FloatVec datavec;
-    datavec = trkdata -> getChargeValues ( );
+    const FloatVec & datavec = trkdata -> getChargeValues ( );
 
     int chipnum = getChipNum ( trkdata );
 
+    // the masked channels are accumulated too, they are ignored at the end
+    if ( useMoments ( ) )
+    {
+	if ( _moments[chipnum] )
+	{
+	    _moments[chipnum] -> addEvent ( datavec );
+	}
+	return;
+    }
+
     for ( size_t ichan = 0; ichan < datavec.size ( ); ichan++ )
     {
 	if ( isMasked ( chipnum, ichan ) )
@@ -255,11 +299,7 @@ void AlibavaPedestalNoiseProcessor::fillHistos ( TrackerDataImpl * trkdata )
 	    continue;
 	}
 
-	string tempHistoName = getChanDataHistoName ( chipnum, ichan );
-	if ( TH1D * histo = dynamic_cast < TH1D* > ( _rootObjectMap[tempHistoName] ) )
-	{
-	    histo -> Fill ( datavec[ichan] );
-	}
+	fillHisto ( _chanDataHistos[chipnum][ichan], datavec[ichan] );
     }
 }
 
@@ -272,8 +312,7 @@ void AlibavaPedestalNoiseProcessor::bookHistos ( )
     //this is guaranteed with AlibavaConverter::checkIfChipSelectionIsValid()
 
     // temperature of event
-    TH1D * temperatureHisto = new TH1D ( _temperatureHistoName.c_str ( ), "Temperature", 1000, -50, 50 );
-    _rootObjectMap.insert ( make_pair ( _temperatureHistoName, temperatureHisto ) );
+    _temperatureHisto = bookHisto1D ( _temperatureHistoName, "Temperature", 1000, -50, 50 );
 
     for ( unsigned int i = 0; i < chipSelection.size ( ); i++ )
     {
@@ -297,6 +336,13 @@ void AlibavaPedestalNoiseProcessor::bookHistos ( )
 	noiseHisto -> SetTitle ( ( sn.str ( ) ) .c_str ( ) );
     }
 
+    // the moments estimator does not need the channel histograms
+    if ( useMoments ( ) )
+    {
+	streamlog_out ( MESSAGE1 )  << "End of Booking histograms. " << endl;
+	return;
+    }
+
     AIDAProcessor::tree ( this ) -> mkdir ( getInputCollectionName ( ) .c_str ( ) );
     AIDAProcessor::tree ( this ) -> cd ( getInputCollectionName ( ) .c_str ( ) );
 
@@ -314,13 +360,7 @@ void AlibavaPedestalNoiseProcessor::bookHistos ( )
 	    }
 	    tempHistoName = getChanDataHistoName ( ichip, ichan );
 	    tempFitName = getChanDataFitName ( ichip, ichan );
-	    stringstream tempHistoTitle;
-	    tempHistoTitle << tempHistoName << ";ADCs;NumberofEntries";
-
-	    TH1D * chanDataHisto = new TH1D ( tempHistoName.c_str ( ), "", 2000, -1000, 1000 );
-	    _rootObjectMap.insert ( make_pair ( tempHistoName, chanDataHisto ) );
-	    string tmp_string = tempHistoTitle.str ( );
-	    chanDataHisto -> SetTitle ( tmp_string.c_str ( ) );
+	    _chanDataHistos[ichip][ichan] = bookHisto1D ( tempHistoName, tempHistoName + ";ADCs;NumberofEntries", 2000, -1000, 1000 );
 
 	    TF1 *chanDataFit = new TF1 ( tempFitName.c_str ( ), "gaus" );
 	    _rootObjectMap.insert ( make_pair ( tempFitName, chanDataFit ) );
@@ -44,6 +44,7 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <limits>
 
 // eutelescope includes ""
 #include "EUTELESCOPE.h"
@@ -59,6 +60,7 @@
 #include "EUTELESCOPE.h"
 #include "EUTelEventImpl.h"
 #include "EUTelRunHeaderImpl.h"
+#include "EUTelStripClusterFinder.h"
 
 #include "CBCClustering.h"
 
@@ -71,7 +73,10 @@ using namespace eutelescope;
 
 
 CBCClustering::CBCClustering ( ) : Processor ( "CBCClustering" ),
-_aidaHistoMap ( )
+_aidaHistoMap ( ),
+_finder ( ),
+_clusters ( ),
+_signal ( )
 {
 
     _description = "CBCClustering clusters the CBC data stream.";
@@ -166,339 +171,147 @@ void CBCClustering::processEvent ( LCEvent * anEvent )
 		// give the collection vec its data
 		inputCollectionVec = dynamic_cast < LCCollectionVec * > ( anEvent -> getCollection ( _cbcInputCollectionName ) );
 
+		// the encoders of the clusters we output
+		CellIDEncoder < TrackerPulseImpl > zsDataEncoder ( eutelescope::EUTELESCOPE::PULSEDEFAULTENCODING, clusterCollection );
+		CellIDEncoder < TrackerDataImpl > idClusterEncoder ( eutelescope::EUTELESCOPE::ZSCLUSTERDEFAULTENCODING, sparseClusterCollectionVec );
+
 		// loop over collection sizes, just in case
 		int noOfDetector = inputCollectionVec -> getNumberOfElements ( );
                 for ( int i = 0; i < noOfDetector; ++i ) 
                 {
 		    TrackerDataImpl * trkdata = dynamic_cast < TrackerDataImpl * > ( inputCollectionVec -> getElementAt ( i ) );
+		    const FloatVec & datavec = trkdata -> getChargeValues ( );
+		    int sensorID = _outputSensorID + i;
 
-		    FloatVec datavec;
-		    datavec = trkdata -> getChargeValues ( );
-
-		    /*
-		    if ( _zsmode != 0 && ( _zsmode != ( i + 1 ) ) )
-		    {
-			size_t temp = datavec.size ( );
-			datavec.assign ( temp, 0 );
-		    }
-		    */
-
-		    int nClusters = 0;
-
-		    //FloatVec outputvec;
+		    // the histograms of this sensor, only booked for the first two
+		    AIDA::IHistogram1D * hitmapHist = getHisto ( "Hitmap_", sensorID );
+		    AIDA::IHistogram1D * csizeHist = getHisto ( "ClusterSize_", sensorID );
+		    AIDA::IHistogram1D * cchargeHist = getHisto ( "ClusterCharge_", sensorID );
 
-		    /*
-		    // highly inefficient way...
-		    if ( _zsmode == ( i + 1 ) )
+		    // the strip signals: the data itself, or in ZS mode 1 on each hit strip
+		    const float * signal = datavec.data ( );
+		    size_t nStrips = datavec.size ( );
+		    if ( _zsmode > 0 )
 		    {
-
-			FloatVec pixel_x;
-			FloatVec pixel_y;
-			FloatVec pixel_charge;
-			FloatVec pixel_time;
-
-			if ( datavec.size ( ) > 0 )
-			{
-			    // data is x,y,q,t
-			    for ( size_t ix = 0; ix <= ( datavec.size ( ) - 4 ); ix = ix + 4 )
-			    {
-				streamlog_out ( DEBUG1 ) << "chan x " << datavec[ix] << endl;
-				streamlog_out ( DEBUG1 ) << "chan y " << datavec[ix+1] << endl;
-				streamlog_out ( DEBUG1 ) << "chan q " << datavec[ix+2] << endl;
-				streamlog_out ( DEBUG1 ) << "chan t " << datavec[ix+3] << endl;
-				pixel_x.push_back ( datavec[ix] );
-				pixel_y.push_back ( datavec[ix+1] );
-				pixel_charge.push_back ( datavec[ix+2] );
-				pixel_time.push_back ( datavec[ix+3] );
-			    }
-			}
-
-			// fill the channels with a signal if it's there...
-			int point = 0;
-
-			for ( int j = 0; j < _chancount; j++ )
+			streamlog_out ( DEBUG4 ) << "Using ZS mode, sensor " << i << endl;
+			_signal.assign ( _chancount, 0.0f );
+			// data is x,y,q,t
+			for ( size_t ix = 0; ix + 4 <= datavec.size ( ); ix = ix + 4 )
 			{
-
-			    double background = 0.0;
-
-			    // add the charge, if any
-			    if ( _nonsensitiveaxis == "x" )
-			    {
-				if ( pixel_y.size ( ) > 0 )
-				{
-				    if ( pixel_y[point] == ( j ) )
-				    {
-					double signal = 0.0;
-					signal = pixel_charge[point];
-					background += signal;
-					point++;
-					streamlog_out ( DEBUG2 ) << "Output chanel "<< j << " signal is " << signal << endl;
-				    }
-				}
-			    }
-			    if ( _nonsensitiveaxis == "y" )
-			    {
-				if ( pixel_x.size ( ) > 0 )
-				{
-				    if ( pixel_x[point] == ( j ) )
-				    {
-					double signal = 0.0;
-					signal = pixel_charge[point];
-					background += signal;
-					point++;
-					streamlog_out ( DEBUG2 ) << "Output chanel "<< j << " signal is " << signal << endl;
-				    }
-				}
-			    }
-			    // push back this channel
-			    outputvec.push_back(background);
-			    if ( background > 0.0 )
+			    int clupos = static_cast < int > ( _nonsensitiveaxis == "x" ? datavec[ix + 1] : datavec[ix] );
+			    if ( clupos < 0 || clupos >= _chancount )
 			    {
-				streamlog_out ( DEBUG3 ) << "Output chanel "<< j << " final signal is " << background << endl;
+				streamlog_out ( WARNING5 ) << "Hit on channel " << clupos << " outside of the " << _chancount << " channels in event " << anEvent -> getEventNumber ( ) << "!" << endl;
+				continue;
 			    }
+			    _signal[clupos] = 1.0f;
 			}
-
-			datavec = outputvec;
-
+			signal = _signal.data ( );
+			nStrips = _signal.size ( );
 		    }
-		    */
 
-		    std::vector < int > clusterNumber;
-		    
-		    
-		    
-		    if ( _zsmode == 0 )
+		    // any strip over 0 is hit, and neighbouring hits make one cluster
+		    if ( !_finder || _finder -> getNStrips ( ) != nStrips )
 		    {
-			clusterNumber.assign ( datavec.size ( ), 0 );
-
-			for ( size_t ichan = 0; ichan < datavec.size ( ); ichan++ )
-			{
-			    int cluleft = 0;
-			    int cluright = 0;
-			    int clusize = 0;
-
-			    if ( datavec[ichan] * 1.0 > 0 )
-			    {
-				streamlog_out ( DEBUG0 ) << "Chan " << ichan << " over threshold" << endl;
-				cluleft = ichan;
-				cluright = ichan;
-				bool search = true;
-				nClusters++;
-				clusize++;
-				dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["Hitmap_" + to_string ( _outputSensorID + i ) ] ) -> fill ( ichan );
-				while ( search == true )
-				{
-				    if ( ( ichan + 1 ) < ( datavec.size ( ) - 1 ) )
-				    {
-					ichan++;
-					if ( datavec[ichan] > 0 )
-					{
-					    if ( clusize < _maxclustersize )
-					    {
-						cluright = ichan;
-						clusize++;
-						dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["Hitmap_" + to_string ( _outputSensorID + i ) ] ) -> fill ( ichan );
-						streamlog_out ( DEBUG1 ) << "Chan " << ichan << " added to cluster, size now " << clusize << endl;
-					    }
-					    else
-					    {
-						streamlog_out ( DEBUG4 ) << "Cluster size larger than allowed max cluster size of " << _maxclustersize << "! Discarding cluster in event " << anEvent -> getEventNumber ( ) << "!" << endl;
-						search = false;
-					    }
-					}
-					else
-					{
-					    search = false;
-					}
-				    }
-				    else
-				    {
-					search = false;
-				    }
-				}
-				for ( int k = cluleft; k <= cluright; k++ )
-				{
-				    clusterNumber.at ( k ) = nClusters;
-				}
-			    }
-			}
-
+			_finder.reset ( new EUTelStripClusterFinder ( nStrips, std::numeric_limits < float > ::min ( ), std::numeric_limits < float > ::min ( ) ) );
+			_finder -> setSplitSeeds ( false );
 		    }
+		    int nClusters = static_cast < int > ( _finder -> findClusters ( signal, _clusters ) );
 
-		    if ( _zsmode > 0 )
+		    for ( size_t icluster = 0; icluster < _clusters.size ( ); icluster++ )
 		    {
-			streamlog_out ( DEBUG4 ) << "Using ZS mode, sensor " << i << endl;
-			clusterNumber.assign ( _chancount, 0 );
-			int clupos = -2;
-			int temppos = -2;
-			int clusize = 0;
-			if ( datavec.size ( ) > 0 )
+			for ( int ichan = _clusters[icluster].firstStrip; ichan <= _clusters[icluster].lastStrip; ichan++ )
 			{
-			    if ( _nonsensitiveaxis == "y" )
-			    {
-				for ( size_t ix = 0; ix <= ( datavec.size ( ) - 4 ); ix = ix + 4 )
-				{
-				    clupos = datavec[ix];
-				    if ( ( ( clupos - temppos ) == 1 ) && clusize < _maxclustersize )
-				    {
-					clusterNumber.at ( clupos ) = nClusters;
-					temppos = clupos;
-					clusize++;
-					streamlog_out ( DEBUG4 ) << "Enlarged cluster at " << clupos << endl;
-					dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["Hitmap_" + to_string ( _outputSensorID + i ) ] ) -> fill ( clupos );
-				    }
-				    else
-				    {
-					nClusters++;
-					clusterNumber.at ( clupos ) = nClusters;
-					streamlog_out ( DEBUG4 ) << "Found new cluster at " << clupos << endl;
-					temppos = clupos;
-					clusize = 1;
-					dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["Hitmap_" + to_string ( _outputSensorID + i ) ] ) -> fill ( clupos );
-				    }
-				}
-			    }
-			    if ( _nonsensitiveaxis == "x" )
+			    if ( hitmapHist )
 			    {
-				for ( size_t ix = 0; ix <= ( datavec.size ( ) - 4 ); ix = ix + 4 )
-				{
-				    clupos = datavec[ix + 1];
-				    if ( ( ( clupos - temppos ) == 1 ) && clusize < _maxclustersize )
-				    {
-					clusterNumber.at ( clupos ) = nClusters;
-					temppos = clupos;
-					clusize++;
-				    }
-				    else
-				    {
-					nClusters++;
-					clusterNumber.at ( clupos ) = nClusters;
-					temppos = clupos;
-					clusize = 1;
-				    }
-				}
+				hitmapHist -> fill ( ichan );
 			    }
 			}
-			datavec.clear ( );
-			for ( size_t ii = 0; ii < clusterNumber.size ( ); ii++ )
-			{
-			    datavec.push_back ( clusterNumber.at ( ii ) );
-			}
-			
 		    }
 
 		    if ( nClusters > _maxclusters )
 		    {
-			clusterNumber.assign ( _chancount, 0 );
 			streamlog_out ( DEBUG4 ) << "Found " << nClusters << " clusters in event " << anEvent -> getEventNumber ( ) << "! Discarding all of them!" << endl;
+			continue;
 		    }
 
 		    // now output the clusters we have found
-		    CellIDEncoder < TrackerPulseImpl > zsDataEncoder ( eutelescope::EUTELESCOPE::PULSEDEFAULTENCODING, clusterCollection );
-		    CellIDEncoder < TrackerDataImpl > idClusterEncoder ( eutelescope::EUTELESCOPE::ZSCLUSTERDEFAULTENCODING, sparseClusterCollectionVec );
-
-		    // decode datavec into pixelvec, each chan goes into a pixel
-		    //std::vector < eutelescope::EUTelGenericSparsePixel* > PixelVec;
-		    std::vector<EUTelGenericSparsePixel> PixelVec;
-		    eutelescope::EUTelGenericSparsePixel Pixel;
-		    std::unique_ptr < EUTelTrackerDataInterfacerImpl < EUTelGenericSparsePixel > > pixelData = std::make_unique < EUTelTrackerDataInterfacerImpl < EUTelGenericSparsePixel > > ( trkdata );
-		    for ( unsigned int iPixel = 0; iPixel < datavec.size ( ); iPixel++ )
+		    for ( size_t icluster = 0; icluster < _clusters.size ( ); icluster++ )
 		    {
-			if ( _nonsensitiveaxis == "x" )
-			{
-			    Pixel.setXCoord ( 0.0 );
-			    Pixel.setYCoord ( iPixel );
-			}
-			else
+			const EUTelStripClusterFinder::Cluster & cluster = _clusters[icluster];
+			if ( cluster.getSize ( ) > _maxclustersize )
 			{
-			    Pixel.setXCoord ( iPixel );
-			    Pixel.setYCoord ( 0.0 );
+			    streamlog_out ( DEBUG4 ) << "Cluster size " << cluster.getSize ( ) << " larger than allowed max cluster size of " << _maxclustersize << "! Discarding cluster in event " << anEvent -> getEventNumber ( ) << "!" << endl;
+			    continue;
 			}
-			Pixel.setSignal ( datavec[iPixel] * 1.0 );
-			PixelVec.push_back ( Pixel );
-			streamlog_out ( DEBUG0 ) << "Decoded pixel with coordinates: ( " << Pixel.getXCoord ( ) << " , " << Pixel.getYCoord ( ) << " ) and charge: " << datavec[iPixel] << " !" << endl;
-			streamlog_out ( DEBUG0 ) << "Input was: " << PixelVec.at ( iPixel ) << endl;
-		    }
 
-		    std::vector < int > ::iterator it;
-		    for ( it = clusterNumber.begin ( ); it != clusterNumber.end ( ); ++it )
-		    {
-			lcio::TrackerPulseImpl * pulseFrame = new lcio::TrackerPulseImpl ( );
-			lcio::TrackerDataImpl * clusterFrame = new lcio::TrackerDataImpl ( );
-			eutelescope::EUTelSparseClusterImpl < eutelescope::EUTelGenericSparsePixel > *pixelCluster = new eutelescope::EUTelSparseClusterImpl < eutelescope::EUTelGenericSparsePixel > ( clusterFrame );
-			
-			for ( size_t j = 0; j < datavec.size ( ); j++ )
+			std::unique_ptr < lcio::TrackerPulseImpl > pulseFrame = std::make_unique < lcio::TrackerPulseImpl > ( );
+			std::unique_ptr < lcio::TrackerDataImpl > clusterFrame = std::make_unique < lcio::TrackerDataImpl > ( );
+			eutelescope::EUTelSparseClusterImpl < eutelescope::EUTelGenericSparsePixel > pixelCluster ( clusterFrame.get ( ) );
+
+			// each channel goes into a pixel
+			for ( int ichan = cluster.firstStrip; ichan <= cluster.lastStrip; ichan++ )
 			{
-			    if ( clusterNumber.at ( j ) == *it ) 
+			    eutelescope::EUTelGenericSparsePixel Pixel;
+			    if ( _nonsensitiveaxis == "x" )
+			    {
+				Pixel.setXCoord ( 0.0 );
+				Pixel.setYCoord ( ichan );
+			    }
+			    else
 			    {
-				if ( clusterNumber.at ( j ) > 0 )
-				{
-				    // put only these pixels in that ClusterCollection that belong to that cluster
-				    auto temppix = PixelVec.at(i);
-				    pixelCluster -> push_back ( temppix );
-				    streamlog_out ( DEBUG1 ) << "Evt " << anEvent -> getEventNumber ( )<<" Adding channel " << j << " to cluster " << clusterNumber.at ( j ) << endl;
-				    if ( it != clusterNumber.end ( ) - 1 )
-				    {
-					++it;
-				    }
-				}
+				Pixel.setXCoord ( ichan );
+				Pixel.setYCoord ( 0.0 );
 			    }
+			    Pixel.setSignal ( signal[ichan] );
+			    pixelCluster.push_back ( Pixel );
+			    streamlog_out ( DEBUG1 ) << "Evt " << anEvent -> getEventNumber ( ) << " Adding channel " << ichan << " to cluster " << icluster << endl;
 			}
 
-			// now we have pixelClusters with the corresponding pixels (which have the xy and q info) in them
-			// this if stops making the "zero" cluster with all strips not in a cluster...
-			unsigned int clumin = 1;
-			unsigned int clumax = 99;
-			if ( ( pixelCluster -> size ( ) >= clumin ) && ( pixelCluster -> size ( ) <= clumax ) && ( pixelCluster -> getTotalCharge ( ) >= 1 ) ) 
+			if ( pixelCluster.getTotalCharge ( ) < 1 )
 			{
+			    continue;
+			}
 
-			    // make a frame of each cluster and give it position, charge, etc. Then push back into clusterCollection and sparseClusterCollectionVec.
-			    float x, y = 0;
-			    int xsize, ysize = 0;
-			    float charge = 0.0;
-			    charge = pixelCluster -> getTotalCharge ( );
-			    pulseFrame -> setCharge ( charge );
-			    pixelCluster -> getCenterOfGravity ( x, y );
-			    pixelCluster -> getClusterSize ( xsize, ysize );
-
-			    streamlog_out( DEBUG1 ) << "Cluster: " << *it << ", Q: " << charge << " , x: " << x << " , y: " << y << " , dx: " << xsize << " , dy: " << ysize << " in event: " << anEvent -> getEventNumber ( ) << endl;
+			// make a frame of each cluster and give it position, charge, etc. Then push back into clusterCollection and sparseClusterCollectionVec.
+			float x, y = 0;
+			int xsize, ysize = 0;
+			float charge = 0.0;
+			charge = pixelCluster.getTotalCharge ( );
+			pulseFrame -> setCharge ( charge );
+			pixelCluster.getCenterOfGravity ( x, y );
+			pixelCluster.getClusterSize ( xsize, ysize );
 
-			    dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["ClusterCharge_" + to_string ( _outputSensorID + i ) ] ) -> fill ( charge );
-			    if ( _nonsensitiveaxis == "x" )
-			    {
-				dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["ClusterSize_" + to_string ( _outputSensorID + i ) ] ) -> fill ( ysize );
-			    }
-			    if ( _nonsensitiveaxis == "y" )
-			    {
-				dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["ClusterSize_" + to_string ( _outputSensorID + i ) ] ) -> fill ( xsize );
-			    }
+			streamlog_out( DEBUG1 ) << "Cluster: " << icluster << ", Q: " << charge << " , x: " << x << " , y: " << y << " , dx: " << xsize << " , dy: " << ysize << " in event: " << anEvent -> getEventNumber ( ) << endl;
 
-			    zsDataEncoder["sensorID"] = _outputSensorID + i;
-			    zsDataEncoder["xSeed"] = static_cast < long > ( x );
-			    zsDataEncoder["ySeed"] = static_cast < long > ( y );
-			    zsDataEncoder["xCluSize"] = xsize;
-			    zsDataEncoder["yCluSize"] = ysize;
-			    zsDataEncoder["type"] = static_cast < int > ( kEUTelSparseClusterImpl );
-			    zsDataEncoder["quality"] =  0;
-			    zsDataEncoder.setCellID ( pulseFrame );
-			    pulseFrame -> setTrackerData ( clusterFrame );
-			    clusterCollection -> push_back ( pulseFrame );
-
-			    idClusterEncoder["sensorID"] = _outputSensorID + i;
-			    idClusterEncoder["sparsePixelType"] = 2;
-			    idClusterEncoder["quality"] = 0;
-			    idClusterEncoder.setCellID ( clusterFrame );
-			    sparseClusterCollectionVec -> push_back ( clusterFrame );
+			if ( cchargeHist )
+			{
+			    cchargeHist -> fill ( charge );
 			}
-			else // clean up
+			if ( csizeHist )
 			{
-			    delete pulseFrame;
-			    delete clusterFrame;
+			    csizeHist -> fill ( _nonsensitiveaxis == "x" ? ysize : xsize );
 			}
 
-			delete pixelCluster;
+			zsDataEncoder["sensorID"] = sensorID;
+			zsDataEncoder["xSeed"] = static_cast < long > ( x );
+			zsDataEncoder["ySeed"] = static_cast < long > ( y );
+			zsDataEncoder["xCluSize"] = xsize;
+			zsDataEncoder["yCluSize"] = ysize;
+			zsDataEncoder["type"] = static_cast < int > ( kEUTelSparseClusterImpl );
+			zsDataEncoder["quality"] =  0;
+			zsDataEncoder.setCellID ( pulseFrame.get ( ) );
+
+			idClusterEncoder["sensorID"] = sensorID;
+			idClusterEncoder["sparsePixelType"] = 2;
+			idClusterEncoder["quality"] = 0;
+			idClusterEncoder.setCellID ( clusterFrame.get ( ) );
 
-		    } // done clusterNumber iteration
+			pulseFrame -> setTrackerData ( clusterFrame.get ( ) );
+			sparseClusterCollectionVec -> push_back ( clusterFrame.release ( ) );
+			clusterCollection -> push_back ( pulseFrame.release ( ) );
+
+		    } // done cluster iteration
 
 		}
 	    }
@@ -513,6 +326,17 @@ void CBCClustering::processEvent ( LCEvent * anEvent )
 }
 
 
+AIDA::IHistogram1D * CBCClustering::getHisto ( const std::string & name, int sensorID )
+{
+    std::map < std::string, AIDA::IBaseHistogram * > ::iterator histo = _aidaHistoMap.find ( name + to_string ( sensorID ) );
+    if ( histo == _aidaHistoMap.end ( ) )
+    {
+	return nullptr;
+    }
+    return dynamic_cast < AIDA::IHistogram1D* > ( histo -> second );
+}
+
+
 void CBCClustering::check ( LCEvent * /* evt */ )
 {
 
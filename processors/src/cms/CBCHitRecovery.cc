@@ -48,6 +48,7 @@
 #include <map>
 #include <cmath>
 #include <algorithm>
+#include <limits>
 
 // eutelescope includes ""
 #include "EUTELESCOPE.h"
@@ -69,7 +70,11 @@ using namespace eutelescope;
 
 
 CBCHitRecovery::CBCHitRecovery ( ) : Processor ( "CBCHitRecovery" ),
-_aidaHistoMap ( )
+_aidaHistoMap ( ),
+_hitGrid ( ),
+_candidates ( ),
+_virtualResidualRange ( 0.5 ),
+_dutResidualRange ( 1.5 )
 {
 
     _description = "CBCHitRecovery recovers the real hit positions from the virtual dut and track.";
@@ -282,49 +287,33 @@ void CBCHitRecovery::processEvent ( LCEvent * anEvent )
                                 dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["FitHitPosY_DUT1"] ) -> fill (fit_hit_pos_dut1[1]);
                                 dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["FitHitPosZ_DUT1"] ) -> fill (fit_hit_pos_dut1[2]);
 
-                                // now calculate the residuals
+                                // the hits of the virtual and the two real DUTs, decoded once
+                                std::vector < double > hitX[3], hitY[3];
+                                CellIDDecoder < TrackerHitImpl > inputCellIDDecoder ( inputHitsVec );
                                 int nHits = inputHitsVec -> getNumberOfElements ( );
                                 for ( int iHit = 0; iHit < nHits; ++iHit ) {
                                         TrackerHitImpl * hit = dynamic_cast < TrackerHitImpl * > ( inputHitsVec -> getElementAt ( iHit ) );
-
-                                        // sensor id decoder
-                                        CellIDDecoder < TrackerHitImpl > inputCellIDDecoder ( inputFitPointVec );
                                         int sensorID = inputCellIDDecoder ( hit ) ["sensorID"];
+                                        const double *pos = hit->getPosition();
+
+                                        int plane = -1;
+                                        if (sensorID == _cbcVirtualDUTId) plane = 0;
+                                        else if (sensorID == _cbcRealDUTsVec.at(0)) plane = 1;
+                                        else if (sensorID == _cbcRealDUTsVec.at(1)) plane = 2;
+                                        if (plane < 0) continue;
 
-                                        // virtual
-                                        if (sensorID == _cbcVirtualDUTId) {
-                                                const double *pos = hit->getPosition();
-                                                double resX = (cVirtualHitPos[0] - pos[0])*1000;
-                                                //double resY = (cVirtualHitPos[1] - pos[1])*1000;
-                                                //double resZ = (cVirtualHitPos[2] - pos[2])*1000;
-
-                                                dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["VirtualResidualX"] ) -> fill (resX);
-                                        }
-
-                                        // first sensor
-                                        if (sensorID == _cbcRealDUTsVec.at(0)) {
-                                                const double *pos = hit->getPosition();
-                                                double resX = (fit_hit_pos_dut0[0] - pos[0])*1000;
-                                                //double resY = (fit_hit_pos_dut0[1] - pos[1])*1000;
-                                                //double resZ = (fit_hit_pos_dut0[2] - pos[2])*1000;
-
-                                                dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["ResidualX_DUT0"] ) -> fill (resX);
-                                        }
-
-                                        // second sensor
-                                        if (sensorID == _cbcRealDUTsVec.at(1)) {
-                                                const double *pos = hit->getPosition();
-                                                double resX = (fit_hit_pos_dut1[0] - pos[0])*1000;
-                                                //double resY = (fit_hit_pos_dut1[1] - pos[1])*1000;
-                                                //double resZ = (fit_hit_pos_dut1[2] - pos[2])*1000;
-
-                                                dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["ResidualX_DUT1"] ) -> fill (resX);
-                                        }
+                                        hitX[plane].push_back(pos[0]);
+                                        hitY[plane].push_back(pos[1]);
                                 }
 
+                                // now calculate the residuals of the hits within the histogram range of the track
+                                fillResiduals(hitX[0], hitY[0], cVirtualHitPos[0], _virtualResidualRange, "VirtualResidualX");
+                                fillResiduals(hitX[1], hitY[1], fit_hit_pos_dut0[0], _dutResidualRange, "ResidualX_DUT0");
+                                fillResiduals(hitX[2], hitY[2], fit_hit_pos_dut1[0], _dutResidualRange, "ResidualX_DUT1");
+
                                 // delete the hist positions
-                                delete fit_hit_pos_dut0;
-                                delete fit_hit_pos_dut1;
+                                delete[] fit_hit_pos_dut0;
+                                delete[] fit_hit_pos_dut1;
 
                                 // clear pos vectors
                                 //delete cTelescope2Pos;
@@ -413,20 +402,34 @@ void CBCHitRecovery::bookHistos ( )
         _aidaHistoMap.insert ( make_pair ( "FitHitPosZ_DUT1", cDUT1FitHitPosZ ) );
         cDUT1FitHitPosX -> setTitle ( "Fit Hit Pos Z - DUT " + to_string(_cbcRealDUTsVec.at(1)) + ";Z [mm];Entries" );
 
-        AIDA::IHistogram1D * cVirtualResidualX = AIDAProcessor::histogramFactory ( this ) -> createHistogram1D ( ( basePathOut + "VirtualResidualX" ).c_str ( ), 100, -500, 500 );
+        AIDA::IHistogram1D * cVirtualResidualX = AIDAProcessor::histogramFactory ( this ) -> createHistogram1D ( ( basePathOut + "VirtualResidualX" ).c_str ( ), 100, -1000 * _virtualResidualRange, 1000 * _virtualResidualRange );
         _aidaHistoMap.insert ( make_pair ( "VirtualResidualX", cVirtualResidualX ) );
         cVirtualResidualX -> setTitle ( "Residual X - Virtual DUT;X [um];Entries" );
 
-        AIDA::IHistogram1D * cDUT0ResidualX = AIDAProcessor::histogramFactory ( this ) -> createHistogram1D ( ( basePathOut + "ResidualX_DUT" + to_string(_cbcRealDUTsVec.at(0))).c_str ( ), 600, -1500, 1500 );
+        AIDA::IHistogram1D * cDUT0ResidualX = AIDAProcessor::histogramFactory ( this ) -> createHistogram1D ( ( basePathOut + "ResidualX_DUT" + to_string(_cbcRealDUTsVec.at(0))).c_str ( ), 600, -1000 * _dutResidualRange, 1000 * _dutResidualRange );
         _aidaHistoMap.insert ( make_pair ( "ResidualX_DUT0", cDUT0ResidualX ) );
         cDUT0ResidualX -> setTitle ( "Residual X - DUT " + to_string(_cbcRealDUTsVec.at(0)) + ";X [um];Entries" );
 
-        AIDA::IHistogram1D * cDUT1ResidualX = AIDAProcessor::histogramFactory ( this ) -> createHistogram1D ( ( basePathOut + "ResidualX_DUT" + to_string(_cbcRealDUTsVec.at(1))).c_str ( ), 600, -1500, 1500 );
+        AIDA::IHistogram1D * cDUT1ResidualX = AIDAProcessor::histogramFactory ( this ) -> createHistogram1D ( ( basePathOut + "ResidualX_DUT" + to_string(_cbcRealDUTsVec.at(1))).c_str ( ), 600, -1000 * _dutResidualRange, 1000 * _dutResidualRange );
         _aidaHistoMap.insert ( make_pair ( "ResidualX_DUT1", cDUT1ResidualX ) );
         cDUT1ResidualX -> setTitle ( "Residual X - DUT " + to_string(_cbcRealDUTsVec.at(1)) + ";X [um];Entries" );
 
 }
 
+// fill the x residuals in um of the hits within range mm of the track
+void CBCHitRecovery::fillResiduals(const std::vector<double> &hitX, const std::vector<double> &hitY, double trackX, double range, const std::string &histoName) {
+        // the hits are binned once, the query only visits the ones near the track
+        _hitGrid.build(hitX, hitY, range);
+        double const anyY = std::numeric_limits<double>::max();
+        _hitGrid.query(trackX - range, trackX + range, -anyY, anyY, _candidates);
+
+        AIDA::IHistogram1D * histo = dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap[histoName] );
+        for(size_t i = 0; i < _candidates.size(); i++) {
+                double resX = (trackX - hitX[_candidates[i]])*1000;
+                histo -> fill (resX);
+        }
+}
+
 // get the module of vector
 double CBCHitRecovery::vector_get_length(const double *vec) {
         double length = 0;
@@ -44,6 +44,7 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <algorithm>
 
 // eutelescope includes ""
 #include "anyoption.h"
@@ -74,6 +75,8 @@ CMSBuncher::CMSBuncher ( ) : DataSourceProcessor ( "CMSBuncher" )
 
     registerProcessorParameter ( "SingleFrameTime", "The time of a frame. Unit is micro seconds", _singleframetime, 115 );
 
+    registerProcessorParameter ( "PrefetchFrames", "The number of telescope frames read ahead on a background thread, 0 to read them on demand. The read ahead needs the thread safe reader of LCIO 2.14 or later, with an older LCIO the frames are always read on demand", _prefetchFrames, 16 );
+
 }
 
 
@@ -89,51 +92,25 @@ void CMSBuncher::init ( )
     printParameters ( );
 
     // set time
-    _frametime = 1;
     _bunchtime = 0;
 
     _evtcount = 0;
 
-    _maxevents = 5;
-
-    _telescopeopen = false;
-    _usestorageevent = false;
-}
-
-
-LCEvent *CMSBuncher::readTelescope ( )
-{
     // the telescope file is read here...
-    if ( _telescopeopen == false )
-    {
-	lcReader = LCFactory::getInstance ( ) -> createLCReader ( IO::LCReader::directAccess );
-	try
-	{
-	    lcReader -> open ( _telescopeFile );
-	    _telescopeopen = true;
-	    _maxevents = lcReader -> getNumberOfEvents ( );
-	     streamlog_out ( MESSAGE4 ) << "Running over " << _maxevents << " events!" << endl;
-	}
-	catch ( IOException& e )
-	{
-	    streamlog_out ( ERROR1 ) << "Can't open the telescope file: " << e.what ( ) << endl;
-	}
-    }
-
     try
     {
-	LCEvent *evt = lcReader -> readNextEvent ( );
-	if ( evt == nullptr )
+	std::vector < std::string > collections ( 1, _inputCollectionName );
+	_telescopeReader.reset ( new EUTelTelescopeReader ( _telescopeFile, collections, static_cast < size_t > ( std::max ( _prefetchFrames, 0 ) ) ) );
+	if ( _prefetchFrames > 0 && !EUTelTelescopeReader::canPrefetch ( ) )
 	{
-	    return nullptr;
-	    streamlog_out ( ERROR1 ) << "FAIL! NULL Event!" << endl ;
+	    streamlog_out ( WARNING5 ) << "This LCIO version can not read the telescope file on a background thread, the frames are read on demand" << endl;
 	}
-	return ( evt );
+	streamlog_out ( MESSAGE4 ) << "Running over " << _telescopeReader -> getNumberOfEvents ( ) << " events!" << endl;
     }
     catch ( IOException& e )
     {
-	streamlog_out ( ERROR1 ) << "FAIL: " << e.what ( ) << endl ;
-	return nullptr;
+	streamlog_out ( ERROR5 ) << "Can't open the telescope file: " << e.what ( ) << endl;
+	exit ( -1 );
     }
 }
 
@@ -146,12 +123,12 @@ void CMSBuncher::readDataSource ( int /*numEvents*/ )
     ProcessorMgr::instance ( ) -> processRunHeader ( lcHeader ) ;
     delete lcHeader;
 
-    // the input collections
-    LCCollectionVec * telescopeCollectionVec;
-
-    int bunchcount = 0;
+    // the telescope frames of a bunch and the data they add up to per sensor
+    std::vector < EUTelTelescopeReader::FramePtr > frames;
+    std::map < int, FloatVec > outputData;
 
-    while ( bunchcount < ( _maxevents - 1 ) )
+    // bunch until the telescope file is exhausted
+    while ( _telescopeReader -> peek ( ) )
     {
 
 	_bunchtime += _singleframetime;
@@ -166,99 +143,63 @@ void CMSBuncher::readDataSource ( int /*numEvents*/ )
 	event -> parameters ( ) .setValue ( "EventType", 2 );
 	event -> setTimeStamp ( _bunchtime );
 
-	// prepare the output vector for this event
-	vector < float > outputData[10];
-
-	try
+	// prepare the output for this event, the six telescope planes are always written
+	outputData.clear ( );
+	for ( int i = 0; i < 6; i++ )
 	{
-	    // process this guy...
-	    LCEvent* evt;
+	    outputData[i];
+	}
 
-	    bool continueloop = true;
+	// all telescope frames before the end of this bunch, the first one after it is kept for the next
+	frames.clear ( );
+	_telescopeReader -> readUntil ( _bunchtime, frames );
+	streamlog_out ( DEBUG2 ) << "Adding " << frames.size ( ) << " telescope frames!" << endl;
 
-	    while ( continueloop == true )
+	try
+	{
+	    for ( auto const & frame : frames )
 	    {
-		if ( _usestorageevent == false )
-		{
-		    // the telescope is read by the function
-		    bunchcount++;
-		    evt = readTelescope ( );
-		    streamlog_out ( DEBUG4 ) << "Reading telescope bunch " << bunchcount << endl;
-		}
-		else
-		{
-		    evt = _storeevt;
-		    _usestorageevent = false;
-		    streamlog_out ( DEBUG2 ) << "Using stored event!" << endl;
-		}
-
-		_frametime = evt -> getTimeStamp ( );
-		// save for future...
-		_storeevt = evt;
-
-		streamlog_out ( DEBUG2 ) << "Read telescope frame has a time of " << _frametime << endl;
-		
-		if ( _frametime < _bunchtime )
-		{
-		    streamlog_out ( DEBUG2 ) << "Adding a telescope frame!" << endl;
-		}
-		else
-		{
-		    _usestorageevent = true;
-		    continueloop = false;
-		    streamlog_out ( DEBUG2 ) << "Over time, breaking!" << endl;
-		    break;
-		}
+		streamlog_out ( DEBUG2 ) << "Read telescope frame has a time of " << frame -> getTimeStamp ( ) << endl;
 
 		// now read the data
-		telescopeCollectionVec = dynamic_cast < LCCollectionVec * > ( evt -> getCollection ( _inputCollectionName ) );
+		LCCollectionVec * telescopeCollectionVec = frame -> getCollection ( _inputCollectionName );
+		CellIDDecoder < TrackerDataImpl > inputDecoder ( telescopeCollectionVec );
 		int readsize = telescopeCollectionVec -> getNumberOfElements ( );
 		for ( int j = 0; j < readsize; j++ )
 		{
-		    streamlog_out ( DEBUG1 ) << "Reading telescope ..." << endl;
-		    CellIDDecoder < TrackerDataImpl > inputDecoder ( telescopeCollectionVec );
 		    lcio::TrackerDataImpl * input  = dynamic_cast < lcio::TrackerDataImpl * > ( telescopeCollectionVec -> getElementAt ( j ) );
 		    int sensorID = inputDecoder ( input )["sensorID"];
 		    streamlog_out ( DEBUG0 ) << "Reading sensorID " << sensorID << endl;
-		    FloatVec inputvec;
-		    inputvec = input -> getChargeValues ( );
-
-		    // assume 10 planes tops
-		    for ( int i = 0; i < 10; i++ )
-		    {
-			if ( i == sensorID )
-			{
-			    for ( size_t k = 0; k < inputvec.size ( ); k++ )
-			    {
-				outputData[i].push_back ( inputvec.at ( k ) );
-			    }
-			}
-		    }
+
+		    const FloatVec & inputvec = input -> getChargeValues ( );
+		    FloatVec & planeData = outputData[sensorID];
+		    planeData.insert ( planeData.end ( ), inputvec.begin ( ), inputvec.end ( ) );
 		}
 	    }
 
 	    streamlog_out ( DEBUG4 ) << "Done accumulating, writing!" << endl;
 
-	    for ( int i = 0; i < 6; i++ )
+	    for ( auto const & plane : outputData )
 	    {
 		TrackerDataImpl* planeData = new TrackerDataImpl ( );
-		encoder["sensorID"] = i;
+		encoder["sensorID"] = plane.first;
 		encoder["sparsePixelType"] = 2;
 		encoder.setCellID ( planeData );
-		planeData -> setChargeValues ( outputData[i] );
+		planeData -> setChargeValues ( plane.second );
 		dataCollection -> addElement ( planeData );
 	    }
 	    event -> addCollection ( dataCollection, _outputCollectionName );
-    }
-    catch ( lcio::DataNotAvailableException& )
-    {
-	streamlog_out( ERROR1 ) << "Collection " << _inputCollectionName << " not found" << endl;
-    }
+	}
+	catch ( lcio::DataNotAvailableException& )
+	{
+	    streamlog_out( ERROR1 ) << "Collection " << _inputCollectionName << " not found" << endl;
+	    delete dataCollection;
+	}
 
-    ProcessorMgr::instance ( ) -> processEvent ( event ) ;
+	ProcessorMgr::instance ( ) -> processEvent ( event ) ;
 
-    _evtcount++;
-    delete event;
+	_evtcount++;
+	delete event;
 
     }
 }
@@ -267,7 +208,6 @@ void CMSBuncher::readDataSource ( int /*numEvents*/ )
 void CMSBuncher::end ( )
 {
     // the telescope file is still open, we can now close it
-    lcReader -> close ( );
-    delete lcReader;
+    _telescopeReader.reset ( );
     streamlog_out ( MESSAGE4 ) << "Successfully finished!" << endl;
 }
@@ -45,6 +45,7 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <algorithm>
 
 // eutelescope includes ""
 #include "anyoption.h"
@@ -86,6 +87,8 @@ CMSMerger::CMSMerger ( ) : Processor ( "CMSMerger" )
 
     registerProcessorParameter ( "EventMerge", "Merge events based on event number (true) or on event time (false)", _eventmerge, true );
 
+    registerProcessorParameter ( "PrefetchFrames", "The number of telescope events read ahead on a background thread, 0 to read them on demand. The read ahead needs the thread safe reader of LCIO 2.14 or later, with an older LCIO the events are always read on demand", _prefetchFrames, 16 );
+
     registerProcessorParameter ( "OutputCollectionName", "The name of the output collection we want to create", _outputCollectionName, string ( "output_collection1" ) );
 
     registerProcessorParameter ( "OutputCollectionName2", "The name of the secondary output collection we want to create", _outputCollectionName2, string ( "output_collection2" ) );
@@ -113,15 +116,31 @@ void CMSMerger::init ( )
     // set times, init with telescope smaller, so that we read the first event
     _cbceventtime = -1;
     _telescopeeventtime = -2;
-    _maxevents = 2;
-    _readcount = 0;
+    _multiplicity = 0;
 
+    // the telescope file is read here, only once...
+    try
+    {
+	std::vector < std::string > collections;
+	collections.push_back ( _telescopeCollectionName );
+	collections.push_back ( _telescopeCollectionName2 );
+	collections.push_back ( _outputCollectionName3 );
+	_telescopeReader.reset ( new EUTelTelescopeReader ( _telescopeFile, collections, static_cast < size_t > ( std::max ( _prefetchFrames, 0 ) ) ) );
+	if ( _prefetchFrames > 0 && !EUTelTelescopeReader::canPrefetch ( ) )
+	{
+	    streamlog_out ( WARNING5 ) << "This LCIO version can not read the telescope file on a background thread, the events are read on demand" << endl;
+	}
+    }
+    catch ( IOException& e )
+    {
+	streamlog_out ( ERROR5 ) << "Can't open the telescope file: " << e.what ( ) << endl;
+	exit ( -1 );
+    }
 
-    for ( int i = 0; i < _eventdifferenceTelescope; i++ )
+    if ( _eventdifferenceTelescope > 0 )
     {
-	LCEvent *evt = readTelescope ( );
-	streamlog_out ( MESSAGE4 ) << "Skipped " << i + 1 << " telescope events!" << endl;
-	streamlog_out ( MESSAGE4 ) << "Event skipped was " << evt -> getEventNumber ( ) << endl;
+	_telescopeReader -> skip ( static_cast < size_t > ( _eventdifferenceTelescope ) );
+	streamlog_out ( MESSAGE4 ) << "Skipped " << _eventdifferenceTelescope << " telescope events!" << endl;
     }
 
 }
@@ -134,52 +153,11 @@ void CMSMerger::processRunHeader ( LCRunHeader * rdr )
     auto arunHeader = std::make_unique < EUTelRunHeaderImpl > ( rdr );
     arunHeader -> addProcessor ( type ( ) );
 
-    // so we only open the telescope file once...
-    _telescopeopen = false;
-
     bookHistos ( );
 
 }
 
 
-LCEvent *CMSMerger::readTelescope ( )
-{
-    // the telescope file is read here...
-    if ( _telescopeopen == false )
-    {
-	lcReader = LCFactory::getInstance ( ) -> createLCReader ( IO::LCReader::directAccess );
-	try
-	{
-	    lcReader -> open ( _telescopeFile );
-	    _telescopeopen = true;
-	    _maxevents = lcReader -> getNumberOfEvents ( );
-	}
-	catch ( IOException& e )
-	{
-	    streamlog_out ( ERROR1 ) << "Can't open the telescope file: " << e.what ( ) << endl;
-	}
-    }
-
-    try
-    {
-	LCEvent *evt = lcReader -> readNextEvent ( );
-	if ( evt == nullptr )
-	{
-	    return nullptr;
-	    streamlog_out ( ERROR1 ) << "FAIL! NULL Event!" << endl ;
-	}
-
-	return ( evt );
-
-    }
-    catch ( IOException& e )
-    {
-	streamlog_out ( ERROR1 ) << "FAIL: " << e.what ( ) << endl ;
-	return nullptr;
-    }
-}
-
-
 void CMSMerger::processEvent ( LCEvent * anEvent )
 {
 
@@ -360,7 +338,7 @@ void CMSMerger::processEvent ( LCEvent * anEvent )
     {
 
 	// process this guy...
-	LCEvent* evt;
+	EUTelTelescopeReader::FramePtr evt;
 
 	if ( _eventmerge == false )
 	{
@@ -372,12 +350,9 @@ void CMSMerger::processEvent ( LCEvent * anEvent )
 		multiplicityhisto -> fill ( _multiplicity );
 		_multiplicity = 1;
 
-		// the telescope is read by the function
-		if ( _readcount <  _maxevents )
-		{
-		    evt = readTelescope ( );
-		}
-		else
+		// the telescope is read ahead by the reader
+		evt = _telescopeReader -> next ( );
+		if ( !evt )
 		{
 		    streamlog_out ( MESSAGE4 ) << "Reached EOF!" << endl;
 		    exit ( -1 );
@@ -386,13 +361,13 @@ void CMSMerger::processEvent ( LCEvent * anEvent )
 		int tempnr = evt -> getEventNumber ( );
 		streamlog_out ( DEBUG4 ) << "Reading new event nr " << tempnr << endl;
 		// save for future...
-		_storeevt = evt;
+		_storedFrame = evt;
 
 	    }
 	    else
 	    {
 		_multiplicity++;
-		evt = _storeevt;
+		evt = _storedFrame;
 		int tempnr = evt -> getEventNumber ( );
 
 		streamlog_out ( DEBUG4 ) << "Reading old event nr " << tempnr << endl;
@@ -403,24 +378,29 @@ void CMSMerger::processEvent ( LCEvent * anEvent )
 	if ( _eventmerge == true )
 	{
 
-	    evt = readTelescope ( );
+	    evt = _telescopeReader -> next ( );
+	    if ( !evt )
+	    {
+		streamlog_out ( MESSAGE4 ) << "Reached EOF!" << endl;
+		exit ( -1 );
+	    }
 
 	}
 
 	 _telescopeeventtime = evt -> getTimeStamp ( );
 	streamlog_out ( DEBUG4 ) << "Telescope time is " << _telescopeeventtime << endl;
 
-	telescopeCollectionVec = dynamic_cast < LCCollectionVec * > ( evt -> getCollection ( _telescopeCollectionName ) );
+	telescopeCollectionVec = evt -> getCollection ( _telescopeCollectionName );
 	telescopesize = telescopeCollectionVec -> getNumberOfElements ( );
 	streamlog_out ( DEBUG1 ) << telescopesize << " Elements in telescope event!" << endl;
 
 	// and the secondary collections
-	telescopeCollectionVec2 = dynamic_cast < LCCollectionVec * > ( evt -> getCollection ( _telescopeCollectionName2 ) );
+	telescopeCollectionVec2 = evt -> getCollection ( _telescopeCollectionName2 );
 	telescopesize2 = telescopeCollectionVec2 -> getNumberOfElements ( );
 	streamlog_out ( DEBUG1 ) << telescopesize2 << " Elements in telescope event - collection 2!" << endl;
 
 	// this guy can have less events and is not merged, but copied
-	telescopeCollectionVec3 = dynamic_cast < LCCollectionVec * > ( evt -> getCollection ( _outputCollectionName3 ) );
+	telescopeCollectionVec3 = evt -> getCollection ( _outputCollectionName3 );
 	telescopesize3 = telescopeCollectionVec3 -> getNumberOfElements ( );
 	streamlog_out ( DEBUG1 ) << telescopesize3 << " Elements in Telescope event - collection 3!" << endl;
 
@@ -522,8 +502,8 @@ void CMSMerger::check (LCEvent * /* evt */ )
 void CMSMerger::end ( )
 {
     // the telescope file is still open, we can now close it
-    lcReader -> close ( );
-    delete lcReader;
+    _storedFrame.reset ( );
+    _telescopeReader.reset ( );
     streamlog_out ( MESSAGE4 ) << "Successfully finished!" << endl;
 }
 
@@ -68,7 +68,9 @@ AIDA::IHistogram1D * stubmap_top_y;
 AIDA::IHistogram1D * stubmap_bot_y;
 
 
-CMSStubGenerator::CMSStubGenerator ( ) : Processor ( "CMSStubGenerator" )
+CMSStubGenerator::CMSStubGenerator ( ) : Processor ( "CMSStubGenerator" ),
+_fillAllPairHistograms ( true ),
+_plane2Grid ( )
 {
     // modify processor description
     _description =  "CMSStubGenerator merges the two CBC sensors' hits into stubs, based on the cluster positions. In modes 1 and 2, it can also drop either sensor's hits to have only one sensor remaining.";
@@ -89,6 +91,8 @@ CMSStubGenerator::CMSStubGenerator ( ) : Processor ( "CMSStubGenerator" )
 
     registerProcessorParameter ( "OutputSensorID", "SensorID of the output stub.", _outputSensorID, 8 );
 
+    registerOptionalParameter ( "FillAllPairHistograms", "Fill the cluster correlation and fail distance histograms with every pair of hits on the two DUT planes, as always done. The stubs are always searched only among the pairs within MaxResidual of each other. Set to false to fill these plots with those pairs only, which avoids looping over all the pairs but leaves the tails out of the plots.", _fillAllPairHistograms, true );
+
     registerProcessorParameter ( "RequireStub", "Do we require an event to have the stub flag set to create an offline stub? 1 for on, 0 for off.", _requirestubflag, 1 );
 
 }
@@ -215,41 +219,60 @@ void CMSStubGenerator::processEvent ( LCEvent * event )
 
     if ( _runMode == 0)
     {
-	for ( unsigned int iHitPlane1 = 0; iHitPlane1 < dutPlane1Hits.size ( ); iHitPlane1++ )
+	// the cluster position and charge of each DUT hit, computed once
+	std::vector < StubHit > plane1 = decodeHits ( inputHitCollection, dutPlane1Hits );
+	std::vector < StubHit > plane2 = decodeHits ( inputHitCollection, dutPlane2Hits );
+
+	// bin the plane 2 hits, so that each plane 1 hit only looks at the ones inside its window
+	std::vector < double > x2vec, y2vec;
+	for ( size_t iHitPlane2 = 0; iHitPlane2 < plane2.size ( ); iHitPlane2++ )
+	{
+	    x2vec.push_back ( plane2[iHitPlane2].x );
+	    y2vec.push_back ( plane2[iHitPlane2].y );
+	}
+	_plane2Grid.build ( x2vec, y2vec, _maxResidual );
+
+	std::vector < size_t > candidates;
+	for ( size_t iHitPlane1 = 0; iHitPlane1 < plane1.size ( ); iHitPlane1++ )
 	{
-	    TrackerHitImpl * Hit1 = dynamic_cast < TrackerHitImpl* > ( inputHitCollection -> getElementAt ( dutPlane1Hits[iHitPlane1] ) );
-	    float x1 = -1.0;
-	    float y1 = -1.0;
-	    float q1 = -1.0;
-	    const double* pos1 = Hit1 -> getPosition ( );
-	    TrackerDataImpl* clusterVector1 = static_cast < TrackerDataImpl* > ( Hit1 -> getRawHits ( ) [0] );
-	    EUTelSimpleVirtualCluster * cluster1 = nullptr;
-	    cluster1 = new EUTelSparseClusterImpl < EUTelGenericSparsePixel > ( clusterVector1 );
-	    if ( cluster1 != nullptr )
+	    const StubHit & hit1 = plane1[iHitPlane1];
+	    float x1 = hit1.x;
+	    float y1 = hit1.y;
+
+	    if ( _fillAllPairHistograms )
 	    {
-		cluster1 -> getCenterOfGravity ( x1, y1 );
-		q1 = cluster1 -> getTotalCharge ( );
+		// every pair, only for the correlation and failed distance plots
+		for ( size_t iHitPlane2 = 0; iHitPlane2 < plane2.size ( ); iHitPlane2++ )
+		{
+		    float x2 = plane2[iHitPlane2].x;
+		    float y2 = plane2[iHitPlane2].y;
+		    correx -> fill ( x1, x2 );
+		    correy -> fill ( y1, y2 );
+		    if ( !( fabs ( x1 - x2 ) < _maxResidual && fabs ( y1 - y2 ) < _maxResidual ) )
+		    {
+			faildistx -> fill ( x1 - x2 );
+			faildisty -> fill ( y1 - y2 );
+		    }
+		}
 	    }
 
-	    for ( unsigned int iHitPlane2 = 0; iHitPlane2 < dutPlane2Hits.size ( ); iHitPlane2++ )
+	    // the stubs come from the pairs in the window, in plane 2 order as the full loop did
+	    _plane2Grid.query ( x1 - _maxResidual, x1 + _maxResidual, y1 - _maxResidual, y1 + _maxResidual, candidates );
+
+	    for ( size_t icandidate = 0; icandidate < candidates.size ( ); icandidate++ )
 	    {
-		TrackerHitImpl * Hit2 = dynamic_cast < TrackerHitImpl* > ( inputHitCollection -> getElementAt ( dutPlane2Hits[iHitPlane2] ) );
-		float x2 = -1.0;
-		float y2 = -1.0;
-		float q2 = -1.0;
-		const double* pos2 = Hit2 -> getPosition ( );
-		TrackerDataImpl* clusterVector2 = static_cast < TrackerDataImpl* > ( Hit2 -> getRawHits ( ) [0] );
-		EUTelSimpleVirtualCluster * cluster2 = nullptr;
-		cluster2 = new EUTelSparseClusterImpl < EUTelGenericSparsePixel > ( clusterVector2 );
-		if ( cluster2 != nullptr )
+		const StubHit & hit2 = plane2[candidates[icandidate]];
+		float x2 = hit2.x;
+		float y2 = hit2.y;
+		const double* pos1 = hit1.hit -> getPosition ( );
+		const double* pos2 = hit2.hit -> getPosition ( );
+		streamlog_out ( DEBUG0 ) << " x1 " << x1 << " y1 " << y1 << " q1 " << hit1.q << " x2 " << x2 << " y2 " << y2 << " q2 " << hit2.q << " evt " << evt -> getRunNumber ( ) << endl;
+
+		if ( !_fillAllPairHistograms )
 		{
-		    cluster2 -> getCenterOfGravity ( x2, y2 );
-		    q2 = cluster2 -> getTotalCharge ( );
+		    correx -> fill ( x1, x2 );
+		    correy -> fill ( y1, y2 );
 		}
-		streamlog_out ( DEBUG0 ) << " x1 " << x1 << " y1 " << y1 << " q1 " << q1 << " x2 " << x2 << " y2 " << y2 << " q2 " << q2 << " evt " << evt -> getRunNumber ( ) << endl;
-
-		correx -> fill ( x1, x2 );
-		correy -> fill ( y1, y2 );
 
 		float dx = -1.0;
 		float dy = -1.0;
@@ -271,11 +294,11 @@ void CMSStubGenerator::processEvent ( LCEvent * event )
 		    hit -> setCovMatrix ( cov );
 		    hit -> setType ( kEUTelGenericSparseClusterImpl );
 		    // assume all times are equal
-		    hit -> setTime ( Hit1 -> getTime ( ) );
+		    hit -> setTime ( hit1.hit -> getTime ( ) );
 
 		    LCObjectVec clusterVec;
-		    clusterVec.push_back ( clusterVector1 );
-		    clusterVec.push_back ( clusterVector2 );
+		    clusterVec.push_back ( hit1.cluster );
+		    clusterVec.push_back ( hit2.cluster );
 
 		    hit -> rawHits ( ) = clusterVec;
 
@@ -315,9 +338,13 @@ void CMSStubGenerator::processEvent ( LCEvent * event )
 			stubmap_top_y -> fill ( y1 );
 			stubmap_bot_y -> fill ( y2 );
 		    }
+		    else
+		    {
+			delete hit;
+		    }
 
 		}
-		else
+		else if ( !_fillAllPairHistograms )
 		{
 		    faildistx -> fill ( x1 - x2 );
 		    faildisty -> fill ( y1 - y2 );
@@ -344,6 +371,24 @@ void CMSStubGenerator::processEvent ( LCEvent * event )
 }
 
 
+std::vector < CMSStubGenerator::StubHit > CMSStubGenerator::decodeHits ( LCCollectionVec * collection, const std::vector < int > & indices )
+{
+    std::vector < StubHit > hits;
+    hits.reserve ( indices.size ( ) );
+    for ( size_t i = 0; i < indices.size ( ); i++ )
+    {
+	StubHit stubHit;
+	stubHit.hit = dynamic_cast < TrackerHitImpl* > ( collection -> getElementAt ( indices[i] ) );
+	stubHit.cluster = static_cast < TrackerDataImpl* > ( stubHit.hit -> getRawHits ( ) [0] );
+	EUTelSparseClusterImpl < EUTelGenericSparsePixel > cluster ( stubHit.cluster );
+	cluster.getCenterOfGravity ( stubHit.x, stubHit.y );
+	stubHit.q = cluster.getTotalCharge ( );
+	hits.push_back ( stubHit );
+    }
+    return hits;
+}
+
+
 TrackerHitImpl* CMSStubGenerator::cloneHit ( TrackerHitImpl *inputHit )
 {
     TrackerHitImpl * newHit = new TrackerHitImpl;
@@ -23,11 +23,12 @@
 
 // eutelescope includes
 #include "EUTelEventImpl.h"
+#include "EUTelMappedFile.h"
+#include "EUTelPh2ACFDecoder.h"
 #include "EUTelRunHeaderImpl.h"
 
 // system includes
 #include <iostream>
-#include <fstream>
 #include <sstream>
 #include <iomanip>
 #include <cassert>
@@ -36,7 +37,6 @@
 #include <algorithm>
 #include <stdio.h>
 #include <string.h>
-#include <bitset>
 
 using namespace std;
 using namespace marlin;
@@ -92,84 +92,92 @@ void Ph2ACF2LCIOConverter::readDataSource ( int /* numEvents */ )
     streamlog_out ( DEBUG4 ) << "Reading " << _fileName << " with Ph2ACF2LCIOConverter!" << endl;
     _runNumber = atoi ( _formattedRunNumber.c_str ( ) );
 
-    // open file
-    ifstream infile;
-    infile.open ( _fileName.c_str ( ) );
-    if ( !infile.is_open ( ) )
+    // map the file, the events are decoded in place
+    std::unique_ptr < EUTelMappedFile > infile;
+    try
+    {
+	infile.reset ( new EUTelMappedFile ( _fileName ) );
+    }
+    catch ( lcio::IOException & e )
     {
 	streamlog_out ( ERROR5 ) << "Ph2ACF2LCIOConverter could not read the file " << _fileName << " correctly. Please check the path and file names that have been input!" << endl;
+	streamlog_out ( ERROR5 ) << e.what ( ) << endl;
 	exit ( -1 );
     }
+    streamlog_out ( DEBUG4 ) << "Input file " << _fileName << " successfully opened!" << endl;
+    if ( _dataformat == "raw" )
+    {
+	streamlog_out ( DEBUG4 ) << "Assuming the file is encoded in RAW file format!" << endl;
+    }
+    else if ( _dataformat == "slink" )
+    {
+	streamlog_out ( DEBUG4 ) << "Assuming the file is encoded in SLINK file format!" << endl;
+    }
     else
     {
-	streamlog_out ( DEBUG4 ) << "Input file " << _fileName << " successfully opened!" << endl;
-	if ( _dataformat == "raw" )
-	{
-	    streamlog_out ( DEBUG4 ) << "Assuming the file is encoded in RAW file format!" << endl;
-	}
-	else if ( _dataformat == "slink" )
-	{
-	    streamlog_out ( DEBUG4 ) << "Assuming the file is encoded in SLINK file format!" << endl;
-	}
-	else
-	{
-	    streamlog_out ( ERROR5 ) << "Unknown file format set! Valid inputs are 'raw' and 'slink'!" << endl;
-	    exit ( -1 );
-	}
+	streamlog_out ( ERROR5 ) << "Unknown file format set! Valid inputs are 'raw' and 'slink'!" << endl;
+	exit ( -1 );
     }
 
+    // the file is a sequence of 32 bit words, mmap returns page aligned memory
+    const uint32_t * words = reinterpret_cast < const uint32_t * > ( infile -> data ( ) );
+    const size_t nWords = infile -> size ( ) / sizeof ( uint32_t );
+    size_t position = 0;
+
     LCRunHeaderImpl * runHeader = new LCRunHeaderImpl ( );
     runHeader -> setRunNumber ( _runNumber );
     runHeader -> setDetectorName ( "CBC" );
     ProcessorMgr::instance ( ) -> processRunHeader ( runHeader ) ;
     delete runHeader;
 
-    // the header in raw file format
-    bool raw_headeropen = false;
-    bool maxreached = false;
+    EUTelPh2ACFDecoder decoder ( _nFE, _nChips );
+    EUTelPh2ACFDecoder::Event event;
+
+    // FIXME the slink format is not decoded yet, its events are skipped
+    const size_t eventWords = _dataformat == "raw" ? decoder.getEventWords ( ) : 19;
 
-    do
+    if ( _dataformat == "raw" )
     {
+	// the raw file format starts with a header
+	EUTelPh2ACFDecoder::FileHeader fileHeader;
+	if ( nWords < EUTelPh2ACFDecoder::fileHeaderWords || !EUTelPh2ACFDecoder::decodeFileHeader ( words, fileHeader ) )
+	{
+	    streamlog_out ( ERROR5 ) << "Error, this is not a valid header!" << endl;
+	    exit ( -1 );
+	}
+	position = EUTelPh2ACFDecoder::fileHeaderWords;
+	streamlog_out ( DEBUG4 ) << "Board Type: " << fileHeader.boardType << endl;
+	streamlog_out ( DEBUG4 ) << "FWMajor: " << fileHeader.versionMajor << endl;
+	streamlog_out ( DEBUG4 ) << "FWMinor: " << fileHeader.versionMinor << endl;
+	streamlog_out ( DEBUG4 ) << "BeId: " << fileHeader.beId << endl;
+	streamlog_out ( DEBUG4 ) << "NCbc: " << fileHeader.nCbc << endl;
+	streamlog_out ( DEBUG4 ) << "EventSize32: " << fileHeader.eventSize32 << endl;
+	streamlog_out ( DEBUG4 ) << "Valid header!" << endl;
+    }
 
-	// header / event parameters
-
-	// header 1
-	unsigned int header1_size = 0;
-	unsigned int fe_nbr = 0;
-	unsigned int block_size = 0;
-	unsigned int cic_id = 0;
-	unsigned int chip_id = 0;
-	unsigned int data_format_ver = 0;
-	unsigned int dummy_size = 0;
-	unsigned int trigdata_size = 0;
-	unsigned int event_nbr = 0;
-	unsigned int bx_cnt = 0;
-	unsigned int stubdata_size = 0;
-	unsigned int tlu_trigger_id = 0;
-	unsigned int tdc = 0;
-
-	// header 2, for each FE
-	std::vector < unsigned int > chip_data_mask;
-	std::vector < unsigned int > header2_size;
-	std::vector < unsigned int > event_size;
-
-	// cbc trigdata, for each chip
-	std::vector < std::vector < unsigned int > > lat_err;
-	std::vector < std::vector < unsigned int > > buf_ovf;
-	std::vector < std::vector < unsigned int > > pipeaddr;
-	std::vector < std::vector < unsigned int > > l1cnt;
-
-	// cbc stubdata, for each chip
-	std::vector < std::vector < unsigned int > > stub1;
-	std::vector < std::vector < unsigned int > > stub2;
-	std::vector < std::vector < unsigned int > > stub3;
-	std::vector < std::vector < unsigned int > > bend1;
-	std::vector < std::vector < unsigned int > > bend2;
-	std::vector < std::vector < unsigned int > > bend3;
+    // the names of the front end and chip parameters, made once instead of every event
+    static const char * const chipParameters[10] = { "l1cnt_", "pipeaddr", "buf_ovf", "lat_err", "stub1_", "stub2_", "stub3_", "bend1_", "bend2_", "bend3_" };
+    std::vector < std::string > chipDataMaskNames, header2SizeNames, eventSizeNames;
+    std::vector < std::string > chipParameterNames;
+    for ( int i = 0; i < _nFE; i++ )
+    {
+	chipDataMaskNames.push_back ( "chip_data_mask_" + std::to_string ( i ) );
+	header2SizeNames.push_back ( "header2_size_" + std::to_string ( i ) );
+	eventSizeNames.push_back ( "event_size_" + std::to_string ( i ) );
+	for ( int j = 0; j < _nChips; j++ )
+	{
+	    for ( const char * parameter : chipParameters )
+	    {
+		chipParameterNames.push_back ( parameter + std::to_string ( i ) + "_" + std::to_string ( j ) );
+	    }
+	}
+    }
 
+    // only complete events are converted
+    while ( position + eventWords <= nWords )
+    {
 	if ( eventCounter > _maxRecordNumber && _maxRecordNumber > 0 )
 	{
-	    maxreached = true;
 	    break ;
 	}
 
@@ -178,432 +186,110 @@ void Ph2ACF2LCIOConverter::readDataSource ( int /* numEvents */ )
 	    streamlog_out ( DEBUG4 ) << "Processing event " << eventCounter << " in run " << _runNumber << endl;
 	}
 
+	// let there be output
+	EUTelEventImpl* anEvent = new EUTelEventImpl ( );
+	const char * dummyencode = "CBCRaw:1,";
+
+	LCCollectionVec* rawDataCollectionTop = new LCCollectionVec ( LCIO::TRACKERDATA );
+	CellIDEncoder < TrackerDataImpl > chipIDEncoderTop ( dummyencode, rawDataCollectionTop );
+	TrackerDataImpl * rawtop = new TrackerDataImpl ( );
+	chipIDEncoderTop.setCellID ( rawtop );
+	rawDataCollectionTop -> push_back ( rawtop );
+	anEvent -> addCollection ( rawDataCollectionTop, _rawDataCollectionNameTop );
+
+	LCCollectionVec* rawDataCollectionBot = new LCCollectionVec ( LCIO::TRACKERDATA );
+	CellIDEncoder < TrackerDataImpl > chipIDEncoderBot ( dummyencode, rawDataCollectionBot );
+	TrackerDataImpl * rawbot = new TrackerDataImpl ( );
+	chipIDEncoderBot.setCellID ( rawbot );
+	rawDataCollectionBot -> push_back ( rawbot );
+	anEvent -> addCollection ( rawDataCollectionBot, _rawDataCollectionNameBottom );
+
+	anEvent -> setRunNumber ( _runNumber );
+	anEvent -> setEventNumber ( eventCounter );
+	anEvent -> setDetectorName ( "CBC" );
+	anEvent -> parameters ( ).setValue ( "EventType", 2 );
+
 	if ( _dataformat == "raw" )
 	{
-
-	    // the first event has a header
-	    if ( raw_headeropen == false )
+	    decoder.decodeEvent ( words + position, event );
+
+	    streamlog_out ( DEBUG3 ) << "CBC Header1: header1_size " << event.header1Size << " fe_nbr " << event.feNbr << " block_size " << event.blockSize
+				     << " cic_id " << event.cicId << " chip_id " << event.chipId << " data_format_ver " << event.dataFormatVer << " dummy_size " << event.dummySize
+				     << " trigdata_size " << event.trigdataSize << " event_nbr " << event.eventNbr << " bx_cnt " << event.bxCnt
+				     << " stubdata_size " << event.stubdataSize << " tlu_trigger_id " << event.tluTriggerId << " tdc " << event.tdc << endl;
+	    streamlog_out ( DEBUG1 ) << "Hit strips: top " << event.topHits << " bottom " << event.bottomHits << endl;
+	    if ( streamlog_level ( DEBUG0 ) )
 	    {
-		uint32_t cMask = 0xAAAAAAAA;
-		std::vector < uint32_t > headervec;
-		raw_headeropen = true;
-		streamlog_out ( DEBUG0 ) << "File Header: ";
-		for ( int i = 0; i < 12; i++ )
-		{
-		    uint32_t tempint;
-		    infile.read ( reinterpret_cast < char * > ( &tempint ), sizeof ( uint32_t ) );
-		    headervec.push_back ( tempint );
-		    streamlog_out ( DEBUG0 ) << tempint << " ";
-		}
-		streamlog_out ( DEBUG0 ) << endl;
-		if ( headervec.at ( 0 ) == cMask && headervec.at ( 3 ) == cMask && headervec.at ( 6 ) == cMask && headervec.at ( 9 ) == cMask && headervec.at ( 11 ) == cMask )
+		streamlog_out ( DEBUG0 ) << "Top ";
+		for ( float strip : event.top )
 		{
-		    char cType[8] = { 0 };
-		    cType[0] = ( headervec.at ( 1 ) && 0xFF000000 ) >> 24;
-		    cType[1] = ( headervec.at ( 1 ) && 0x00FF0000 ) >> 16;
-		    cType[2] = ( headervec.at ( 1 ) && 0x0000FF00 ) >> 8;
-		    cType[3] = ( headervec.at ( 1 ) && 0x000000FF );
-
-		    cType[4] = ( headervec.at ( 2 ) && 0xFF000000 ) >> 24;
-		    cType[5] = ( headervec.at ( 2 ) && 0x00FF0000 ) >> 16;
-		    cType[6] = ( headervec.at ( 2 ) && 0x0000FF00 ) >> 8;
-		    cType[7] = ( headervec.at ( 2 ) && 0x000000FF );
-
-		    std::string cTypeString ( cType );
-		    std::string fType = cTypeString;
-
-		    uint32_t fVersionMajor = headervec.at ( 4 );
-		    uint32_t fVersionMinor = headervec.at ( 5 );
-
-		    uint32_t fBeId = headervec.at ( 7 ) & 0x000003FF;
-		    uint32_t fNCbc = headervec.at ( 8 );
-
-		    uint32_t fEventSize32 = headervec.at ( 10 );
-		    streamlog_out ( DEBUG4 ) << "Board Type: " << fType << endl;
-		    streamlog_out ( DEBUG4 ) << "FWMajor: " << fVersionMajor << endl;
-		    streamlog_out ( DEBUG4 ) << "FWMinor: " << fVersionMinor << endl;
-		    streamlog_out ( DEBUG4 ) << "BeId: " << fBeId << endl;
-		    streamlog_out ( DEBUG4 ) << "NCbc: " << fNCbc << endl;
-		    streamlog_out ( DEBUG4 ) << "EventSize32: " << fEventSize32 << endl;
-		    streamlog_out ( DEBUG4 ) << "Valid header!" << endl;
+		    streamlog_out ( DEBUG0 ) << strip;
 		}
-		else
+		streamlog_out ( DEBUG0 ) << endl << "Bot ";
+		for ( float strip : event.bottom )
 		{
-		    streamlog_out ( ERROR5 ) << "Error, this is not a valid header!" << endl;
-		    exit ( -1 );
+		    streamlog_out ( DEBUG0 ) << strip;
 		}
-
+		streamlog_out ( DEBUG0 ) << endl;
 	    }
 
-	    // the output vectors
-	    FloatVec dataoutputvec_top;
-	    FloatVec dataoutputvec_bot;
+	    rawtop -> setChargeValues ( event.top );
+	    rawbot -> setChargeValues ( event.bottom );
 
-	    // read event header
-	    streamlog_out ( DEBUG1 ) << endl;
-	    streamlog_out ( DEBUG1 ) << "CBC Header1:" << endl;
-	    uint32_t tempint;
-	    std::vector < uint32_t > vec_header1;
-	    for ( int i = 0; i < 5; i++ )
+	    // now we set all the header parameters
+	    anEvent -> parameters ( ).setValue ( "header1_size", int ( event.header1Size ) );
+	    anEvent -> parameters ( ).setValue ( "fe_nbr", int ( event.feNbr ) );
+	    anEvent -> parameters ( ).setValue ( "block_size", int ( event.blockSize ) );
+	    anEvent -> parameters ( ).setValue ( "cic_id", int ( event.cicId ) );
+	    anEvent -> parameters ( ).setValue ( "chip_id", int ( event.chipId ) );
+	    anEvent -> parameters ( ).setValue ( "data_format_ver", int ( event.dataFormatVer ) );
+	    anEvent -> parameters ( ).setValue ( "dummy_size", int ( event.dummySize ) );
+	    anEvent -> parameters ( ).setValue ( "trigdata_size", int ( event.trigdataSize ) );
+	    anEvent -> parameters ( ).setValue ( "event_nbr", int ( event.eventNbr ) );
+	    anEvent -> parameters ( ).setValue ( "bx_cnt", int ( event.bxCnt ) );
+	    anEvent -> parameters ( ).setValue ( "stubdata_size", int ( event.stubdataSize ) );
+	    anEvent -> parameters ( ).setValue ( "tlu_trigger_id", int ( event.tluTriggerId ) );
+	    anEvent -> parameters ( ).setValue ( "tdc", int ( event.tdc ) );
+
+	    for ( size_t i = 0; i < event.frontEnds.size ( ); i++ )
 	    {
-		infile.read ( reinterpret_cast < char * > ( &tempint ), sizeof ( uint32_t ) );
-		vec_header1.push_back ( tempint );
+		anEvent -> parameters ( ).setValue ( chipDataMaskNames[i], int ( event.frontEnds[i].chipDataMask ) );
+		anEvent -> parameters ( ).setValue ( header2SizeNames[i], int ( event.frontEnds[i].header2Size ) );
+		anEvent -> parameters ( ).setValue ( eventSizeNames[i], int ( event.frontEnds[i].eventSize ) );
 	    }
 
-	    for ( unsigned int i = 0 ; i < vec_header1.size ( ); i++ )
+	    for ( size_t i = 0; i < event.chips.size ( ); i++ )
 	    {
-		if ( i == 0 )
+		const EUTelPh2ACFDecoder::Chip & chip = event.chips[i];
+		const unsigned int values[10] = { chip.l1Cnt, chip.pipeAddr, chip.bufOvf, chip.latErr, chip.stub1, chip.stub2, chip.stub3, chip.bend1, chip.bend2, chip.bend3 };
+		for ( size_t k = 0; k < 10; k++ )
 		{
-		    streamlog_out ( DEBUG3 ) << "Part 0: " << vec_header1.at ( i ) << endl;
-
-		    header1_size = ( vec_header1.at ( i ) >> 24 );
-		    streamlog_out ( DEBUG3 ) << " header1_size " << header1_size << endl;
-
-		    fe_nbr = ( vec_header1.at ( i ) >> 16 ) & 0xFF;
-		    streamlog_out ( DEBUG3 ) << " fe_nbr " << fe_nbr << endl;
-
-		    block_size = ( ( ( vec_header1.at ( i ) >> 8 ) & 0xFF ) + ( ( vec_header1.at ( i ) ) & 0xFF ) );
-		    streamlog_out ( DEBUG3 ) << " block_size " << block_size << endl;
+		    anEvent -> parameters ( ).setValue ( chipParameterNames[i * 10 + k], int ( values[k] ) );
 		}
-		if ( i == 1 )
-		{
-		    streamlog_out ( DEBUG3 ) << "Part 1: " << vec_header1.at ( i ) << endl;
-
-		    cic_id = ( vec_header1.at ( i ) >> 24 );
-		    streamlog_out ( DEBUG3 ) << " cic_id " << cic_id << endl;
-
-		    chip_id = ( vec_header1.at ( i ) >> 16 ) & 0xFF;
-		    streamlog_out ( DEBUG3 ) << " chip_id " << chip_id << endl;
-
-		    data_format_ver = ( vec_header1.at ( i ) >> 8 ) & 0xFF;
-		    streamlog_out ( DEBUG3 ) << " data_format_ver " << data_format_ver << endl;
 
-		    dummy_size = ( vec_header1.at ( i ) ) & 0xFF;
-		    streamlog_out ( DEBUG3 ) << " dummy_size " << dummy_size << endl;
-		}
-		if ( i == 2 )
-		{
-		    streamlog_out ( DEBUG3 ) << "Part 2: " << vec_header1.at ( i ) << endl;
-
-		    trigdata_size = ( vec_header1.at ( i ) >> 24 );
-		    streamlog_out ( DEBUG3 ) << " trigdata_size " << trigdata_size << endl;
-
-		    event_nbr = ( ( ( vec_header1.at ( i ) >> 16 ) & 0xFF ) + ( ( vec_header1.at ( i ) >> 8 ) & 0xFF ) + ( ( vec_header1.at ( i ) ) & 0xFF ) );
-		    streamlog_out ( DEBUG3 ) << " event_nbr " << event_nbr << endl;
-		}
-		if ( i == 3 )
-		{
-		    streamlog_out ( DEBUG3 ) << "Part 3: " << vec_header1.at ( i ) << endl;
-
-		    bx_cnt = ( vec_header1.at ( i ) );
-		    streamlog_out ( DEBUG3 ) << " bx_cnt " << bx_cnt << endl;
-		}
-		if ( i == 4 )
-		{
-		    streamlog_out ( DEBUG3 ) << "Part 4: " << vec_header1.at ( i ) << endl;
-
-		    stubdata_size = ( vec_header1.at ( i ) >> 24 );
-		    streamlog_out ( DEBUG3 ) << " stubdata_size " << stubdata_size << endl;
-
-		    tlu_trigger_id = ( ( ( vec_header1.at ( i ) >> 16 ) & 0xFF ) + ( ( vec_header1.at ( i ) >> 8 ) & 0xFF ) );
-		    streamlog_out ( DEBUG3 ) << " tlu_trigger_id " << tlu_trigger_id << endl;
-
-		    tdc = ( vec_header1.at ( i ) ) & 0xFF;
-		    streamlog_out ( DEBUG3 ) << " tdc " << tdc << endl;
-		}
-	    }
-
-	    // loop frontends
-	    for ( int iFE = 0; iFE < _nFE; iFE++ )
-	    {
-		// read header 2
-		std::vector < uint32_t > vec_header2;
-		uint32_t tempint;
-		infile.read ( reinterpret_cast < char * > ( &tempint ), sizeof ( uint32_t ) );
-		vec_header2.push_back ( tempint );
-		streamlog_out ( DEBUG2 ) << endl;
-		streamlog_out ( DEBUG2 ) << "CBC Header2, FE " << iFE << ":" << endl;
-		for ( unsigned int i = 0; i < vec_header2.size ( ); i++ )
-		{
-		    if ( i == 0 )
-		    {
-			chip_data_mask.push_back ( vec_header2.at ( i ) >> 24 );
-			streamlog_out ( DEBUG2 ) << " chip_data_mask " << chip_data_mask.at ( iFE ) << endl;
-
-			header2_size.push_back ( ( vec_header2.at ( i ) >> 16 ) & 0xFF );
-			streamlog_out ( DEBUG2 ) << " header2_size " << header2_size.at ( iFE ) << endl;
-
-			event_size.push_back ( ( ( vec_header2.at ( i ) >> 8 ) & 0xFF ) + ( ( vec_header2.at ( i ) ) & 0xFF ) );
-			streamlog_out ( DEBUG2 ) << " event_size " << event_size.at ( iFE ) << endl;
-		    }
-		}
-		streamlog_out ( DEBUG2 ) << endl;
-
-		// chip loop
-		// push_back for the vectors...
-		lat_err.push_back ( std::vector < unsigned int > ( ) );
-		buf_ovf.push_back ( std::vector < unsigned int > ( ) );
-		pipeaddr.push_back ( std::vector < unsigned int > ( ) );
-		l1cnt.push_back ( std::vector < unsigned int > ( ) );
-		stub1.push_back ( std::vector < unsigned int > ( ) );
-		stub2.push_back ( std::vector < unsigned int > ( ) );
-		stub3.push_back ( std::vector < unsigned int > ( ) );
-		bend1.push_back ( std::vector < unsigned int > ( ) );
-		bend2.push_back ( std::vector < unsigned int > ( ) );
-		bend3.push_back ( std::vector < unsigned int > ( ) );
-
-		for ( int j = 0; j < _nChips; j++ )
-		{
-		    // top sensor
-		    int topvec[4][32] = { 0 };
-		    // bottom sensor
-		    int botvec[4][32] = { 0 };
-
-		    // 9 for trg data, 2 for stub
-		    for ( int i = 0; i < 11; i++ )
-		    {
-			uint32_t tempint;
-			infile.read ( reinterpret_cast < char * > ( &tempint ), sizeof ( uint32_t ) );
-
-			if ( i < 4 )
-			{
-			    // top sensor
-			    bitset < 32 > tempbit ( tempint );
-			    for ( unsigned j = 0; j < tempbit.size ( ); j++ )
-			    {
-				if ( tempbit.test ( j ) )
-				{
-				    topvec[i][j] = 1;
-				}
-				else
-				{
-				    topvec[i][j] = 0;
-				}
-			    }
-			}
-			if ( i >=4 && i < 8 )
-			{
-			    // bottom sensor
-			    bitset < 32 > tempbit ( tempint );
-			    for ( unsigned j = 0; j < tempbit.size ( ); j++ )
-			    {
-				if ( tempbit.test ( j ) )
-				{
-				    botvec[i - 4][j] = 1;
-				}
-				else
-				{
-				    botvec[i - 4][j] = 0;
-				}
-			    }
-			}
-			if ( i == 8 )
-			{
-			    // cbc trgdata status
-			    unsigned int test =  ( ( tempint & 1 ) >> 1 );
-			    lat_err[iFE].push_back ( test );
-			    streamlog_out ( DEBUG1 ) << " lat_err " << lat_err.at ( iFE ).at ( j ) << endl;
-			    buf_ovf[iFE].push_back ( ( tempint & 2 ) >> 2 );
-			    streamlog_out ( DEBUG1 ) << " buf_ovf " << buf_ovf.at ( iFE ).at ( j ) << endl;
-			    pipeaddr[iFE].push_back ( ( tempint >> 4 ) & 0x09 );
-			    streamlog_out ( DEBUG1 ) << " pipeaddr " << pipeaddr.at ( iFE ).at ( j ) << endl;
-			    l1cnt[iFE].push_back ( ( tempint >> 16 ) & 0xFE );
-			    streamlog_out ( DEBUG1 ) << " l1cnt " << l1cnt.at ( iFE ).at ( j ) << endl;
-			}
-			if ( i == 9 )
-			{
-			    // stubdata
-			    stub1[iFE].push_back ( createMask ( 0, 7 ) & tempint );
-			    stub2[iFE].push_back ( createMask ( 0, 7 ) & ( tempint >> 8 ) );
-			    stub3[iFE].push_back ( createMask ( 0, 7 ) & ( tempint >> 16 ) );
-			    streamlog_out ( DEBUG1 ) << " stub1 " << stub1.at ( iFE ).at ( j ) << " stub2 " << stub2.at ( iFE ).at ( j ) << " stub3 " << stub3.at ( iFE ).at ( j ) << endl;
-			}
-			if ( i == 10 )
-			{
-			    // stubdata
-			    unsigned int sync = ( ( tempint >> 3) & 1 );
-			    unsigned int or254 = ( ( tempint >> 1 ) & 1 );
-			    streamlog_out ( DEBUG1 ) << " sync " << sync << " or254 " << or254 << endl;
-			    bend1[iFE].push_back ( createMask ( 0, 3 ) & ( tempint >> 8 ) );
-			    bend2[iFE].push_back ( createMask ( 0, 3 ) & ( tempint >> 16 ) );
-			    bend3[iFE].push_back ( createMask ( 0, 3 ) & ( tempint >> 24 ) );
-			    streamlog_out ( DEBUG1 ) << " bend1 " << bend1.at ( iFE ).at ( j ) << " bend2 " << bend2.at ( iFE ).at ( j ) << " bend3 " << bend3.at ( iFE ).at ( j ) << endl;
-
-			    // check
-			    if ( stub1.at ( iFE).at ( j ) == 1 )
-			    {
-				if ( sync != 1 || or254 != 1 )
-				{
-				    streamlog_out ( WARNING1 ) << "Warning! Stub found, but sync/or254 is not 1!" << endl;
-				}
-			    }
-			}
-		    }
-
-		    int counter = 0;
-		    streamlog_out ( DEBUG0 ) << "Top ";
-		    for ( int i = 3; i >= 0; i-- )
-		    {
-			for ( int k = 0; k < 32; k++ )
-			{
-			    counter++;
-			    if ( counter != 32 )
-			    {
-				streamlog_out ( DEBUG0 ) << topvec[i][k] ;
-				// output to the vector
-				dataoutputvec_top.push_back ( topvec[i][k] );
-			    }
-			}
-		    }
-		    streamlog_out ( DEBUG0 ) << endl;
-		    counter = 0;
-		    streamlog_out ( DEBUG0 ) << "Bot ";
-		    for ( int i = 3; i >= 0; i-- )
-		    {
-			for ( int k = 0; k < 32; k++ )
-			{
-			    counter ++;
-			    if ( counter != 32 )
-			    {
-				streamlog_out ( DEBUG0 ) << botvec[i][k] ;
-				// output to the vector
-				dataoutputvec_bot.push_back ( botvec[i][k] );
-			    }
-			}
-		    }
-		    streamlog_out ( DEBUG0 ) << endl;
-
-		} // done chip loop
-
-	    } // done FE loop
-
-	    // let there be output
-	    EUTelEventImpl* anEvent = new EUTelEventImpl ( );
-	    const char * dummyencode = "CBCRaw:1,";
-
-	    LCCollectionVec* rawDataCollectionTop = new LCCollectionVec ( LCIO::TRACKERDATA );
-	    CellIDEncoder < TrackerDataImpl > chipIDEncoderTop ( dummyencode, rawDataCollectionTop );
-	    TrackerDataImpl * rawtop = new TrackerDataImpl ( );
-	    rawtop -> setChargeValues ( dataoutputvec_top );
-	    chipIDEncoderTop.setCellID ( rawtop );
-	    rawDataCollectionTop -> push_back ( rawtop );
-	    anEvent -> addCollection ( rawDataCollectionTop, _rawDataCollectionNameTop );
-
-	    LCCollectionVec* rawDataCollectionBot = new LCCollectionVec ( LCIO::TRACKERDATA );
-	    CellIDEncoder < TrackerDataImpl > chipIDEncoderBot ( dummyencode, rawDataCollectionBot );
-	    TrackerDataImpl * rawbot = new TrackerDataImpl ( );
-	    rawbot -> setChargeValues ( dataoutputvec_bot );
-	    chipIDEncoderBot.setCellID ( rawbot );
-	    rawDataCollectionBot -> push_back ( rawbot );
-	    anEvent -> addCollection ( rawDataCollectionBot, _rawDataCollectionNameBottom );
-
-	    anEvent -> setRunNumber ( _runNumber );
-	    anEvent -> setEventNumber ( eventCounter );
-	    anEvent -> setDetectorName ( "CBC" );
-	    anEvent -> parameters ( ).setValue ( "EventType", 2 );
-
-	    // now we set all the header parameters
-	    anEvent -> parameters ( ).setValue ( "header1_size", int ( header1_size ) );
-	    anEvent -> parameters ( ).setValue ( "fe_nbr", int ( fe_nbr ) );
-	    anEvent -> parameters ( ).setValue ( "block_size", int ( block_size ) );
-	    anEvent -> parameters ( ).setValue ( "cic_id", int ( cic_id ) );
-	    anEvent -> parameters ( ).setValue ( "chip_id", int ( chip_id ) );
-	    anEvent -> parameters ( ).setValue ( "data_format_ver", int ( data_format_ver ) );
-	    anEvent -> parameters ( ).setValue ( "dummy_size", int ( dummy_size ) );
-	    anEvent -> parameters ( ).setValue ( "trigdata_size", int ( trigdata_size ) );
-	    anEvent -> parameters ( ).setValue ( "event_nbr", int ( event_nbr ) );
-	    anEvent -> parameters ( ).setValue ( "bx_cnt", int ( bx_cnt ) );
-	    anEvent -> parameters ( ).setValue ( "stubdata_size", int ( stubdata_size ) );
-	    anEvent -> parameters ( ).setValue ( "tlu_trigger_id", int ( tlu_trigger_id ) );
-	    anEvent -> parameters ( ).setValue ( "tdc", int ( tdc ) );
-
-	    for ( int i = 0; i < _nFE; i++ )
-	    {
-		anEvent -> parameters ( ).setValue ( "chip_data_mask_" + std::to_string ( i ), int ( chip_data_mask.at ( i ) ) );
-		anEvent -> parameters ( ).setValue ( "header2_size_" + std::to_string ( i ), int ( header2_size.at ( i ) ) );
-		anEvent -> parameters ( ).setValue ( "event_size_" + std::to_string ( i ), int ( event_size.at ( i ) ) );
-
-		for ( int j = 0; j < _nChips; j++ )
+		// check
+		if ( chip.stub1 == 1 && ( chip.sync != 1 || chip.or254 != 1 ) )
 		{
-		    anEvent -> parameters ( ).setValue ( "l1cnt_" + std::to_string ( i ) + "_" + std::to_string ( j ), int ( l1cnt.at ( i ).at ( j ) ) );
-		    anEvent -> parameters ( ).setValue ( "pipeaddr" + std::to_string ( i ) + "_" + std::to_string ( j ), int ( pipeaddr.at ( i ).at ( j ) ) );
-		    anEvent -> parameters ( ).setValue ( "buf_ovf" + std::to_string ( i ) + "_" + std::to_string ( j ), int ( buf_ovf.at ( i ).at ( j ) ) );
-		    anEvent -> parameters ( ).setValue ( "lat_err" + std::to_string ( i ) + "_" + std::to_string ( j ), int ( lat_err.at ( i ).at ( j ) ) );
-		    anEvent -> parameters ( ).setValue ( "stub1_" + std::to_string ( i ) + "_" + std::to_string ( j ), int ( stub1.at ( i ).at ( j ) ) );
-		    anEvent -> parameters ( ).setValue ( "stub2_" + std::to_string ( i ) + "_" + std::to_string ( j ), int ( stub2.at ( i ).at ( j ) ) );
-		    anEvent -> parameters ( ).setValue ( "stub3_" + std::to_string ( i ) + "_" + std::to_string ( j ), int ( stub3.at ( i ).at ( j ) ) );
-		    anEvent -> parameters ( ).setValue ( "bend1_" + std::to_string ( i ) + "_" + std::to_string ( j ), int ( bend1.at ( i ).at ( j ) ) );
-		    anEvent -> parameters ( ).setValue ( "bend2_" + std::to_string ( i ) + "_" + std::to_string ( j ), int ( bend2.at ( i ).at ( j ) ) );
-		    anEvent -> parameters ( ).setValue ( "bend3_" + std::to_string ( i ) + "_" + std::to_string ( j ), int ( bend3.at ( i ).at ( j ) ) );
+		    streamlog_out ( WARNING1 ) << "Warning! Stub found, but sync/or254 is not 1!" << endl;
 		}
-
 	    }
+	}
 
-	    // FIXME this will be the TLU trigger ID
-	    anEvent -> setTimeStamp ( long64 ( eventCounter * 100.0 ) );
-
-	    ProcessorMgr::instance ( ) -> processEvent ( static_cast < LCEventImpl* > ( anEvent ) ) ;
-	    eventCounter++;
-	    delete anEvent;
-	
-	} // done _dataformat if
-	else if ( _dataformat == "slink" )
-	{
-
-	    // FIXME
-
-	    // the output vectors
-	    FloatVec dataoutputvec_top;
-	    FloatVec dataoutputvec_bot;
-
-	    // FIXME
-	    for ( int i = 0; i < 19; i++ )
-	    {
-		uint32_t tempint;
-		std::vector < uint32_t > inputvec;
-		infile.read ( reinterpret_cast < char * > ( &tempint ), sizeof ( uint32_t ) );
-		inputvec.push_back ( tempint );
-		streamlog_out ( DEBUG0 ) << tempint << " ";
-	    }
-	    streamlog_out ( DEBUG0 ) << endl;
-
-	    // let there be output
-	    EUTelEventImpl* anEvent = new EUTelEventImpl ( );
-	    const char * dummyencode = "CBCRaw:1,";
-
-	    LCCollectionVec* rawDataCollectionTop = new LCCollectionVec ( LCIO::TRACKERDATA );
-	    CellIDEncoder < TrackerDataImpl > chipIDEncoderTop ( dummyencode, rawDataCollectionTop );
-	    TrackerDataImpl * rawtop = new TrackerDataImpl ( );
-	    rawtop -> setChargeValues ( dataoutputvec_top );
-	    chipIDEncoderTop.setCellID ( rawtop );
-	    rawDataCollectionTop -> push_back ( rawtop );
-	    anEvent -> addCollection ( rawDataCollectionTop, _rawDataCollectionNameTop );
-
-	    LCCollectionVec* rawDataCollectionBot = new LCCollectionVec ( LCIO::TRACKERDATA );
-	    CellIDEncoder < TrackerDataImpl > chipIDEncoderBot ( dummyencode, rawDataCollectionBot );
-	    TrackerDataImpl * rawbot = new TrackerDataImpl ( );
-	    rawbot -> setChargeValues ( dataoutputvec_bot );
-	    chipIDEncoderBot.setCellID ( rawbot );
-	    rawDataCollectionBot -> push_back ( rawbot );
-	    anEvent -> addCollection ( rawDataCollectionBot, _rawDataCollectionNameBottom );
-
-	    anEvent -> setRunNumber ( _runNumber );
-	    anEvent -> setEventNumber ( eventCounter );
-	    anEvent -> setDetectorName ( "CBC" );
-	    anEvent -> parameters ( ).setValue ( "EventType", 2 );
-
-	    // FIXME this will be the TLU trigger ID
-	    anEvent -> setTimeStamp ( long64 ( eventCounter * 100.0 ) );
+	// FIXME this will be the TLU trigger ID
+	anEvent -> setTimeStamp ( long64 ( eventCounter * 100.0 ) );
 
-	    ProcessorMgr::instance ( ) -> processEvent ( static_cast < LCEventImpl* > ( anEvent ) ) ;
-	    eventCounter++;
-	    delete anEvent;
+	ProcessorMgr::instance ( ) -> processEvent ( static_cast < LCEventImpl* > ( anEvent ) ) ;
+	eventCounter++;
+	delete anEvent;
 
-	} // done _dataformat if
+	position += eventWords;
 
-    } while ( !( infile.bad ( ) || infile.eof ( ) ) || maxreached == true );
+    }
 
-    infile.close ( );
+    if ( position + eventWords > nWords && position < nWords )
+    {
+	streamlog_out ( WARNING5 ) << "Ignoring the last " << nWords - position << " words of " << _fileName << ", they are not a complete event!" << endl;
+    }
 
 }
 
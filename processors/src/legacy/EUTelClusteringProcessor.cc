@@ -78,7 +78,8 @@ EUTelClusteringProcessor::EUTelClusteringProcessor()
       _ffYClusterSize(0), _ffSeedCut(0.0), _sparseSeedCut(0.0),
       _ffClusterCut(0.0), _sparseClusterCut(0.0), _sparseMinDistanceSquared(2),
       _sparseMinDistance(0.0), _iEvt(0), _fillHistos(false),
-      _histoInfoFileName(""), _seedCandidateMap(), _totClusterMap(),
+      _histoInfoFileName(""), _seedCandidateMap(), _ffClusterFinderMap(),
+      _ffClusters(), _totClusterMap(),
       _noOfDetector(0), _ExcludedPlanes(), _clusterSpectraNVector(),
       _clusterSpectraNxNVector(), _clusterSignalHistos(), _clusterSizeXHistos(),
       _clusterSizeYHistos(), _seedSignalHistos(), _hitMapHistos(),
@@ -2280,8 +2281,31 @@ void EUTelClusteringProcessor::fixedFrameClustering(
     TrackerRawDataImpl *status = dynamic_cast<TrackerRawDataImpl *>(
         statusCollectionVec->getElementAt(_ancillaryIndexMap[sensorID]));
 
-    // prepare the matrix decoder
-    EUTelMatrixDecoder matrixDecoder(cellDecoder, nzsData);
+    // the cluster finder of this sensor, the frame is indexed as
+    // EUTelMatrixDecoder does with the origin in (minX, minY)
+    auto finderIter = _ffClusterFinderMap.find(sensorID);
+    if (finderIter == _ffClusterFinderMap.end()) {
+      finderIter =
+          _ffClusterFinderMap
+              .emplace(sensorID, EUTelFixedFrameClusterFinder(
+                                     maxX - minX + 1, maxY - minY + 1,
+                                     _ffXClusterSize, _ffYClusterSize,
+                                     _ffSeedCut, _ffClusterCut))
+              .first;
+    }
+    EUTelFixedFrameClusterFinder &finder = finderIter->second;
+
+    FloatVec const &charges = nzsData->getChargeValues();
+    FloatVec const &noises = noise->getChargeValues();
+    ShortVec &statuses = status->adcValues();
+    if ((charges.size() != finder.getNoOfPixels()) ||
+        (noises.size() != finder.getNoOfPixels()) ||
+        (statuses.size() != finder.getNoOfPixels())) {
+      throw IncompatibleDataSetException(
+          "NZS data and noise/status size mismatch with the geometry of "
+          "sensor " +
+          to_string(sensorID));
+    }
 
     // reset the status
     resetStatus(status);
@@ -2290,170 +2314,70 @@ void EUTelClusteringProcessor::fixedFrameClustering(
     short clusterCounter = 0;
     short limitExceed = 0;
 
-    _seedCandidateMap.clear();
-
-    for (unsigned int iPixel = 0; iPixel < nzsData->getChargeValues().size();
-         iPixel++) {
-      if (status->getADCValues()[iPixel] == EUTELESCOPE::GOODPIXEL) {
-        if (nzsData->getChargeValues()[iPixel] >
-            _ffSeedCut * noise->getChargeValues()[iPixel]) {
-          _seedCandidateMap.push_back(
-              make_pair(nzsData->getChargeValues()[iPixel], iPixel));
-        }
-      }
-    }
-
-    // continue only if seed candidate map is not empty!
-    if (!_seedCandidateMap.empty()) {
-
-      streamlog_out(DEBUG0) << "There are << " << _seedCandidateMap.size()
-                            << " seed candidates." << endl;
-
-      // now built up a cluster for each seed candidate
-      // Start by sorting the vector in order of smallest to largest seed signal
-      std::sort(_seedCandidateMap.begin(), _seedCandidateMap.end());
-      vector<pair<float, unsigned int>>::iterator mapIter =
-          _seedCandidateMap.end();
-      while (mapIter != _seedCandidateMap.begin()) {
-        --mapIter;
-        // check if this seed candidate has not been already added to a
-        // cluster
-        if (status->adcValues()[(*mapIter).second] == EUTELESCOPE::GOODPIXEL) {
-          // if we enter here, this means that at least the seed pixel
-          // wasn't added yet to another cluster.  Note that now we need
-          // to build a candidate cluster that has to pass the
-          // clusterCut to be considered a good cluster
-          double clusterCandidateSignal = 0.;
-          double clusterCandidateNoise2 = 0.;
-          FloatVec clusterCandidateCharges;
-          IntVec clusterCandidateIndeces;
-          int seedX, seedY;
-          matrixDecoder.getXYFromIndex((*mapIter).second, seedX, seedY);
-
-          // start looping around the seed pixel. Remember that the seed
-          // pixel has to stay in the center of cluster
-          ClusterQuality cluQuality = kGoodCluster;
-          for (int yPixel = seedY - (_ffYClusterSize / 2);
-               yPixel <= seedY + (_ffYClusterSize / 2); yPixel++) {
-            for (int xPixel = seedX - (_ffXClusterSize / 2);
-                 xPixel <= seedX + (_ffXClusterSize / 2); xPixel++) {
-              // always check we are still within the sensor!!!
-              if ((xPixel >= minX) && (xPixel <= maxX) && (yPixel >= minY) &&
-                  (yPixel <= maxY)) {
-                int index = matrixDecoder.getIndexFromXY(xPixel, yPixel);
-
-                bool isHit =
-                    (status->getADCValues()[index] == EUTELESCOPE::HITPIXEL);
-                bool isGood =
-                    (status->getADCValues()[index] == EUTELESCOPE::GOODPIXEL);
-
-                if (isGood)
-                  clusterCandidateIndeces.push_back(index);
-                else
-                  clusterCandidateIndeces.push_back(-1);
-
-                if (isGood && !isHit) {
-                  clusterCandidateSignal += nzsData->getChargeValues()[index];
-                  clusterCandidateNoise2 +=
-                      pow(noise->getChargeValues()[index], 2);
-                  clusterCandidateCharges.push_back(
-                      nzsData->getChargeValues()[index]);
-                } else if (isHit) {
-                  // this can be a good place to flag the current
-                  // cluster as kMergedCluster, but it would introduce
-                  // a bias since the at least another cluster (the
-                  // one which this pixel belong to) is not flagged.
-                  //
-                  // In order to flag all merged clusters and possibly
-                  // try to separate the different contributions use
-                  // the EUTelSeparateClusterProcessor. In this
-                  // processor not all the merged clusters will be
-                  // flagged as kMergedCluster | kIncompleteCluster
-                  cluQuality = cluQuality | kIncompleteCluster | kMergedCluster;
-                  clusterCandidateCharges.push_back(0.);
-                } else if (!isGood) {
-                  cluQuality = cluQuality | kIncompleteCluster;
-                  clusterCandidateCharges.push_back(0.);
-                }
-              } else {
-                cluQuality = cluQuality | kBorderCluster;
-                clusterCandidateCharges.push_back(0.);
-                clusterCandidateIndeces.push_back(-1);
-              }
-            }
-          }
-
-          // at this point we have built the cluster candidate,
-          // we need to validate it
-          if (clusterCandidateSignal >
-              _ffClusterCut * sqrt(clusterCandidateNoise2)) {
-            // the cluster candidate is a good cluster
-            // mark all pixels belonging to the cluster as hit
-            IntVec::iterator indexIter = clusterCandidateIndeces.begin();
-
-            // the final result of the clustering will enter in a
-            // TrackerPulseImpl in order to be algorithm independent
-            TrackerPulseImpl *pulse = new TrackerPulseImpl;
-            CellIDEncoder<TrackerPulseImpl> idPulseEncoder(
-                EUTELESCOPE::PULSEDEFAULTENCODING, pulseCollection);
-            idPulseEncoder["sensorID"] = sensorID;
-            idPulseEncoder["xSeed"] = seedX;
-            idPulseEncoder["ySeed"] = seedY;
-            idPulseEncoder["xCluSize"] = _ffXClusterSize;
-            idPulseEncoder["yCluSize"] = _ffYClusterSize;
-            idPulseEncoder["type"] = static_cast<int>(kEUTelFFClusterImpl);
-            idPulseEncoder.setCellID(pulse);
-
-            TrackerDataImpl *cluster = new TrackerDataImpl;
-            CellIDEncoder<TrackerDataImpl> idClusterEncoder(
-                EUTELESCOPE::CLUSTERDEFAULTENCODING, dummyCollection);
-            idClusterEncoder["sensorID"] = sensorID;
-            idClusterEncoder["xSeed"] = seedX;
-            idClusterEncoder["ySeed"] = seedY;
-            idClusterEncoder["xCluSize"] = _ffXClusterSize;
-            idClusterEncoder["yCluSize"] = _ffYClusterSize;
-            idClusterEncoder["quality"] = static_cast<int>(cluQuality);
-            idClusterEncoder.setCellID(cluster);
-
-            streamlog_out(DEBUG0) << "  Cluster no " << clusterCounter
-                                  << " seedX " << seedX << " seedY " << seedY
-                                  << endl;
-
-            while (indexIter != clusterCandidateIndeces.end()) {
-              if (*indexIter != -1) {
-                status->adcValues()[(*indexIter)] = EUTELESCOPE::HITPIXEL;
-              }
-              ++indexIter;
-            }
-
-            // copy the candidate charges inside the cluster
-            cluster->setChargeValues(clusterCandidateCharges);
-            dummyCollection->push_back(cluster);
-
-            EUTelFFClusterImpl *eutelCluster = new EUTelFFClusterImpl(cluster);
-            pulse->setCharge(eutelCluster->getTotalCharge());
-            delete eutelCluster;
-
-            pulse->setQuality(static_cast<int>(cluQuality));
-            pulse->setTrackerData(cluster);
-            pulseCollection->push_back(pulse);
-
-            // increment the cluster counters
-            _totClusterMap[sensorID] += 1;
-            ++clusterCounter;
-            if (clusterCounter > MAXCLUSTERSIZE) {
-              ++limitExceed;
-              --clusterCounter;
-              streamlog_out(WARNING2)
-                  << "Event " << evt->getEventNumber() << " in run "
-                  << evt->getRunNumber() << " on detector " << sensorID
-                  << " contains more than " << MAXCLUSTERSIZE << " cluster ("
-                  << clusterCounter + limitExceed << ")" << endl;
-            }
-          } else {
-            // the cluster has not passed the cut!
-          }
-        }
+    finder.findClusters(charges.data(), noises.data(), statuses.data(),
+                        _ffClusters);
+
+    streamlog_out(DEBUG0) << "There are " << _ffClusters.size()
+                          << " clusters." << endl;
+
+    for (auto const &candidate : _ffClusters) {
+
+      int seedX = candidate.seedX + minX;
+      int seedY = candidate.seedY + minY;
+      ClusterQuality cluQuality = candidate.quality;
+
+      // the final result of the clustering will enter in a
+      // TrackerPulseImpl in order to be algorithm independent
+      TrackerPulseImpl *pulse = new TrackerPulseImpl;
+      CellIDEncoder<TrackerPulseImpl> idPulseEncoder(
+          EUTELESCOPE::PULSEDEFAULTENCODING, pulseCollection);
+      idPulseEncoder["sensorID"] = sensorID;
+      idPulseEncoder["xSeed"] = seedX;
+      idPulseEncoder["ySeed"] = seedY;
+      idPulseEncoder["xCluSize"] = _ffXClusterSize;
+      idPulseEncoder["yCluSize"] = _ffYClusterSize;
+      idPulseEncoder["type"] = static_cast<int>(kEUTelFFClusterImpl);
+      idPulseEncoder.setCellID(pulse);
+
+      TrackerDataImpl *cluster = new TrackerDataImpl;
+      CellIDEncoder<TrackerDataImpl> idClusterEncoder(
+          EUTELESCOPE::CLUSTERDEFAULTENCODING, dummyCollection);
+      idClusterEncoder["sensorID"] = sensorID;
+      idClusterEncoder["xSeed"] = seedX;
+      idClusterEncoder["ySeed"] = seedY;
+      idClusterEncoder["xCluSize"] = _ffXClusterSize;
+      idClusterEncoder["yCluSize"] = _ffYClusterSize;
+      idClusterEncoder["quality"] = static_cast<int>(cluQuality);
+      idClusterEncoder.setCellID(cluster);
+
+      streamlog_out(DEBUG0) << "  Cluster no " << clusterCounter << " seedX "
+                            << seedX << " seedY " << seedY << endl;
+
+      // copy the candidate charges inside the cluster
+      float const *clusterCharges = finder.getCharges(candidate);
+      cluster->setChargeValues(
+          FloatVec(clusterCharges, clusterCharges + finder.getWindowSize()));
+      dummyCollection->push_back(cluster);
+
+      EUTelFFClusterImpl *eutelCluster = new EUTelFFClusterImpl(cluster);
+      pulse->setCharge(eutelCluster->getTotalCharge());
+      delete eutelCluster;
+
+      pulse->setQuality(static_cast<int>(cluQuality));
+      pulse->setTrackerData(cluster);
+      pulseCollection->push_back(pulse);
+
+      // increment the cluster counters
+      _totClusterMap[sensorID] += 1;
+      ++clusterCounter;
+      if (clusterCounter > MAXCLUSTERSIZE) {
+        ++limitExceed;
+        --clusterCounter;
+        streamlog_out(WARNING2)
+            << "Event " << evt->getEventNumber() << " in run "
+            << evt->getRunNumber() << " on detector " << sensorID
+            << " contains more than " << MAXCLUSTERSIZE << " cluster ("
+            << clusterCounter + limitExceed << ")" << endl;
       }
     }
   }
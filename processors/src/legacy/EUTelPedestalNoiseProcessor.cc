@@ -44,6 +44,7 @@
 
 // system includes <>
 #include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <fstream>
 #include <iomanip>
@@ -178,6 +179,11 @@ EUTelPedestalNoiseProcessor::EUTelPedestalNoiseProcessor()
                              _firstEvent, 0);
   registerProcessorParameter("LastEvent", "Last event for pedestal calculation",
                              _lastEvent, -1);
+  registerOptionalParameter(
+      "SinglePassMaxFrames",
+      "Maximum number of frames kept in memory to do all the loops with a "
+      "single pass over the input. 0 to rewind the input for each loop",
+      _singlePassMaxFrames, 0);
   registerProcessorParameter(
       "OutputPedeFile", "The filename (w/o .slcio) to store the pedestal file",
       _outputPedeFileName, string("outputpede"));
@@ -218,8 +224,9 @@ void EUTelPedestalNoiseProcessor::init() {
   // set the geometry ready switch to false
   _isGeometryReady = false;
 
-  // set the loop counter
-  if (_preLoopSwitch)
+  // set the loop counter. In the single pass mode the pre-loop is
+  // done on the buffered frames
+  if (_preLoopSwitch && _singlePassMaxFrames <= 0)
     _iLoop = -1;
   else
     _iLoop = 0;
@@ -242,6 +249,19 @@ void EUTelPedestalNoiseProcessor::init() {
   }
 #endif
 
+  if (_singlePassMaxFrames > 0 && _pedestalAlgo == EUTELESCOPE::AIDAPROFILE) {
+    streamlog_out(WARNING2)
+        << "The " << EUTELESCOPE::AIDAPROFILE
+        << " algorithm cannot be applied to the buffered frames" << endl
+        << " Algorithm changed to " << EUTELESCOPE::MEANRMS << endl;
+    _pedestalAlgo = EUTELESCOPE::MEANRMS;
+  }
+
+  _frameBuffer.clear();
+  _escapedValues.clear();
+  _escapeOffset.assign(1, 0);
+  _nFrames = 0;
+
   if (_preLoopSwitch) {
     _maxValuePos.clear();
     _maxValue.clear();
@@ -309,6 +329,11 @@ void EUTelPedestalNoiseProcessor::processRunHeader(LCRunHeader *rdr) {
   if (_additionalMaskingLoop)
     additionalLoop = 1;
 
+  // the number of passes over the input
+  int noOfPasses = _noOfCMIterations + 1 + additionalLoop;
+  if (_singlePassMaxFrames > 0)
+    noOfPasses = 1;
+
   if (_lastEvent == -1) {
     // the user didn't select an upper limit for the event range, so
     // we don't know on how many events the calculation should be done
@@ -323,7 +348,7 @@ void EUTelPedestalNoiseProcessor::processRunHeader(LCRunHeader *rdr) {
           << maxRecordNumber << ".\n"
           << "This means that in order to properly perform the pedestal "
              "calculation the maximum allowed number of events is "
-          << maxRecordNumber / (_noOfCMIterations + 1 + additionalLoop) << ".\n"
+          << maxRecordNumber / noOfPasses << ".\n"
           << "Let's hope it is correct and try to continue." << endl;
     }
   } else {
@@ -331,15 +356,11 @@ void EUTelPedestalNoiseProcessor::processRunHeader(LCRunHeader *rdr) {
     // we can compare this number with the maxRecordNumber if
     // different from 0
     if (maxRecordNumber != 0) {
-      if ((_lastEvent - _firstEvent) *
-              (_noOfCMIterations + 1 + additionalLoop) >
-          maxRecordNumber) {
+      if ((_lastEvent - _firstEvent) * noOfPasses > maxRecordNumber) {
         streamlog_out(ERROR4)
             << "The pedestal calculation should be done on "
-            << _lastEvent - _firstEvent << " times " << _noOfCMIterations + 1
-            << " iterations = "
-            << (_lastEvent - _firstEvent) *
-                   (_noOfCMIterations + 1 + additionalLoop)
+            << _lastEvent - _firstEvent << " times " << noOfPasses
+            << " iterations = " << (_lastEvent - _firstEvent) * noOfPasses
             << " records.\n"
             << "The global variable MarRecordNumber is limited to "
             << maxRecordNumber << endl;
@@ -451,6 +472,13 @@ void EUTelPedestalNoiseProcessor::processEvent(LCEvent *evt) {
                             << endl;
   }
 
+  if (_singlePassMaxFrames > 0) {
+    // after the buffer has been processed there is nothing more to do
+    if (_iLoop == 0)
+      bufferFrame(evt);
+    return;
+  }
+
   if (_iLoop == -1)
     preLoop(evt);
   else if (_iLoop == 0)
@@ -473,6 +501,18 @@ void EUTelPedestalNoiseProcessor::check(LCEvent * /* evt */) {
 
 void EUTelPedestalNoiseProcessor::end() {
 
+  // without an EORE, or when MaxRecordNumber stops the run before the
+  // buffer is full, the frames are still waiting in the buffer. The
+  // last loop asks Marlin to stop, which is done already here
+  if (_singlePassMaxFrames > 0 && _nFrames > 0 && _iLoop == 0) {
+    streamlog_out(MESSAGE4) << "End of the input: using the " << _nFrames
+                            << " buffered frames." << endl;
+    try {
+      processFrameBuffer();
+    } catch (StopProcessingException &) {
+    }
+  }
+
   int additionalLoop = 0;
   if (_additionalMaskingLoop)
     additionalLoop = 1;
@@ -2079,9 +2119,14 @@ void EUTelPedestalNoiseProcessor::finalizeProcessor(bool fromMaskingLoop) {
       }
 #endif
     }
+    // the buffered frames are looped by processFrameBuffer()
+    if (_singlePassMaxFrames > 0)
+      return;
     setReturnValue("IsPedestalFinished", false);
     throw RewindDataFilesException(this);
   } else if ((_additionalMaskingLoop) && (_iLoop == _noOfCMIterations + 1)) {
+    if (_singlePassMaxFrames > 0)
+      return;
     // additional loop!
     // now we need to loop again
     // so reset the event counter
@@ -2171,6 +2216,459 @@ void EUTelPedestalNoiseProcessor::additionalMaskingLoop(LCEvent *event) {
   }
 }
 
+void EUTelPedestalNoiseProcessor::bufferFrame(LCEvent *event) {
+
+  EUTelEventImpl *evt = static_cast<EUTelEventImpl *>(event);
+
+  // the end of the event range is the end of the only pass over the
+  // input, all the loops are then done on the buffered frames
+  if (evt->getEventType() == kEORE) {
+    streamlog_out(DEBUG4) << "EORE found: calling processFrameBuffer()."
+                          << endl;
+    processFrameBuffer();
+    return;
+  }
+
+  if ((_lastEvent != -1) && (_iEvt >= _lastEvent)) {
+    streamlog_out(DEBUG4)
+        << "Looping limited by _lastEvent: calling processFrameBuffer()."
+        << endl;
+    processFrameBuffer();
+    return;
+  }
+
+  if (_iEvt < _firstEvent) {
+    ++_iEvt;
+    throw SkipEventException(this);
+  }
+
+  if (isFirstEvent()) {
+
+    // a frame is made by all the detectors in the order of
+    // _orderedSensorIDVec
+    _pixelOffset.assign(1, 0);
+    for (size_t iDetector = 0; iDetector < _noOfDetector; ++iDetector) {
+      size_t nPixel = (_maxX[iDetector] - _minX[iDetector] + 1) *
+                      (_maxY[iDetector] - _minY[iDetector] + 1);
+      _pixelOffset.push_back(_pixelOffset.back() + nPixel);
+      _status.push_back(ShortVec(nPixel, EUTELESCOPE::GOODPIXEL));
+      if (_additionalMaskingLoop)
+        _hitCounter.push_back(ShortVec(nPixel, 0));
+    }
+    _frameSize = _pixelOffset.back();
+
+    // the whole buffer is allocated now, so that a too large
+    // SinglePassMaxFrames fails before reading the input. Only the
+    // escaped values come on top of it
+    streamlog_out(MESSAGE4)
+        << "Buffering up to " << _singlePassMaxFrames << " frames of "
+        << _frameSize << " pixels ("
+        << static_cast<double>(_singlePassMaxFrames) * _frameSize *
+               sizeof(signed char) / (1024. * 1024.)
+        << " MB)" << endl;
+    _frameBuffer.clear();
+    _frameBuffer.reserve(_frameSize * _singlePassMaxFrames);
+    _referenceFrame.assign(_frameSize, 0);
+    _escapedValues.clear();
+    _escapeOffset.assign(1, 0);
+    _nFrames = 0;
+
+    bookHistos();
+
+    _isFirstEvent = false;
+  }
+
+  // the first frame is the reference of all the others
+  _frameBuffer.resize((_nFrames + 1) * _frameSize);
+  signed char *frame = &_frameBuffer[_nFrames * _frameSize];
+
+  size_t iDetector = 0;
+  for (size_t iCol = 0; iCol < _rawDataCollectionNameVec.size(); ++iCol) {
+
+    try {
+      LCCollectionVec *collectionVec = dynamic_cast<LCCollectionVec *>(
+          evt->getCollection(_rawDataCollectionNameVec.at(iCol)));
+
+      for (size_t iElement = 0; iElement < collectionVec->size();
+           ++iElement, ++iDetector) {
+        TrackerRawData *trackerRawData = dynamic_cast<TrackerRawData *>(
+            collectionVec->getElementAt(iElement));
+        ShortVec const &adcValues = trackerRawData->getADCValues();
+
+        if ((iDetector >= _noOfDetector) ||
+            (adcValues.size() !=
+             _pixelOffset[iDetector + 1] - _pixelOffset[iDetector])) {
+          streamlog_out(ERROR5)
+              << "Event " << _iEvt << " does not have the detectors of the "
+              << "first event. Sorry for quitting." << endl;
+          exit(-1);
+        }
+        size_t const offset = _pixelOffset[iDetector];
+        if (_nFrames == 0) {
+          copy(adcValues.begin(), adcValues.end(),
+               _referenceFrame.begin() + offset);
+        }
+        short const *reference = &_referenceFrame[offset];
+        for (size_t iPixel = 0; iPixel < adcValues.size(); ++iPixel) {
+          int const delta = adcValues[iPixel] - reference[iPixel];
+          if ((delta > _frameEscape) && (delta <= 127)) {
+            frame[offset + iPixel] = static_cast<signed char>(delta);
+          } else {
+            frame[offset + iPixel] = _frameEscape;
+            _escapedValues.push_back(make_pair(
+                static_cast<unsigned int>(offset + iPixel), adcValues[iPixel]));
+          }
+        }
+      }
+
+    } catch (DataNotAvailableException &e) {
+      // an incomplete frame is not buffered at all
+      streamlog_out(WARNING2)
+          << "No input collection " << _rawDataCollectionNameVec.at(iCol)
+          << " is not available in the current event ("
+          << event->getEventNumber() << "), skipping it" << endl;
+      _frameBuffer.resize(_nFrames * _frameSize);
+      _escapedValues.resize(_escapeOffset.back());
+      ++_iEvt;
+      return;
+    }
+  }
+
+  _escapeOffset.push_back(_escapedValues.size());
+  ++_nFrames;
+  ++_iEvt;
+
+  if (_nFrames == static_cast<size_t>(_singlePassMaxFrames)) {
+    streamlog_out(MESSAGE4)
+        << "The frame buffer is full at event " << _iEvt << ": using the "
+        << _nFrames << " buffered frames." << endl;
+    processFrameBuffer();
+  }
+}
+
+void EUTelPedestalNoiseProcessor::processFrameBuffer() {
+
+  if (_nFrames == 0) {
+    streamlog_out(ERROR5) << "No frame has been buffered for the pedestal "
+                             "calculation. Sorry for quitting."
+                          << endl;
+    exit(-1);
+  }
+
+  if ((_commonModeAlgo != EUTELESCOPE::FULLFRAME) &&
+      (_commonModeAlgo != EUTELESCOPE::ROWWISE)) {
+    streamlog_out(ERROR4)
+        << "Unknown common mode algorithm. Using flat null correction"
+        << endl;
+  }
+
+  // the skipped event list, and so the event numbers, refer to the
+  // buffered frames
+  _skippedFrame.assign(_nFrames, 0);
+  size_t maxPixel = 0;
+  for (size_t iDetector = 0; iDetector < _noOfDetector; ++iDetector) {
+    maxPixel =
+        max(maxPixel, _pixelOffset[iDetector + 1] - _pixelOffset[iDetector]);
+  }
+  _commonModeCor.assign(maxPixel, 0.);
+
+  // the pre-loop: the frame with the maximum and the one with the
+  // minimum signal of each pixel
+  if (_preLoopSwitch) {
+    _decodedFrame.resize(_frameSize);
+    decodeFrame(0, 0, _frameSize, _decodedFrame.data());
+    ShortVec maxValue(_decodedFrame);
+    ShortVec minValue(maxValue);
+    _maxFrame.assign(_frameSize, 0);
+    _minFrame.assign(_frameSize, 0);
+    for (size_t iFrame = 1; iFrame < _nFrames; ++iFrame) {
+      decodeFrame(iFrame, 0, _frameSize, _decodedFrame.data());
+      short const *frame = _decodedFrame.data();
+      int const frameNumber = static_cast<int>(iFrame);
+      for (size_t iPixel = 0; iPixel < _frameSize; ++iPixel) {
+        bool const isMax = frame[iPixel] > maxValue[iPixel];
+        bool const isMin = frame[iPixel] < minValue[iPixel];
+        maxValue[iPixel] = isMax ? frame[iPixel] : maxValue[iPixel];
+        _maxFrame[iPixel] = isMax ? frameNumber : _maxFrame[iPixel];
+        minValue[iPixel] = isMin ? frame[iPixel] : minValue[iPixel];
+        _minFrame[iPixel] = isMin ? frameNumber : _minFrame[iPixel];
+      }
+    }
+  } else {
+    _maxFrame.assign(_frameSize, -1);
+    _minFrame.assign(_frameSize, -1);
+  }
+
+  // the same sequence of loops as with the rewind, finalizeProcessor
+  // resets the event counter used for the rates
+  _iLoop = 0;
+  _iEvt = _nFrames;
+  accumulateFrames(false);
+  finalizeProcessor(false);
+
+  while (_iLoop < _noOfCMIterations + 1) {
+    _iEvt = _nFrames;
+    accumulateFrames(true);
+    finalizeProcessor(false);
+  }
+
+  if ((_additionalMaskingLoop) && (_iLoop == _noOfCMIterations + 1)) {
+    _iEvt = _nFrames;
+    countFiringFrames();
+    finalizeProcessor(true);
+  }
+}
+
+void EUTelPedestalNoiseProcessor::decodeFrame(size_t iFrame, size_t first,
+                                              size_t nPixel,
+                                              short *adcValues) const {
+
+  signed char const *frame = &_frameBuffer[iFrame * _frameSize + first];
+  short const *reference = &_referenceFrame[first];
+  for (size_t iPixel = 0; iPixel < nPixel; ++iPixel) {
+    adcValues[iPixel] = static_cast<short>(reference[iPixel] + frame[iPixel]);
+  }
+
+  // the escaped values of the frame are sorted by pixel
+  auto escape = lower_bound(
+      _escapedValues.begin() + _escapeOffset[iFrame],
+      _escapedValues.begin() + _escapeOffset[iFrame + 1],
+      make_pair(static_cast<unsigned int>(first), numeric_limits<short>::min()));
+  auto const lastEscape = _escapedValues.begin() + _escapeOffset[iFrame + 1];
+  for (; (escape != lastEscape) && (escape->first < first + nPixel); ++escape) {
+    adcValues[escape->first - first] = escape->second;
+  }
+}
+
+void EUTelPedestalNoiseProcessor::accumulateFrames(bool commonModeSuppression) {
+
+  _tempPede.resize(_noOfDetector);
+  _tempNoise.resize(_noOfDetector);
+  _tempEntries.clear();
+
+  if (!commonModeSuppression)
+    fill(_commonModeCor.begin(), _commonModeCor.end(), 0.);
+
+  vector<double> sum, sum2;
+  IntVec entries;
+  FloatVec reference, window;
+
+  for (size_t iDetector = 0; iDetector < _noOfDetector; ++iDetector) {
+
+    size_t const offset = _pixelOffset[iDetector];
+    size_t const nPixel = _pixelOffset[iDetector + 1] - offset;
+    int const *maxFrame = &_maxFrame[offset];
+    int const *minFrame = &_minFrame[offset];
+
+    // the sums are relative to the first frame, or to the current
+    // pedestal, not to lose precision. The window is the largest
+    // accepted signal: the hit rejection cut for the good pixels
+    // after the first loop, nothing for the bad ones
+    reference.resize(nPixel);
+    window.resize(nPixel);
+    if (commonModeSuppression) {
+      reference = _pedestal[iDetector];
+      for (size_t iPixel = 0; iPixel < nPixel; ++iPixel) {
+        window[iPixel] =
+            (_status[iDetector][iPixel] == EUTELESCOPE::GOODPIXEL)
+                ? _hitRejectionCut * _noise[iDetector][iPixel]
+                : -1.f;
+      }
+    } else {
+      _decodedFrame.resize(nPixel);
+      decodeFrame(0, offset, nPixel, _decodedFrame.data());
+      copy(_decodedFrame.begin(), _decodedFrame.end(), reference.begin());
+      fill(window.begin(), window.end(), numeric_limits<float>::infinity());
+    }
+
+    sum.assign(nPixel, 0.);
+    sum2.assign(nPixel, 0.);
+    entries.assign(nPixel, 0);
+
+    _decodedFrame.resize(nPixel);
+    for (size_t iFrame = 0; iFrame < _nFrames; ++iFrame) {
+
+      decodeFrame(iFrame, offset, nPixel, _decodedFrame.data());
+      short const *adcValues = _decodedFrame.data();
+
+      if (commonModeSuppression &&
+          !frameCommonMode(iDetector, adcValues)) {
+        streamlog_out(WARNING2)
+            << "Skipping frame " << iFrame
+            << " because of the common mode on detector "
+            << _orderedSensorIDVec.at(iDetector) << endl;
+        if (!_skippedFrame[iFrame]) {
+          _skippedFrame[iFrame] = 1;
+          _skippedEventList.push_back(static_cast<int>(iFrame));
+        }
+        continue;
+      }
+
+      int const frameNumber = static_cast<int>(iFrame);
+      for (size_t iPixel = 0; iPixel < nPixel; ++iPixel) {
+        float const signal =
+            adcValues[iPixel] - _commonModeCor[iPixel] - reference[iPixel];
+        bool const use = (std::abs(signal) < window[iPixel]) &&
+                         (frameNumber != maxFrame[iPixel]) &&
+                         (frameNumber != minFrame[iPixel]);
+        sum[iPixel] += use ? signal : 0.;
+        sum2[iPixel] += use ? signal * signal : 0.;
+        entries[iPixel] += use ? 1 : 0;
+      }
+    }
+
+    // a pixel without entries keeps its previous values
+    FloatVec pedestal(nPixel), noise(nPixel);
+    for (size_t iPixel = 0; iPixel < nPixel; ++iPixel) {
+      if (entries[iPixel] > 0) {
+        double const mean = sum[iPixel] / entries[iPixel];
+        pedestal[iPixel] = reference[iPixel] + mean;
+        noise[iPixel] =
+            sqrt(max(0., sum2[iPixel] / entries[iPixel] - mean * mean));
+      } else {
+        pedestal[iPixel] = reference[iPixel];
+        noise[iPixel] = commonModeSuppression ? _noise[iDetector][iPixel] : 0.;
+      }
+    }
+    _tempPede[iDetector].swap(pedestal);
+    _tempNoise[iDetector].swap(noise);
+  }
+}
+
+bool EUTelPedestalNoiseProcessor::frameCommonMode(size_t iDetector,
+                                                  short const *adcValues) {
+
+  float const *pedestal = _pedestal[iDetector].data();
+  float const *noise = _noise[iDetector].data();
+  short const *status = _status[iDetector].data();
+  float *correction = _commonModeCor.data();
+  int const rowLength = _maxX[iDetector] - _minX[iDetector] + 1;
+  int const noOfRows = _maxY[iDetector] - _minY[iDetector] + 1;
+
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+  // the common mode of the accepted frames and rows, as in otherLoop
+  AIDA::IHistogram1D *histo = dynamic_cast<AIDA::IHistogram1D *>(
+      _aidaHistoMap[_commonModeHistoName + "_d" +
+                    to_string(_orderedSensorIDVec.at(iDetector)) + "_l" +
+                    to_string(_iLoop)]);
+#endif
+
+  if (_commonModeAlgo == EUTELESCOPE::FULLFRAME) {
+
+    int const nPixel = rowLength * noOfRows;
+    double pixelSum = 0.;
+    int goodPixel = 0;
+    int skippedPixel = 0;
+    for (int iPixel = 0; iPixel < nPixel; ++iPixel) {
+      float const signal = adcValues[iPixel] - pedestal[iPixel];
+      bool const isHit = signal > _hitRejectionCut * noise[iPixel];
+      bool const use = !isHit && (status[iPixel] == EUTELESCOPE::GOODPIXEL);
+      pixelSum += use ? signal : 0.f;
+      goodPixel += use ? 1 : 0;
+      skippedPixel += isHit ? 1 : 0;
+    }
+    if ((skippedPixel >= _maxNoOfRejectedPixels) || (goodPixel == 0))
+      return false;
+    double const commonMode = pixelSum / goodPixel;
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+    if (histo)
+      histo->fill(commonMode);
+#endif
+    fill(correction, correction + nPixel, static_cast<float>(commonMode));
+    return true;
+
+  } else if (_commonModeAlgo == EUTELESCOPE::ROWWISE) {
+
+    int skippedRow = 0;
+    for (int iRow = 0; iRow < noOfRows; ++iRow) {
+      int const first = iRow * rowLength;
+      double pixelSum = 0.;
+      int goodPixel = 0;
+      int skippedPixelPerRow = 0;
+      for (int iPixel = first; iPixel < first + rowLength; ++iPixel) {
+        float const signal = adcValues[iPixel] - pedestal[iPixel];
+        bool const isHit = signal > _hitRejectionCut * noise[iPixel];
+        bool const use = !isHit && (status[iPixel] == EUTELESCOPE::GOODPIXEL);
+        pixelSum += use ? signal : 0.f;
+        goodPixel += use ? 1 : 0;
+        skippedPixelPerRow += isHit ? 1 : 0;
+      }
+      if ((skippedPixelPerRow < _maxNoOfRejectedPixelPerRow) &&
+          (goodPixel != 0)) {
+        double const commonMode = pixelSum / goodPixel;
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+        if (histo)
+          histo->fill(commonMode);
+#endif
+        fill(correction + first, correction + first + rowLength,
+             static_cast<float>(commonMode));
+      } else {
+        fill(correction + first, correction + first + rowLength, 0.f);
+        ++skippedRow;
+      }
+    }
+    return skippedRow < _maxNoOfSkippedRow;
+  }
+
+  fill(correction, correction + rowLength * noOfRows, 0.f);
+  return true;
+}
+
+void EUTelPedestalNoiseProcessor::countFiringFrames() {
+
+  FloatVec threshold;
+  for (size_t iDetector = 0; iDetector < _noOfDetector; ++iDetector) {
+
+    size_t const offset = _pixelOffset[iDetector];
+    size_t const nPixel = _pixelOffset[iDetector + 1] - offset;
+
+    // a pixel fires above pedestal + 3 noise, bad pixels never
+    threshold.resize(nPixel);
+    for (size_t iPixel = 0; iPixel < nPixel; ++iPixel) {
+      threshold[iPixel] =
+          (_status[iDetector][iPixel] == EUTELESCOPE::GOODPIXEL)
+              ? _pedestal[iDetector][iPixel] + 3.f * _noise[iDetector][iPixel]
+              : numeric_limits<float>::infinity();
+    }
+
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+    // the signal of one pixel, as in additionalMaskingLoop
+    size_t const aPixel = 1 + nPixel / 10;
+    AIDA::IHistogram1D *aPixelHisto = nullptr;
+    if (_histogramSwitch && aPixel < nPixel &&
+        _status[iDetector][aPixel] == EUTELESCOPE::GOODPIXEL) {
+      string tempHistoName = _aPixelHistoName + "_d" +
+                             to_string(_orderedSensorIDVec.at(iDetector)) +
+                             "_l" + to_string(_iLoop);
+      aPixelHisto =
+          dynamic_cast<AIDA::IHistogram1D *>(_aidaHistoMap[tempHistoName]);
+      if (!aPixelHisto) {
+        streamlog_out(ERROR1)
+            << "Not able to retrieve histogram pointer for " << tempHistoName
+            << ".\nDisabling histogramming from now on " << endl;
+        _histogramSwitch = false;
+      }
+    }
+#endif
+
+    short *hitCounter = _hitCounter[iDetector].data();
+    _decodedFrame.resize(nPixel);
+    for (size_t iFrame = 0; iFrame < _nFrames; ++iFrame) {
+      if (_skippedFrame[iFrame])
+        continue;
+      decodeFrame(iFrame, offset, nPixel, _decodedFrame.data());
+      short const *adcValues = _decodedFrame.data();
+      for (size_t iPixel = 0; iPixel < nPixel; ++iPixel) {
+        hitCounter[iPixel] += (adcValues[iPixel] > threshold[iPixel]) ? 1 : 0;
+      }
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+      if (aPixelHisto)
+        aPixelHisto->fill(adcValues[aPixel] - _pedestal[iDetector][aPixel]);
+#endif
+    }
+  }
+}
+
 void EUTelPedestalNoiseProcessor::setBadPixelAlgoSwitches() {
 
   if (find(_badPixelAlgoVec.begin(), _badPixelAlgoVec.end(),
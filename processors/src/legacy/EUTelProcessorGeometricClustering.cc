@@ -30,7 +30,6 @@
 #include "EUTelGeometryTelescopeGeoDescription.h"
 
 // ROOT includes
-#include "TGeoBBox.h"
 #include "TGeoShape.h"
 
 // marlin includes
@@ -151,8 +150,9 @@ void EUTelProcessorGeometricClustering::initializeGeometry(
 
     for (size_t i = 0; i < _zsInputDataCollectionVec->size(); ++i) {
       auto data = dynamic_cast<TrackerDataImpl*>(_zsInputDataCollectionVec->getElementAt(i));
-      _sensorIDVec.push_back(cellDecoder(data)["sensorID"]);
-      _totClusterMap.insert(std::make_pair(cellDecoder(data)["sensorID"], 0));
+      int const sensorID = cellDecoder(data)["sensorID"];
+      _sensorIDVec.push_back(sensorID);
+      _totClusterMap.insert(std::make_pair(sensorID, 0));
     }
   } catch (lcio::DataNotAvailableException& ) {
     streamlog_out(DEBUG5) << "Could not find the input collection: "
@@ -281,9 +281,7 @@ void EUTelProcessorGeometricClustering::geometricClustering(
         static_cast<int>(cellDecoder(zsData)["sparsePixelType"]));
     int sensorID = static_cast<int>(cellDecoder(zsData)["sensorID"]);
 
-    // get alle the plane relevant geo information, that is the plane name and
-    // the plane pix geometry
-    std::string planePath = geo::gGeometry().getPlanePath(sensorID);
+    // get the plane pix geometry
     geo::EUTelGenericPixGeoDescr *geoDescr =
         (geo::gGeometry().getPixGeoDescr(sensorID));
 
@@ -305,6 +303,12 @@ void EUTelProcessorGeometricClustering::geometricClustering(
     minX = minY = maxX = maxY = 0;
     geoDescr->getPixelIndexRange(minX, maxX, minY, maxY);
 
+    // tabulate the pixel positions and sizes once per sensor, when it
+    // first shows up, the clustering then needs no ROOT navigation
+    if (!geoDescr->hasPixelBoxes()) {
+      geoDescr->buildPixelBoxes(geo::gGeometry().getPlanePath(sensorID));
+    }
+
     // now prepare the EUTelescope interface to sparsified data.
     auto sparseData = Utility::getSparseData(zsData, type);
 
@@ -321,49 +325,21 @@ void EUTelProcessorGeometricClustering::geometricClustering(
       EUTelGeometricPixel hitPixel(
           dynamic_cast<EUTelGenericSparsePixel const &>(pixel));
 
-      // And get the path to the given pixel
-      std::string pixelPath =
-          geoDescr->getPixName(hitPixel.getXCoord(), hitPixel.getYCoord());
-
-      // Then navigate to this pixel with the TGeo manager
-      geo::gGeometry()._geoManager->cd((planePath + pixelPath).c_str());
-
-      // get the imbedding box
-      auto currentShape = geo::gGeometry()._geoManager->GetCurrentVolume()->GetShape();
-      auto bbox = dynamic_cast<TGeoBBox*>(currentShape);
-      // store the dimensions of this box in the GeometricPixel
-      hitPixel.setBoundaryX(bbox->GetDX());
-      hitPixel.setBoundaryY(bbox->GetDY());
-
-      // Get how deep the node description goes (this is how often we have to
-      // transform to get coordinates in the local plane coordinate system)
-      auto split = Utility::stringSplit(planePath + pixelPath, "/", false);
-
-      // Three recursions for the telescope/plane
-      int recursionDepth = split.size() - 3;
-
-      // The do the transformation
-      Double_t origin_pt[3] = {0, 0, 0};
-      Double_t transformed1_pt[3];
-      Double_t transformed2_pt[3];
-      gGeoManager->GetCurrentNode()->LocalToMaster(origin_pt, transformed1_pt);
-
-      transformed2_pt[0] = transformed1_pt[0];
-      transformed2_pt[1] = transformed1_pt[1];
-      transformed2_pt[2] = transformed1_pt[2];
-
-      // transform into local plane coordinate system
-      for (int i = 1; i < recursionDepth; ++i) {
-        gGeoManager->GetMother(i)->LocalToMaster(transformed1_pt,
-                                                 transformed2_pt);
-        transformed1_pt[0] = transformed2_pt[0];
-        transformed1_pt[1] = transformed2_pt[1];
-        transformed1_pt[2] = transformed2_pt[2];
+      // The pixel centre and half widths, tabulated at initialisation
+      if (hitPixel.getXCoord() < minX || hitPixel.getXCoord() > maxX ||
+          hitPixel.getYCoord() < minY || hitPixel.getYCoord() > maxY) {
+        streamlog_out(WARNING2) << "Pixel (" << hitPixel.getXCoord() << ", "
+                                << hitPixel.getYCoord()
+                                << ") outside of the matrix of sensor "
+                                << sensorID << ", skipped" << std::endl;
+        continue;
       }
-
-      // store all the position information in the GeometricPixel
-      hitPixel.setPosX(transformed2_pt[0]);
-      hitPixel.setPosY(transformed2_pt[1]);
+      auto const &box =
+          geoDescr->getPixelBox(hitPixel.getXCoord(), hitPixel.getYCoord());
+      hitPixel.setBoundaryX(box.halfX);
+      hitPixel.setBoundaryY(box.halfY);
+      hitPixel.setPosX(box.x);
+      hitPixel.setPosY(box.y);
       // and push this pixel back
       hitPixelVec.push_back(hitPixel);
     }
@@ -113,6 +113,8 @@ EUTelTestFitter::EUTelTestFitter()
       _planeThickness(nullptr), _planeX0(nullptr), _planeResolution(nullptr),
       _isActive(nullptr), _planeWindowIDs(nullptr), _planeMaskIDs(nullptr), _nRun(0),
       _nEvt(0), _planeHits(nullptr), _planeChoice(nullptr), _planeMod(nullptr),
+      _partialChi2(nullptr), _partialFitX(nullptr), _partialFitEx(nullptr),
+      _partialFitY(nullptr), _partialFitEy(nullptr),
       _planeX(nullptr), _planeEx(nullptr), _planeY(nullptr), _planeEy(nullptr),
       _planeScatAngle(nullptr), _planeDist(nullptr), _planeScat(nullptr), _fitX(nullptr),
       _fitEx(nullptr), _fitY(nullptr), _fitEy(nullptr), _fitArray(nullptr),
@@ -640,6 +642,12 @@ void EUTelTestFitter::init() {
   _planeChoice = new int[_nTelPlanes];
   _planeMod = new type_fitcount[_nTelPlanes];
 
+  _partialChi2 = new double[_nTelPlanes];
+  _partialFitX = new double[_nTelPlanes * _nTelPlanes];
+  _partialFitEx = new double[_nTelPlanes * _nTelPlanes];
+  _partialFitY = new double[_nTelPlanes * _nTelPlanes];
+  _partialFitEy = new double[_nTelPlanes * _nTelPlanes];
+
   _planeX = new double[_nTelPlanes];
   _planeEx = new double[_nTelPlanes];
   _planeY = new double[_nTelPlanes];
@@ -1308,6 +1316,16 @@ void EUTelTestFitter::processEvent(LCEvent *event) {
 
   double chi2min = numeric_limits<double>::max();
 
+  // Partial tracks are only fitted if hits can still be added to them
+
+  int lastFiredPlane = -1;
+
+  for (int ipl = 0; ipl < _nTelPlanes; ipl++) {
+    _partialChi2[ipl] = -1.;
+    if (_isActive[ipl] && _planeHits[ipl] > 0)
+      lastFiredPlane = ipl;
+  }
+
   // Loop over fit possibilities
   // Start from one-hit track to allow for "smart" skipping of wrong matches
 
@@ -1336,12 +1354,15 @@ void EUTelTestFitter::processEvent(LCEvent *event) {
     //             plane + beam slope): hit missed
     //   - angle between track segments (slope change) too large:
     //                  track slope
+    //   - chi2 of the partial track above Chi2Max when the hit is
+    //     added: track window
     //
     // Value >0 gives first layer which failed the cut
     // 0 value means that preselection cuts were passed by all hits
 
     int firstHitMissed = 0;
     int firstTrackSlope = 0;
+    int firstWindowMissed = 0;
 
     // If beam constraint used: assume the track should go along
     // beam direction, otherwise beam is assumed to be perpendicular
@@ -1376,6 +1397,18 @@ void EUTelTestFitter::processEvent(LCEvent *event) {
           _planeEy[ipl] =
               (_useNominalResolution) ? _planeResolution[ipl] : hitEy[jhit];
 
+          // Track window, from the fit of the partial track ending with
+          // the previous hit. Hypotheses are checked in such an order that
+          // this partial track has been fitted just before its extensions.
+          // Chi2 can only increase when more hits are added, so all
+          // hypotheses including the hit can be skipped (small margin
+          // for rounding errors of the full fit).
+
+          if (ifirst >= 0 && firstWindowMissed == 0 &&
+              _partialChi2[ilast] >= 0. &&
+              ExtendedChi2(ilast, ipl) >= _chi2Max * (1. + 1.e-6))
+            firstWindowMissed = ipl;
+
           // Calculate distance from expected position
           // starting from the second hit (when ifirst already set)
 
@@ -1423,20 +1456,32 @@ void EUTelTestFitter::processEvent(LCEvent *event) {
     }
     // End of plane loop (decoding fit hypothesis)
 
+    // This hypothesis is the partial track for the following ones,
+    // until it is fitted
+
+    if (nChoiceFired > 0)
+      _partialChi2[ilast] = -1.;
+
     // Check number of selected hits
     // =============================
 
     // No fit to 1 hit :-)
+    // Only used to predict the track position in the next planes
+    // (with beam constraint)
+
+    bool predictOnly = false;
 
     if (nChoiceFired < 2) {
-      continue;
+      if (nChoiceFired == 0 || !_useBeamConstraint)
+        continue;
+      predictOnly = true;
     }
     // Fit with 2 hits make sense only with beam constraint, or
-    // when 2 point fit is allowed
+    // when 2 point fit is allowed (otherwise only for prediction)
 
     if (nChoiceFired == 2 && !_useBeamConstraint &&
         nChoiceFired + _allowMissingHits < _nActivePlanes) {
-      continue;
+      predictOnly = true;
     }
 
     // Skip also if the fit can not be extended to proper number
@@ -1463,6 +1508,19 @@ void EUTelTestFitter::processEvent(LCEvent *event) {
       continue;
     }
 
+    // Cut on track window
+
+    if (firstWindowMissed > 0) {
+      ichoice -= _planeMod[firstWindowMissed] - 1;
+      continue;
+    }
+
+    // Nothing to predict after the last fired plane
+
+    if (predictOnly && ilast >= lastFiredPlane) {
+      continue;
+    }
+
     // Select fit method
     // "Nominal" fit only if all active planes used
 
@@ -1478,11 +1536,23 @@ void EUTelTestFitter::processEvent(LCEvent *event) {
     // Fit failed ?
 
     if (choiceChi2 < 0.) {
-      streamlog_out(WARNING2)
-          << "Fit to " << nChoiceFired << " planes failed for event "
-          << event->getEventNumber() << " in run " << event->getRunNumber()
-          << endl;
+      if (!predictOnly) {
+        streamlog_out(WARNING2)
+            << "Fit to " << nChoiceFired << " planes failed for event "
+            << event->getEventNumber() << " in run " << event->getRunNumber()
+            << endl;
+      }
+
+      continue;
+    }
+
+    // Keep the fit for the window of the next hits
+
+    if (ilast < lastFiredPlane) {
+      StorePartialFit(ilast, choiceChi2);
+    }
 
+    if (predictOnly) {
       continue;
     }
 
@@ -2011,6 +2081,12 @@ void EUTelTestFitter::end() {
   delete[] _planeChoice;
   delete[] _planeMod;
 
+  delete[] _partialChi2;
+  delete[] _partialFitX;
+  delete[] _partialFitEx;
+  delete[] _partialFitY;
+  delete[] _partialFitEy;
+
   delete[] _planeX;
   delete[] _planeEx;
   delete[] _planeY;
@@ -2701,6 +2777,42 @@ int EUTelTestFitter::GaussjSolve(double *alfa, double *beta, int n) {
   return 0;
 }
 
+void EUTelTestFitter::StorePartialFit(int lastPlane, double chi2) {
+  _partialChi2[lastPlane] = chi2;
+
+  for (int ipl = 0; ipl < _nTelPlanes; ipl++) {
+    int imx = ipl + lastPlane * _nTelPlanes;
+
+    _partialFitX[imx] = _fitX[ipl];
+    _partialFitEx[imx] = _fitEx[ipl];
+    _partialFitY[imx] = _fitY[ipl];
+    _partialFitEy[imx] = _fitEy[ipl];
+  }
+}
+
+double EUTelTestFitter::ExtendedChi2(int lastPlane, int plane) const {
+  // Adding one measurement to a linear fit increases its chi2 by the
+  // squared distance to the prediction over the sum of the measurement
+  // and prediction variances
+
+  int imx = plane + lastPlane * _nTelPlanes;
+  double chi2 = _partialChi2[lastPlane];
+
+  if (_planeEx[plane] > 0.) {
+    double dx = _planeX[plane] - _partialFitX[imx];
+    chi2 += dx * dx / (_planeEx[plane] * _planeEx[plane] +
+                       _partialFitEx[imx] * _partialFitEx[imx]);
+  }
+
+  if (_planeEy[plane] > 0.) {
+    double dy = _planeY[plane] - _partialFitY[imx];
+    chi2 += dy * dy / (_planeEy[plane] * _planeEy[plane] +
+                       _partialFitEy[imx] * _partialFitEy[imx]);
+  }
+
+  return chi2;
+}
+
 void EUTelTestFitter::getImpactPoint(double &x, double &y, double &z,
                                      double &slopeX, double &slopeY,
                                      double &slopeZ) {
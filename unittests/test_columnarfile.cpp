@@ -0,0 +1,113 @@
+//STL
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelColumnarFile.h"
+#include "EUTelExceptions.h"
+
+using eutelescope::EUTelColumnarReader;
+using eutelescope::EUTelColumnarWriter;
+using eutelescope::EUTelColumnType;
+
+namespace {
+
+char const * const fileName = "test_columnarfile.columns";
+
+}
+
+/** Rows spread over several row groups, the last one partial, must be read back unchanged.
+ *  The cells not set in a row must be NaN for a float column and 0 for an int one.
+ */
+TEST(EUTelColumnarFileTest, WriteReadRoundTrip) {
+
+	size_t const noOfRows = 52;
+	{
+		EUTelColumnarWriter writer(8);
+		auto event = writer.addIntColumn("event");
+		auto chi2 = writer.addFloatColumn("chi2");
+		auto x = writer.addFloatColumn("x");
+		auto nHits = writer.addIntColumn("nHits");
+		writer.open(fileName);
+		ASSERT_TRUE(writer.isOpen());
+		for(size_t iRow = 0; iRow < noOfRows; ++iRow) {
+			writer.set(event, static_cast<std::int32_t>(iRow));
+			writer.set(chi2, 0.5f * static_cast<float>(iRow));
+			//every third row misses its x and nHits
+			if(iRow % 3 != 0) {
+				writer.set(x, -1.f * static_cast<float>(iRow));
+				writer.set(nHits, static_cast<std::int32_t>(iRow % 7));
+			}
+			writer.endRow();
+		}
+		ASSERT_EQ(noOfRows, writer.getNRows());
+		writer.close();
+	}
+
+	EUTelColumnarReader reader(fileName);
+	ASSERT_EQ(noOfRows, reader.getNRows());
+	ASSERT_EQ((std::vector<std::string>{"event", "chi2", "x", "nHits"}), reader.getColumnNames());
+	ASSERT_EQ(EUTelColumnType::Int, reader.getColumnType("event"));
+	ASSERT_EQ(EUTelColumnType::Float, reader.getColumnType("chi2"));
+	ASSERT_FALSE(reader.hasColumn("y"));
+
+	//out of the file order, to check the seeks over the other columns
+	std::vector<float> x, chi2;
+	std::vector<std::int32_t> event, nHits;
+	reader.readColumn("x", x);
+	reader.readColumn("event", event);
+	reader.readColumn("nHits", nHits);
+	reader.readColumn("chi2", chi2);
+	ASSERT_EQ(noOfRows, x.size());
+	ASSERT_EQ(noOfRows, event.size());
+	ASSERT_EQ(noOfRows, nHits.size());
+	ASSERT_EQ(noOfRows, chi2.size());
+	for(size_t iRow = 0; iRow < noOfRows; ++iRow) {
+		ASSERT_EQ(static_cast<std::int32_t>(iRow), event[iRow]);
+		ASSERT_EQ(0.5f * static_cast<float>(iRow), chi2[iRow]);
+		if(iRow % 3 != 0) {
+			ASSERT_EQ(-1.f * static_cast<float>(iRow), x[iRow]);
+			ASSERT_EQ(static_cast<std::int32_t>(iRow % 7), nHits[iRow]);
+		} else {
+			ASSERT_TRUE(std::isnan(x[iRow]));
+			ASSERT_EQ(0, nHits[iRow]);
+		}
+	}
+
+	ASSERT_THROW(reader.readColumn("event", x), eutelescope::InvalidParameterException);
+	ASSERT_THROW(reader.readColumn("y", x), eutelescope::InvalidParameterException);
+	std::remove(fileName);
+}
+
+/** A file without any row, and a file which is not a columnar one.
+ */
+TEST(EUTelColumnarFileTest, EmptyAndForeignFiles) {
+
+	{
+		EUTelColumnarWriter writer(4);
+		writer.addFloatColumn("chi2");
+		writer.open(fileName);
+		writer.close();
+	}
+	{
+		EUTelColumnarReader reader(fileName);
+		ASSERT_EQ(0u, reader.getNRows());
+		std::vector<float> chi2(3, 1.f);
+		reader.readColumn("chi2", chi2);
+		ASSERT_TRUE(chi2.empty());
+	}
+
+	{
+		std::ofstream file(fileName);
+		file << "not a columnar file";
+	}
+	ASSERT_THROW(EUTelColumnarReader reader(fileName), lcio::IOException);
+	std::remove(fileName);
+}
@@ -1,4 +1,5 @@
 //STL
+#include <algorithm>
 #include <iostream>
 #include <random>
 #include <chrono>
@@ -13,6 +14,10 @@
 
 //EUTelescope
 #include "eutelgeotest.h"
+#include "EUTelGenericPixGeoDescr.h"
+
+//ROOT
+#include "TGeoBBox.h"
 
 #define PI 3.14159265
 
@@ -301,5 +306,46 @@ TEST_F(eutelgeotestTest, radLengthTest1) {
 }
 
 
+/** The tabulated pixel boxes must agree with the pixel volumes in TGeo: the centre transformed into the
+ *  sensitive area and the half widths, checked for 100 random pixels on each plane.
+ */
+TEST_F(eutelgeotestTest, PixelBoxesMatchTGeo) {
+
+	double const abs_err = 1e-5;
+
+	for(auto sensorID: eugeo::gGeometry().sensorIDsVec()) {
+		auto geoDescr = eugeo::gGeometry().getPixGeoDescr(sensorID);
+		auto const planePath = eugeo::gGeometry().getPlanePath(sensorID);
+		geoDescr->buildPixelBoxes(planePath);
+
+		int minX, maxX, minY, maxY;
+		geoDescr->getPixelIndexRange(minX, maxX, minY, maxY);
+		std::uniform_int_distribution<int> xDist(minX, maxX), yDist(minY, maxY);
+
+		for(size_t i = 0; i < 100; i++) {
+			int const x = xDist(generator);
+			int const y = yDist(generator);
+			std::string const path = planePath + geoDescr->getPixName(x, y);
+			ASSERT_TRUE(eugeo::gGeometry()._geoManager->cd(path.c_str()));
+
+			auto bbox = dynamic_cast<TGeoBBox*>(eugeo::gGeometry()._geoManager->GetCurrentVolume()->GetShape());
+			auto const depth = std::count(path.begin(), path.end(), '/') - 3;
+			double local[3] = {0, 0, 0};
+			double master[3];
+			eugeo::gGeometry()._geoManager->GetCurrentNode()->LocalToMaster(local, master);
+			for(int up = 1; up < depth; up++) {
+				std::copy(master, master+3, local);
+				eugeo::gGeometry()._geoManager->GetMother(up)->LocalToMaster(local, master);
+			}
+
+			auto const & box = geoDescr->getPixelBox(x, y);
+			ASSERT_NEAR(box.x, master[0], abs_err);
+			ASSERT_NEAR(box.y, master[1], abs_err);
+			ASSERT_NEAR(box.halfX, bbox->GetDX(), abs_err);
+			ASSERT_NEAR(box.halfY, bbox->GetDY(), abs_err);
+		}
+	}
+}
+
 
 // }  // namespace - could surround eutelgeotestTest in a namespace
@@ -0,0 +1,137 @@
+//STL
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <utility>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTELESCOPE.h"
+#include "EUTelFixedFrameClusterFinder.h"
+
+using namespace eutelescope;
+
+namespace {
+
+struct LegacyCluster {
+	int seedX, seedY;
+	int quality;
+	std::vector<float> charges;
+};
+
+/** Reference implementation: the seed and window loops formerly used in
+ *  EUTelClusteringProcessor::fixedFrameClustering, on plain vectors.
+ */
+std::vector<LegacyCluster> legacyClustering(int xNoOfPixel, int yNoOfPixel, int xClusterSize, int yClusterSize, float seedCut, float clusterCut,
+                                            std::vector<float> const & charge, std::vector<float> const & noise, std::vector<short> & status) {
+
+	std::vector<std::pair<float, unsigned int>> seedCandidates;
+	for(unsigned int iPixel = 0; iPixel < charge.size(); iPixel++) {
+		if(status[iPixel] == EUTELESCOPE::GOODPIXEL && charge[iPixel] > seedCut * noise[iPixel]) {
+			seedCandidates.push_back(std::make_pair(charge[iPixel], iPixel));
+		}
+	}
+	std::sort(seedCandidates.begin(), seedCandidates.end());
+
+	std::vector<LegacyCluster> clusters;
+	for(auto seed = seedCandidates.rbegin(); seed != seedCandidates.rend(); ++seed) {
+		if(status[seed->second] != EUTELESCOPE::GOODPIXEL) continue;
+		double signal = 0.;
+		double noise2 = 0.;
+		std::vector<float> charges;
+		std::vector<int> indices;
+		int seedX = seed->second % xNoOfPixel;
+		int seedY = seed->second / xNoOfPixel;
+		ClusterQuality quality = kGoodCluster;
+		for(int yPixel = seedY - (yClusterSize / 2); yPixel <= seedY + (yClusterSize / 2); yPixel++) {
+			for(int xPixel = seedX - (xClusterSize / 2); xPixel <= seedX + (xClusterSize / 2); xPixel++) {
+				if(xPixel >= 0 && xPixel < xNoOfPixel && yPixel >= 0 && yPixel < yNoOfPixel) {
+					int index = xPixel + yPixel * xNoOfPixel;
+					bool isHit = status[index] == EUTELESCOPE::HITPIXEL;
+					bool isGood = status[index] == EUTELESCOPE::GOODPIXEL;
+					indices.push_back(isGood ? index : -1);
+					if(isGood && !isHit) {
+						signal += charge[index];
+						noise2 += pow(noise[index], 2);
+						charges.push_back(charge[index]);
+					} else if(isHit) {
+						quality = quality | kIncompleteCluster | kMergedCluster;
+						charges.push_back(0.);
+					} else {
+						quality = quality | kIncompleteCluster;
+						charges.push_back(0.);
+					}
+				} else {
+					quality = quality | kBorderCluster;
+					charges.push_back(0.);
+					indices.push_back(-1);
+				}
+			}
+		}
+		if(signal > clusterCut * sqrt(noise2)) {
+			for(int index: indices) {
+				if(index != -1) status[index] = EUTELESCOPE::HITPIXEL;
+			}
+			clusters.push_back(LegacyCluster{seedX, seedY, static_cast<int>(quality), charges});
+		}
+	}
+	return clusters;
+}
+
+}
+
+/** Random noise frames with Gaussian charge blobs and some bad pixels, for
+ *  several window sizes including even ones: the clusters, their quality,
+ *  their charges and the final status must be identical to the former loop.
+ *  The same finder is reused across frames to check that its buffers are
+ *  properly reset.
+ */
+TEST(EUTelFixedFrameClusterFinderTest, IdenticalToLegacyClustering) {
+
+	int const xNoOfPixel = 128;
+	int const yNoOfPixel = 64;
+	std::mt19937 generator(20170902);
+	std::normal_distribution<float> gaussian(0.f, 1.f);
+	std::uniform_int_distribution<int> pixelDistribution(0, xNoOfPixel * yNoOfPixel - 1);
+
+	for(auto size: {std::make_pair(3, 3), std::make_pair(5, 3), std::make_pair(1, 1), std::make_pair(4, 2)}) {
+		EUTelFixedFrameClusterFinder finder(xNoOfPixel, yNoOfPixel, size.first, size.second, 4.5f, 6.f);
+		std::vector<EUTelFixedFrameClusterFinder::Cluster> clusters;
+		for(int frame = 0; frame < 20; ++frame) {
+			std::vector<float> charge(xNoOfPixel * yNoOfPixel), noise(xNoOfPixel * yNoOfPixel);
+			std::vector<short> status(xNoOfPixel * yNoOfPixel, EUTELESCOPE::GOODPIXEL);
+			for(size_t iPixel = 0; iPixel < charge.size(); ++iPixel) {
+				noise[iPixel] = 1.f + 0.2f * std::abs(gaussian(generator));
+				charge[iPixel] = noise[iPixel] * gaussian(generator);
+			}
+			for(int iHit = 0; iHit < 10 * frame; ++iHit) {
+				int centre = pixelDistribution(generator);
+				for(int dy = -1; dy <= 1; ++dy) {
+					for(int dx = -1; dx <= 1; ++dx) {
+						int index = centre + dx + dy * xNoOfPixel;
+						if(index < 0 || index >= xNoOfPixel * yNoOfPixel) continue;
+						charge[index] += (dx == 0 && dy == 0 ? 20.f : 5.f) * (1.f + 0.3f * gaussian(generator));
+					}
+				}
+			}
+			for(int iBad = 0; iBad < 30; ++iBad) {
+				status[pixelDistribution(generator)] = EUTELESCOPE::BADPIXEL;
+			}
+
+			std::vector<short> legacyStatus(status);
+			auto reference = legacyClustering(xNoOfPixel, yNoOfPixel, size.first, size.second, 4.5f, 6.f, charge, noise, legacyStatus);
+			ASSERT_EQ(reference.size(), finder.findClusters(charge.data(), noise.data(), status.data(), clusters));
+			for(size_t iCluster = 0; iCluster < clusters.size(); ++iCluster) {
+				ASSERT_EQ(reference[iCluster].seedX, clusters[iCluster].seedX);
+				ASSERT_EQ(reference[iCluster].seedY, clusters[iCluster].seedY);
+				ASSERT_EQ(reference[iCluster].quality, static_cast<int>(clusters[iCluster].quality));
+				std::vector<float> charges(finder.getCharges(clusters[iCluster]), finder.getCharges(clusters[iCluster]) + finder.getWindowSize());
+				ASSERT_EQ(reference[iCluster].charges, charges);
+			}
+			ASSERT_EQ(legacyStatus, status);
+		}
+	}
+}
@@ -0,0 +1,108 @@
+//STL
+#include <algorithm>
+#include <random>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelSparseClusterFinder.h"
+
+using eutelescope::EUTelSparseClusterFinder;
+
+namespace {
+
+/** Reference implementation: the neighbour search formerly used in EUTelSparseClustering,
+ *  working on pixel indices instead of EUTelBaseSparsePixel references.
+ */
+std::vector<std::vector<size_t>> legacyClustering(std::vector<int> const & x, std::vector<int> const & y, int minDistanceSquared) {
+
+	std::vector<size_t> hitPixelVec(x.size());
+	for(size_t i = 0; i < hitPixelVec.size(); ++i) hitPixelVec[i] = i;
+
+	std::vector<std::vector<size_t>> clusters;
+	while(!hitPixelVec.empty()) {
+		std::vector<size_t> cluster;
+		std::vector<size_t> newlyAdded;
+		newlyAdded.push_back(hitPixelVec.front());
+		cluster.push_back(hitPixelVec.front());
+		hitPixelVec.erase(hitPixelVec.begin());
+
+		while(!newlyAdded.empty()) {
+			bool newlyDone = true;
+			for(auto hitVec = hitPixelVec.begin(); hitVec != hitPixelVec.end(); ++hitVec) {
+				int dX = x[newlyAdded.front()] - x[*hitVec];
+				int dY = y[newlyAdded.front()] - y[*hitVec];
+				if(dX*dX + dY*dY <= minDistanceSquared) {
+					newlyAdded.push_back(*hitVec);
+					cluster.push_back(*hitVec);
+					hitPixelVec.erase(hitVec);
+					newlyDone = false;
+					break;
+				}
+			}
+			if(newlyDone) newlyAdded.erase(newlyAdded.begin());
+		}
+		clusters.push_back(cluster);
+	}
+	return clusters;
+}
+
+void compareToLegacy(EUTelSparseClusterFinder& finder, std::vector<int> const & x, std::vector<int> const & y, int minDistanceSquared) {
+
+	finder.clear();
+	for(size_t i = 0; i < x.size(); ++i) finder.addPixel(x[i], y[i]);
+	size_t noOfClusters = finder.findClusters();
+
+	auto reference = legacyClustering(x, y, minDistanceSquared);
+	ASSERT_EQ(reference.size(), noOfClusters);
+	for(size_t iCluster = 0; iCluster < noOfClusters; ++iCluster) {
+		auto range = finder.getCluster(iCluster);
+		std::vector<size_t> cluster(range.first, range.second);
+		ASSERT_EQ(reference[iCluster], cluster);
+	}
+}
+
+}
+
+/** Random hit maps on a Mimosa26 sized matrix at various occupancies and distance cuts, clusters
+ *  (including the order of the pixels inside them) must be identical to the former algorithm.
+ *  The same finder is reused across events to check that the grid is properly reset.
+ */
+TEST(EUTelSparseClusterFinderTest, IdenticalToLegacyClustering) {
+
+	std::mt19937 generator(20170901);
+	std::uniform_int_distribution<int> xDistribution(0, 1151);
+	std::uniform_int_distribution<int> yDistribution(0, 575);
+
+	for(int minDistanceSquared: {0, 1, 2, 4, 8}) {
+		EUTelSparseClusterFinder finder(0, 1151, 0, 575, minDistanceSquared);
+		for(size_t noOfHits: {0, 1, 50, 500, 2000}) {
+			std::vector<int> x, y;
+			for(size_t i = 0; i < noOfHits; ++i) {
+				//hits are generated in small blobs to get sizeable clusters and duplicates
+				int xSeed = xDistribution(generator);
+				int ySeed = yDistribution(generator);
+				x.push_back(std::min(1151, xSeed));
+				y.push_back(std::min(575, ySeed));
+				for(int k = 0; k < static_cast<int>(generator() % 4); ++k) {
+					x.push_back(std::min(1151, xSeed + static_cast<int>(generator() % 3)));
+					y.push_back(std::min(575, ySeed + static_cast<int>(generator() % 3)));
+				}
+			}
+			compareToLegacy(finder, x, y, minDistanceSquared);
+		}
+	}
+}
+
+/** Pixels outside the declared index range must still be clustered correctly.
+ */
+TEST(EUTelSparseClusterFinderTest, PixelsOutsideIndexRange) {
+
+	EUTelSparseClusterFinder finder(0, 9, 0, 9, 2);
+	std::vector<int> x = {-1, 0, 10, 11, 5, 20, 21};
+	std::vector<int> y = {-1, 0, 10, 11, 5, -3, -3};
+	compareToLegacy(finder, x, y, 2);
+	ASSERT_EQ(4u, finder.getNumberOfClusters());
+}